@@ -486,6 +486,17 @@ main (int argc, char *argv[])
   dict.Add ( Collider ("Murmur3",
                        Hasher ( Create<Hash::Function::Murmur3> () ),
                        Collider::Bits64));
+
+  dict.Add ( Collider ("xxHash",
+                       Hasher ( Create<Hash::Function::XxHash> () ),
+                       Collider::Bits32));
+  dict.Add ( Collider ("xxHash",
+                       Hasher ( Create<Hash::Function::XxHash> () ),
+                       Collider::Bits64));
+
+  dict.Add ( Collider ("CRC32C",
+                       Hasher ( Create<Hash::Function::Crc32c> () ),
+                       Collider::Bits32));
   
   files.ReadInto (dict);
   
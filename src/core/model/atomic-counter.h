@@ -0,0 +1,93 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef ATOMIC_COUNTER_H
+#define ATOMIC_COUNTER_H
+
+#include "ns3/core-config.h"
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup core
+ * \param count the reference count to increment
+ * \returns the incremented value
+ *
+ * Reference counts shared by objects which may be used by several
+ * simulation threads are updated with these functions. They are plain
+ * increments and decrements unless ns-3 is configured with
+ * --enable-multithreading, in which case they are atomic.
+ */
+inline uint32_t
+AtomicIncrement (uint32_t &count)
+{
+#ifdef NS3_MULTITHREADED
+  return __sync_add_and_fetch (&count, 1);
+#else
+  return ++count;
+#endif
+}
+
+/**
+ * \ingroup core
+ * \param count the reference count to decrement
+ * \returns the decremented value
+ */
+inline uint32_t
+AtomicDecrement (uint32_t &count)
+{
+#ifdef NS3_MULTITHREADED
+  return __sync_sub_and_fetch (&count, 1);
+#else
+  // Relaxed loads and stores are plain moves, but unlike --count they
+  // are not treated by GCC as uses of an object which a previous
+  // Unref of an aliasing pointer may have deleted (-Wuse-after-free).
+  uint32_t value = __atomic_load_n (&count, __ATOMIC_RELAXED) - 1;
+  __atomic_store_n (&count, value, __ATOMIC_RELAXED);
+  return value;
+#endif
+}
+
+/**
+ * \ingroup core
+ * \param value the value to update
+ * \param expected the value which \p value must have
+ * \param desired the new value
+ * \returns true if \p value was \p expected, and is now \p desired
+ *
+ * Used to claim a part of a structure shared by several simulation
+ * threads: only one of the threads which try to claim it at the same
+ * time succeeds.
+ */
+template <typename T>
+inline bool
+AtomicCompareAndSwap (T &value, T expected, T desired)
+{
+#ifdef NS3_MULTITHREADED
+  return __sync_bool_compare_and_swap (&value, expected, desired);
+#else
+  if (value != expected)
+    {
+      return false;
+    }
+  value = desired;
+  return true;
+#endif
+}
+
+} // namespace ns3
+
+#endif /* ATOMIC_COUNTER_H */
@@ -29,6 +29,8 @@
 #include "attribute-helper.h"
 #include "simple-ref-count.h"
 #include <typeinfo>
+#include <new>
+#include <stdint.h>
 
 namespace ns3 {
 
@@ -138,6 +140,93 @@ public:
    * \return true if we are equal
    */
   virtual bool IsEqual (Ptr<const CallbackImplBase> other) const = 0;
+  /**
+   * Copy this implementation, to store it in a CallbackBase.
+   *
+   * Only the implementations which CallbackBase stores inline are
+   * copied: the others are shared by reference counting, so a
+   * CallbackImpl which is only ever passed as a Ptr to a Callback
+   * does not need to override this method.
+   *
+   * \param buffer the storage of the copy, or 0 to allocate it
+   * \return the copy
+   */
+  virtual CallbackImplBase *Copy (void *buffer) const {
+    NS_FATAL_ERROR ("CallbackImpl does not support inline storage");
+    return 0;
+  }
+};
+
+/**
+ * \ingroup callbackimpl
+ * The buffer in which a CallbackBase stores its implementation inline:
+ * large enough for a member function pointer, its object pointer and
+ * one bound argument, or a function pointer and two bound arguments.
+ */
+struct CallbackBuffer
+{
+  /** An element of the buffer, aligned for the implementations. */
+  union Element
+  {
+    void *m_pointer;                    //!< a pointer alignment
+    double m_double;                    //!< a double alignment
+    uint64_t m_integer;                 //!< a 64-bit integer alignment
+  };
+  Element m_elements[6];                //!< the storage
+};
+
+/**
+ * \ingroup callbackimpl
+ * The storage of the implementations of type IMPL in a CallbackBase.
+ *
+ * Whether IMPL is stored inline is decided from its type at compile
+ * time: the code which copies an implementation into a CallbackBuffer
+ * is only instantiated for the implementations which fit in it.
+ *
+ * \tparam IMPL the type of the implementation
+ * \tparam INLINE true if IMPL fits in a CallbackBuffer
+ */
+template <typename IMPL,
+          bool INLINE = (sizeof (IMPL) <= sizeof (CallbackBuffer)
+                         && alignof (IMPL) <= alignof (CallbackBuffer))>
+struct CallbackStorage
+{
+  static const bool IS_INLINE = true;   //!< IMPL is stored inline
+  /**
+   * \param impl the implementation to copy
+   * \param buffer the storage of the copy, or 0 to allocate it
+   * \return the copy
+   */
+  static CallbackImplBase *Copy (IMPL const &impl, void *buffer)
+  {
+    if (buffer == 0)
+      {
+        return new IMPL (impl);
+      }
+    return new (buffer) IMPL (impl);
+  }
+};
+
+/**
+ * \ingroup callbackimpl
+ * The storage of the implementations too large to be stored inline:
+ * they are allocated, and shared by reference counting.
+ *
+ * \tparam IMPL the type of the implementation
+ */
+template <typename IMPL>
+struct CallbackStorage<IMPL, false>
+{
+  static const bool IS_INLINE = false;  //!< IMPL is not stored inline
+  /**
+   * Never called: only the implementations stored inline are copied.
+   * \return 0
+   */
+  static CallbackImplBase *Copy (IMPL const &, void *)
+  {
+    NS_FATAL_ERROR ("Callback implementation not stored inline");
+    return 0;
+  }
 };
 
 /**
@@ -349,6 +438,15 @@ public:
     return m_functor (a1,a2,a3,a4,a5,a6,a7,a8,a9);
   }
   /**@}*/
+  /**
+   * Copy this implementation.
+   *
+   * \param buffer the storage of the copy, or 0 to allocate it
+   * \return the copy
+   */
+  virtual CallbackImplBase *Copy (void *buffer) const {
+    return CallbackStorage<FunctorCallbackImpl>::Copy (*this, buffer);
+  }
   /**
    * Equality test.
    *
@@ -496,6 +594,15 @@ public:
     return ((CallbackTraits<OBJ_PTR>::GetReference (m_objPtr)).*m_memPtr)(a1, a2, a3, a4, a5, a6, a7, a8, a9);
   }
   /**@}*/
+  /**
+   * Copy this implementation.
+   *
+   * \param buffer the storage of the copy, or 0 to allocate it
+   * \return the copy
+   */
+  virtual CallbackImplBase *Copy (void *buffer) const {
+    return CallbackStorage<MemPtrCallbackImpl>::Copy (*this, buffer);
+  }
   /**
    * Equality test.
    *
@@ -630,6 +737,15 @@ public:
     return m_functor (m_a,a1,a2,a3,a4,a5,a6,a7,a8);
   }
   /**@}*/
+  /**
+   * Copy this implementation.
+   *
+   * \param buffer the storage of the copy, or 0 to allocate it
+   * \return the copy
+   */
+  virtual CallbackImplBase *Copy (void *buffer) const {
+    return CallbackStorage<BoundFunctorCallbackImpl>::Copy (*this, buffer);
+  }
   /**
    * Equality test.
    *
@@ -751,6 +867,15 @@ public:
     return m_functor (m_a1,m_a2,a1,a2,a3,a4,a5,a6,a7);
   }
   /**@}*/
+  /**
+   * Copy this implementation.
+   *
+   * \param buffer the storage of the copy, or 0 to allocate it
+   * \return the copy
+   */
+  virtual CallbackImplBase *Copy (void *buffer) const {
+    return CallbackStorage<TwoBoundFunctorCallbackImpl>::Copy (*this, buffer);
+  }
   /**
    * Equality test.
    *
@@ -861,6 +986,15 @@ public:
     return m_functor (m_a1,m_a2,m_a3,a1,a2,a3,a4,a5,a6);
   }
   /**@}*/
+  /**
+   * Copy this implementation.
+   *
+   * \param buffer the storage of the copy, or 0 to allocate it
+   * \return the copy
+   */
+  virtual CallbackImplBase *Copy (void *buffer) const {
+    return CallbackStorage<ThreeBoundFunctorCallbackImpl>::Copy (*this, buffer);
+  }
   /**
    * Equality test.
    *
@@ -892,25 +1026,140 @@ private:
  * \ingroup callbackimpl
  * Base class for Callback class.
  * Provides pimpl abstraction.
+ *
+ * The implementations of the common callbacks (a member function and
+ * its object, or a function and up to two bound arguments) are small:
+ * they are stored inline, in a buffer of the CallbackBase, and are
+ * copied with it, so creating, copying and destroying these callbacks
+ * does not allocate memory.  The larger implementations are allocated
+ * and shared by reference counting.
  */
 class CallbackBase {
 public:
-  CallbackBase () : m_impl () {}
-  /** \return the impl pointer */
-  Ptr<CallbackImplBase> GetImpl (void) const { return m_impl; }
+  CallbackBase () : m_impl (0) {}
+  /**
+   * Copy constructor
+   * \param o the CallbackBase to copy
+   */
+  CallbackBase (const CallbackBase &o) : m_impl (0) { Acquire (o); }
+  /**
+   * Assignment operator
+   * \param o the CallbackBase to copy
+   * \return this CallbackBase
+   */
+  CallbackBase &operator = (const CallbackBase &o) {
+    if (this != &o)
+      {
+        Release ();
+        Acquire (o);
+      }
+    return *this;
+  }
+  ~CallbackBase () { Release (); }
+  /**
+   * Get the impl pointer.
+   *
+   * An implementation stored inline is copied to the heap, so the
+   * returned Ptr stays valid after this CallbackBase is destroyed.
+   * Use PeekImpl to inspect the implementation without copying it.
+   *
+   * \return the impl pointer
+   */
+  Ptr<CallbackImplBase> GetImpl (void) const {
+    if (IsInline ())
+      {
+        return Ptr<CallbackImplBase> (m_impl->Copy (0), false);
+      }
+    return Ptr<CallbackImplBase> (m_impl);
+  }
+  /**
+   * \return the impl pointer, valid as long as this CallbackBase is
+   * not modified or destroyed
+   */
+  CallbackImplBase *PeekImpl (void) const { return m_impl; }
+  /** Tag to construct a Callback from a copy of a CallbackImpl. */
+  struct ImplTag {};
 protected:
   /**
    * Construct from a pimpl
    * \param impl the CallbackImplBase Ptr
    */
-  CallbackBase (Ptr<CallbackImplBase> impl) : m_impl (impl) {}
-  Ptr<CallbackImplBase> m_impl;         //!< the pimpl
+  CallbackBase (Ptr<CallbackImplBase> impl) : m_impl (PeekPointer (impl)) {
+    if (m_impl != 0)
+      {
+        m_impl->Ref ();
+      }
+  }
+  /**
+   * Get the storage of a new implementation: the inline buffer when
+   * the implementation fits in it, else a heap allocation which is
+   * released by the reference counting of the implementation.
+   *
+   * \tparam IMPL the type of the implementation
+   * \return the storage of the implementation, to construct with
+   * placement new
+   */
+  template <typename IMPL>
+  void *Allocate (void) {
+    if (CallbackStorage<IMPL>::IS_INLINE)
+      {
+        return &m_buffer;
+      }
+    return ::operator new (sizeof (IMPL));
+  }
+  /**
+   * Set the implementation, constructed in the inline buffer or on the heap.
+   * \param impl the implementation to copy
+   */
+  template <typename IMPL>
+  void Store (IMPL const &impl) {
+    m_impl = new (Allocate<IMPL> ()) IMPL (impl);
+  }
+  /** Discard the implementation, set it to null */
+  void Release (void) {
+    if (IsInline ())
+      {
+        m_impl->~CallbackImplBase ();
+      }
+    else if (m_impl != 0)
+      {
+        m_impl->Unref ();
+      }
+    m_impl = 0;
+  }
+
+  CallbackImplBase *m_impl;             //!< the pimpl
 
   /**
    * \param mangled the mangled string
    * \return the demangled form of mangled
    */
   static std::string Demangle (const std::string& mangled);
+
+private:
+  /**
+   * Share or copy the implementation of another CallbackBase.
+   * \param o the CallbackBase
+   */
+  void Acquire (const CallbackBase &o) {
+    if (o.IsInline ())
+      {
+        m_impl = o.m_impl->Copy (&m_buffer);
+      }
+    else if (o.m_impl != 0)
+      {
+        m_impl = o.m_impl;
+        m_impl->Ref ();
+      }
+  }
+  /** \return true if the implementation is stored in the inline buffer */
+  bool IsInline (void) const {
+    const char *impl = reinterpret_cast<const char *> (m_impl);
+    const char *buffer = reinterpret_cast<const char *> (&m_buffer);
+    return impl >= buffer && impl < buffer + sizeof (m_buffer);
+  }
+
+  CallbackBuffer m_buffer;              //!< the inline implementation
 };
 
 /**
@@ -984,8 +1233,10 @@ public:
    */
   template <typename FUNCTOR>
   Callback (FUNCTOR const &functor, bool, bool) 
-    : CallbackBase (Create<FunctorCallbackImpl<FUNCTOR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (functor))
-  {}
+  {
+    typedef FunctorCallbackImpl<FUNCTOR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> Impl;
+    m_impl = new (Allocate<Impl> ()) Impl (functor);
+  }
 
   /**
    * Construct a member function pointer call back.
@@ -995,8 +1246,10 @@ public:
    */
   template <typename OBJ_PTR, typename MEM_PTR>
   Callback (OBJ_PTR const &objPtr, MEM_PTR memPtr)
-    : CallbackBase (Create<MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (objPtr, memPtr))
-  {}
+  {
+    typedef MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> Impl;
+    m_impl = new (Allocate<Impl> ()) Impl (objPtr, memPtr);
+  }
 
   /**
    * Construct from a CallbackImpl pointer
@@ -1007,6 +1260,19 @@ public:
     : CallbackBase (impl)
   {}
 
+  /**
+   * Construct from a copy of a CallbackImpl, stored inline if it is
+   * small enough.
+   *
+   * \param impl the CallbackImpl, derived from
+   *        CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9>
+   */
+  template <typename IMPL>
+  Callback (IMPL const &impl, CallbackBase::ImplTag)
+  {
+    Store (impl);
+  }
+
   /**
    * Bind the first arguments
    *
@@ -1015,12 +1281,11 @@ public:
    */
   template <typename T>
   Callback<R,T2,T3,T4,T5,T6,T7,T8,T9> Bind (T a) {
-    Ptr<CallbackImpl<R,T2,T3,T4,T5,T6,T7,T8,T9,empty> > impl =
-      Ptr<CallbackImpl<R,T2,T3,T4,T5,T6,T7,T8,T9,empty> > (
-        new BoundFunctorCallbackImpl<
-          Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9>,
-          R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (*this, a), false);
-    return Callback<R,T2,T3,T4,T5,T6,T7,T8,T9> (impl);
+    return Callback<R,T2,T3,T4,T5,T6,T7,T8,T9> (
+      BoundFunctorCallbackImpl<
+        Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9>,
+        R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (*this, a),
+      CallbackBase::ImplTag ());
   }
 
   /**
@@ -1032,12 +1297,11 @@ public:
    */
   template <typename TX1, typename TX2>
   Callback<R,T3,T4,T5,T6,T7,T8,T9> TwoBind (TX1 a1, TX2 a2) {
-    Ptr<CallbackImpl<R,T3,T4,T5,T6,T7,T8,T9,empty,empty> > impl =
-      Ptr<CallbackImpl<R,T3,T4,T5,T6,T7,T8,T9,empty,empty> > (
-        new TwoBoundFunctorCallbackImpl<
-          Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9>,
-          R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (*this, a1, a2), false);
-    return Callback<R,T3,T4,T5,T6,T7,T8,T9> (impl);
+    return Callback<R,T3,T4,T5,T6,T7,T8,T9> (
+      TwoBoundFunctorCallbackImpl<
+        Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9>,
+        R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (*this, a1, a2),
+      CallbackBase::ImplTag ());
   }
 
   /**
@@ -1050,12 +1314,11 @@ public:
    */
   template <typename TX1, typename TX2, typename TX3>
   Callback<R,T4,T5,T6,T7,T8,T9> ThreeBind (TX1 a1, TX2 a2, TX3 a3) {
-    Ptr<CallbackImpl<R,T4,T5,T6,T7,T8,T9,empty,empty,empty> > impl =
-      Ptr<CallbackImpl<R,T4,T5,T6,T7,T8,T9,empty,empty,empty> > (
-        new ThreeBoundFunctorCallbackImpl<
-          Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9>,
-          R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (*this, a1, a2, a3), false);
-    return Callback<R,T4,T5,T6,T7,T8,T9> (impl);
+    return Callback<R,T4,T5,T6,T7,T8,T9> (
+      ThreeBoundFunctorCallbackImpl<
+        Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9>,
+        R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (*this, a1, a2, a3),
+      CallbackBase::ImplTag ());
   }
 
   /**
@@ -1068,7 +1331,7 @@ public:
   }
   /** Discard the implementation, set it to null */
   void Nullify (void) {
-    m_impl = 0;
+    Release ();
   }
 
   /**
@@ -1187,7 +1450,7 @@ public:
    * \return true if we are equal
    */
   bool IsEqual (const CallbackBase &other) const {
-    return m_impl->IsEqual (other.GetImpl ());
+    return m_impl->IsEqual (Ptr<const CallbackImplBase> (other.PeekImpl ()));
   }
 
   /**
@@ -1197,7 +1460,7 @@ public:
    * \return true if other can be dynamic_cast to my type
    */
   bool CheckType (const CallbackBase & other) const {
-    return DoCheckType (other.GetImpl ());
+    return DoCheckType (other.PeekImpl ());
   }
   /**
    * Adopt the other's implementation, if type compatible
@@ -1205,21 +1468,27 @@ public:
    * \param other Callback
    */
   void Assign (const CallbackBase &other) {
-    DoAssign (other.GetImpl ());
+    if (!DoCheckType (other.PeekImpl ()))
+      {
+        NS_FATAL_ERROR ("Incompatible types. (feed to \"c++filt -t\" if needed)" << std::endl <<
+                        "got=" << Demangle ( typeid (*other.PeekImpl ()).name () ) << std::endl <<
+                        "expected=" << Demangle ( typeid (CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *).name () ));
+      }
+    CallbackBase::operator = (other);
   }
 private:
   /** \return the pimpl pointer */
   CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *DoPeekImpl (void) const {
-    return static_cast<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (PeekPointer (m_impl));
+    return static_cast<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (m_impl);
   }
   /**
    * Check for compatible types
    *
-   * \param other Callback Ptr
+   * \param other Callback implementation
    * \return true if other can be dynamic_cast to my type
    */
-  bool DoCheckType (Ptr<const CallbackImplBase> other) const {
-    if (other != 0 && dynamic_cast<const CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (PeekPointer (other)) != 0)
+  bool DoCheckType (const CallbackImplBase *other) const {
+    if (other != 0 && dynamic_cast<const CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (other) != 0)
       {
         return true;
       }
@@ -1232,20 +1501,6 @@ private:
         return false;
       }
   }
-  /**
-   * Adopt the other's implementation, if type compatible
-   *
-   * \param other Callback Ptr to adopt from
-   */
-  void DoAssign (Ptr<const CallbackImplBase> other) {
-    if (!DoCheckType (other))
-      {
-        NS_FATAL_ERROR ("Incompatible types. (feed to \"c++filt -t\" if needed)" << std::endl <<
-                        "got=" << Demangle ( typeid (*other).name () ) << std::endl <<
-                        "expected=" << Demangle ( typeid (CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *).name () ));
-      }
-    m_impl = const_cast<CallbackImplBase *> (PeekPointer (other));
-  }
 };
 
 
@@ -1478,65 +1733,56 @@ Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> MakeNullCallback (void) {
  */   
 template <typename R, typename TX, typename ARG>
 Callback<R> MakeBoundCallback (R (*fnPtr)(TX), ARG a1) {
-  Ptr<CallbackImpl<R,empty,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX),R,TX,empty,empty,empty,empty,empty,empty,empty,empty> >(fnPtr, a1);
-  return Callback<R> (impl);
+  return Callback<R> (BoundFunctorCallbackImpl<R (*)(TX),R,TX,empty,empty,empty,empty,empty,empty,empty,empty> (fnPtr, a1),
+                      CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG, 
           typename T1>
 Callback<R,T1> MakeBoundCallback (R (*fnPtr)(TX,T1), ARG a1) {
-  Ptr<CallbackImpl<R,T1,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1),R,TX,T1,empty,empty,empty,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1> (impl);
+  return Callback<R,T1> (BoundFunctorCallbackImpl<R (*)(TX,T1),R,TX,T1,empty,empty,empty,empty,empty,empty,empty> (fnPtr, a1),
+                         CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG, 
           typename T1, typename T2>
 Callback<R,T1,T2> MakeBoundCallback (R (*fnPtr)(TX,T1,T2), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2),R,TX,T1,T2,empty,empty,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2> (impl);
+  return Callback<R,T1,T2> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2),R,TX,T1,T2,empty,empty,empty,empty,empty,empty> (fnPtr, a1),
+                            CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3>
 Callback<R,T1,T2,T3> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3),R,TX,T1,T2,T3,empty,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3> (impl);
+  return Callback<R,T1,T2,T3> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3),R,TX,T1,T2,T3,empty,empty,empty,empty,empty> (fnPtr, a1),
+                               CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4>
 Callback<R,T1,T2,T3,T4> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4),R,TX,T1,T2,T3,T4,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4> (impl);
+  return Callback<R,T1,T2,T3,T4> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4),R,TX,T1,T2,T3,T4,empty,empty,empty,empty> (fnPtr, a1),
+                                  CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5>
 Callback<R,T1,T2,T3,T4,T5> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5),R,TX,T1,T2,T3,T4,T5,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5> (impl);
+  return Callback<R,T1,T2,T3,T4,T5> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5),R,TX,T1,T2,T3,T4,T5,empty,empty,empty> (fnPtr, a1),
+                                     CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6>
 Callback<R,T1,T2,T3,T4,T5,T6> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5,T6), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6),R,TX,T1,T2,T3,T4,T5,T6,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5,T6> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6),R,TX,T1,T2,T3,T4,T5,T6,empty,empty> (fnPtr, a1),
+                                        CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6, typename T7>
 Callback<R,T1,T2,T3,T4,T5,T6,T7> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5,T6,T7), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7),R,TX,T1,T2,T3,T4,T5,T6,T7,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7),R,TX,T1,T2,T3,T4,T5,T6,T7,empty> (fnPtr, a1),
+                                           CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6, typename T7, typename T8>
 Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5,T6,T7,T8), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7,T8),R,TX,T1,T2,T3,T4,T5,T6,T7,T8> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7,T8),R,TX,T1,T2,T3,T4,T5,T6,T7,T8> (fnPtr, a1),
+                                              CallbackBase::ImplTag ());
 }
 /**@}*/
 
@@ -1551,58 +1797,50 @@ Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4
  */
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2>
 Callback<R> MakeBoundCallback (R (*fnPtr)(TX1,TX2), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,empty,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2),R,TX1,TX2,empty,empty,empty,empty,empty,empty,empty> >(fnPtr, a1, a2);
-  return Callback<R> (impl);
+  return Callback<R> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2),R,TX1,TX2,empty,empty,empty,empty,empty,empty,empty> (fnPtr, a1, a2),
+                      CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1>
 Callback<R,T1> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1),R,TX1,TX2,T1,empty,empty,empty,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1> (impl);
+  return Callback<R,T1> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1),R,TX1,TX2,T1,empty,empty,empty,empty,empty,empty> (fnPtr, a1, a2),
+                         CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2>
 Callback<R,T1,T2> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2),R,TX1,TX2,T1,T2,empty,empty,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2> (impl);
+  return Callback<R,T1,T2> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2),R,TX1,TX2,T1,T2,empty,empty,empty,empty,empty> (fnPtr, a1, a2),
+                            CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3>
 Callback<R,T1,T2,T3> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3),R,TX1,TX2,T1,T2,T3,empty,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3> (impl);
+  return Callback<R,T1,T2,T3> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3),R,TX1,TX2,T1,T2,T3,empty,empty,empty,empty> (fnPtr, a1, a2),
+                               CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4>
 Callback<R,T1,T2,T3,T4> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4),R,TX1,TX2,T1,T2,T3,T4,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4> (impl);
+  return Callback<R,T1,T2,T3,T4> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4),R,TX1,TX2,T1,T2,T3,T4,empty,empty,empty> (fnPtr, a1, a2),
+                                  CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4,typename T5>
 Callback<R,T1,T2,T3,T4,T5> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4,T5), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5),R,TX1,TX2,T1,T2,T3,T4,T5,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4,T5> (impl);
+  return Callback<R,T1,T2,T3,T4,T5> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5),R,TX1,TX2,T1,T2,T3,T4,T5,empty,empty> (fnPtr, a1, a2),
+                                     CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6>
 Callback<R,T1,T2,T3,T4,T5,T6> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4,T5,T6), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6),R,TX1,TX2,T1,T2,T3,T4,T5,T6,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4,T5,T6> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6),R,TX1,TX2,T1,T2,T3,T4,T5,T6,empty> (fnPtr, a1, a2),
+                                        CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6, typename T7>
 Callback<R,T1,T2,T3,T4,T5,T6,T7> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4,T5,T6,T7), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6,T7),R,TX1,TX2,T1,T2,T3,T4,T5,T6,T7> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6,T7),R,TX1,TX2,T1,T2,T3,T4,T5,T6,T7> (fnPtr, a1, a2),
+                                           CallbackBase::ImplTag ());
 }
 /**@}*/
 
@@ -1618,51 +1856,44 @@ Callback<R,T1,T2,T3,T4,T5,T6,T7> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,
  */
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3>
 Callback<R> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,empty,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3),R,TX1,TX2,TX3,empty,empty,empty,empty,empty,empty> >(fnPtr, a1, a2, a3);
-  return Callback<R> (impl);
+  return Callback<R> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3),R,TX1,TX2,TX3,empty,empty,empty,empty,empty,empty> (fnPtr, a1, a2, a3),
+                      CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1>
 Callback<R,T1> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1),R,TX1,TX2,TX3,T1,empty,empty,empty,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1> (impl);
+  return Callback<R,T1> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1),R,TX1,TX2,TX3,T1,empty,empty,empty,empty,empty> (fnPtr, a1, a2, a3),
+                         CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2>
 Callback<R,T1,T2> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2),R,TX1,TX2,TX3,T1,T2,empty,empty,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2> (impl);
+  return Callback<R,T1,T2> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2),R,TX1,TX2,TX3,T1,T2,empty,empty,empty,empty> (fnPtr, a1, a2, a3),
+                            CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3>
 Callback<R,T1,T2,T3> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3),R,TX1,TX2,TX3,T1,T2,T3,empty,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3> (impl);
+  return Callback<R,T1,T2,T3> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3),R,TX1,TX2,TX3,T1,T2,T3,empty,empty,empty> (fnPtr, a1, a2, a3),
+                               CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3,typename T4>
 Callback<R,T1,T2,T3,T4> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3,T4), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4),R,TX1,TX2,TX3,T1,T2,T3,T4,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3,T4> (impl);
+  return Callback<R,T1,T2,T3,T4> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4),R,TX1,TX2,TX3,T1,T2,T3,T4,empty,empty> (fnPtr, a1, a2, a3),
+                                  CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3,typename T4,typename T5>
 Callback<R,T1,T2,T3,T4,T5> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3,T4,T5), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3,T4,T5> (impl);
+  return Callback<R,T1,T2,T3,T4,T5> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,empty> (fnPtr, a1, a2, a3),
+                                     CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6>
 Callback<R,T1,T2,T3,T4,T5,T6> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3,T4,T5,T6), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5,T6),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,T6> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3,T4,T5,T6> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5,T6),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,T6> (fnPtr, a1, a2, a3),
+                                        CallbackBase::ImplTag ());
 }
 /**@}*/
 
@@ -26,6 +26,8 @@
 #include "pointer.h"
 #include "log.h"
 
+#include <algorithm>
+#include <map>
 #include <sstream>
 
 NS_LOG_COMPONENT_DEFINE ("Config");
@@ -147,80 +149,128 @@ class ArrayMatcher
 public:
   ArrayMatcher (std::string element);
   bool Matches (uint32_t i) const;
+  /**
+   * \param n the number of elements of a container
+   * \returns true if it is faster to look up the few indexes which can
+   *          match than to try every element of the container
+   */
+  bool IsSparse (uint32_t n) const;
+  /**
+   * \returns the sorted and disjoint ranges of the indexes which match
+   */
+  std::vector<std::pair<uint32_t, uint32_t> > GetRanges (void) const;
 private:
+  void Parse (std::string element);
   bool StringToUint32 (std::string str, uint32_t *value) const;
-  std::string m_element;
+  bool m_all;
+  // the inclusive ranges of the indexes which match
+  std::vector<std::pair<uint32_t, uint32_t> > m_ranges;
 };
 
 
 ArrayMatcher::ArrayMatcher (std::string element)
-  : m_element (element)
+  : m_all (false)
 {
   NS_LOG_FUNCTION (this << element);
+  Parse (element);
 }
-bool
-ArrayMatcher::Matches (uint32_t i) const
+void
+ArrayMatcher::Parse (std::string element)
 {
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  NS_LOG_FUNCTION (this << element);
+  if (element == "*")
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches *");
-      return true;
+      m_all = true;
+      return;
     }
   std::string::size_type tmp;
-  tmp = m_element.find ("|");
+  tmp = element.find ("|");
   if (tmp != std::string::npos)
     {
-      std::string left = m_element.substr (0, tmp-0);
-      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-      return false;
+      Parse (element.substr (0, tmp-0));
+      Parse (element.substr (tmp+1, element.size () - (tmp + 1)));
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1 &&
       dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
       if (StringToUint32 (lowerBound, &min) && 
           StringToUint32 (upperBound, &max) &&
-          i >= min && i <= max)
+          min <= max)
         {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-          return true;
-        }
-      else
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" does not "<<m_element);
-          return false;
+          m_ranges.push_back (std::make_pair (min, max));
         }
+      return;
     }
   uint32_t value;
-  if (StringToUint32 (m_element, &value) &&
-      i == value)
+  if (StringToUint32 (element, &value))
+    {
+      m_ranges.push_back (std::make_pair (value, value));
+    }
+}
+bool
+ArrayMatcher::Matches (uint32_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_all)
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
       return true;
     }
-  NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator j = m_ranges.begin ();
+       j != m_ranges.end (); ++j)
+    {
+      if (i >= j->first && i <= j->second)
+        {
+          return true;
+        }
+    }
   return false;
 }
+bool
+ArrayMatcher::IsSparse (uint32_t n) const
+{
+  NS_LOG_FUNCTION (this << n);
+  if (m_all)
+    {
+      return false;
+    }
+  uint64_t count = 0;
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator j = m_ranges.begin ();
+       j != m_ranges.end (); ++j)
+    {
+      count += (uint64_t)j->second - j->first + 1;
+    }
+  return count < n;
+}
+std::vector<std::pair<uint32_t, uint32_t> >
+ArrayMatcher::GetRanges (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_all);
+  std::vector<std::pair<uint32_t, uint32_t> > sorted = m_ranges;
+  std::sort (sorted.begin (), sorted.end ());
+  std::vector<std::pair<uint32_t, uint32_t> > merged;
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator j = sorted.begin ();
+       j != sorted.end (); ++j)
+    {
+      if (!merged.empty () && j->first <= merged.back ().second)
+        {
+          merged.back ().second = std::max (merged.back ().second, j->second);
+        }
+      else
+        {
+          merged.push_back (*j);
+        }
+    }
+  return merged;
+}
 
 bool
 ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
@@ -233,6 +283,53 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
 }
 
 
+/**
+ * A segment of a configuration path, parsed once for all the objects
+ * the path is resolved against.
+ */
+struct PathSegment
+{
+  PathSegment (std::string item);
+  std::string item;
+  // true if item is "$typeid", a call to GetObject
+  bool isGetObject;
+  // the TypeId of a "$typeid" item, if it exists
+  bool hasTid;
+  TypeId tid;
+  // item interpreted as the index of an element of a container
+  ArrayMatcher matcher;
+};
+
+PathSegment::PathSegment (std::string item)
+  : item (item),
+    isGetObject (item.find ("$") == 0),
+    hasTid (false),
+    matcher (item)
+{
+  if (isGetObject)
+    {
+      hasTid = TypeId::LookupByNameFailSafe (item.substr (1, item.size () - 1), &tid);
+    }
+}
+
+/**
+ * The segments of a canonical path, without the empty segment which
+ * follows the final '/'.
+ */
+typedef std::vector<PathSegment> PathSegments;
+
+/**
+ * An attribute of a TypeId, which a segment of a path can follow to
+ * reach other objects.
+ */
+struct PathAttribute
+{
+  std::string name;
+  // pointer attribute, or container of pointers
+  bool isContainer;
+};
+typedef std::vector<PathAttribute> PathAttributes;
+
 class Resolver
 {
 public:
@@ -242,13 +339,19 @@ public:
   void Resolve (Ptr<Object> root);
 private:
   void Canonicalize (void);
-  void DoResolve (std::string path, Ptr<Object> root);
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoResolve (uint32_t segment, Ptr<Object> root);
+  void DoArrayResolve (uint32_t segment, const ObjectPtrContainerValue &vector);
   void DoResolveOne (Ptr<Object> object);
   std::string GetResolvedPath (void) const;
   virtual void DoOne (Ptr<Object> object, std::string path) = 0;
+  static void Compile (std::string path, PathSegments *segments);
+  static const PathSegments * GetSegments (std::string path);
+  static const PathAttributes & GetAttributes (TypeId tid, std::string item);
   std::vector<std::string> m_workStack;
   std::string m_path;
+  const PathSegments *m_segments;
+  // the segments of m_path, when they are not cached
+  PathSegments m_ownSegments;
 };
 
 Resolver::Resolver (std::string path)
@@ -256,6 +359,12 @@ Resolver::Resolver (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
   Canonicalize ();
+  m_segments = GetSegments (m_path);
+  if (m_segments == 0)
+    {
+      Compile (m_path, &m_ownSegments);
+      m_segments = &m_ownSegments;
+    }
 }
 Resolver::~Resolver ()
 {
@@ -281,12 +390,95 @@ Resolver::Canonicalize (void)
     }
 }
 
+void
+Resolver::Compile (std::string path, PathSegments *segments)
+{
+  NS_LOG_FUNCTION (path << segments);
+  std::string::size_type start = 0;
+  std::string::size_type next = path.find ("/", 1);
+  while (next != std::string::npos)
+    {
+      segments->push_back (PathSegment (path.substr (start + 1, next - (start + 1))));
+      start = next;
+      next = path.find ("/", start + 1);
+    }
+}
+
+const PathSegments *
+Resolver::GetSegments (std::string path)
+{
+  NS_LOG_FUNCTION (path);
+  // the same paths are typically resolved many times, against every
+  // root and by a series of Config::Set and Connect calls.
+  static std::map<std::string, PathSegments> cache;
+  std::map<std::string, PathSegments>::const_iterator i = cache.find (path);
+  if (i != cache.end ())
+    {
+      return &i->second;
+    }
+  if (cache.size () >= 1024)
+    {
+      return 0;
+    }
+  PathSegments *segments = &cache[path];
+  Compile (path, segments);
+  return segments;
+}
+
+const PathAttributes &
+Resolver::GetAttributes (TypeId tid, std::string item)
+{
+  NS_LOG_FUNCTION (tid << item);
+  // resolving a path against a large number of objects of the same
+  // type checks the same attributes of the same TypeId again and again.
+  static std::map<std::pair<uint16_t, std::string>, PathAttributes> cache;
+  std::pair<uint16_t, std::string> key = std::make_pair (tid.GetUid (), item);
+  std::map<std::pair<uint16_t, std::string>, PathAttributes>::const_iterator i = cache.find (key);
+  if (i != cache.end ())
+    {
+      return i->second;
+    }
+  PathAttributes &attributes = cache[key];
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info;
+          info = tid.GetAttribute (i);
+          if (info.name != item && item != "*")
+            {
+              continue;
+            }
+          PathAttribute attribute;
+          attribute.name = info.name;
+          // attempt to cast to a pointer checker.
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.isContainer = false;
+              attributes.push_back (attribute);
+            }
+          // attempt to cast to an object vector.
+          else if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.isContainer = true;
+              attributes.push_back (attribute);
+            }
+          // this could be anything else and we don't know what to do with it.
+          // So, we just ignore it.
+        }
+      nextTid = tid.GetParent ();
+    } while (nextTid != tid);
+  return attributes;
+}
+
 void 
 Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
@@ -312,13 +504,11 @@ Resolver::DoResolveOne (Ptr<Object> object)
 }
 
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::DoResolve (uint32_t segment, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (this << segment << root);
 
-  if (next == std::string::npos)
+  if (segment == m_segments->size ())
     {
       //
       // If root is zero, we're beginning to see if we can use the object name 
@@ -334,8 +524,8 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const PathSegment &current = (*m_segments)[segment];
+  const std::string &item = current.item;
 
   //
   // If root is zero, we're beginning to see if we can use the object name 
@@ -346,11 +536,10 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
+      if (item.compare (0, 5, "Names") == 0)
         {
           m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
+          DoResolve (segment + 1, root);
           m_workStack.pop_back ();
           return;
         }
@@ -367,7 +556,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
       m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      DoResolve (segment + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -383,13 +572,13 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       return;
     }
-  std::string::size_type dollarPos = item.find ("$");
-  if (dollarPos == 0)
+  if (current.isGetObject)
     {
       // This is a call to GetObject
       std::string tidString = item.substr (1, item.size () - 1);
       NS_LOG_DEBUG ("GetObject="<<tidString<<" on path="<<GetResolvedPath ());
-      TypeId tid = TypeId::LookupByName (tidString);
+      // fails loudly if the type does not exist
+      TypeId tid = current.hasTid ? current.tid : TypeId::LookupByName (tidString);
       Ptr<Object> object = root->GetObject<Object> (tid);
       if (object == 0)
         {
@@ -397,69 +586,44 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
           return;
         }
       m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      DoResolve (segment + 1, object);
       m_workStack.pop_back ();
     }
   else 
     {
       // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
-      bool foundMatch = false;
-      
-      do
+      const PathAttributes &attributes = GetAttributes (root->GetInstanceTypeId (), item);
+      for (PathAttributes::const_iterator i = attributes.begin (); i != attributes.end (); ++i)
         {
-          tid = nextTid;
-          
-          for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+          if (!i->isContainer)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute(i);
-              if (info.name != item && item != "*")
+              NS_LOG_DEBUG ("GetAttribute(ptr)="<<i->name<<" on path="<<GetResolvedPath ());
+              PointerValue ptr;
+              root->GetAttribute (i->name, ptr);
+              Ptr<Object> object = ptr.Get<Object> ();
+              if (object == 0)
                 {
+                  NS_LOG_ERROR ("Requested object name=\""<<item<<
+                                "\" exists on path=\""<<GetResolvedPath ()<<"\""
+                                " but is null.");
                   continue;
                 }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *ptr = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker));
-              if (ptr != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)="<<info.name<<" on path="<<GetResolvedPath ());
-                  PointerValue ptr;
-                  root->GetAttribute (info.name, ptr);
-                  Ptr<Object> object = ptr.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\""<<item<<
-                                    "\" exists on path=\""<<GetResolvedPath ()<<"\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
-                }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker = 
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
-                }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              m_workStack.push_back (i->name);
+              DoResolve (segment + 1, object);
+              m_workStack.pop_back ();
             }
-
-          nextTid = tid.GetParent ();
-        } while (nextTid != tid);
+          else
+            {
+              NS_LOG_DEBUG ("GetAttribute(vector)="<<i->name<<" on path="<<GetResolvedPath ());
+              ObjectPtrContainerValue vector;
+              root->GetAttribute (i->name, vector);
+              m_workStack.push_back (i->name);
+              DoArrayResolve (segment + 1, vector);
+              m_workStack.pop_back ();
+            }
+        }
       
-      if (!foundMatch)
+      if (attributes.empty ())
         {
           NS_LOG_DEBUG ("Requested item="<<item<<" does not exist on path="<<GetResolvedPath ());
           return;
@@ -468,20 +632,39 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
 }
 
 void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (uint32_t segment, const ObjectPtrContainerValue &container)
 {
-  NS_LOG_FUNCTION(this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION(this << segment << &container);
+  if (segment == m_segments->size ())
+    {
+      return;
+    }
+  const ArrayMatcher &matcher = (*m_segments)[segment].matcher;
+
+  if (matcher.IsSparse (container.GetN ()))
     {
+      // look up the indexes which can match, in increasing order, like
+      // the iteration over the container below.
+      std::vector<std::pair<uint32_t, uint32_t> > ranges = matcher.GetRanges ();
+      for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator j = ranges.begin ();
+           j != ranges.end (); ++j)
+        {
+          for (uint64_t index = j->first; index <= j->second; ++index)
+            {
+              Ptr<Object> object = container.Get (index);
+              if (object != 0)
+                {
+                  std::ostringstream oss;
+                  oss << index;
+                  m_workStack.push_back (oss.str ());
+                  DoResolve (segment + 1, object);
+                  m_workStack.pop_back ();
+                }
+            }
+        }
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
 
-  ArrayMatcher matcher = ArrayMatcher (item);
   ObjectPtrContainerValue::Iterator it;
   for (it = container.Begin (); it != container.End (); ++it)
     {
@@ -490,7 +673,7 @@ Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &conta
           std::ostringstream oss;
           oss << (*it).first;
           m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
+          DoResolve (segment + 1, (*it).second);
           m_workStack.pop_back ();
         }
     }
@@ -596,7 +779,7 @@ ConfigImpl::LookupMatches (std::string path)
     }
     std::vector<Ptr<Object> > m_objects;
     std::vector<std::string> m_contexts;
-  } resolver = LookupMatchesResolver (path);
+  } resolver (path);
   for (Roots::const_iterator i = m_roots.begin (); i != m_roots.end (); i++)
     {
       resolver.Resolve (*i);
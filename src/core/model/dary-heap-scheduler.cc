@@ -0,0 +1,251 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "dary-heap-scheduler.h"
+#include "event-impl.h"
+#include "uinteger.h"
+#include "assert.h"
+#include "fatal-error.h"
+#include "log.h"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DaryHeapScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (DaryHeapScheduler);
+
+TypeId
+DaryHeapScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DaryHeapScheduler")
+    .SetParent<Scheduler> ()
+    .AddConstructor<DaryHeapScheduler> ()
+    .AddAttribute ("Arity",
+                   "The number of children of each node of the heap (2, 4 or 8).",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&DaryHeapScheduler::SetArity,
+                                         &DaryHeapScheduler::GetArity),
+                   MakeUintegerChecker<uint32_t> (2, 8))
+  ;
+  return tid;
+}
+
+/** The size of the cache lines which the key array is aligned on. */
+static const std::size_t CACHE_LINE_SIZE = 64;
+
+template <typename T>
+T *
+DaryHeapScheduler::CacheLineAllocator<T>::allocate (std::size_t n)
+{
+  void *p;
+  if (posix_memalign (&p, CACHE_LINE_SIZE, n * sizeof (T)) != 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return static_cast<T *> (p);
+}
+template <typename T>
+void
+DaryHeapScheduler::CacheLineAllocator<T>::deallocate (T *p, std::size_t n)
+{
+  std::free (p);
+}
+
+DaryHeapScheduler::DaryHeapScheduler ()
+  : m_shift (2),
+    m_root (3)
+{
+  NS_LOG_FUNCTION (this);
+  m_keys.resize (m_root);
+  m_impls.resize (m_root, 0);
+}
+DaryHeapScheduler::~DaryHeapScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+DaryHeapScheduler::SetArity (uint32_t arity)
+{
+  NS_LOG_FUNCTION (this << arity);
+  NS_ASSERT_MSG (IsEmpty (), "The arity cannot be changed while events are pending");
+  switch (arity)
+    {
+    case 2:
+      m_shift = 1;
+      break;
+    case 4:
+      m_shift = 2;
+      break;
+    case 8:
+      m_shift = 3;
+      break;
+    default:
+      NS_FATAL_ERROR ("Unsupported heap arity " << arity << ", use 2, 4 or 8");
+      break;
+    }
+  m_root = arity - 1;
+  m_keys.resize (m_root);
+  m_impls.resize (m_root, 0);
+}
+uint32_t
+DaryHeapScheduler::GetArity (void) const
+{
+  return 1 << m_shift;
+}
+
+uint32_t
+DaryHeapScheduler::Parent (uint32_t i) const
+{
+  return ((i - m_root - 1) >> m_shift) + m_root;
+}
+uint32_t
+DaryHeapScheduler::FirstChild (uint32_t i) const
+{
+  return ((i - m_root) << m_shift) + m_root + 1;
+}
+void
+DaryHeapScheduler::Place (uint32_t i, const EventKey &key, EventImpl *impl)
+{
+  m_keys[i] = key;
+  m_impls[i] = impl;
+  impl->SetSchedulerSlot (i);
+}
+
+void
+DaryHeapScheduler::SiftUp (uint32_t i, const EventKey &key, EventImpl *impl)
+{
+  while (i > m_root)
+    {
+      uint32_t parent = Parent (i);
+      if (!(key < m_keys[parent]))
+        {
+          break;
+        }
+      Place (i, m_keys[parent], m_impls[parent]);
+      i = parent;
+    }
+  Place (i, key, impl);
+}
+
+void
+DaryHeapScheduler::SiftDown (uint32_t i, const EventKey &key, EventImpl *impl)
+{
+  // The element to place usually comes from the bottom of the heap and
+  // ends up close to a leaf, so move the hole all the way down along the
+  // smallest children without comparing them to the key, then sift the
+  // key up from there (Floyd's heuristic): this saves one comparison per
+  // level.
+  uint32_t size = m_keys.size ();
+  uint32_t arity = 1 << m_shift;
+  while (true)
+    {
+      uint32_t first = FirstChild (i);
+      if (first >= size)
+        {
+          break;
+        }
+      uint32_t end = std::min (first + arity, size);
+      uint32_t smallest = first;
+      for (uint32_t child = first + 1; child < end; child++)
+        {
+          if (m_keys[child] < m_keys[smallest])
+            {
+              smallest = child;
+            }
+        }
+      Place (i, m_keys[smallest], m_impls[smallest]);
+      i = smallest;
+    }
+  SiftUp (i, key, impl);
+}
+
+void
+DaryHeapScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (ev.impl != 0);
+  m_keys.push_back (ev.key);
+  m_impls.push_back (ev.impl);
+  SiftUp (m_keys.size () - 1, ev.key, ev.impl);
+}
+
+bool
+DaryHeapScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_keys.size () == m_root;
+}
+
+Scheduler::Event
+DaryHeapScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Event ev;
+  ev.impl = m_impls[m_root];
+  ev.key = m_keys[m_root];
+  return ev;
+}
+
+Scheduler::Event
+DaryHeapScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Event next;
+  next.impl = m_impls[m_root];
+  next.key = m_keys[m_root];
+  EventKey lastKey = m_keys.back ();
+  EventImpl *lastImpl = m_impls.back ();
+  m_keys.pop_back ();
+  m_impls.pop_back ();
+  if (!IsEmpty ())
+    {
+      SiftDown (m_root, lastKey, lastImpl);
+    }
+  return next;
+}
+
+void
+DaryHeapScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint32_t i = ev.impl->GetSchedulerSlot ();
+  NS_ASSERT (i >= m_root && i < m_keys.size () && m_impls[i] == ev.impl && m_keys[i].m_uid == ev.key.m_uid);
+  EventKey lastKey = m_keys.back ();
+  EventImpl *lastImpl = m_impls.back ();
+  m_keys.pop_back ();
+  m_impls.pop_back ();
+  if (i == m_keys.size ())
+    {
+      // the removed event was the last one
+      return;
+    }
+  if (i > m_root && lastKey < m_keys[Parent (i)])
+    {
+      SiftUp (i, lastKey, lastImpl);
+    }
+  else
+    {
+      SiftDown (i, lastKey, lastImpl);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DARY_HEAP_SCHEDULER_H
+#define DARY_HEAP_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a cache-friendly d-ary heap event scheduler
+ *
+ * This is an implicit heap in which every node has Arity (2, 4 or 8)
+ * children, 4 by default. Compared to HeapScheduler:
+ *  - the 16-byte event keys and the EventImpl pointers are kept in two
+ *    separate arrays, so that sifting only reads keys, and the heap is
+ *    half as deep as a binary heap.  The key array is allocated on a
+ *    cache line boundary and the root is stored at index Arity - 1, so
+ *    that the children of every node start at a multiple of Arity: the
+ *    4 sibling keys compared at each level of a 4-ary heap fill exactly
+ *    one 64-byte cache line;
+ *  - elements are moved into a hole instead of being swapped;
+ *  - the position of each event in the heap is stored in the event itself
+ *    (see EventImpl::SetSchedulerSlot), so Remove costs O(log n) instead
+ *    of a linear search.
+ *
+ * Because of the last point, every event given to this scheduler must
+ * have a valid EventImpl.
+ */
+class DaryHeapScheduler : public Scheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  DaryHeapScheduler ();
+  virtual ~DaryHeapScheduler ();
+
+  virtual void Insert (const Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Event PeekNext (void) const;
+  virtual Event RemoveNext (void);
+  virtual void Remove (const Event &ev);
+
+private:
+  void SetArity (uint32_t arity);
+  uint32_t GetArity (void) const;
+
+  /**
+   * The allocator of the key array, which aligns it on a cache line.
+   */
+  template <typename T>
+  struct CacheLineAllocator
+  {
+    typedef T value_type;
+    CacheLineAllocator () {}
+    template <typename U>
+    CacheLineAllocator (const CacheLineAllocator<U> &) {}
+    T *allocate (std::size_t n);
+    void deallocate (T *p, std::size_t n);
+    template <typename U>
+    bool operator == (const CacheLineAllocator<U> &) const { return true; }
+    template <typename U>
+    bool operator != (const CacheLineAllocator<U> &) const { return false; }
+  };
+
+  inline uint32_t Parent (uint32_t i) const;
+  inline uint32_t FirstChild (uint32_t i) const;
+  inline void Place (uint32_t i, const EventKey &key, EventImpl *impl);
+  void SiftUp (uint32_t i, const EventKey &key, EventImpl *impl);
+  void SiftDown (uint32_t i, const EventKey &key, EventImpl *impl);
+
+  // The first m_root slots of both arrays are unused.
+  std::vector<EventKey, CacheLineAllocator<EventKey> > m_keys;
+  std::vector<EventImpl *> m_impls;
+  // log2 of the arity
+  uint32_t m_shift;
+  // the index of the root: Arity - 1
+  uint32_t m_root;
+};
+
+} // namespace ns3
+
+#endif /* DARY_HEAP_SCHEDULER_H */
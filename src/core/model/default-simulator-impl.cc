@@ -25,10 +25,14 @@
 
 #include "ptr.h"
 #include "pointer.h"
+#include "boolean.h"
+#include "uinteger.h"
 #include "assert.h"
 #include "log.h"
 
 #include <cmath>
+#include <iostream>
+#include <limits>
 
 // Note:  Logging in this file is largely avoided due to the
 // number of calls that are made to these functions and the possibility
@@ -38,6 +42,12 @@ NS_LOG_COMPONENT_DEFINE ("DefaultSimulatorImpl");
 
 namespace ns3 {
 
+/**
+ * The simulator slot of the events removed from the event list, which
+ * tells them from the cancelled events still in the list.
+ */
+static const uint32_t REMOVED_SLOT = 1;
+
 NS_OBJECT_ENSURE_REGISTERED (DefaultSimulatorImpl);
 
 TypeId
@@ -46,6 +56,22 @@ DefaultSimulatorImpl::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::DefaultSimulatorImpl")
     .SetParent<SimulatorImpl> ()
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("StatisticsInterval",
+                   "The number of events run between two notifications of the "
+                   "Statistics trace source, or 0 to notify it only at the end "
+                   "of each run.",
+                   UintegerValue (1000000),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::m_statisticsInterval),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PrintStatistics",
+                   "Whether Simulator::Destroy prints the statistics of the events.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DefaultSimulatorImpl::m_printStatistics),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("Statistics",
+                     "The statistics of the events, every StatisticsInterval "
+                     "events and at the end of each run.",
+                     MakeTraceSourceAccessor (&DefaultSimulatorImpl::m_statisticsTrace))
   ;
   return tid;
 }
@@ -64,8 +90,17 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentTs = 0;
   m_currentContext = 0xffffffff;
   m_unscheduledEvents = 0;
-  m_eventsWithContextEmpty = true;
+  m_eventsWithContext = 0;
   m_main = SystemThread::Self();
+  m_executedEvents = 0;
+  m_insertedEvents = 0;
+  m_cancelledEvents = 0;
+  m_cancelledPendingEvents = 0;
+  m_removedEvents = 0;
+  m_maxUnscheduledEvents = 0;
+  m_eventRate = 0;
+  m_windowEnd = std::numeric_limits<uint64_t>::max ();
+  m_windowStart = 0;
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
@@ -83,12 +118,23 @@ DefaultSimulatorImpl::DoDispose (void)
       next.impl->Unref ();
     }
   m_events = 0;
+  while (m_eventsWithContext != 0)
+    {
+      struct EventWithContext *next = m_eventsWithContext->next;
+      m_eventsWithContext->event->Unref ();
+      delete m_eventsWithContext;
+      m_eventsWithContext = next;
+    }
   SimulatorImpl::DoDispose ();
 }
 void
 DefaultSimulatorImpl::Destroy ()
 {
   NS_LOG_FUNCTION (this);
+  if (m_printStatistics)
+    {
+      PrintStatistics (std::cout);
+    }
   while (!m_destroyEvents.empty ()) 
     {
       Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
@@ -125,6 +171,17 @@ DefaultSimulatorImpl::GetSystemId (void) const
   return 0;
 }
 
+inline void
+DefaultSimulatorImpl::NotifyInsert (void)
+{
+  m_insertedEvents++;
+  m_unscheduledEvents++;
+  if (m_unscheduledEvents > m_maxUnscheduledEvents)
+    {
+      m_maxUnscheduledEvents = m_unscheduledEvents;
+    }
+}
+
 void
 DefaultSimulatorImpl::ProcessOneEvent (void)
 {
@@ -137,10 +194,22 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (next.impl->IsCancelled ())
+    {
+      m_cancelledPendingEvents--;
+    }
+  else
+    {
+      m_executedEvents++;
+      next.impl->Invoke ();
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
+  if (m_executedEvents == m_windowEnd)
+    {
+      EndWindow ();
+    }
 }
 
 bool 
@@ -152,30 +221,36 @@ DefaultSimulatorImpl::IsFinished (void) const
 void
 DefaultSimulatorImpl::ProcessEventsWithContext (void)
 {
-  if (m_eventsWithContextEmpty)
+  if (m_eventsWithContext == 0)
     {
       return;
     }
 
-  // swap queues
-  EventsWithContext eventsWithContext;
-  {
-    CriticalSection cs (m_eventsWithContextMutex);
-    m_eventsWithContext.swap(eventsWithContext);
-    m_eventsWithContextEmpty = true;
-  }
-  while (!eventsWithContext.empty ())
+  // take the whole stack at once, and reverse it to process the events
+  // in the order in which they have been scheduled.
+  struct EventWithContext *top = __sync_lock_test_and_set (&m_eventsWithContext,
+                                                           (struct EventWithContext *)0);
+  struct EventWithContext *first = 0;
+  while (top != 0)
     {
-       EventWithContext event = eventsWithContext.front ();
-       eventsWithContext.pop_front ();
-       Scheduler::Event ev;
-       ev.impl = event.event;
-       ev.key.m_ts = m_currentTs + event.timestamp;
-       ev.key.m_context = event.context;
-       ev.key.m_uid = m_uid;
-       m_uid++;
-       m_unscheduledEvents++;
-       m_events->Insert (ev);
+      struct EventWithContext *next = top->next;
+      top->next = first;
+      first = top;
+      top = next;
+    }
+  while (first != 0)
+    {
+      struct EventWithContext *event = first;
+      first = event->next;
+      Scheduler::Event ev;
+      ev.impl = event->event;
+      ev.key.m_ts = m_currentTs + event->timestamp;
+      ev.key.m_context = event->context;
+      ev.key.m_uid = m_uid;
+      m_uid++;
+      NotifyInsert ();
+      m_events->Insert (ev);
+      delete event;
     }
 }
 
@@ -187,11 +262,16 @@ DefaultSimulatorImpl::Run (void)
   m_main = SystemThread::Self();
   ProcessEventsWithContext ();
   m_stop = false;
+  m_windowStart = m_executedEvents;
+  m_windowEnd = m_statisticsInterval != 0 ? m_executedEvents + m_statisticsInterval
+    : std::numeric_limits<uint64_t>::max ();
+  m_windowClock.Start ();
 
   while (!m_events->IsEmpty () && !m_stop) 
     {
       ProcessOneEvent ();
     }
+  EndWindow ();
 
   // If the simulator stopped naturally by lack of events, make a
   // consistency test to check that we didn't lose any events along the way.
@@ -231,7 +311,7 @@ DefaultSimulatorImpl::Schedule (Time const &time, EventImpl *event)
   ev.key.m_context = GetContext ();
   ev.key.m_uid = m_uid;
   m_uid++;
-  m_unscheduledEvents++;
+  NotifyInsert ();
   m_events->Insert (ev);
   return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
 }
@@ -250,20 +330,24 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &time, E
       ev.key.m_context = context;
       ev.key.m_uid = m_uid;
       m_uid++;
-      m_unscheduledEvents++;
+      NotifyInsert ();
       m_events->Insert (ev);
     }
   else
     {
-      EventWithContext ev;
-      ev.context = context;
-      ev.timestamp = time.GetTimeStep ();
-      ev.event = event;
-      {
-        CriticalSection cs (m_eventsWithContextMutex);
-        m_eventsWithContext.push_back(ev);
-        m_eventsWithContextEmpty = false;
-      }
+      struct EventWithContext *ev = new EventWithContext;
+      ev->context = context;
+      ev->timestamp = time.GetTimeStep ();
+      ev->event = event;
+      // push on the stack: a concurrent push or a concurrent drain
+      // by the main thread makes the compare-and-swap fail, and we retry.
+      struct EventWithContext *top;
+      do
+        {
+          top = m_eventsWithContext;
+          ev->next = top;
+        }
+      while (!__sync_bool_compare_and_swap (&m_eventsWithContext, top, ev));
     }
 }
 
@@ -278,7 +362,7 @@ DefaultSimulatorImpl::ScheduleNow (EventImpl *event)
   ev.key.m_context = GetContext ();
   ev.key.m_uid = m_uid;
   m_uid++;
-  m_unscheduledEvents++;
+  NotifyInsert ();
   m_events->Insert (ev);
   return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
 }
@@ -330,7 +414,13 @@ DefaultSimulatorImpl::Remove (const EventId &id)
         }
       return;
     }
-  if (IsExpired (id))
+  // a cancelled event is still in the event list, until it is removed
+  // or its time comes
+  if (id.PeekEventImpl () == 0 ||
+      id.PeekEventImpl ()->GetSimulatorSlot () == REMOVED_SLOT ||
+      id.GetTs () < m_currentTs ||
+      (id.GetTs () == m_currentTs &&
+       id.GetUid () <= m_currentUid))
     {
       return;
     }
@@ -340,11 +430,17 @@ DefaultSimulatorImpl::Remove (const EventId &id)
   event.key.m_context = id.GetContext ();
   event.key.m_uid = id.GetUid ();
   m_events->Remove (event);
+  if (event.impl->IsCancelled ())
+    {
+      m_cancelledPendingEvents--;
+    }
   event.impl->Cancel ();
+  event.impl->SetSimulatorSlot (REMOVED_SLOT);
   // whenever we remove an event from the event list, we have to unref it.
   event.impl->Unref ();
 
   m_unscheduledEvents--;
+  m_removedEvents++;
 }
 
 void
@@ -353,6 +449,12 @@ DefaultSimulatorImpl::Cancel (const EventId &id)
   if (!IsExpired (id))
     {
       id.PeekEventImpl ()->Cancel ();
+      if (id.GetUid () != 2)
+        {
+          // the destroy events are not in the event list
+          m_cancelledEvents++;
+          m_cancelledPendingEvents++;
+        }
     }
 }
 
@@ -404,4 +506,48 @@ DefaultSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+void
+DefaultSimulatorImpl::EndWindow (void)
+{
+  int64_t ms = m_windowClock.End ();
+  m_eventRate = ms > 0 ? (m_executedEvents - m_windowStart) * 1000.0 / ms : 0;
+  m_statisticsTrace (GetStatistics ());
+  m_windowStart = m_executedEvents;
+  if (m_statisticsInterval != 0)
+    {
+      m_windowEnd = m_executedEvents + m_statisticsInterval;
+    }
+  m_windowClock.Start ();
+}
+
+DefaultSimulatorImpl::Statistics
+DefaultSimulatorImpl::GetStatistics (void) const
+{
+  Statistics statistics;
+  statistics.executed = m_executedEvents;
+  statistics.inserted = m_insertedEvents;
+  statistics.cancelled = m_cancelledEvents;
+  statistics.cancelledPending = m_cancelledPendingEvents;
+  statistics.removed = m_removedEvents;
+  statistics.queueSize = m_unscheduledEvents;
+  statistics.maxQueueSize = m_maxUnscheduledEvents;
+  statistics.eventRate = m_eventRate;
+  return statistics;
+}
+
+void
+DefaultSimulatorImpl::PrintStatistics (std::ostream &os) const
+{
+  Statistics statistics = GetStatistics ();
+  double ratio = statistics.inserted > 0 ? 100.0 * statistics.cancelled / statistics.inserted : 0;
+  os << "Events: " << statistics.inserted << " inserted, "
+     << statistics.executed << " run, "
+     << statistics.removed << " removed, "
+     << statistics.cancelled << " cancelled (" << ratio << "% of the inserted events, "
+     << statistics.cancelledPending << " still in the event list)" << std::endl
+     << "Event list: " << statistics.queueSize << " events, at most "
+     << statistics.maxQueueSize << std::endl
+     << "Event rate: " << statistics.eventRate << " events/s" << std::endl;
+}
+
 } // namespace ns3
@@ -25,20 +25,59 @@
 #include "scheduler.h"
 #include "event-impl.h"
 #include "system-thread.h"
-#include "ns3/system-mutex.h"
+#include "system-wall-clock-ms.h"
+#include "traced-callback.h"
 
 #include "ptr.h"
 
 #include <list>
+#include <ostream>
 
 namespace ns3 {
 
 /**
  * \ingroup simulator
+ *
+ * The DefaultSimulatorImpl counts the events it inserts, runs, cancels
+ * and removes, to tell how the event list is used by the models:  the
+ * events which are cancelled, rather than removed, stay in the event
+ * list until their time comes, so a model which cancels most of its
+ * events fills the event list, and slows down the scheduler, with
+ * events which will never run.
+ *
+ * These statistics are returned by GetStatistics, passed to the
+ * "Statistics" trace source every StatisticsInterval events, and
+ * printed by Simulator::Destroy if PrintStatistics is true.
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
 public:
+  /**
+   * The statistics of the events of a simulation.
+   */
+  struct Statistics
+  {
+    /** The number of events run. */
+    uint64_t executed;
+    /** The number of events inserted in the event list. */
+    uint64_t inserted;
+    /** The number of events cancelled while in the event list. */
+    uint64_t cancelled;
+    /** The number of cancelled events still in the event list. */
+    uint64_t cancelledPending;
+    /** The number of events removed from the event list. */
+    uint64_t removed;
+    /** The number of events in the event list. */
+    uint64_t queueSize;
+    /** The largest number of events in the event list. */
+    uint64_t maxQueueSize;
+    /**
+     * The number of events run per second of wall-clock time, over the
+     * last StatisticsInterval events, or zero if it is too short to tell.
+     */
+    double eventRate;
+  };
+
   static TypeId GetTypeId (void);
 
   DefaultSimulatorImpl ();
@@ -63,20 +102,42 @@ public:
   virtual uint32_t GetSystemId (void) const; 
   virtual uint32_t GetContext (void) const;
 
+  /**
+   * \returns the statistics of the events since the creation of this
+   *          simulator implementation.
+   */
+  Statistics GetStatistics (void) const;
+  /**
+   * \param os the stream to print the statistics to
+   *
+   * Print the statistics of the events.
+   */
+  void PrintStatistics (std::ostream &os) const;
+
 private:
   virtual void DoDispose (void);
   void ProcessOneEvent (void);
   void ProcessEventsWithContext (void);
+  /** Count an event inserted in the event list. */
+  void NotifyInsert (void);
+  /** Update the event rate, and notify the Statistics trace source. */
+  void EndWindow (void);
  
+  /**
+   * An event scheduled with ScheduleWithContext by a thread other than
+   * the main one. These events are pushed on a lock-free stack by the
+   * other threads, and moved to the event list by the main thread,
+   * in order, after each event.
+   */
   struct EventWithContext {
     uint32_t context;
     uint64_t timestamp;
     EventImpl *event;
+    struct EventWithContext *next;
   };
-  typedef std::list<struct EventWithContext> EventsWithContext;
-  EventsWithContext m_eventsWithContext;
-  bool m_eventsWithContextEmpty;
-  SystemMutex m_eventsWithContextMutex;
+  // top of the stack of events with context; the last pushed event
+  // comes first
+  struct EventWithContext * volatile m_eventsWithContext;
 
   typedef std::list<EventId> DestroyEvents;
   DestroyEvents m_destroyEvents;
@@ -92,6 +153,23 @@ private:
   int m_unscheduledEvents;
 
   SystemThread::ThreadId m_main;
+
+  // event statistics, see Statistics
+  uint64_t m_executedEvents;
+  uint64_t m_insertedEvents;
+  uint64_t m_cancelledEvents;
+  uint64_t m_cancelledPendingEvents;
+  uint64_t m_removedEvents;
+  int m_maxUnscheduledEvents;
+  double m_eventRate;
+  // the statistics window: its length in events, the number of events
+  // run at its end, and its wall-clock duration
+  uint32_t m_statisticsInterval;
+  uint64_t m_windowEnd;
+  uint64_t m_windowStart;
+  SystemWallClockMs m_windowClock;
+  bool m_printStatistics;
+  TracedCallback<const Statistics &> m_statisticsTrace;
 };
 
 } // namespace ns3
@@ -23,15 +23,85 @@
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/**
+ * The event object sizes which are recycled are multiples of
+ * GRANULARITY up to N_CLASSES * GRANULARITY bytes.
+ */
+const std::size_t GRANULARITY = 16;
+const std::size_t N_CLASSES = 8;
+/**
+ * Maximum number of free blocks kept per size class and per thread:
+ * the extra blocks are given back to the global allocator.
+ */
+const uint32_t MAX_FREE_BLOCKS = 4096;
+
+struct FreeBlock
+{
+  FreeBlock *next;
+};
+
+struct FreeList
+{
+  FreeBlock *head;
+  uint32_t size;
+};
+
+__thread FreeList g_freeLists[N_CLASSES];
+
+} // anonymous namespace
+
 namespace ns3 {
 
+void *
+EventImpl::operator new (std::size_t size)
+{
+  std::size_t sizeClass = (size - 1) / GRANULARITY;
+  if (sizeClass >= N_CLASSES)
+    {
+      return ::operator new (size);
+    }
+  FreeList &list = g_freeLists[sizeClass];
+  FreeBlock *block = list.head;
+  if (block == 0)
+    {
+      return ::operator new ((sizeClass + 1) * GRANULARITY);
+    }
+  list.head = block->next;
+  list.size--;
+  return block;
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  std::size_t sizeClass = (size - 1) / GRANULARITY;
+  if (sizeClass >= N_CLASSES || g_freeLists[sizeClass].size >= MAX_FREE_BLOCKS)
+    {
+      ::operator delete (p);
+      return;
+    }
+  FreeList &list = g_freeLists[sizeClass];
+  FreeBlock *block = static_cast<FreeBlock *> (p);
+  block->next = list.head;
+  list.head = block;
+  list.size++;
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
 }
 
 EventImpl::EventImpl ()
-  : m_cancel (false)
+  : m_cancel (false),
+    m_schedulerSlot (0),
+    m_simulatorSlot (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 namespace ns3 {
@@ -57,14 +58,80 @@ public:
    * Invoked by the simulation engine before calling Invoke.
    */
   bool IsCancelled (void);
+  /**
+   * \param slot an opaque value owned by the Scheduler which holds this event
+   *
+   * Schedulers may use this, e.g., to remember the position of the
+   * event in their data structure for a fast Scheduler::Remove.
+   */
+  inline void SetSchedulerSlot (uint32_t slot);
+  /**
+   * \returns the value last given to SetSchedulerSlot.
+   */
+  inline uint32_t GetSchedulerSlot (void) const;
+  /**
+   * \param slot an opaque value owned by the SimulatorImpl which
+   *        scheduled this event
+   *
+   * Simulator implementations may use this, e.g., to remember which
+   * of their partitions holds the event.
+   */
+  inline void SetSimulatorSlot (uint32_t slot);
+  /**
+   * \returns the value last given to SetSimulatorSlot.
+   */
+  inline uint32_t GetSimulatorSlot (void) const;
+
+  /**
+   * \param size the size of the event object to allocate
+   * \returns a memory block at least size bytes long
+   *
+   * Events are allocated and freed for every Simulator::Schedule, so
+   * small events are recycled through per-thread free lists, one per
+   * 16-byte size class, instead of going through the global allocator.
+   * An event freed by another thread than the one which allocated it
+   * is simply recycled by the freeing thread.
+   */
+  static void *operator new (std::size_t size);
+  /**
+   * \param p the memory block to free
+   * \param size the size of the event object stored in p
+   */
+  static void operator delete (void *p, std::size_t size);
 
 protected:
   virtual void Notify (void) = 0;
 
 private:
   bool m_cancel;
+  uint32_t m_schedulerSlot;
+  uint32_t m_simulatorSlot;
 };
 
+void
+EventImpl::SetSchedulerSlot (uint32_t slot)
+{
+  m_schedulerSlot = slot;
+}
+
+uint32_t
+EventImpl::GetSchedulerSlot (void) const
+{
+  return m_schedulerSlot;
+}
+
+void
+EventImpl::SetSimulatorSlot (uint32_t slot)
+{
+  m_simulatorSlot = slot;
+}
+
+uint32_t
+EventImpl::GetSimulatorSlot (void) const
+{
+  return m_simulatorSlot;
+}
+
 } // namespace ns3
 
 #endif /* EVENT_IMPL_H */
@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <stdint.h>
+
+#include "log.h"
+#include "hash-crc32c.h"
+
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+#define NS3_CRC32C_SSE42 1
+#include <nmmintrin.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Hash-Crc32c");
+
+namespace Hash {
+
+namespace Function {
+
+namespace Crc32cImplementation {
+
+/**
+ * Update a CRC32C register with a buffer.
+ *
+ * The register holds the CRC before its final inversion.
+ */
+typedef uint32_t (*Update_ptr) (uint32_t crc, const unsigned char *p, size_t size);
+
+/** The slicing-by-8 tables of the software implementation. */
+class Tables
+{
+public:
+  Tables ()
+  {
+    for (uint32_t n = 0; n < 256; n++)
+      {
+        uint32_t crc = n;
+        for (int k = 0; k < 8; k++)
+          {
+            crc = (crc & 1) ? (crc >> 1) ^ 0x82f63b78 : crc >> 1;
+          }
+        t[0][n] = crc;
+      }
+    for (uint32_t n = 0; n < 256; n++)
+      {
+        for (int k = 1; k < 8; k++)
+          {
+            t[k][n] = (t[k - 1][n] >> 8) ^ t[0][t[k - 1][n] & 0xff];
+          }
+      }
+  }
+  uint32_t t[8][256];
+};
+
+uint32_t
+UpdateSoftware (uint32_t crc, const unsigned char *p, size_t size)
+{
+  static const Tables tables;
+  const uint32_t (*t)[256] = tables.t;
+
+  while (size >= 8)
+    {
+      crc ^= p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+      crc = t[7][crc & 0xff] ^ t[6][(crc >> 8) & 0xff]
+        ^ t[5][(crc >> 16) & 0xff] ^ t[4][crc >> 24]
+        ^ t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+      p += 8;
+      size -= 8;
+    }
+  while (size-- > 0)
+    {
+      crc = t[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    }
+  return crc;
+}
+
+#ifdef NS3_CRC32C_SSE42
+__attribute__ ((target ("sse4.2")))
+uint32_t
+UpdateSse42 (uint32_t crc, const unsigned char *p, size_t size)
+{
+#ifdef __x86_64__
+  uint64_t crc64 = crc;
+  while (size >= 8)
+    {
+      uint64_t word;
+      std::memcpy (&word, p, sizeof (word));
+      crc64 = _mm_crc32_u64 (crc64, word);
+      p += 8;
+      size -= 8;
+    }
+  crc = (uint32_t)crc64;
+#endif
+  while (size >= 4)
+    {
+      uint32_t word;
+      std::memcpy (&word, p, sizeof (word));
+      crc = _mm_crc32_u32 (crc, word);
+      p += 4;
+      size -= 4;
+    }
+  while (size-- > 0)
+    {
+      crc = _mm_crc32_u8 (crc, *p++);
+    }
+  return crc;
+}
+#endif /* NS3_CRC32C_SSE42 */
+
+/** \return the fastest update function supported by the processor. */
+Update_ptr
+SelectUpdate (void)
+{
+#ifdef NS3_CRC32C_SSE42
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("sse4.2"))
+    {
+      NS_LOG_LOGIC ("Using the SSE4.2 crc32 instruction");
+      return &UpdateSse42;
+    }
+#endif
+  NS_LOG_LOGIC ("Using the software implementation");
+  return &UpdateSoftware;
+}
+
+/** \return the update function, selected on the first call. */
+Update_ptr
+GetUpdate (void)
+{
+  static const Update_ptr update = SelectUpdate ();
+  return update;
+}
+
+}  // namespace Crc32cImplementation
+
+
+Crc32c::Crc32c ()
+{
+  clear ();
+}
+
+uint32_t
+Crc32c::GetHash32  (const char * buffer, const size_t size)
+{
+  using namespace Crc32cImplementation;
+
+  m_hash32 = ~(*GetUpdate ())(~m_hash32, (const unsigned char *)buffer, size);
+  return m_hash32;
+}
+
+void
+Crc32c::clear (void)
+{
+  m_hash32 = 0;
+}
+
+bool
+Crc32c::IsAccelerated (void)
+{
+  using namespace Crc32cImplementation;
+
+  return GetUpdate () != &UpdateSoftware;
+}
+
+}  // namespace Function
+
+}  // namespace Hash
+
+}  // namespace ns3
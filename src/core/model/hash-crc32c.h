@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef HASH_CRC32C_H
+#define HASH_CRC32C_H
+
+#include "hash-function.h"
+
+namespace ns3 {
+
+namespace Hash {
+
+namespace Function {
+
+/**
+ *  \ingroup hash
+ *
+ *  \brief CRC32C hash function implementation
+ *
+ *  This is the Castagnoli CRC, the 32-bit cyclic redundancy check
+ *  with the polynomial 0x1EDC6F41 (0x82F63B78 reflected) used by
+ *  iSCSI, SCTP and ext4.
+ *
+ *  On x86 processors supporting SSE4.2, the crc32 instruction computes
+ *  the checksum eight bytes at a time.  The processor is checked once,
+ *  at run time, so that the same binary runs on older processors, with
+ *  a table driven (slicing-by-8) implementation.
+ *
+ *  The CRC is a 32-bit hash only:  GetHash64 () returns the 32-bit hash.
+ *  It is fast, but it is linear, and it should not be used where the
+ *  keys may be chosen to collide.
+ */
+class Crc32c : public Implementation
+{
+public:
+  /**
+   * Constructor
+   */
+  Crc32c ();
+  /**
+   * Compute 32-bit hash of a byte buffer
+   *
+   * Call clear () between calls to GetHash32() to reset the
+   * internal state and hash each buffer separately.
+   *
+   * If you don't call clear() between calls to GetHash32,
+   * you can hash successive buffers.  The final return value
+   * will be the cumulative hash across all calls.
+   *
+   * \param [in] buffer pointer to the beginning of the buffer
+   * \param [in] size length of the buffer, in bytes
+   * \return 32-bit hash of the buffer
+   */
+  uint32_t  GetHash32  (const char * buffer, const size_t size);
+  /**
+   * Restore initial state
+   */
+  virtual void clear (void);
+  /**
+   * \return true if the CRC is computed by the processor.
+   */
+  static bool IsAccelerated (void);
+
+private:
+  /**
+   * Cache last hash value, for incremental hashing.
+   */
+  uint32_t m_hash32;
+
+};  // class Crc32c
+
+}  // namespace Function
+
+}  // namespace Hash
+
+}  // namespace ns3
+
+#endif  /* HASH_CRC32C_H */
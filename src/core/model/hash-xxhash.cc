@@ -0,0 +1,335 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * The xxHash algorithms are by Yann Collet, and are described in
+ *   https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+ * This is an independent implementation of that specification.
+ */
+
+#include <stdint.h>
+
+#include "log.h"
+#include "hash-xxhash.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Hash-XxHash");
+
+namespace Hash {
+
+namespace Function {
+
+namespace XxHashImplementation {
+
+const uint32_t PRIME32_1 = 0x9E3779B1U;
+const uint32_t PRIME32_2 = 0x85EBCA77U;
+const uint32_t PRIME32_3 = 0xC2B2AE3DU;
+const uint32_t PRIME32_4 = 0x27D4EB2FU;
+const uint32_t PRIME32_5 = 0x165667B1U;
+
+const uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+const uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+const uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+const uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+inline uint32_t
+Rotl32 (uint32_t x, int r)
+{
+  return (x << r) | (x >> (32 - r));
+}
+
+inline uint64_t
+Rotl64 (uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+// The input is little endian on all the platforms; the compilers
+// turn these into single loads on the little endian ones.
+inline uint32_t
+Read32 (const unsigned char *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+inline uint64_t
+Read64 (const unsigned char *p)
+{
+  return Read32 (p) | ((uint64_t)Read32 (p + 4) << 32);
+}
+
+/*************************************************
+ **  XXH32
+ ************************************************/
+
+inline uint32_t
+Round32 (uint32_t acc, uint32_t input)
+{
+  acc += input * PRIME32_2;
+  acc = Rotl32 (acc, 13);
+  return acc * PRIME32_1;
+}
+
+void
+Reset32 (uint32_t lanes[4])
+{
+  lanes[0] = PRIME32_1 + PRIME32_2;
+  lanes[1] = PRIME32_2;
+  lanes[2] = 0;
+  lanes[3] = 0 - PRIME32_1;
+}
+
+void
+Update32 (uint32_t lanes[4], uint64_t &total, unsigned char stripe[16],
+          const unsigned char *p, size_t size)
+{
+  size_t used = total % 16;
+  total += size;
+  if (used + size < 16)
+    {
+      std::memcpy (stripe + used, p, size);
+      return;
+    }
+  uint32_t v1 = lanes[0];
+  uint32_t v2 = lanes[1];
+  uint32_t v3 = lanes[2];
+  uint32_t v4 = lanes[3];
+  if (used > 0)
+    {
+      size_t fill = 16 - used;
+      std::memcpy (stripe + used, p, fill);
+      v1 = Round32 (v1, Read32 (stripe));
+      v2 = Round32 (v2, Read32 (stripe + 4));
+      v3 = Round32 (v3, Read32 (stripe + 8));
+      v4 = Round32 (v4, Read32 (stripe + 12));
+      p += fill;
+      size -= fill;
+    }
+  while (size >= 16)
+    {
+      v1 = Round32 (v1, Read32 (p));
+      v2 = Round32 (v2, Read32 (p + 4));
+      v3 = Round32 (v3, Read32 (p + 8));
+      v4 = Round32 (v4, Read32 (p + 12));
+      p += 16;
+      size -= 16;
+    }
+  lanes[0] = v1;
+  lanes[1] = v2;
+  lanes[2] = v3;
+  lanes[3] = v4;
+  std::memcpy (stripe, p, size);
+}
+
+uint32_t
+Digest32 (const uint32_t lanes[4], uint64_t total, const unsigned char stripe[16])
+{
+  uint32_t h;
+  if (total >= 16)
+    {
+      h = Rotl32 (lanes[0], 1) + Rotl32 (lanes[1], 7)
+        + Rotl32 (lanes[2], 12) + Rotl32 (lanes[3], 18);
+    }
+  else
+    {
+      h = lanes[2] + PRIME32_5;
+    }
+  h += (uint32_t)total;
+
+  const unsigned char *p = stripe;
+  size_t size = total % 16;
+  while (size >= 4)
+    {
+      h += Read32 (p) * PRIME32_3;
+      h = Rotl32 (h, 17) * PRIME32_4;
+      p += 4;
+      size -= 4;
+    }
+  while (size-- > 0)
+    {
+      h += (*p++) * PRIME32_5;
+      h = Rotl32 (h, 11) * PRIME32_1;
+    }
+
+  h ^= h >> 15;
+  h *= PRIME32_2;
+  h ^= h >> 13;
+  h *= PRIME32_3;
+  h ^= h >> 16;
+  return h;
+}
+
+/*************************************************
+ **  XXH64
+ ************************************************/
+
+inline uint64_t
+Round64 (uint64_t acc, uint64_t input)
+{
+  acc += input * PRIME64_2;
+  acc = Rotl64 (acc, 31);
+  return acc * PRIME64_1;
+}
+
+inline uint64_t
+MergeRound64 (uint64_t acc, uint64_t lane)
+{
+  acc ^= Round64 (0, lane);
+  return acc * PRIME64_1 + PRIME64_4;
+}
+
+void
+Reset64 (uint64_t lanes[4])
+{
+  lanes[0] = PRIME64_1 + PRIME64_2;
+  lanes[1] = PRIME64_2;
+  lanes[2] = 0;
+  lanes[3] = 0 - PRIME64_1;
+}
+
+void
+Update64 (uint64_t lanes[4], uint64_t &total, unsigned char stripe[32],
+          const unsigned char *p, size_t size)
+{
+  size_t used = total % 32;
+  total += size;
+  if (used + size < 32)
+    {
+      std::memcpy (stripe + used, p, size);
+      return;
+    }
+  uint64_t v1 = lanes[0];
+  uint64_t v2 = lanes[1];
+  uint64_t v3 = lanes[2];
+  uint64_t v4 = lanes[3];
+  if (used > 0)
+    {
+      size_t fill = 32 - used;
+      std::memcpy (stripe + used, p, fill);
+      v1 = Round64 (v1, Read64 (stripe));
+      v2 = Round64 (v2, Read64 (stripe + 8));
+      v3 = Round64 (v3, Read64 (stripe + 16));
+      v4 = Round64 (v4, Read64 (stripe + 24));
+      p += fill;
+      size -= fill;
+    }
+  while (size >= 32)
+    {
+      v1 = Round64 (v1, Read64 (p));
+      v2 = Round64 (v2, Read64 (p + 8));
+      v3 = Round64 (v3, Read64 (p + 16));
+      v4 = Round64 (v4, Read64 (p + 24));
+      p += 32;
+      size -= 32;
+    }
+  lanes[0] = v1;
+  lanes[1] = v2;
+  lanes[2] = v3;
+  lanes[3] = v4;
+  std::memcpy (stripe, p, size);
+}
+
+uint64_t
+Digest64 (const uint64_t lanes[4], uint64_t total, const unsigned char stripe[32])
+{
+  uint64_t h;
+  if (total >= 32)
+    {
+      h = Rotl64 (lanes[0], 1) + Rotl64 (lanes[1], 7)
+        + Rotl64 (lanes[2], 12) + Rotl64 (lanes[3], 18);
+      h = MergeRound64 (h, lanes[0]);
+      h = MergeRound64 (h, lanes[1]);
+      h = MergeRound64 (h, lanes[2]);
+      h = MergeRound64 (h, lanes[3]);
+    }
+  else
+    {
+      h = lanes[2] + PRIME64_5;
+    }
+  h += total;
+
+  const unsigned char *p = stripe;
+  size_t size = total % 32;
+  while (size >= 8)
+    {
+      h ^= Round64 (0, Read64 (p));
+      h = Rotl64 (h, 27) * PRIME64_1 + PRIME64_4;
+      p += 8;
+      size -= 8;
+    }
+  if (size >= 4)
+    {
+      h ^= Read32 (p) * PRIME64_1;
+      h = Rotl64 (h, 23) * PRIME64_2 + PRIME64_3;
+      p += 4;
+      size -= 4;
+    }
+  while (size-- > 0)
+    {
+      h ^= (*p++) * PRIME64_5;
+      h = Rotl64 (h, 11) * PRIME64_1;
+    }
+
+  h ^= h >> 33;
+  h *= PRIME64_2;
+  h ^= h >> 29;
+  h *= PRIME64_3;
+  h ^= h >> 32;
+  return h;
+}
+
+}  // namespace XxHashImplementation
+
+
+XxHash::XxHash ()
+{
+  clear ();
+}
+
+uint32_t
+XxHash::GetHash32  (const char * buffer, const size_t size)
+{
+  using namespace XxHashImplementation;
+
+  Update32 (m_lanes32, m_size32, m_stripe32, (const unsigned char *)buffer, size);
+  return Digest32 (m_lanes32, m_size32, m_stripe32);
+}
+
+uint64_t
+XxHash::GetHash64  (const char * buffer, const size_t size)
+{
+  using namespace XxHashImplementation;
+
+  Update64 (m_lanes64, m_size64, m_stripe64, (const unsigned char *)buffer, size);
+  return Digest64 (m_lanes64, m_size64, m_stripe64);
+}
+
+void
+XxHash::clear (void)
+{
+  using namespace XxHashImplementation;
+
+  Reset32 (m_lanes32);
+  m_size32 = 0;
+  Reset64 (m_lanes64);
+  m_size64 = 0;
+}
+
+}  // namespace Function
+
+}  // namespace Hash
+
+}  // namespace ns3
@@ -0,0 +1,108 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef HASH_XXHASH_H
+#define HASH_XXHASH_H
+
+#include "hash-function.h"
+
+namespace ns3 {
+
+namespace Hash {
+
+namespace Function {
+
+/**
+ *  \ingroup hash
+ *
+ *  \brief xxHash hash function implementation
+ *
+ *  This is Yann Collet's xxHash (see the
+ *  <a href="https://github.com/Cyan4973/xxHash">xxHash page</a>):
+ *  XXH32 for the 32-bit hashes and XXH64 for the 64-bit hashes.
+ *  They hash four independent lanes of 4 (XXH32) or 8 (XXH64) bytes
+ *  at a time, which keeps the multipliers of the processor busy, and
+ *  they are much faster than Murmur3 and FNV1a on long keys.
+ *
+ *  The seed is 0, so that the hashes are the hashes of the reference
+ *  implementation, on all the platforms, and incremental hashing gives
+ *  the same hash as hashing the concatenated buffers at once.
+ */
+class XxHash : public Implementation
+{
+public:
+  /**
+   * Constructor, clears internal state
+   */
+  XxHash ();
+  /**
+   * Compute 32-bit hash of a byte buffer
+   *
+   * Call clear () between calls to GetHash32() to reset the
+   * internal state and hash each buffer separately.
+   *
+   * If you don't call clear() between calls to GetHash32,
+   * you can hash successive buffers.  The final return value
+   * will be the cumulative hash across all calls.
+   *
+   * \param [in] buffer pointer to the beginning of the buffer
+   * \param [in] size length of the buffer, in bytes
+   * \return 32-bit hash of the buffer
+   */
+  uint32_t  GetHash32  (const char * buffer, const size_t size);
+  /**
+   * Compute 64-bit hash of a byte buffer.
+   *
+   * Call clear () between calls to GetHash64() to reset the
+   * internal state and hash each buffer separately.
+   *
+   * If you don't call clear() between calls to GetHash64,
+   * you can hash successive buffers.  The final return value
+   * will be the cumulative hash across all calls.
+   *
+   * \param [in] buffer pointer to the beginning of the buffer
+   * \param [in] size length of the buffer, in bytes
+   * \return 64-bit hash of the buffer
+   */
+  uint64_t  GetHash64  (const char * buffer, const size_t size);
+  /**
+   * Restore initial state
+   */
+  virtual void clear (void);
+
+private:
+  //@{
+  /**
+   * Incremental hashing state:  the four lanes, the total bytes
+   * hashed, and the bytes not yet hashed, less than a stripe.
+   */
+  uint32_t m_lanes32[4];
+  uint64_t m_size32;
+  unsigned char m_stripe32[16];
+  uint64_t m_lanes64[4];
+  uint64_t m_size64;
+  unsigned char m_stripe64[32];
+  //@}
+
+};  // class XxHash
+
+}  // namespace Function
+
+}  // namespace Hash
+
+}  // namespace ns3
+
+#endif  /* HASH_XXHASH_H */
@@ -29,6 +29,8 @@
 #include "hash-function.h"
 #include "hash-murmur3.h"
 #include "hash-fnv.h"
+#include "hash-crc32c.h"
+#include "hash-xxhash.h"
 
 namespace ns3 {
 
@@ -60,7 +62,10 @@ namespace ns3 {
  *    \endcode
  *
  *  The available implementations are documented in group hash.
- *  The default implementation is Murmur3.  FNV1a is also available.
+ *  The default implementation is Murmur3.  FNV1a, xxHash and CRC32C
+ *  are also available:  xxHash is the fastest on long keys, and CRC32C
+ *  on the processors with the SSE4.2 crc32 instruction, but CRC32C only
+ *  produces 32-bit hashes.
  *
  *  In addition to this class interface, global functions are
  *  defined which use the default hash implementation.
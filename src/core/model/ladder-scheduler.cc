@@ -0,0 +1,309 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include <algorithm>
+#include "assert.h"
+#include "log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topStart (0),
+    m_rungs (MAX_RUNGS),
+    m_nRungs (0),
+    m_bottomHead (0),
+    m_qSize (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::CurrentStart (const Rung &rung) const
+{
+  return rung.start + rung.current * rung.width;
+}
+
+void
+LadderScheduler::InitRung (Rung &rung, uint64_t start, uint64_t end, uint32_t nEvents)
+{
+  NS_LOG_FUNCTION (this << start << end << nEvents);
+  NS_ASSERT (end > start && nEvents > 0);
+  uint64_t span = end - start;
+  rung.width = std::max (span / nEvents, (uint64_t)1);
+  rung.start = start;
+  rung.current = 0;
+  rung.count = 0;
+  // all buckets of a rung which is not in use are empty.
+  rung.buckets.resize ((span - 1) / rung.width + 1);
+}
+
+void
+LadderScheduler::InsertRung (Rung &rung, const Event &ev)
+{
+  uint32_t bucket = (ev.key.m_ts - rung.start) / rung.width;
+  NS_ASSERT (bucket >= rung.current && bucket < rung.buckets.size ());
+  rung.buckets[bucket].push_back (ev);
+  rung.count++;
+}
+
+void
+LadderScheduler::InsertBottom (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  // most new events are later than those already in the bottom,
+  // so keep it in increasing order to make the insertion cheap.
+  Bucket::iterator i = std::upper_bound (m_bottom.begin () + m_bottomHead, m_bottom.end (), ev);
+  m_bottom.insert (i, ev);
+  if (m_bottom.size () - m_bottomHead > THRES && m_nRungs < MAX_RUNGS)
+    {
+      BottomToRung ();
+    }
+}
+
+void
+LadderScheduler::BottomToRung (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t start = m_bottom[m_bottomHead].key.m_ts;
+  uint64_t end = m_nRungs > 0 ? CurrentStart (m_rungs[m_nRungs - 1]) : m_topStart;
+  if (m_bottom.back ().key.m_ts == start)
+    {
+      // all events share the same timestamp: there is nothing to spread.
+      return;
+    }
+  Rung &rung = m_rungs[m_nRungs];
+  InitRung (rung, start, end, m_bottom.size () - m_bottomHead);
+  for (Bucket::const_iterator i = m_bottom.begin () + m_bottomHead; i != m_bottom.end (); ++i)
+    {
+      InsertRung (rung, *i);
+    }
+  m_nRungs++;
+  m_bottom.clear ();
+  m_bottomHead = 0;
+}
+
+void
+LadderScheduler::TopToLadder (void)
+{
+  NS_LOG_FUNCTION (this << m_top.size () << m_topRemoved.size ());
+  NS_ASSERT (m_nRungs == 0 && m_bottomHead == m_bottom.size ());
+
+  // drop the events removed while they were in top and find the range
+  // of the others.
+  uint64_t minTs = ~(uint64_t)0;
+  uint64_t maxTs = 0;
+  uint32_t n = 0;
+  for (Bucket::const_iterator i = m_top.begin (); i != m_top.end (); ++i)
+    {
+      if (!m_topRemoved.empty () && m_topRemoved.erase (i->key.m_uid) != 0)
+        {
+          continue;
+        }
+      m_top[n++] = *i;
+      minTs = std::min (minTs, i->key.m_ts);
+      maxTs = std::max (maxTs, i->key.m_ts);
+    }
+  NS_ASSERT (m_topRemoved.empty ());
+  NS_ASSERT (n > 0);
+  m_top.resize (n);
+
+  m_bottom.clear ();
+  m_bottomHead = 0;
+  if (n <= THRES || minTs == maxTs)
+    {
+      m_top.swap (m_bottom);
+      std::sort (m_bottom.begin (), m_bottom.end ());
+      m_topStart = maxTs + 1;
+      return;
+    }
+
+  Rung &rung = m_rungs[0];
+  InitRung (rung, minTs, maxTs + 1, n);
+  for (Bucket::const_iterator i = m_top.begin (); i != m_top.end (); ++i)
+    {
+      InsertRung (rung, *i);
+    }
+  m_nRungs = 1;
+  m_topStart = rung.start + rung.buckets.size () * rung.width;
+  m_top.clear ();
+}
+
+void
+LadderScheduler::RefillBottom (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_bottomHead == m_bottom.size ());
+  while (true)
+    {
+      while (m_nRungs > 0 && m_rungs[m_nRungs - 1].count == 0)
+        {
+          m_nRungs--;
+        }
+      if (m_nRungs == 0)
+        {
+          TopToLadder ();
+          if (m_nRungs == 0)
+            {
+              // top was small enough to go straight to the bottom
+              return;
+            }
+        }
+      Rung &rung = m_rungs[m_nRungs - 1];
+      while (rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      Bucket &bucket = rung.buckets[rung.current];
+      uint32_t nEvents = bucket.size ();
+      uint64_t bucketStart = CurrentStart (rung);
+      rung.current++;
+      rung.count -= nEvents;
+      if (nEvents > THRES && rung.width > 1 && m_nRungs < MAX_RUNGS)
+        {
+          // spread this bucket over a new, finer rung
+          Rung &child = m_rungs[m_nRungs];
+          InitRung (child, bucketStart, bucketStart + rung.width, nEvents);
+          for (Bucket::const_iterator i = bucket.begin (); i != bucket.end (); ++i)
+            {
+              InsertRung (child, *i);
+            }
+          bucket.clear ();
+          m_nRungs++;
+          continue;
+        }
+      NS_LOG_LOGIC ("transfer " << nEvents << " events to bottom");
+      m_bottom.clear ();
+      m_bottomHead = 0;
+      m_bottom.swap (bucket);
+      std::sort (m_bottom.begin (), m_bottom.end ());
+      return;
+    }
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  m_qSize++;
+  if (ev.key.m_ts >= m_topStart)
+    {
+      m_top.push_back (ev);
+      return;
+    }
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      if (ev.key.m_ts >= CurrentStart (m_rungs[i]))
+        {
+          InsertRung (m_rungs[i], ev);
+          return;
+        }
+    }
+  InsertBottom (ev);
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_qSize == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  if (m_bottomHead == m_bottom.size ())
+    {
+      // refilling the bottom does not change the content of the queue.
+      const_cast<LadderScheduler *> (this)->RefillBottom ();
+    }
+  return m_bottom[m_bottomHead];
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  if (m_bottomHead == m_bottom.size ())
+    {
+      RefillBottom ();
+    }
+  Scheduler::Event ev = m_bottom[m_bottomHead];
+  m_bottomHead++;
+  m_qSize--;
+  NS_LOG_LOGIC ("remove ts=" << ev.key.m_ts << ", key=" << ev.key.m_uid);
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  m_qSize--;
+  if (ev.key.m_ts >= m_topStart)
+    {
+      m_topRemoved.insert (ev.key.m_uid);
+      return;
+    }
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      Rung &rung = m_rungs[i];
+      if (ev.key.m_ts >= CurrentStart (rung))
+        {
+          Bucket &bucket = rung.buckets[(ev.key.m_ts - rung.start) / rung.width];
+          for (Bucket::iterator j = bucket.begin (); j != bucket.end (); ++j)
+            {
+              if (j->key.m_uid == ev.key.m_uid)
+                {
+                  NS_ASSERT (ev.impl == j->impl);
+                  *j = bucket.back ();
+                  bucket.pop_back ();
+                  rung.count--;
+                  return;
+                }
+            }
+          NS_ASSERT (false);
+        }
+    }
+  Bucket::iterator i = std::lower_bound (m_bottom.begin () + m_bottomHead, m_bottom.end (), ev);
+  NS_ASSERT (i != m_bottom.end () && i->key.m_uid == ev.key.m_uid);
+  m_bottom.erase (i);
+}
+
+} // namespace ns3
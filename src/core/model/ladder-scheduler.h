@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+#include <set>
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale Discrete
+ * Event Simulation" by Wai Teng Tang, Rick Siow Mong Goh and Ian Li-Jin Thng
+ * (ACM TOMACS, 2005). Events are kept in three tiers:
+ *  - Top: an unsorted vector of far-future events,
+ *  - Ladder: up to MAX_RUNGS rungs of unsorted buckets, each rung refining one
+ *    bucket of the rung above it,
+ *  - Bottom: a small sorted vector holding the events about to be dequeued.
+ *
+ * Events are only sorted once they reach the bottom, when a bucket holding
+ * at most THRES events is transferred there, which yields O(1) amortized
+ * Insert and RemoveNext. Bucket boundaries are timestamps, so events with
+ * equal timestamps always share a bucket and are ordered by uid, just like
+ * the other schedulers.
+ *
+ * Removing an event from Top only records its uid; the event is dropped
+ * when Top is next spread over a rung. Removal from a bucket is linear in
+ * the bucket size and removal from Bottom is a binary search.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  LadderScheduler ();
+  virtual ~LadderScheduler ();
+
+  virtual void Insert (const Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Event PeekNext (void) const;
+  virtual Event RemoveNext (void);
+  virtual void Remove (const Event &ev);
+
+private:
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  struct Rung
+  {
+    std::vector<Bucket> buckets;
+    // timestamp at the start of bucket 0
+    uint64_t start;
+    // duration of a bucket
+    uint64_t width;
+    // index of the first bucket which has not been dequeued yet
+    uint32_t current;
+    // number of events in this rung
+    uint32_t count;
+  };
+
+  // maximum number of events in a bucket before it is split into a new rung
+  static const uint32_t THRES = 50;
+  // maximum number of rungs in the ladder
+  static const uint32_t MAX_RUNGS = 8;
+
+  inline uint64_t CurrentStart (const Rung &rung) const;
+  void InitRung (Rung &rung, uint64_t start, uint64_t end, uint32_t nEvents);
+  void InsertBottom (const Event &ev);
+  void InsertRung (Rung &rung, const Event &ev);
+  void BottomToRung (void);
+  void TopToLadder (void);
+  void RefillBottom (void);
+
+  // far-future events, unsorted
+  Bucket m_top;
+  // uids of events removed from m_top but still stored in it
+  std::set<uint32_t> m_topRemoved;
+  // smallest timestamp which belongs to m_top
+  uint64_t m_topStart;
+
+  // rungs in use are m_rungs[0..m_nRungs-1]
+  std::vector<Rung> m_rungs;
+  uint32_t m_nRungs;
+
+  // sorted events, the next event is m_bottom[m_bottomHead]
+  Bucket m_bottom;
+  uint32_t m_bottomHead;
+
+  // number of events in queue
+  uint32_t m_qSize;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -0,0 +1,1268 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "log.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <streambuf>
+#include "ns3/core-config.h"
+#include "fatal-error.h"
+#include "fatal-impl.h"
+#include "simulator.h"
+#include "nstime.h"
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+/**
+ * \file
+ * \ingroup logging
+ * The binary log files.
+ *
+ * A binary log file starts with the 8 bytes of MAGIC, followed by
+ * entries made of their size, as a varint, and of their content. The
+ * first byte of an entry gives its type:
+ *
+ * - SITE: a call site of the NS_LOG macros, with its identifier, the
+ *   name of its LogComponent, the name of its function and its
+ *   LogRecord::Kind;
+ * - RECORD: a log message, with the identifier of its site, its
+ *   LogLevel, the Flags of its prefixes, the simulation time and the
+ *   context if enabled, the file-local context, and its arguments,
+ *   each made of a Tag and of its value.
+ *
+ * The integers are stored as varints, the signed ones after a zigzag
+ * encoding, the strings as their size and their characters, and the
+ * doubles as their 8 bytes in the byte order of the host.
+ */
+
+namespace {
+
+/** The first bytes of a binary log file. */
+const char MAGIC[8] = { 'n', 's', '3', 'b', 'l', 'o', 'g', '1' };
+
+/** The types of the entries of a binary log file. */
+enum Type
+{
+  SITE = 'S',
+  RECORD = 'R'
+};
+
+/** The prefixes of a log message. */
+enum Flags
+{
+  HAS_TIME = 0x01,
+  HAS_NODE = 0x02,
+  PREFIX_FUNC = 0x04,
+  PREFIX_LEVEL = 0x08
+};
+
+/** The types of the arguments of a log message. */
+enum Tag
+{
+  SIGNED = 'i',
+  UNSIGNED = 'u',
+  DOUBLE = 'd',
+  CHAR = 'c',
+  POINTER = 'p',
+  STRING = 's',
+  TEXT = 'x'      //!< formatted arguments, never separated by `, `
+};
+
+/**
+ * A lock for the short critical sections of the registration of the
+ * call sites.
+ */
+struct SpinLock
+{
+  volatile int locked;  //!< 1 when locked
+
+  void Lock (void)
+  {
+    while (__sync_lock_test_and_set (&locked, 1))
+      {
+#ifdef HAVE_PTHREAD_H
+        sched_yield ();
+#endif
+      }
+  }
+  void Unlock (void)
+  {
+    __sync_lock_release (&locked);
+  }
+};
+
+/** A call site of the NS_LOG macros. */
+struct Site
+{
+  const char *component;  //!< the name of the LogComponent
+  const char *function;   //!< the name of the function
+  uint8_t kind;           //!< the LogRecord::Kind
+};
+
+/** The lock of the list of sites. */
+SpinLock g_sitesLock;
+
+/**
+ * \return the call sites registered so far.
+ */
+std::vector<Site> *
+GetSites (void)
+{
+  static std::vector<Site> sites;
+  return &sites;
+}
+
+/**
+ * Append a varint to a string of bytes.
+ *
+ * \param [in,out] out the bytes.
+ * \param [in] value the integer.
+ */
+void
+AppendVarint (std::string &out, uint64_t value)
+{
+  while (value >= 0x80)
+    {
+      out.push_back (static_cast<char> (value | 0x80));
+      value >>= 7;
+    }
+  out.push_back (static_cast<char> (value));
+}
+
+/**
+ * Append a string to a string of bytes.
+ *
+ * \param [in,out] out the bytes.
+ * \param [in] value the string.
+ */
+void
+AppendString (std::string &out, const char *value)
+{
+  std::size_t size = std::strlen (value);
+  AppendVarint (out, size);
+  out.append (value, size);
+}
+
+/**
+ * Encode the entry of a site.
+ *
+ * \param [in] id the identifier of the site.
+ * \param [in] site the site.
+ * \return the entry.
+ */
+std::string
+EncodeSite (uint32_t id, const Site &site)
+{
+  std::string entry;
+  entry.push_back (SITE);
+  AppendVarint (entry, id);
+  AppendString (entry, site.component);
+  AppendString (entry, site.function);
+  entry.push_back (site.kind);
+  return entry;
+}
+
+/**
+ * The binary log file.
+ *
+ * The log entries are copied, by any thread, to a ring buffer, and
+ * written to the file by a background thread. A producer reserves the
+ * bytes of its entry with an atomic addition, copies the entry, and
+ * publishes it once the entries reserved before it are published. The
+ * writer only reads the position of the published bytes, and the
+ * producers wait for it only when the buffer is full.
+ * Without threads, the entries are written when the buffer is full.
+ *
+ * The sink registers a stream with FatalImpl::RegisterStream, so that
+ * NS_FATAL_ERROR and NS_ASSERT write the pending entries before they
+ * terminate the program.
+ */
+class LogBinarySink
+{
+public:
+  /**
+   * \param [in] file the opened file.
+   * \param [in] bufferSize the size of the ring buffer, a power of 2.
+   */
+  LogBinarySink (FILE *file, uint32_t bufferSize);
+  /** Write the remaining entries and close the file. */
+  ~LogBinarySink ();
+  /**
+   * Write an entry.
+   *
+   * \param [in] data the content of the entry.
+   * \param [in] size the size of the content.
+   */
+  void Write (const void *data, std::size_t size);
+  /**
+   * Write the entries copied so far to the file, and flush it.
+   */
+  void Sync (void);
+  /**
+   * Forget the writer thread, in the child process of a fork: the
+   * destructor then closes the file without writing to it.
+   */
+  void Forget (void);
+
+private:
+  /**
+   * The buffer of the stream registered with FatalImpl::RegisterStream:
+   * flushing the stream calls Sync.
+   */
+  class FatalBuffer : public std::streambuf
+  {
+  public:
+    /** \param [in] sink the LogBinarySink to sync. */
+    FatalBuffer (LogBinarySink *sink)
+      : m_sink (sink)
+    {
+    }
+  protected:
+    virtual int sync (void)
+    {
+      m_sink->Sync ();
+      return 0;
+    }
+  private:
+    LogBinarySink *m_sink;    //!< The LogBinarySink to sync.
+  };
+
+  /**
+   * Copy bytes of an entry to the ring buffer, waiting for room if
+   * needed.
+   *
+   * \param [in] start the position reserved for the entry.
+   * \param [in] position the position of the bytes.
+   * \param [in] data the bytes.
+   * \param [in] size the number of bytes.
+   * \return the position following the bytes.
+   */
+  uint64_t Copy (uint64_t start, uint64_t position, const uint8_t *data, std::size_t size);
+  /** Write the bytes of the ring buffer to the file. */
+  void Flush (void);
+  /**
+   * The loop of the writer thread.
+   *
+   * It does not use a SystemThread, which logs: the writer thread would
+   * wait for itself once the buffer is full.
+   *
+   * \param [in] sink the LogBinarySink.
+   * \return 0
+   */
+  static void * Drain (void *sink);
+
+  FILE *m_file;               //!< The binary log file.
+  uint8_t *m_ring;            //!< The ring buffer.
+  uint64_t m_mask;            //!< The size of m_ring, minus 1.
+  volatile uint64_t m_reserved; //!< The bytes reserved by the producers so far.
+  volatile uint64_t m_head;   //!< The bytes published in m_ring so far.
+  volatile uint64_t m_tail;   //!< The bytes written to m_file so far.
+  volatile bool m_stop;       //!< Tells the writer thread to stop.
+#ifdef HAVE_PTHREAD_H
+  pthread_t m_thread;         //!< The writer thread.
+  bool m_forgotten;           //!< No writer thread, after a fork.
+#endif
+  FatalBuffer m_fatalBuffer;  //!< Syncs the sink on fatal errors.
+  std::ostream m_fatalStream; //!< The stream of m_fatalBuffer.
+};
+
+LogBinarySink::LogBinarySink (FILE *file, uint32_t bufferSize)
+  : m_file (file),
+    m_ring (static_cast<uint8_t *> (std::malloc (bufferSize))),
+    m_mask (bufferSize - 1),
+    m_reserved (0),
+    m_head (0),
+    m_tail (0),
+    m_stop (false),
+#ifdef HAVE_PTHREAD_H
+    m_forgotten (false),
+#endif
+    m_fatalBuffer (this),
+    m_fatalStream (&m_fatalBuffer)
+{
+  std::fwrite (MAGIC, 1, sizeof (MAGIC), m_file);
+#ifdef HAVE_PTHREAD_H
+  int rc = pthread_create (&m_thread, 0, &LogBinarySink::Drain, this);
+  if (rc != 0)
+    {
+      NS_FATAL_ERROR ("pthread_create failed: " << rc << "=\"" << std::strerror (rc) << "\".");
+    }
+#endif
+  ns3::FatalImpl::RegisterStream (&m_fatalStream);
+}
+
+LogBinarySink::~LogBinarySink ()
+{
+  ns3::FatalImpl::UnregisterStream (&m_fatalStream);
+#ifdef HAVE_PTHREAD_H
+  if (!m_forgotten)
+    {
+      m_stop = true;
+      __sync_synchronize ();
+      pthread_join (m_thread, 0);
+      Flush ();
+    }
+#else
+  Flush ();
+#endif
+  std::fclose (m_file);
+  std::free (m_ring);
+}
+
+void
+LogBinarySink::Write (const void *data, std::size_t size)
+{
+  uint8_t header[10];
+  std::size_t headerSize = 0;
+  for (uint64_t value = size; ; value >>= 7)
+    {
+      if (value < 0x80)
+        {
+          header[headerSize++] = static_cast<uint8_t> (value);
+          break;
+        }
+      header[headerSize++] = static_cast<uint8_t> (value | 0x80);
+    }
+  uint64_t start = __sync_fetch_and_add (&m_reserved, headerSize + size);
+  uint64_t position = Copy (start, start, header, headerSize);
+  position = Copy (start, position, static_cast<const uint8_t *> (data), size);
+  // publish the entry after the previous ones, which are published by
+  // their producers in the order of their reservations
+  while (true)
+    {
+      __sync_synchronize ();
+      if (m_head >= start)
+        {
+          break;
+        }
+#ifdef HAVE_PTHREAD_H
+      sched_yield ();
+#endif
+    }
+  m_head = position;
+}
+
+void
+LogBinarySink::Sync (void)
+{
+  __sync_synchronize ();
+  uint64_t head = m_head;
+#ifdef HAVE_PTHREAD_H
+  // the writer thread writes the bytes copied so far
+  while (m_tail < head)
+    {
+      sched_yield ();
+      __sync_synchronize ();
+    }
+#else
+  Flush ();
+#endif
+  std::fflush (m_file);
+}
+
+void
+LogBinarySink::Forget (void)
+{
+#ifdef HAVE_PTHREAD_H
+  m_forgotten = true;
+#endif
+}
+
+uint64_t
+LogBinarySink::Copy (uint64_t start, uint64_t position, const uint8_t *data, std::size_t size)
+{
+  while (size > 0)
+    {
+      __sync_synchronize ();
+      uint64_t used = position - m_tail;
+      uint64_t room = used > m_mask ? 0 : m_mask + 1 - used;
+      if (room == 0)
+        {
+          // Once the previous entries are published, publish the bytes
+          // copied so far, which the writer may be waiting for when the
+          // entry is larger than the buffer.
+          if (m_head >= start)
+            {
+              m_head = position;
+            }
+#ifdef HAVE_PTHREAD_H
+          sched_yield ();
+#else
+          Flush ();
+#endif
+          continue;
+        }
+      uint64_t offset = position & m_mask;
+      std::size_t n = size;
+      if (n > room)
+        {
+          n = room;
+        }
+      if (n > m_mask + 1 - offset)
+        {
+          n = m_mask + 1 - offset;
+        }
+      std::memcpy (m_ring + offset, data, n);
+      position += n;
+      data += n;
+      size -= n;
+    }
+  // the copies are visible before the entry is published
+  __sync_synchronize ();
+  return position;
+}
+
+void
+LogBinarySink::Flush (void)
+{
+  uint64_t head = m_head;
+  __sync_synchronize ();
+  uint64_t tail = m_tail;
+  while (tail != head)
+    {
+      uint64_t offset = tail & m_mask;
+      uint64_t n = head - tail;
+      if (n > m_mask + 1 - offset)
+        {
+          n = m_mask + 1 - offset;
+        }
+      std::fwrite (m_ring + offset, 1, n, m_file);
+      tail += n;
+      __sync_synchronize ();
+      m_tail = tail;
+    }
+}
+
+void *
+LogBinarySink::Drain (void *sink)
+{
+#ifdef HAVE_PTHREAD_H
+  LogBinarySink *self = static_cast<LogBinarySink *> (sink);
+  while (true)
+    {
+      // read m_stop first: once it is set, m_head is final
+      bool stop = self->m_stop;
+      __sync_synchronize ();
+      if (self->m_head != self->m_tail)
+        {
+          self->Flush ();
+        }
+      else if (stop)
+        {
+          break;
+        }
+      else
+        {
+          usleep (1000);
+        }
+    }
+#endif
+  return 0;
+}
+
+/** The binary log file, if any. */
+LogBinarySink * volatile g_logBinarySink = 0;
+/**
+ * The number of threads which may be writing to g_logBinarySink, so
+ * that LogSetBinaryFile deletes it only once they are done.
+ */
+uint32_t volatile g_logBinaryWriters = 0;
+/** Holds the writers back while the process forks. */
+bool volatile g_logBinaryForking = false;
+/** The name of the binary log file, if any. */
+std::string g_logBinaryFilename;
+/** The size of the buffer of the binary log file. */
+uint32_t g_logBinaryBufferSize = 0;
+
+/**
+ * Write an entry to the binary log file, if any.
+ *
+ * \param [in] data the content of the entry.
+ * \param [in] size the size of the content.
+ */
+void
+WriteBinary (const void *data, std::size_t size)
+{
+  // a full barrier: LogSetBinaryFile sees this thread as a writer,
+  // or this thread sees the new sink.
+  while (true)
+    {
+      __sync_add_and_fetch (&g_logBinaryWriters, 1);
+      if (!g_logBinaryForking)
+        {
+          break;
+        }
+      __sync_sub_and_fetch (&g_logBinaryWriters, 1);
+      while (g_logBinaryForking)
+        {
+#ifdef HAVE_PTHREAD_H
+          sched_yield ();
+#endif
+          __sync_synchronize ();
+        }
+    }
+  LogBinarySink *sink = g_logBinarySink;
+  if (sink != 0)
+    {
+      sink->Write (data, size);
+    }
+  __sync_sub_and_fetch (&g_logBinaryWriters, 1);
+}
+
+/**
+ * \return the stream which formats the arguments of the log messages
+ * of this thread.
+ */
+std::ostringstream *
+GetTextStream (void)
+{
+  // one per thread, never freed
+  static __thread std::ostringstream *text = 0;
+  if (text == 0)
+    {
+      text = new std::ostringstream ();
+    }
+  return text;
+}
+
+/**
+ * \return the buffer which receives the file-local context of the log
+ * messages of this thread.
+ */
+std::stringbuf *
+GetContextBuffer (void)
+{
+  // one per thread, never freed
+  static __thread std::stringbuf *buffer = 0;
+  if (buffer == 0)
+    {
+      buffer = new std::stringbuf ();
+    }
+  return buffer;
+}
+
+/** The format flags of a new stream. */
+const std::ios_base::fmtflags DEFAULT_FLAGS = std::ios_base::skipws | std::ios_base::dec;
+/** The precision of a new stream. */
+const std::streamsize DEFAULT_PRECISION = 6;
+
+/** Close the binary log file, at exit. */
+void
+CloseBinaryFile (void)
+{
+  ns3::LogSetBinaryFile ("");
+}
+
+#ifdef HAVE_PTHREAD_H
+/**
+ * Before a fork: wait for the writers, and write their entries to the
+ * file, so that the child process inherits none of them.
+ */
+void
+PrepareFork (void)
+{
+  g_sitesLock.Lock ();
+  g_logBinaryForking = true;
+  __sync_synchronize ();
+  while (g_logBinaryWriters != 0)
+    {
+      sched_yield ();
+      __sync_synchronize ();
+    }
+  if (g_logBinarySink != 0)
+    {
+      g_logBinarySink->Sync ();
+    }
+}
+
+/** After a fork, in the parent process: let the writers resume. */
+void
+ResumeParent (void)
+{
+  g_logBinaryForking = false;
+  g_sitesLock.Unlock ();
+}
+
+/**
+ * After a fork, in the child process: the writer thread of the sink
+ * is not there, and the file is shared with the parent process. Close
+ * the file, and go on with the file \c filename.pid.
+ */
+void
+RestartChild (void)
+{
+  // the other threads are not there either
+  g_logBinaryWriters = 0;
+  g_logBinaryForking = false;
+  g_sitesLock.Unlock ();
+  LogBinarySink *sink = g_logBinarySink;
+  if (sink == 0)
+    {
+      return;
+    }
+  g_logBinarySink = 0;
+  sink->Forget ();
+  delete sink;
+  std::ostringstream filename;
+  filename << g_logBinaryFilename << "." << getpid ();
+  ns3::LogSetBinaryFile (filename.str (), g_logBinaryBufferSize);
+}
+#endif /* HAVE_PTHREAD_H */
+
+/**
+ * Reads the entries of a binary log file.
+ */
+class Reader
+{
+public:
+  /**
+   * \param [in] data the content of an entry.
+   * \param [in] size the size of the entry.
+   */
+  Reader (const uint8_t *data, std::size_t size)
+    : m_current (data),
+      m_end (data + size),
+      m_ok (true)
+  {
+  }
+  /** \return false if an entry was truncated. */
+  bool IsOk (void) const
+  {
+    return m_ok;
+  }
+  /** \return true at the end of the entry. */
+  bool IsEnd (void) const
+  {
+    return m_current == m_end;
+  }
+  /** \return the next byte. */
+  uint8_t ReadByte (void)
+  {
+    if (m_current == m_end)
+      {
+        m_ok = false;
+        return 0;
+      }
+    return *m_current++;
+  }
+  /** \return the next varint. */
+  uint64_t ReadVarint (void)
+  {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64 && m_ok; shift += 7)
+      {
+        uint8_t byte = ReadByte ();
+        value |= static_cast<uint64_t> (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+          {
+            break;
+          }
+      }
+    return value;
+  }
+  /** \return the next zigzag encoded varint. */
+  int64_t ReadSigned (void)
+  {
+    uint64_t value = ReadVarint ();
+    return static_cast<int64_t> (value >> 1) ^ -static_cast<int64_t> (value & 1);
+  }
+  /** \return the next double. */
+  double ReadDouble (void)
+  {
+    double value = 0;
+    if (m_end - m_current < static_cast<std::ptrdiff_t> (sizeof (value)))
+      {
+        m_ok = false;
+        return value;
+      }
+    std::memcpy (&value, m_current, sizeof (value));
+    m_current += sizeof (value);
+    return value;
+  }
+  /** \return the next string. */
+  std::string ReadString (void)
+  {
+    uint64_t size = ReadVarint ();
+    if (!m_ok || static_cast<uint64_t> (m_end - m_current) < size)
+      {
+        m_ok = false;
+        return "";
+      }
+    std::string value (reinterpret_cast<const char *> (m_current), size);
+    m_current += size;
+    return value;
+  }
+
+private:
+  const uint8_t *m_current;  //!< The next byte.
+  const uint8_t *m_end;      //!< The end of the entry.
+  bool m_ok;                 //!< false if the entry was truncated.
+};
+
+/**
+ * Read a varint from a stream.
+ *
+ * \param [in] is the stream.
+ * \param [out] value the integer.
+ * \return false at the end of the stream.
+ */
+bool
+ReadVarint (std::istream &is, uint64_t *value)
+{
+  *value = 0;
+  for (int shift = 0; shift < 64; shift += 7)
+    {
+      int byte = is.get ();
+      if (byte == std::char_traits<char>::eof ())
+        {
+          return false;
+        }
+      *value |= static_cast<uint64_t> (byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+} // anonymous namespace
+
+
+namespace ns3 {
+
+void
+LogSetBinaryFile (std::string filename, uint32_t bufferSize)
+{
+  if (bufferSize == 0 || (bufferSize & (bufferSize - 1)) != 0)
+    {
+      NS_FATAL_ERROR ("The size of the binary log buffer, " << bufferSize <<
+                      ", is not a power of 2");
+    }
+  if (g_logBinarySink != 0)
+    {
+      // swap the sink, then wait for the threads which may still be
+      // writing to it
+      g_sitesLock.Lock ();
+      LogBinarySink *sink = g_logBinarySink;
+      g_logBinarySink = 0;
+      g_sitesLock.Unlock ();
+      __sync_synchronize ();
+      while (g_logBinaryWriters != 0)
+        {
+#ifdef HAVE_PTHREAD_H
+          sched_yield ();
+#endif
+          __sync_synchronize ();
+        }
+      delete sink;
+    }
+  if (filename.empty ())
+    {
+      return;
+    }
+  FILE *file = std::fopen (filename.c_str (), "wb");
+  if (file == 0)
+    {
+      NS_FATAL_ERROR ("Could not open the binary log file \"" << filename << "\"");
+    }
+  // the sites must outlive CloseBinaryFile
+  std::vector<Site> *sites = GetSites ();
+  static bool closeAtExit = false;
+  if (!closeAtExit)
+    {
+      std::atexit (&CloseBinaryFile);
+#ifdef HAVE_PTHREAD_H
+      pthread_atfork (&PrepareFork, &ResumeParent, &RestartChild);
+#endif
+      closeAtExit = true;
+    }
+  g_logBinaryFilename = filename;
+  g_logBinaryBufferSize = bufferSize;
+
+  LogBinarySink *sink = new LogBinarySink (file, bufferSize);
+  g_sitesLock.Lock ();
+  for (uint32_t i = 0; i < sites->size (); ++i)
+    {
+      std::string entry = EncodeSite (i, (*sites)[i]);
+      sink->Write (entry.data (), entry.size ());
+    }
+  g_logBinarySink = sink;
+  g_sitesLock.Unlock ();
+}
+
+bool
+LogIsBinary (void)
+{
+  return g_logBinarySink != 0;
+}
+
+bool
+LogPrintBinary (std::istream &is, std::ostream &os)
+{
+  char magic[sizeof (MAGIC)];
+  if (!is.read (magic, sizeof (magic)) || std::memcmp (magic, MAGIC, sizeof (MAGIC)) != 0)
+    {
+      return false;
+    }
+  struct SiteName
+  {
+    std::string component;
+    std::string function;
+    uint8_t kind;
+  };
+  std::vector<SiteName> sites;
+  std::vector<uint8_t> entry;
+  uint64_t size;
+  while (ReadVarint (is, &size))
+    {
+      entry.resize (size);
+      if (size > 0 && !is.read (reinterpret_cast<char *> (&entry[0]), size))
+        {
+          return false;
+        }
+      Reader reader (entry.empty () ? 0 : &entry[0], size);
+      uint8_t type = reader.ReadByte ();
+      if (type == SITE)
+        {
+          uint64_t id = reader.ReadVarint ();
+          SiteName site;
+          site.component = reader.ReadString ();
+          site.function = reader.ReadString ();
+          site.kind = reader.ReadByte ();
+          if (!reader.IsOk () || id > sites.size ())
+            {
+              return false;
+            }
+          if (id == sites.size ())
+            {
+              sites.push_back (site);
+            }
+          continue;
+        }
+      if (type != RECORD)
+        {
+          return false;
+        }
+      uint64_t id = reader.ReadVarint ();
+      enum LogLevel level = static_cast<enum LogLevel> (reader.ReadVarint ());
+      uint8_t flags = reader.ReadByte ();
+      if (!reader.IsOk () || id >= sites.size ())
+        {
+          return false;
+        }
+      const SiteName &site = sites[id];
+      // the same prefixes as the NS_LOG macros
+      if (flags & HAS_TIME)
+        {
+          os << reader.ReadDouble () << "s ";
+        }
+      if (flags & HAS_NODE)
+        {
+          uint32_t context = static_cast<uint32_t> (reader.ReadVarint ());
+          if (context == 0xffffffff)
+            {
+              os << "-1 ";
+            }
+          else
+            {
+              os << context << " ";
+            }
+        }
+      os << reader.ReadString ();
+      bool function = site.kind == LogRecord::FUNCTION;
+      if (function)
+        {
+          os << site.component << ":" << site.function << "(";
+        }
+      else
+        {
+          if (flags & PREFIX_FUNC)
+            {
+              os << site.component << ":" << site.function << "(): ";
+            }
+          if (flags & PREFIX_LEVEL)
+            {
+              os << "[" << LogComponent::GetLevelLabel (level) << "] ";
+            }
+        }
+      bool first = true;
+      while (!reader.IsEnd () && reader.IsOk ())
+        {
+          uint8_t tag = reader.ReadByte ();
+          if (function && !first && tag != TEXT)
+            {
+              os << ", ";
+            }
+          first = false;
+          switch (tag)
+            {
+            case SIGNED:
+              os << reader.ReadSigned ();
+              break;
+            case UNSIGNED:
+              os << reader.ReadVarint ();
+              break;
+            case DOUBLE:
+              os << reader.ReadDouble ();
+              break;
+            case CHAR:
+              os << static_cast<char> (reader.ReadByte ());
+              break;
+            case POINTER:
+              os << reinterpret_cast<const void *> (static_cast<uintptr_t> (reader.ReadVarint ()));
+              break;
+            case STRING:
+            case TEXT:
+              os << reader.ReadString ();
+              break;
+            default:
+              return false;
+            }
+        }
+      if (!reader.IsOk ())
+        {
+          return false;
+        }
+      if (function)
+        {
+          os << ")";
+        }
+      os << "\n";
+    }
+  os.flush ();
+  return is.eof ();
+}
+
+uint32_t
+LogRecord::RegisterSite (const LogComponent &component,
+                         const char *function, enum Kind kind)
+{
+  Site site;
+  site.component = component.Name ();
+  site.function = function;
+  site.kind = kind;
+  g_sitesLock.Lock ();
+  std::vector<Site> *sites = GetSites ();
+  uint32_t id = sites->size ();
+  sites->push_back (site);
+  if (g_logBinarySink != 0)
+    {
+      std::string entry = EncodeSite (id, site);
+      g_logBinarySink->Write (entry.data (), entry.size ());
+    }
+  g_sitesLock.Unlock ();
+  return id;
+}
+
+LogRecord::LogRecord (const LogComponent &component, uint32_t site, enum LogLevel level)
+  : m_function (level == LOG_FUNCTION),
+    m_textStarted (false),
+    m_formatted (false),
+    m_text (0),
+    m_clog (0),
+    m_data (m_buffer),
+    m_size (0),
+    m_capacity (sizeof (m_buffer))
+{
+  uint8_t flags = 0;
+  double time = 0;
+  uint32_t context = 0;
+  // the simulator sets the printers once it exists
+  if (component.IsEnabled (LOG_PREFIX_TIME) && LogGetTimePrinter () != 0)
+    {
+      flags |= HAS_TIME;
+      time = Simulator::Now ().GetSeconds ();
+    }
+  if (component.IsEnabled (LOG_PREFIX_NODE) && LogGetNodePrinter () != 0)
+    {
+      flags |= HAS_NODE;
+      context = Simulator::GetContext ();
+    }
+  if (component.IsEnabled (LOG_PREFIX_FUNC))
+    {
+      flags |= PREFIX_FUNC;
+    }
+  if (component.IsEnabled (LOG_PREFIX_LEVEL))
+    {
+      flags |= PREFIX_LEVEL;
+    }
+  uint8_t type = RECORD;
+  Write (&type, 1);
+  WriteVarint (site);
+  WriteVarint (level);
+  Write (&flags, 1);
+  if (flags & HAS_TIME)
+    {
+      Write (&time, sizeof (time));
+    }
+  if (flags & HAS_NODE)
+    {
+      WriteVarint (context);
+    }
+}
+
+LogRecord::~LogRecord ()
+{
+  if (m_formatted)
+    {
+      std::string text = GetTextStream ()->str ();
+      WriteText (TEXT, text.data (), text.size ());
+    }
+  WriteBinary (m_data, m_size);
+  if (m_data != m_buffer)
+    {
+      std::free (m_data);
+    }
+}
+
+void
+LogRecord::BeginContext (void)
+{
+  std::stringbuf *buffer = GetContextBuffer ();
+  // a message logged while evaluating the context of another one
+  // leaves its context to the first one
+  if (std::clog.rdbuf () != buffer)
+    {
+      m_clog = std::clog.rdbuf (buffer);
+    }
+}
+
+void
+LogRecord::EndContext (void)
+{
+  if (m_clog == 0)
+    {
+      WriteVarint (0);
+      return;
+    }
+  std::clog.rdbuf (m_clog);
+  m_clog = 0;
+  std::stringbuf *buffer = GetContextBuffer ();
+  std::string context = buffer->str ();
+  WriteVarint (context.size ());
+  if (!context.empty ())
+    {
+      Write (context.data (), context.size ());
+      buffer->str (std::string ());
+    }
+}
+
+LogRecord &
+LogRecord::operator<< (const char *value)
+{
+  if (m_formatted)
+    {
+      *m_text << value;
+    }
+  else
+    {
+      WriteText (STRING, value, std::strlen (value));
+    }
+  return *this;
+}
+
+LogRecord &
+LogRecord::operator<< (const std::string &value)
+{
+  if (m_formatted)
+    {
+      *m_text << value;
+    }
+  else
+    {
+      WriteText (STRING, value.data (), value.size ());
+    }
+  return *this;
+}
+
+LogRecord &
+LogRecord::operator<< (std::ostream & (*manipulator)(std::ostream &))
+{
+  BeginText () << manipulator;
+  m_formatted = !m_function;
+  EndText ();
+  return *this;
+}
+
+LogRecord &
+LogRecord::operator<< (std::ios & (*manipulator)(std::ios &))
+{
+  BeginText () << manipulator;
+  m_formatted = !m_function;
+  EndText ();
+  return *this;
+}
+
+LogRecord &
+LogRecord::operator<< (std::ios_base & (*manipulator)(std::ios_base &))
+{
+  BeginText () << manipulator;
+  m_formatted = !m_function;
+  EndText ();
+  return *this;
+}
+
+void
+LogRecord::WriteSigned (int64_t value)
+{
+  uint8_t tag = SIGNED;
+  Write (&tag, 1);
+  WriteVarint ((static_cast<uint64_t> (value) << 1) ^ static_cast<uint64_t> (value >> 63));
+}
+
+void
+LogRecord::WriteUnsigned (uint64_t value)
+{
+  uint8_t tag = UNSIGNED;
+  Write (&tag, 1);
+  WriteVarint (value);
+}
+
+void
+LogRecord::WriteDouble (double value)
+{
+  uint8_t tag = DOUBLE;
+  Write (&tag, 1);
+  Write (&value, sizeof (value));
+}
+
+void
+LogRecord::WriteChar (char value)
+{
+  uint8_t bytes[2] = { CHAR, static_cast<uint8_t> (value) };
+  Write (bytes, 2);
+}
+
+void
+LogRecord::WritePointer (const void *value)
+{
+  uint8_t tag = POINTER;
+  Write (&tag, 1);
+  WriteVarint (reinterpret_cast<uintptr_t> (value));
+}
+
+void
+LogRecord::WriteText (uint8_t tag, const char *value, std::size_t size)
+{
+  Write (&tag, 1);
+  WriteVarint (size);
+  Write (value, size);
+}
+
+void
+LogRecord::Write (const void *data, std::size_t size)
+{
+  if (m_size + size > m_capacity)
+    {
+      std::size_t capacity = m_capacity * 2;
+      if (capacity < m_size + size)
+        {
+          capacity = m_size + size;
+        }
+      if (m_data == m_buffer)
+        {
+          m_data = static_cast<uint8_t *> (std::malloc (capacity));
+          std::memcpy (m_data, m_buffer, m_size);
+        }
+      else
+        {
+          m_data = static_cast<uint8_t *> (std::realloc (m_data, capacity));
+        }
+      m_capacity = capacity;
+    }
+  std::memcpy (m_data + m_size, data, size);
+  m_size += size;
+}
+
+void
+LogRecord::WriteVarint (uint64_t value)
+{
+  uint8_t bytes[10];
+  std::size_t size = 0;
+  while (value >= 0x80)
+    {
+      bytes[size++] = static_cast<uint8_t> (value | 0x80);
+      value >>= 7;
+    }
+  bytes[size++] = static_cast<uint8_t> (value);
+  Write (bytes, size);
+}
+
+std::ostream &
+LogRecord::BeginText (void)
+{
+  if (!m_textStarted)
+    {
+      // the arguments of each message are formatted from the defaults
+      m_text = GetTextStream ();
+      m_text->flags (DEFAULT_FLAGS);
+      m_text->precision (DEFAULT_PRECISION);
+      m_text->width (0);
+      m_text->fill (' ');
+      GetTextStream ()->str ("");
+      m_textStarted = true;
+    }
+  return *m_text;
+}
+
+void
+LogRecord::EndText (void)
+{
+  if (m_formatted)
+    {
+      return;
+    }
+  if (!m_function
+      && (m_text->flags () != DEFAULT_FLAGS || m_text->precision () != DEFAULT_PRECISION
+          || m_text->width () != 0 || m_text->fill () != ' '))
+    {
+      // a manipulator changes the format of the following arguments
+      m_formatted = true;
+      return;
+    }
+  std::ostringstream *text = GetTextStream ();
+  std::string value = text->str ();
+  WriteText (STRING, value.data (), value.size ());
+  text->str ("");
+}
+
+/**
+ * Open the binary log file given by the NS_LOG_BINARY_FILE environment
+ * variable.
+ */
+static class LogBinaryEnvironment
+{
+public:
+  LogBinaryEnvironment ()
+  {
+#ifdef HAVE_GETENV
+    char *filename = getenv ("NS_LOG_BINARY_FILE");
+    if (filename != 0 && *filename != 0)
+      {
+        LogSetBinaryFile (filename);
+      }
+#endif
+  }
+} g_logBinaryEnvironment;
+
+} // namespace ns3
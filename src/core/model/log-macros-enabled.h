@@ -106,6 +106,19 @@
 #endif /* NS_LOG_APPEND_CONTEXT */
 
 
+/**
+ * \ingroup logging
+ * The compile-time condition of the logging macros:  false for the
+ * log components which are not in the NS3_LOG_WHITELIST, so that the
+ * compiler drops their logging code.
+ * \internal
+ */
+#ifdef NS3_LOG_WHITELIST
+#define NS_LOG_COMPILED g_logCompiled
+#else
+#define NS_LOG_COMPILED true
+#endif
+
 #ifndef NS_LOG_CONDITION
 /**
  * \ingroup logging
@@ -124,6 +137,24 @@
 #define NS_LOG_CONDITION
 #endif
 
+/**
+ * \ingroup logging
+ * Start a LogRecord named \c ns3LogRecord for the current call site,
+ * with the file-local context.
+ * \internal
+ * Logging implementation macro; should not be called directly.
+ *
+ * \param kind the LogRecord::Kind of the site.
+ * \param level the log level.
+ */
+#define NS_LOG_BINARY_RECORD(kind, level)                       \
+  static uint32_t ns3LogSite =                                  \
+    ns3::LogRecord::RegisterSite (g_log, __FUNCTION__, kind);   \
+  ns3::LogRecord ns3LogRecord (g_log, ns3LogSite, level);       \
+  ns3LogRecord.BeginContext ();                                 \
+  NS_LOG_APPEND_CONTEXT;                                        \
+  ns3LogRecord.EndContext ()
+
 /**
  * \ingroup logging
  *
@@ -147,8 +178,15 @@
   NS_LOG_CONDITION                                              \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (level))                              \
+      if (NS_LOG_COMPILED && g_log.IsEnabled (level))           \
         {                                                       \
+          if (ns3::LogIsBinary ())                              \
+            {                                                   \
+              NS_LOG_BINARY_RECORD (ns3::LogRecord::MESSAGE,    \
+                                    level);                     \
+              ns3LogRecord << msg;                              \
+              break;                                            \
+            }                                                   \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
           NS_LOG_APPEND_CONTEXT;                                \
@@ -171,8 +209,15 @@
   NS_LOG_CONDITION                                              \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+      if (NS_LOG_COMPILED                                       \
+          && g_log.IsEnabled (ns3::LOG_FUNCTION))               \
         {                                                       \
+          if (ns3::LogIsBinary ())                              \
+            {                                                   \
+              NS_LOG_BINARY_RECORD (ns3::LogRecord::FUNCTION,   \
+                                    ns3::LOG_FUNCTION);         \
+              break;                                            \
+            }                                                   \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
           NS_LOG_APPEND_CONTEXT;                                \
@@ -208,8 +253,16 @@
   NS_LOG_CONDITION                                              \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+      if (NS_LOG_COMPILED                                       \
+          && g_log.IsEnabled (ns3::LOG_FUNCTION))               \
         {                                                       \
+          if (ns3::LogIsBinary ())                              \
+            {                                                   \
+              NS_LOG_BINARY_RECORD (ns3::LogRecord::FUNCTION,   \
+                                    ns3::LOG_FUNCTION);         \
+              ns3LogRecord << parameters;                       \
+              break;                                            \
+            }                                                   \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
           NS_LOG_APPEND_CONTEXT;                                \
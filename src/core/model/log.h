@@ -24,9 +24,14 @@
 #include <string>
 #include <iostream>
 #include <stdint.h>
+#include <cstddef>
 #include <map>
 #include <vector>
+#include <type_traits>
 
+#include "ns3/core-config.h"
+#include "int-to-type.h"
+#include "unused.h"
 #include "log-macros-enabled.h"
 #include "log-macros-disabled.h"
 
@@ -59,6 +64,16 @@ namespace ns3 {
  * NS_LOG='*=level_all|prefix' would enable all log levels and prefix all
  * prints with the component and function names.
  *
+ * Use the environment variable NS_LOG_BINARY_FILE, or
+ * ns3::LogSetBinaryFile, to write the logging messages to a binary
+ * file instead of std::clog, with much less overhead.
+ *
+ * The optimized builds compile all the logging out.  To keep the
+ * logging of a few components only, configure with
+ * --log-whitelist=Component1,Component2:  the logging of the other
+ * components is then compiled out, and the logging of these components
+ * is still enabled and disabled at run time.
+ *
  * A note on NS_LOG_FUNCTION() and NS_LOG_FUNCTION_NOARGS():
  * generally, use of (at least) NS_LOG_FUNCTION(this) is preferred.
  * Use NS_LOG_FUNCTION_NOARGS() only in static functions.
@@ -152,8 +167,66 @@ void LogComponentDisable (char const *name, enum LogLevel level);
 void LogComponentDisableAll (enum LogLevel level);
 
 
+/**
+ * \ingroup logging
+ *
+ * \param a a string
+ * \param b another string
+ * \returns true if \p a and \p b are equal
+ */
+constexpr bool
+LogComponentNameEqual (const char *a, const char *b)
+{
+  return *a == *b && (*a == '\0' || LogComponentNameEqual (a + 1, b + 1));
+}
+
+/**
+ * \ingroup logging
+ *
+ * \param name the name of a log component
+ * \param names an array of log component names
+ * \param size the number of names in \p names
+ * \returns true if \p name is one of \p names
+ *
+ * This function is evaluated at compile time when its arguments are
+ * constant, to compile out the logging of the components which are not
+ * in the NS3_LOG_WHITELIST.
+ */
+constexpr bool
+LogComponentIsListed (const char *name, const char * const *names, std::size_t size)
+{
+  return size != 0
+    && (LogComponentNameEqual (name, names[0])
+        || LogComponentIsListed (name, names + 1, size - 1));
+}
+
+#ifdef NS3_LOG_WHITELIST
+/**
+ * \ingroup logging
+ *
+ * The log components whose logging is compiled in, given to
+ * --log-whitelist.
+ */
+constexpr const char *g_logWhitelist[] = { NS3_LOG_WHITELIST };
+#endif /* NS3_LOG_WHITELIST */
+
 } // namespace ns3
 
+#ifdef NS3_LOG_WHITELIST
+/*
+ * g_logCompiled is false for the components which are not in the
+ * whitelist, so that the compiler drops their logging code; see the
+ * NS_LOG_COMPILED condition of the logging macros.
+ */
+#define NS_LOG_COMPONENT_DEFINE_COMPILED(name)                          \
+  static const bool NS_UNUSED_GLOBAL (g_logCompiled) =                  \
+    ns3::LogComponentIsListed (name, ns3::g_logWhitelist,               \
+                               sizeof (ns3::g_logWhitelist)             \
+                               / sizeof (ns3::g_logWhitelist[0]));
+#else
+#define NS_LOG_COMPONENT_DEFINE_COMPILED(name)
+#endif /* NS3_LOG_WHITELIST */
+
 /**
  * \ingroup logging
  *
@@ -169,6 +242,7 @@ void LogComponentDisableAll (enum LogLevel level);
  * \param name a string
  */
 #define NS_LOG_COMPONENT_DEFINE(name)                           \
+  NS_LOG_COMPONENT_DEFINE_COMPILED (name)                       \
   static ns3::LogComponent g_log = ns3::LogComponent (name)
 
 /**
@@ -182,6 +256,7 @@ void LogComponentDisableAll (enum LogLevel level);
  * \param mask the default mask
  */
 #define NS_LOG_COMPONENT_DEFINE_MASK(name, mask)                \
+  NS_LOG_COMPONENT_DEFINE_COMPILED (name)                       \
   static ns3::LogComponent g_log = ns3::LogComponent (name, mask)
 
 /**
@@ -264,6 +339,48 @@ LogTimePrinter LogGetTimePrinter (void);
 void LogSetNodePrinter (LogNodePrinter);
 LogNodePrinter LogGetNodePrinter (void);
 
+/**
+ * \ingroup logging
+ *
+ * Write the log messages to a binary file instead of std::clog.
+ *
+ * The NS_LOG macros then store their arguments unformatted in a
+ * buffer of \pname{bufferSize} bytes, which a background thread
+ * writes to \pname{filename}. Use ns3::LogPrintBinary, or the
+ * print-binary-log program, to print the file with the usual format.
+ *
+ * Same as running your program with the NS_LOG_BINARY_FILE
+ * environment variable set to \pname{filename}.
+ *
+ * A child process created with fork(), as by ns3::ParameterSweep,
+ * writes its messages to \pname{filename}.pid instead, where pid is
+ * its process id.
+ *
+ * \param [in] filename the binary log file, or the empty string to
+ *             close it and log to std::clog again.
+ * \param [in] bufferSize the size of the buffer, a power of 2.
+ */
+void LogSetBinaryFile (std::string filename, uint32_t bufferSize = 1 << 22);
+
+/**
+ * \ingroup logging
+ *
+ * \return true if the log messages are written to a binary file.
+ */
+bool LogIsBinary (void);
+
+/**
+ * \ingroup logging
+ *
+ * Print the messages of a binary log file, as they would have been
+ * printed to std::clog.
+ *
+ * \param [in] is the binary log file.
+ * \param [in] os the output stream.
+ * \return false if \pname{is} is not a complete binary log file.
+ */
+bool LogPrintBinary (std::istream &is, std::ostream &os);
+
 
 /**
  * \ingroup logging
@@ -378,6 +495,285 @@ public:
   }
 };
 
+template <typename T>
+class Ptr;
+
+/**
+ * \ingroup logging
+ *
+ * A log message written to the binary log file.
+ *
+ * The NS_LOG macros stream their arguments into a LogRecord instead of
+ * std::clog when ns3::LogIsBinary is true. The integers, floating point
+ * numbers, characters, strings and pointers are stored as they are;
+ * the values of the other types, and the arguments which follow a
+ * stream manipulator, are formatted as text.
+ * The record is written to the file when it is destroyed.
+ */
+class LogRecord
+{
+public:
+  /** The kind of the NS_LOG macro of a log site. */
+  enum Kind
+  {
+    MESSAGE,        //!< NS_LOG and the NS_LOG_ERROR, ... macros
+    FUNCTION        //!< NS_LOG_FUNCTION and NS_LOG_FUNCTION_NOARGS
+  };
+
+  /**
+   * Register a call site of the NS_LOG macros, once.
+   *
+   * \param [in] component the LogComponent of the site.
+   * \param [in] function the name of the function of the site.
+   * \param [in] kind the kind of macro of the site.
+   * \return the identifier of the site in the binary log files.
+   */
+  static uint32_t RegisterSite (const LogComponent &component,
+                                const char *function, enum Kind kind);
+
+  /**
+   * Start a log message, with the prefixes enabled in \pname{component}.
+   *
+   * \param [in] component the LogComponent of the message.
+   * \param [in] site the identifier given by RegisterSite.
+   * \param [in] level the LogLevel of the message.
+   */
+  LogRecord (const LogComponent &component, uint32_t site, enum LogLevel level);
+  /** Write the log message to the binary log file. */
+  ~LogRecord ();
+
+  /**
+   * Redirect std::clog to the context of this message, while the
+   * NS_LOG_APPEND_CONTEXT of the file is evaluated.
+   */
+  void BeginContext (void);
+  /** Stop the redirection of std::clog started by BeginContext. */
+  void EndContext (void);
+
+  /**
+   * Append an argument of the message.
+   *
+   * \param [in] value the argument.
+   * \return this record.
+   */
+  LogRecord & operator<< (bool value)
+  {
+    return Unsigned (value);
+  }
+  LogRecord & operator<< (short value)
+  {
+    return Signed (value);
+  }
+  LogRecord & operator<< (unsigned short value)
+  {
+    return Unsigned (value);
+  }
+  LogRecord & operator<< (int value)
+  {
+    return Signed (value);
+  }
+  LogRecord & operator<< (unsigned int value)
+  {
+    return Unsigned (value);
+  }
+  LogRecord & operator<< (long value)
+  {
+    return Signed (value);
+  }
+  LogRecord & operator<< (unsigned long value)
+  {
+    return Unsigned (value);
+  }
+  LogRecord & operator<< (long long value)
+  {
+    return Signed (value);
+  }
+  LogRecord & operator<< (unsigned long long value)
+  {
+    return Unsigned (value);
+  }
+  LogRecord & operator<< (float value)
+  {
+    return Double (value);
+  }
+  LogRecord & operator<< (double value)
+  {
+    return Double (value);
+  }
+  LogRecord & operator<< (char value)
+  {
+    return Char (value);
+  }
+  LogRecord & operator<< (signed char value)
+  {
+    return Char (value);
+  }
+  LogRecord & operator<< (unsigned char value)
+  {
+    return Char (value);
+  }
+  LogRecord & operator<< (const char *value);
+  LogRecord & operator<< (char *value)
+  {
+    return *this << static_cast<const char *> (value);
+  }
+  LogRecord & operator<< (const std::string &value);
+  template <typename T>
+  LogRecord & operator<< (T *value)
+  {
+    return Pointer (value, IntToType<std::is_function<T>::value> ());
+  }
+  template <typename T>
+  LogRecord & operator<< (const Ptr<T> &value)
+  {
+    return Pointer (PeekPointer (value), IntToType<0> ());
+  }
+  LogRecord & operator<< (std::ostream & (*manipulator)(std::ostream &));
+  LogRecord & operator<< (std::ios & (*manipulator)(std::ios &));
+  LogRecord & operator<< (std::ios_base & (*manipulator)(std::ios_base &));
+  template <typename T>
+  LogRecord & operator<< (const T &value)
+  {
+    std::ostream &os = BeginText ();
+    os << value;
+    EndText ();
+    return *this;
+  }
+
+private:
+  /**
+   * Append an argument of the message.
+   *
+   * \param [in] value the argument.
+   * \return this record.
+   */
+  template <typename T>
+  LogRecord & Signed (T value)
+  {
+    if (m_formatted)
+      {
+        *m_text << value;
+      }
+    else
+      {
+        WriteSigned (value);
+      }
+    return *this;
+  }
+  template <typename T>
+  LogRecord & Unsigned (T value)
+  {
+    if (m_formatted)
+      {
+        *m_text << value;
+      }
+    else
+      {
+        WriteUnsigned (value);
+      }
+    return *this;
+  }
+  template <typename T>
+  LogRecord & Double (T value)
+  {
+    if (m_formatted)
+      {
+        *m_text << value;
+      }
+    else
+      {
+        WriteDouble (value);
+      }
+    return *this;
+  }
+  template <typename T>
+  LogRecord & Char (T value)
+  {
+    if (m_formatted)
+      {
+        *m_text << value;
+      }
+    else
+      {
+        WriteChar (value);
+      }
+    return *this;
+  }
+  template <typename T>
+  LogRecord & Pointer (const T *value, IntToType<0>)
+  {
+    if (m_formatted)
+      {
+        *m_text << value;
+      }
+    else
+      {
+        WritePointer (value);
+      }
+    return *this;
+  }
+  template <typename T>
+  LogRecord & Pointer (T *value, IntToType<1>)
+  {
+    // a function pointer, printed as a bool
+    std::ostream &os = BeginText ();
+    os << value;
+    EndText ();
+    return *this;
+  }
+
+  void WriteSigned (int64_t value);
+  void WriteUnsigned (uint64_t value);
+  void WriteDouble (double value);
+  void WriteChar (char value);
+  void WritePointer (const void *value);
+  /**
+   * Write an argument formatted as text.
+   *
+   * \param [in] tag the type of the argument.
+   * \param [in] value the text.
+   * \param [in] size the length of the text.
+   */
+  void WriteText (uint8_t tag, const char *value, std::size_t size);
+  /**
+   * Write raw bytes.
+   *
+   * \param [in] data the bytes.
+   * \param [in] size the number of bytes.
+   */
+  void Write (const void *data, std::size_t size);
+  /**
+   * Write an integer in a variable number of bytes.
+   *
+   * \param [in] value the integer.
+   */
+  void WriteVarint (uint64_t value);
+  /**
+   * Get the stream which formats the arguments written as text.
+   *
+   * \return the stream.
+   */
+  std::ostream & BeginText (void);
+  /**
+   * Write the argument formatted by the stream given by BeginText,
+   * unless the stream keeps formatting the following arguments.
+   */
+  void EndText (void);
+
+  LogRecord (const LogRecord &);
+  LogRecord & operator= (const LogRecord &);
+
+  bool m_function;          //!< The record is for NS_LOG_FUNCTION.
+  bool m_textStarted;       //!< The state of m_text was reset for this record.
+  bool m_formatted;         //!< The arguments are formatted by m_text.
+  std::ostream *m_text;     //!< The stream which formats the arguments.
+  std::streambuf *m_clog;   //!< The buffer of std::clog, during BeginContext.
+  uint8_t *m_data;          //!< The encoded record.
+  std::size_t m_size;       //!< The size of the encoded record.
+  std::size_t m_capacity;   //!< The capacity of m_data.
+  uint8_t m_buffer[256];    //!< Initial storage of the encoded record.
+};
+
 } // namespace ns3
 
 
@@ -16,7 +16,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-#include <map>
+#include <unordered_map>
 #include "object.h"
 #include "log.h"
 #include "assert.h"
@@ -27,6 +27,14 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Names");
 
+class NameNode;
+
+/**
+ * The names of the children of a NameNode.  The names are hashed, so that
+ * the lookups of a segment do not compare it to O(log n) other names.
+ */
+typedef std::unordered_map<std::string, NameNode *> NameMap;
+
 class NameNode
 {
 public:
@@ -41,7 +49,7 @@ public:
   std::string m_name;
   Ptr<Object> m_object;
 
-  std::map<std::string, NameNode *> m_nameMap;
+  NameMap m_nameMap;
 };
 
 NameNode::NameNode ()
@@ -107,9 +115,26 @@ private:
 
   NameNode *IsNamed (Ptr<Object>);
   bool IsDuplicateName (NameNode *node, std::string name);
+  NameNode *FindNode (const std::string &path);
+
+  /** Hash an object by its address. */
+  struct ObjectHash
+  {
+    std::size_t operator () (const Ptr<Object> &object) const
+    {
+      return std::hash<Object *> () (PeekPointer (object));
+    }
+  };
+  typedef std::unordered_map<Ptr<Object>, NameNode *, ObjectHash> ObjectMap;
 
   NameNode m_root;
-  std::map<Ptr<Object>, NameNode *> m_objectMap;
+  ObjectMap m_objectMap;
+  /**
+   * The nodes found by Find (path), indexed by their path relative to
+   * /Names.  Only the successful lookups are cached, so that adding a name
+   * never invalidates the cache; renaming a node clears it.
+   */
+  NameMap m_pathCache;
 };
 
 NamesPriv *
@@ -144,13 +169,14 @@ NamesPriv::Clear (void)
   // Every name is associated with an object in the object map, so freeing the
   // NameNodes in this map will free all of the memory allocated for the NameNodes
   //
-  for (std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.begin (); i != m_objectMap.end (); ++i)
+  for (ObjectMap::iterator i = m_objectMap.begin (); i != m_objectMap.end (); ++i)
     {
       delete i->second;
       i->second = 0;
     }
 
   m_objectMap.clear ();
+  m_pathCache.clear ();
 
   m_root.m_parent = 0;
   m_root.m_name = "Names";
@@ -363,7 +389,7 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
       return false;
     }
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (oldname);
+  NameMap::iterator i = node->m_nameMap.find (oldname);
   if (i == node->m_nameMap.end ())
     {
       NS_LOG_LOGIC ("Old name does not exist in name map");
@@ -384,6 +410,10 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
       node->m_nameMap.erase (i);
       changeNode->m_name = newname;
       node->m_nameMap[newname] = changeNode;
+      //
+      // The paths of the node and of all its descendants changed.
+      //
+      m_pathCache.clear ();
       return true;
     }
 }
@@ -393,7 +423,7 @@ NamesPriv::FindName (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
+  ObjectMap::iterator i = m_objectMap.find (object);
   if (i == m_objectMap.end ())
     {
       NS_LOG_LOGIC ("Object does not exist in object map");
@@ -411,7 +441,7 @@ NamesPriv::FindPath (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
+  ObjectMap::iterator i = m_objectMap.find (object);
   if (i == m_objectMap.end ())
     {
       NS_LOG_LOGIC ("Object does not exist in object map");
@@ -456,8 +486,7 @@ NamesPriv::Find (std::string path)
   std::string namespaceName = "/Names/";
   std::string remaining;
 
-  std::string::size_type offset = path.find (namespaceName);
-  if (offset == 0)
+  if (path.compare (0, namespaceName.size (), namespaceName) == 0)
     {
       NS_LOG_LOGIC (path << " is a fully qualified name");
       remaining = path.substr (namespaceName.size ());
@@ -468,64 +497,63 @@ NamesPriv::Find (std::string path)
       remaining = path;
     }
 
-  NameNode *node = &m_root;
-
   //
   // The string <remaining> is now composed entirely of path segments in
   // the /Names name space and we have eaten the leading slash. e.g., 
-  // remaining = "ClientNode/eth0"
+  // remaining = "ClientNode/eth0".  The paths already found are cached, so
+  // that looking them up again hashes the whole path once instead of
+  // searching for every segment.
+  //
+  NameMap::iterator cached = m_pathCache.find (remaining);
+  if (cached != m_pathCache.end ())
+    {
+      NS_LOG_LOGIC ("Name found in path cache");
+      return cached->second->m_object;
+    }
+
+  NameNode *node = FindNode (remaining);
+  if (node == 0)
+    {
+      return 0;
+    }
+  m_pathCache[remaining] = node;
+  return node->m_object;
+}
+
+NameNode *
+NamesPriv::FindNode (const std::string &path)
+{
+  NS_LOG_FUNCTION (this << path);
+
+  NameNode *node = &m_root;
+
   //
   // The start of the search is always at the root of the name space.
+  // Every segment but the last one is an intermediate segment of the
+  // specified name, and we "recurse" into its node when we find it.
   //
+  std::string::size_type start = 0;
   for (;;)
     {
-      NS_LOG_LOGIC ("Looking for the object of name " << remaining);
-      offset = remaining.find ("/");
-      if (offset == std::string::npos)
+      std::string::size_type offset = path.find ('/', start);
+      std::string segment = path.substr (start, offset - start);
+      NS_LOG_LOGIC ("Looking for the object of name " << segment);
+
+      NameMap::iterator i = node->m_nameMap.find (segment);
+      if (i == node->m_nameMap.end ())
         {
-          //
-          // There are no remaining slashes so this is the last segment of the 
-          // specified name.  We're done when we find it
-          //
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (remaining);
-          if (i == node->m_nameMap.end ())
-            {
-              NS_LOG_LOGIC ("Name does not exist in name map");
-              return 0;
-            }
-          else
-            {
-              NS_LOG_LOGIC ("Name parsed, found object");
-              return i->second->m_object;
-            }
+          NS_LOG_LOGIC ("Name does not exist in name map");
+          return 0;
         }
-      else
+      node = i->second;
+      if (offset == std::string::npos)
         {
-          //
-          // There are more slashes so this is an intermediate segment of the 
-          // specified name.  We need to "recurse" when we find this segment.
-          //
-          offset = remaining.find ("/");
-          std::string segment = remaining.substr (0, offset);
-
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (segment);
-          if (i == node->m_nameMap.end ())
-            {
-              NS_LOG_LOGIC ("Name does not exist in name map");
-              return 0;
-            }
-          else
-            {
-              node = i->second;
-              remaining = remaining.substr (offset + 1);
-              NS_LOG_LOGIC ("Intermediate segment parsed");
-              continue;
-            }
+          NS_LOG_LOGIC ("Name parsed, found object");
+          return node;
         }
+      NS_LOG_LOGIC ("Intermediate segment parsed");
+      start = offset + 1;
     }
-
-  NS_ASSERT_MSG (node, "NamesPriv::Find(): Internal error:  this can't happen");
-  return 0;
 }
 
 Ptr<Object>
@@ -562,7 +590,7 @@ NamesPriv::Find (Ptr<Object> context, std::string name)
         }
     }
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
+  NameMap::iterator i = node->m_nameMap.find (name);
   if (i == node->m_nameMap.end ())
     {
       NS_LOG_LOGIC ("Name does not exist in name map");
@@ -580,7 +608,7 @@ NamesPriv::IsNamed (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
+  ObjectMap::iterator i = m_objectMap.find (object);
   if (i == m_objectMap.end ())
     {
       NS_LOG_LOGIC ("Object does not exist in object map, returning NameNode 0");
@@ -598,7 +626,7 @@ NamesPriv::IsDuplicateName (NameNode *node, std::string name)
 {
   NS_LOG_FUNCTION (this << node << name);
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
+  NameMap::iterator i = node->m_nameMap.find (name);
   if (i == node->m_nameMap.end ())
     {
       NS_LOG_LOGIC ("Name does not exist in name map");
@@ -295,6 +295,10 @@ public:
    * This method requires that the name path of the object be provided, e.g., 
    * "Names/client/eth0".
    *
+   * The paths found are remembered until a name is renamed or the names are
+   * cleared, so that finding the same path again costs a single hashed
+   * lookup.
+   *
    * \param path A string containing a name space path used to locate the object.
    *
    * \returns a smart pointer to the named object converted to the requested
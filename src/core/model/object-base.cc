@@ -64,96 +64,92 @@ ObjectBase::NotifyConstructionCompleted (void)
 void
 ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
 {
-  // loop over the inheritance tree back to the Object base class.
+  // loop over the attributes of the inheritance tree back to the Object base class.
   NS_LOG_FUNCTION (this << &attributes);
   TypeId tid = GetInstanceTypeId ();
-  do {
-      // loop over all attributes in object type
-      NS_LOG_DEBUG ("construct tid="<<tid.GetName ()<<", params="<<tid.GetAttributeN ());
-      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+  char *envVar = 0;
+#ifdef HAVE_GETENV
+  envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
+#endif /* HAVE_GETENV */
+  NS_LOG_DEBUG ("construct tid="<<tid.GetName ()<<", params="<<tid.GetAllAttributeN ());
+  for (uint32_t i = 0; i < tid.GetAllAttributeN (); i++)
+    {
+      TypeId owner;
+      const struct TypeId::AttributeInformation &info = tid.GetAllAttribute (i, &owner);
+      NS_LOG_DEBUG ("try to construct \""<< owner.GetName ()<<"::"<<
+                    info.name <<"\"");
+      // is this attribute stored in this AttributeConstructionList instance ?
+      Ptr<AttributeValue> value = attributes.Find(info.checker);
+      // See if this attribute should not be set here in the
+      // constructor.
+      if (!(info.flags & TypeId::ATTR_CONSTRUCT))
         {
-          struct TypeId::AttributeInformation info = tid.GetAttribute(i);
-          NS_LOG_DEBUG ("try to construct \""<< tid.GetName ()<<"::"<<
-                        info.name <<"\"");
-          // is this attribute stored in this AttributeConstructionList instance ?
-          Ptr<AttributeValue> value = attributes.Find(info.checker);
-          // See if this attribute should not be set here in the
-          // constructor.
-          if (!(info.flags & TypeId::ATTR_CONSTRUCT))
+          // Handle this attribute if it should not be 
+          // set here.
+          if (value == 0)
             {
-              // Handle this attribute if it should not be 
-              // set here.
-              if (value == 0)
-                {
-                  // Skip this attribute if it's not in the
-                  // AttributeConstructionList.
-                  continue;
-                }              
-              else
-                {
-                  // This is an error because this attribute is not
-                  // settable in its constructor but is present in
-                  // the AttributeConstructionList.
-                  NS_FATAL_ERROR ("Attribute name="<<info.name<<" tid="<<tid.GetName () << ": initial value cannot be set using attributes");
-                }
+              // Skip this attribute if it's not in the
+              // AttributeConstructionList.
+              continue;
+            }              
+          else
+            {
+              // This is an error because this attribute is not
+              // settable in its constructor but is present in
+              // the AttributeConstructionList.
+              NS_FATAL_ERROR ("Attribute name="<<info.name<<" tid="<<owner.GetName () << ": initial value cannot be set using attributes");
             }
-          bool found = false;
-          if (value != 0)
+        }
+      bool found = false;
+      if (value != 0)
+        {
+          // We have a matching attribute value.
+          if (DoSet (info.accessor, info.checker, *value))
             {
-              // We have a matching attribute value.
-              if (DoSet (info.accessor, info.checker, *value))
-                {
-                  NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                                info.name<<"\"");
-                  found = true;
-                  continue;
-                }
-            }              
-          if (!found)
+              NS_LOG_DEBUG ("construct \""<< owner.GetName ()<<"::"<<
+                            info.name<<"\"");
+              found = true;
+              continue;
+            }
+        }              
+      if (!found && envVar != 0)
+        {
+          // No matching attribute value so we try to look at the env var.
+          std::string env = std::string (envVar);
+          std::string fullName = owner.GetName () + "::" + info.name;
+          std::string::size_type cur = 0;
+          std::string::size_type next = 0;
+          while (next != std::string::npos)
             {
-              // No matching attribute value so we try to look at the env var.
-#ifdef HAVE_GETENV
-              char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
-              if (envVar != 0)
+              next = env.find (";", cur);
+              std::string tmp = std::string (env, cur, next-cur);
+              std::string::size_type equal = tmp.find ("=");
+              if (equal != std::string::npos)
                 {
-                  std::string env = std::string (envVar);
-                  std::string::size_type cur = 0;
-                  std::string::size_type next = 0;
-                  while (next != std::string::npos)
+                  std::string name = tmp.substr (0, equal);
+                  std::string value = tmp.substr (equal+1, tmp.size () - equal - 1);
+                  if (name == fullName)
                     {
-                      next = env.find (";", cur);
-                      std::string tmp = std::string (env, cur, next-cur);
-                      std::string::size_type equal = tmp.find ("=");
-                      if (equal != std::string::npos)
+                      if (DoSet (info.accessor, info.checker, StringValue (value)))
                         {
-                          std::string name = tmp.substr (0, equal);
-                          std::string value = tmp.substr (equal+1, tmp.size () - equal - 1);
-                          if (name == tid.GetAttributeFullName (i))
-                            {
-                              if (DoSet (info.accessor, info.checker, StringValue (value)))
-                                {
-                                  NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                                                info.name <<"\" from env var");
-                                  found = true;
-                                  break;
-                                }
-                            }
+                          NS_LOG_DEBUG ("construct \""<< owner.GetName ()<<"::"<<
+                                        info.name <<"\" from env var");
+                          found = true;
+                          break;
                         }
-                      cur = next + 1;
                     }
                 }
-#endif /* HAVE_GETENV */
-            }
-          if (!found)
-            {
-              // No matching attribute value so we try to set the default value.
-              DoSet (info.accessor, info.checker, *info.initialValue);
-              NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                            info.name <<"\" from initial value.");
+              cur = next + 1;
             }
         }
-      tid = tid.GetParent ();
-    } while (tid != ObjectBase::GetTypeId ());
+      if (!found)
+        {
+          // No matching attribute value so we try to set the default value.
+          DoSet (info.accessor, info.checker, *info.initialValue);
+          NS_LOG_DEBUG ("construct \""<< owner.GetName ()<<"::"<<
+                        info.name <<"\" from initial value.");
+        }
+    }
   NotifyConstructionCompleted ();
 }
 
@@ -79,6 +79,20 @@ MakeObjectMapAccessor (U T::*memberVector)
       // quiet compiler.
       return 0;
     }
+    virtual bool DoGetAll (const ObjectBase *object, std::map<uint32_t, Ptr<Object> > *objects) const {
+      const T *obj = dynamic_cast<const T *> (object);
+      if (obj == 0)
+        {
+          return false;
+        }
+      typename U::const_iterator begin = (obj->*m_memberVector).begin ();
+      typename U::const_iterator end = (obj->*m_memberVector).end ();
+      for (typename U::const_iterator j = begin; j != end; j++)
+        {
+          objects->insert (objects->end (), std::pair<uint32_t, Ptr<Object> > ((*j).first, (*j).second));
+        }
+      return true;
+    }
     U T::*m_memberVector;
   } *spec = new MemberStdContainer ();
   spec->m_memberVector = memberVector;
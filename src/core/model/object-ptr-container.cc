@@ -107,6 +107,12 @@ ObjectPtrContainerAccessor::Get (const ObjectBase * object, AttributeValue &valu
       return false;
     }
   v->m_objects.clear ();
+  return DoGetAll (object, &v->m_objects);
+}
+bool
+ObjectPtrContainerAccessor::DoGetAll (const ObjectBase *object, std::map<uint32_t, Ptr<Object> > *objects) const
+{
+  NS_LOG_FUNCTION (this << object << objects);
   uint32_t n;
   bool ok = DoGetN (object, &n);
   if (!ok)
@@ -117,7 +123,8 @@ ObjectPtrContainerAccessor::Get (const ObjectBase * object, AttributeValue &valu
     {
       uint32_t index;
       Ptr<Object> o = DoGet (object, i, &index);
-      v->m_objects.insert (std::pair <uint32_t, Ptr<Object> > (index, o));
+      // the indexes usually come in increasing order
+      objects->insert (objects->end (), std::pair <uint32_t, Ptr<Object> > (index, o));
     }
   return true;
 }
@@ -142,6 +142,16 @@ public:
 private:
   virtual bool DoGetN (const ObjectBase *object, uint32_t *n) const = 0;
   virtual Ptr<Object> DoGet (const ObjectBase *object, uint32_t i, uint32_t *index) const = 0;
+  /**
+   * \param object the object which holds the container
+   * \param objects the map to fill with the objects of the container
+   * \returns true on success
+   *
+   * The default implementation calls DoGet for each index in turn,
+   * which is quadratic in the size of the container when DoGet cannot
+   * access an index in constant time: such containers override this method.
+   */
+  virtual bool DoGetAll (const ObjectBase *object, std::map<uint32_t, Ptr<Object> > *objects) const;
 };
 
 template <typename T, typename U, typename INDEX>
@@ -26,6 +26,9 @@
 #include "attribute.h"
 #include "log.h"
 #include "string.h"
+#ifdef NS3_MULTITHREADED
+#include "system-mutex.h"
+#endif
 #include <vector>
 #include <sstream>
 #include <cstdlib>
@@ -43,6 +46,19 @@ namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED (Object);
 
+#ifdef NS3_MULTITHREADED
+/**
+ * \return the mutex which serializes the updates of the caches of
+ * DoGetObject, and of the sort of the aggregates.
+ */
+static SystemMutex &
+GetCacheMutex (void)
+{
+  static SystemMutex mutex;
+  return mutex;
+}
+#endif
+
 Object::AggregateIterator::AggregateIterator ()
   : m_object (0),
     m_current (0)
@@ -98,6 +114,7 @@ Object::Object ()
 {
   NS_LOG_FUNCTION (this);
   m_aggregates->n = 1;
+  m_aggregates->cache = 0;
   m_aggregates->buffer[0] = this;
 }
 Object::~Object () 
@@ -114,6 +131,9 @@ Object::~Object ()
                    &m_aggregates->buffer[i+1],
                    sizeof (Object *)*(m_aggregates->n - (i+1)));
           m_aggregates->n--;
+          // the cache might point to this object
+          FreeCache (m_aggregates->cache);
+          m_aggregates->cache = 0;
         }
     }
   // finally, if all objects have been removed from the list,
@@ -132,6 +152,7 @@ Object::Object (const Object &o)
     m_getObjectCount (0)
 {
   m_aggregates->n = 1;
+  m_aggregates->cache = 0;
   m_aggregates->buffer[0] = this;
 }
 void
@@ -147,6 +168,27 @@ Object::DoGetObject (TypeId tid) const
   NS_LOG_FUNCTION (this << tid);
   NS_ASSERT (CheckLoose ());
 
+  // first, look for the result of a previous lookup of this TypeId
+  uint16_t uid = tid.GetUid ();
+  Object *found = 0;
+#ifdef NS3_MULTITHREADED
+  struct Cache *cache = __atomic_load_n (&m_aggregates->cache, __ATOMIC_ACQUIRE);
+#else
+  struct Cache *cache = m_aggregates->cache;
+#endif
+  if (LookupCache (cache, uid, &found))
+    {
+      return found;
+    }
+#ifdef NS3_MULTITHREADED
+  CriticalSection cs (GetCacheMutex ());
+  // another thread may have looked it up in the meantime
+  if (LookupCache (m_aggregates->cache, uid, &found))
+    {
+      return found;
+    }
+#endif
+
   uint32_t n = m_aggregates->n;
   TypeId objectTid = Object::GetTypeId ();
   for (uint32_t i = 0; i < n; i++)
@@ -159,21 +201,109 @@ Object::DoGetObject (TypeId tid) const
         }
       if (cur == tid)
         {
-          // This is an attempt to 'cache' the result of this lookup.
-          // the idea is that if we perform a lookup for a TypeId on this object,
-          // we are likely to perform the same lookup later so, we make sure
-          // that the aggregate array is sorted by the number of accesses
-          // to each object.
+          // Keep the aggregate array sorted by the number of accesses
+          // to each object, so that the lookups of other TypeIds find
+          // the most used objects first.
 
           // first, increment the access count
           current->m_getObjectCount++;
           // then, update the sort
           UpdateSortedArray (m_aggregates, i);
-          // finally, return the match
-          return const_cast<Object *> (current);
+          found = current;
+          break;
+        }
+    }
+  // finally, remember the match, or the lack of match
+  AddToCache (uid, found);
+  return found;
+}
+
+void
+Object::AddToCache (uint16_t uid, Object *object) const
+{
+  NS_LOG_FUNCTION (this << uid << object);
+  struct Cache *cache = m_aggregates->cache;
+  if (cache == 0 || 2 * (cache->n + 1) > cache->mask + 1)
+    {
+      // keep the table at most half full, so that the probe
+      // sequences stay short.
+      uint32_t size = (cache == 0) ? 16 : 2 * (cache->mask + 1);
+      struct Cache *bigger = 
+        (struct Cache *)std::calloc (1, sizeof (struct Cache) + (size - 1) * sizeof (struct CacheEntry));
+      bigger->mask = size - 1;
+      bigger->previous = cache;
+      if (cache != 0)
+        {
+          for (uint32_t i = 0; i <= cache->mask; i++)
+            {
+              if (cache->entries[i].uid != 0)
+                {
+                  InsertInCache (bigger, cache->entries[i].uid, cache->entries[i].object);
+                }
+            }
+        }
+      // publish the table once it is filled
+#ifdef NS3_MULTITHREADED
+      __sync_synchronize ();
+#endif
+      m_aggregates->cache = bigger;
+      cache = bigger;
+    }
+  InsertInCache (cache, uid, object);
+}
+
+bool
+Object::LookupCache (const struct Cache *cache, uint16_t uid, Object **object)
+{
+  if (cache == 0)
+    {
+      return false;
+    }
+  for (uint32_t i = uid & cache->mask; ; i = (i + 1) & cache->mask)
+    {
+#ifdef NS3_MULTITHREADED
+      uint16_t entry = __atomic_load_n (&cache->entries[i].uid, __ATOMIC_ACQUIRE);
+#else
+      uint16_t entry = cache->entries[i].uid;
+#endif
+      if (entry == 0)
+        {
+          return false;
+        }
+      if (entry == uid)
+        {
+          *object = cache->entries[i].object;
+          return true;
         }
     }
-  return 0;
+}
+
+void
+Object::InsertInCache (struct Cache *cache, uint16_t uid, Object *object)
+{
+  uint32_t i = uid & cache->mask;
+  while (cache->entries[i].uid != 0)
+    {
+      i = (i + 1) & cache->mask;
+    }
+  cache->entries[i].object = object;
+  // the lookups which see the uid see the object too
+#ifdef NS3_MULTITHREADED
+  __sync_synchronize ();
+#endif
+  cache->entries[i].uid = uid;
+  cache->n++;
+}
+
+void
+Object::FreeCache (struct Cache *cache)
+{
+  while (cache != 0)
+    {
+      struct Cache *previous = cache->previous;
+      std::free (cache);
+      cache = previous;
+    }
 }
 void
 Object::Initialize (void)
@@ -260,6 +390,7 @@ Object::AggregateObject (Ptr<Object> o)
   struct Aggregates *aggregates = 
     (struct Aggregates *)std::malloc (sizeof(struct Aggregates)+(total-1)*sizeof(Object*));
   aggregates->n = total;
+  aggregates->cache = 0;
 
   // copy our buffer to the new buffer
   std::memcpy (&aggregates->buffer[0], 
@@ -303,6 +434,8 @@ Object::AggregateObject (Ptr<Object> o)
     }
 
   // Now that we are done with them, we can free our old aggregate buffers
+  FreeCache (a->cache);
+  FreeCache (b->cache);
   std::free (a);
   std::free (b);
 }
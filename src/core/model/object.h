@@ -231,6 +231,28 @@ private:
   friend class AggregateIterator;
   friend struct ObjectDeleter;
 
+  /**
+   * An entry of the cache of DoGetObject: the uid of a TypeId and
+   * the aggregate which matches it, or zero if none matches.
+   */
+  struct CacheEntry {
+    uint16_t uid;
+    Object *object;
+  };
+  /**
+   * The cache of DoGetObject, a hash table with open addressing
+   * of 'mask' + 1 entries, of which 'n' are used. It is allocated
+   * with the same trick as the Aggregates below. When it grows, the
+   * 'previous' smaller tables are kept until the cache is discarded,
+   * because the lookups of other threads may still be reading them.
+   */
+  struct Cache {
+    uint32_t n;
+    uint32_t mask;
+    struct Cache *previous;
+    struct CacheEntry entries[1];
+  };
+
   /**
    * This data structure uses a classic C-style trick to 
    * hold an array of variable size without performing
@@ -240,9 +262,16 @@ private:
    * chunk of memory than the struct to allow space for a larger
    * variable sized buffer whose size is indicated by the element
    * 'n'
+   *
+   * The 'cache' of the lookups of DoGetObject is shared by the
+   * aggregated objects too, and discarded when the set of aggregates
+   * changes. With --enable-multithreading, the lookups which miss the
+   * cache, and update it and the sort of the aggregates, are serialized
+   * by a mutex; the lookups which hit it only read it, without a lock.
    */
   struct Aggregates {
     uint32_t n;
+    struct Cache *cache;
     Object *buffer[1];
   };
 
@@ -253,6 +282,36 @@ private:
    * \return the matching Object, if it is found
    */
   Ptr<Object> DoGetObject (TypeId tid) const;
+  /**
+   * Record the result of a lookup of DoGetObject in the cache.
+   *
+   * \param uid the uid of the TypeId looked up
+   * \param object the matching Object, or zero
+   */
+  void AddToCache (uint16_t uid, Object *object) const;
+  /**
+   * Look a TypeId up in a cache of DoGetObject.
+   *
+   * \param cache the cache, or zero
+   * \param uid the uid of the TypeId looked up
+   * \param object the matching Object, or zero if none matches
+   * \return true if the TypeId was found in the cache
+   */
+  static bool LookupCache (const struct Cache *cache, uint16_t uid, Object **object);
+  /**
+   * Insert an entry in a cache of DoGetObject which has room for it.
+   *
+   * \param cache the cache
+   * \param uid the uid of the TypeId looked up
+   * \param object the matching Object, or zero
+   */
+  static void InsertInCache (struct Cache *cache, uint16_t uid, Object *object);
+  /**
+   * Free a cache of DoGetObject, with its previous smaller tables.
+   *
+   * \param cache the cache, or zero
+   */
+  static void FreeCache (struct Cache *cache);
   /**
    * \return is reference count non zero
    */
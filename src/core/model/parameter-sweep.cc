@@ -0,0 +1,248 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "parameter-sweep.h"
+#include "simulator.h"
+#include "config.h"
+#include "string.h"
+#include "assert.h"
+#include "fatal-error.h"
+#include "log.h"
+
+NS_LOG_COMPONENT_DEFINE ("ParameterSweep");
+
+namespace ns3 {
+
+ParameterSweep::ParameterSweep ()
+  : m_maxProcesses (0),
+    m_child (false),
+    m_variant (0),
+    m_pipe (-1)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ParameterSweep::~ParameterSweep ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+ParameterSweep::AddVariant (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_variants.push_back (Overrides ());
+  return m_variants.size () - 1;
+}
+
+uint32_t
+ParameterSweep::GetNVariants (void) const
+{
+  return m_variants.size ();
+}
+
+void
+ParameterSweep::Set (uint32_t variant, std::string path, std::string value)
+{
+  NS_LOG_FUNCTION (this << variant << path << value);
+  NS_ASSERT (variant < m_variants.size ());
+  m_variants[variant].push_back (std::make_pair (path, value));
+}
+
+void
+ParameterSweep::SetMaxProcesses (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  m_maxProcesses = n;
+}
+
+void
+ParameterSweep::ForkAt (Time const &time)
+{
+  NS_LOG_FUNCTION (this << time);
+  NS_ASSERT (time >= Simulator::Now ());
+  Simulator::Schedule (time - Simulator::Now (), &ParameterSweep::Fork, this);
+}
+
+bool
+ParameterSweep::IsChild (void) const
+{
+  return m_child;
+}
+
+uint32_t
+ParameterSweep::GetVariant (void) const
+{
+  NS_ASSERT (m_child);
+  return m_variant;
+}
+
+void
+ParameterSweep::Fork (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t n = m_variants.size ();
+  uint32_t batch = m_maxProcesses == 0 ? n : m_maxProcesses;
+  m_results.assign (n, "");
+  m_success.assign (n, false);
+
+  // whatever is buffered would otherwise be output by every child
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (0);
+
+  for (uint32_t start = 0; start < n; start += batch)
+    {
+      uint32_t end = std::min (start + batch, n);
+      std::vector<int> fds;
+      std::vector<pid_t> pids;
+      for (uint32_t i = start; i < end; ++i)
+        {
+          int fd[2];
+          if (pipe (fd) != 0)
+            {
+              NS_FATAL_ERROR ("ParameterSweep::Fork(): pipe() failed: " << std::strerror (errno));
+            }
+          pid_t pid = fork ();
+          if (pid < 0)
+            {
+              NS_FATAL_ERROR ("ParameterSweep::Fork(): fork() failed: " << std::strerror (errno));
+            }
+          if (pid == 0)
+            {
+              // child: keep only our own pipe, apply our overrides,
+              // and carry on with the simulation.
+              close (fd[0]);
+              for (std::vector<int>::const_iterator j = fds.begin (); j != fds.end (); ++j)
+                {
+                  close (*j);
+                }
+              m_child = true;
+              m_variant = i;
+              m_pipe = fd[1];
+              for (Overrides::const_iterator j = m_variants[i].begin (); j != m_variants[i].end (); ++j)
+                {
+                  Config::Set (j->first, StringValue (j->second));
+                }
+              return;
+            }
+          NS_LOG_LOGIC ("variant " << i << " runs in process " << pid);
+          close (fd[1]);
+          fds.push_back (fd[0]);
+          pids.push_back (pid);
+        }
+      // a child blocked on a full pipe waits until we get to it
+      for (uint32_t k = 0; k < fds.size (); ++k)
+        {
+          Collect (fds[k], pids[k], start + k);
+        }
+    }
+  Simulator::Stop ();
+}
+
+void
+ParameterSweep::Collect (int fd, int pid, uint32_t variant)
+{
+  NS_LOG_FUNCTION (this << fd << pid << variant);
+  char buffer[4096];
+  while (true)
+    {
+      ssize_t len = read (fd, buffer, sizeof (buffer));
+      if (len > 0)
+        {
+          m_results[variant].append (buffer, len);
+        }
+      else if (len == 0 || errno != EINTR)
+        {
+          break;
+        }
+    }
+  close (fd);
+  int status;
+  while (waitpid (pid, &status, 0) < 0)
+    {
+      if (errno != EINTR)
+        {
+          NS_FATAL_ERROR ("ParameterSweep::Collect(): waitpid() failed: " << std::strerror (errno));
+        }
+    }
+  m_success[variant] = WIFEXITED (status) && WEXITSTATUS (status) == 0;
+  if (!m_success[variant])
+    {
+      NS_LOG_WARN ("variant " << variant << " failed");
+    }
+}
+
+void
+ParameterSweep::Report (std::string result)
+{
+  NS_LOG_FUNCTION (this << result);
+  if (!m_child)
+    {
+      return;
+    }
+  const char *data = result.data ();
+  std::string::size_type left = result.size ();
+  while (left > 0)
+    {
+      ssize_t len = write (m_pipe, data, left);
+      if (len < 0 && errno == EINTR)
+        {
+          continue;
+        }
+      if (len < 0)
+        {
+          NS_FATAL_ERROR ("ParameterSweep::Report(): write() failed: " << std::strerror (errno));
+        }
+      data += len;
+      left -= len;
+    }
+  close (m_pipe);
+  Simulator::Destroy ();
+  // _exit does not close the binary log file of this process
+  LogSetBinaryFile ("");
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (0);
+  // do not run the exit handlers and the static destructors of the
+  // parent process, which still owns them.
+  _exit (0);
+}
+
+std::string
+ParameterSweep::GetResult (uint32_t variant) const
+{
+  NS_ASSERT (variant < m_results.size ());
+  return m_results[variant];
+}
+
+bool
+ParameterSweep::IsSuccess (uint32_t variant) const
+{
+  NS_ASSERT (variant < m_success.size ());
+  return m_success[variant];
+}
+
+} // namespace ns3
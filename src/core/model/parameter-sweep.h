@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PARAMETER_SWEEP_H
+#define PARAMETER_SWEEP_H
+
+#include "nstime.h"
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Run several variants of a simulation from a shared warm-up
+ *
+ * Many experiments share an identical warm-up phase (building the
+ * topology, waiting for the routing protocols to converge, filling the
+ * caches, ...) and then vary a few parameters. Instead of running the
+ * warm-up once per variant, a ParameterSweep forks the process at the
+ * end of the warm-up, once per variant: each child process applies the
+ * Config::Set overrides of its variant and carries on with the
+ * simulation, while the memory of the warm-up is shared between the
+ * processes, copy-on-write.
+ *
+ * \code
+ *   ParameterSweep sweep;
+ *   for (uint32_t i = 0; i < rates.size (); ++i)
+ *     {
+ *       uint32_t variant = sweep.AddVariant ();
+ *       sweep.Set (variant, "/NodeList/0/ApplicationList/0/$ns3::OnOffApplication/DataRate", rates[i]);
+ *     }
+ *   sweep.ForkAt (Seconds (30));
+ *   Simulator::Stop (Seconds (60));
+ *   Simulator::Run ();
+ *   if (sweep.IsChild ())
+ *     {
+ *       // does not return
+ *       sweep.Report (GetResultOfThisVariant ());
+ *     }
+ *   for (uint32_t i = 0; i < sweep.GetNVariants (); ++i)
+ *     {
+ *       std::cout << rates[i] << " " << sweep.GetResult (i) << std::endl;
+ *     }
+ *   Simulator::Destroy ();
+ * \endcode
+ *
+ * The parent process waits for its children at the time of the fork,
+ * collects the result they report, and then stops its own simulation,
+ * so that Simulator::Run returns in the parent once all the variants
+ * are done. The children share the terminal of the parent: their outputs
+ * are interleaved, and they should write to files named after their
+ * variant. The binary log file, if any, is continued by each child in a
+ * file of its own, see ns3::LogSetBinaryFile. Threads do not survive a fork, so this cannot be used with
+ * the realtime simulator or with emulated devices. Only available on
+ * POSIX systems.
+ */
+class ParameterSweep
+{
+public:
+  ParameterSweep ();
+  ~ParameterSweep ();
+
+  /**
+   * \returns the index of the new variant
+   */
+  uint32_t AddVariant (void);
+  /**
+   * \returns the number of variants
+   */
+  uint32_t GetNVariants (void) const;
+  /**
+   * \param variant the index of a variant
+   * \param path the path of the attributes to set in the variant
+   * \param value the value, as a string, of these attributes
+   *
+   * The variant calls Config::Set (path, StringValue (value)) after the fork.
+   */
+  void Set (uint32_t variant, std::string path, std::string value);
+  /**
+   * \param n the maximum number of child processes run at the same time,
+   *        0 (the default) for no limit.
+   */
+  void SetMaxProcesses (uint32_t n);
+  /**
+   * \param time the absolute simulation time of the fork
+   *
+   * Schedule the fork. The ParameterSweep must stay alive until
+   * Simulator::Run returns.
+   */
+  void ForkAt (Time const &time);
+
+  /**
+   * \returns true in the child processes, once the fork happened
+   */
+  bool IsChild (void) const;
+  /**
+   * \returns the index of the variant run by this child process
+   */
+  uint32_t GetVariant (void) const;
+  /**
+   * \param result the result of the variant, sent to the parent process
+   *
+   * In a child process, send the result to the parent, call
+   * Simulator::Destroy, and terminate the process. Does nothing in the
+   * parent process.
+   */
+  void Report (std::string result);
+
+  /**
+   * \param variant the index of a variant
+   * \returns the result reported by the variant, in the parent process
+   */
+  std::string GetResult (uint32_t variant) const;
+  /**
+   * \param variant the index of a variant
+   * \returns true if the process of the variant terminated normally
+   */
+  bool IsSuccess (uint32_t variant) const;
+
+private:
+  void Fork (void);
+  void Collect (int fd, int pid, uint32_t variant);
+
+  typedef std::vector<std::pair<std::string, std::string> > Overrides;
+
+  std::vector<Overrides> m_variants;
+  uint32_t m_maxProcesses;
+  // variant of this process, and pipe to the parent, in a child
+  bool m_child;
+  uint32_t m_variant;
+  int m_pipe;
+  // in the parent
+  std::vector<std::string> m_results;
+  std::vector<bool> m_success;
+};
+
+} // namespace ns3
+
+#endif /* PARAMETER_SWEEP_H */
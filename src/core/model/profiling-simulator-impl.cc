@@ -0,0 +1,528 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "profiling-simulator-impl.h"
+#include "system-wall-clock-ms.h"
+#include "uinteger.h"
+#include "string.h"
+#include "assert.h"
+#include "log.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <typeinfo>
+
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+#if !defined (__i386__) && !defined (__x86_64__)
+#include <sys/time.h>
+#endif
+
+NS_LOG_COMPONENT_DEFINE ("ProfilingSimulatorImpl");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (ProfilingSimulatorImpl);
+
+namespace {
+
+/**
+ * \returns the time stamp counter of the processor, or the time of day
+ * in microseconds when there is none.
+ */
+inline uint64_t
+GetTicks (void)
+{
+#if defined (__i386__) || defined (__x86_64__)
+  uint32_t lo, hi;
+  __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+  return ((uint64_t)hi << 32) | lo;
+#else
+  struct timeval tv;
+  gettimeofday (&tv, 0);
+  return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
+/**
+ * \returns a readable name for the event type whose mangled name is \p mangled
+ *
+ * The events created by MakeEvent are instances of classes local to the
+ * MakeEvent function templates, so the template arguments of MakeEvent,
+ * that is the type of the function, or of the member function and of
+ * its object, followed by the types of the bound arguments, identify
+ * the event site.
+ */
+std::string
+GetSiteName (const char *mangled)
+{
+  std::string name = mangled;
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (mangled, NULL, NULL, &status);
+  if (status == 0)
+    {
+      name = demangled;
+    }
+  std::free (demangled);
+#endif
+  std::string prefix = "ns3::MakeEvent";
+  std::string::size_type start = name.find (prefix);
+  if (start == std::string::npos)
+    {
+      return name;
+    }
+  start += prefix.size ();
+  // keep what is between the '<' or the '(' which follows and the
+  // matching '>' or ')'
+  int depth = 0;
+  for (std::string::size_type i = start; i < name.size (); ++i)
+    {
+      if (name[i] == '<' || name[i] == '(')
+        {
+          depth++;
+        }
+      else if (name[i] == '>' || name[i] == ')')
+        {
+          depth--;
+          if (depth == 0)
+            {
+              std::string::size_type end = name.find_last_not_of (' ', i - 1);
+              return name.substr (start + 1, end - start);
+            }
+        }
+    }
+  return name;
+}
+
+} // anonymous namespace
+
+/**
+ * The event scheduled in the wrapped simulator implementation in place
+ * of each event, which profiles it when it is invoked.
+ */
+class ProfilingSimulatorImpl::ProfiledEvent : public EventImpl
+{
+public:
+  ProfiledEvent (ProfilingSimulatorImpl *profiler, EventImpl *event)
+    : m_profiler (profiler),
+      m_event (event)
+  {
+  }
+  virtual ~ProfiledEvent ()
+  {
+    m_event->Unref ();
+  }
+private:
+  virtual void Notify (void)
+  {
+    m_profiler->Invoke (m_event);
+  }
+  ProfilingSimulatorImpl *m_profiler;
+  EventImpl *m_event;
+};
+
+ProfilingSimulatorImpl::Stats::Stats ()
+  : events (0),
+    sampled (0),
+    ticks (0)
+{
+}
+
+TypeId
+ProfilingSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ProfilingSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .AddConstructor<ProfilingSimulatorImpl> ()
+    .AddAttribute ("SimulatorImplFactory",
+                   "Factory for the simulator implementation which runs the profiled events.",
+                   ObjectFactoryValue (ObjectFactory ("ns3::DefaultSimulatorImpl")),
+                   MakeObjectFactoryAccessor (&ProfilingSimulatorImpl::m_simulatorImplFactory),
+                   MakeObjectFactoryChecker ())
+    .AddAttribute ("SamplingInterval",
+                   "Mean number of events between two timed events.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&ProfilingSimulatorImpl::m_samplingInterval),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxRows",
+                   "Maximum number of sites and of nodes printed, 0 for all of them.",
+                   UintegerValue (20),
+                   MakeUintegerAccessor (&ProfilingSimulatorImpl::m_maxRows),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("OutputFile",
+                   "File where the profile is printed at the end of each run, "
+                   "the standard output if empty.",
+                   StringValue (""),
+                   MakeStringAccessor (&ProfilingSimulatorImpl::m_outputFile),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+ProfilingSimulatorImpl::ProfilingSimulatorImpl ()
+  : m_countdown (1),
+    m_rng (1),
+    m_lastName (0),
+    m_lastSite (0),
+    m_runTicks (0),
+    m_runMs (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ProfilingSimulatorImpl::~ProfilingSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ProfilingSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_simulator)
+    {
+      m_simulator->Dispose ();
+      m_simulator = 0;
+    }
+  SimulatorImpl::DoDispose ();
+}
+
+void
+ProfilingSimulatorImpl::NotifyConstructionCompleted (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_simulator = m_simulatorImplFactory.Create<SimulatorImpl> ();
+  SimulatorImpl::NotifyConstructionCompleted ();
+}
+
+EventImpl *
+ProfilingSimulatorImpl::Wrap (EventImpl *event)
+{
+  return new ProfiledEvent (this, event);
+}
+
+void
+ProfilingSimulatorImpl::Invoke (EventImpl *event)
+{
+  Stats *site = GetSite (event);
+  Stats *node = GetNode (m_simulator->GetContext ());
+  site->events++;
+  node->events++;
+  if (--m_countdown != 0)
+    {
+      event->Invoke ();
+      return;
+    }
+  // draw the next interval uniformly in [1, 2 * SamplingInterval - 1],
+  // so that periodic sequences of events do not bias the samples
+  m_rng = m_rng * 1664525 + 1013904223;
+  m_countdown = 1 + (m_rng >> 8) % (2 * m_samplingInterval - 1);
+  uint64_t start = GetTicks ();
+  event->Invoke ();
+  uint64_t ticks = GetTicks () - start;
+  site->sampled++;
+  site->ticks += ticks;
+  node->sampled++;
+  node->ticks += ticks;
+}
+
+ProfilingSimulatorImpl::Stats *
+ProfilingSimulatorImpl::GetSite (EventImpl *event)
+{
+  // the names of the type_info objects are unique in a given library,
+  // but a type may have several type_info objects across libraries.
+  const char *mangled = typeid (*event).name ();
+  if (mangled == m_lastName)
+    {
+      return m_lastSite;
+    }
+  m_lastName = mangled;
+  std::map<const char *, Stats *>::const_iterator i = m_siteCache.find (mangled);
+  if (i != m_siteCache.end ())
+    {
+      m_lastSite = i->second;
+      return m_lastSite;
+    }
+  m_lastSite = &m_sites[GetSiteName (mangled)];
+  m_siteCache[mangled] = m_lastSite;
+  return m_lastSite;
+}
+
+ProfilingSimulatorImpl::Stats *
+ProfilingSimulatorImpl::GetNode (uint32_t context)
+{
+  if (context == 0xffffffff)
+    {
+      return &m_noContext;
+    }
+  if (context >= m_nodes.size ())
+    {
+      m_nodes.resize (context + 1);
+    }
+  return &m_nodes[context];
+}
+
+bool
+ProfilingSimulatorImpl::Row::operator < (const Row &o) const
+{
+  return ticks > o.ticks;
+}
+
+void
+ProfilingSimulatorImpl::AddRow (Rows &rows, std::string name, const Stats *stats) const
+{
+  Row row;
+  row.name = name;
+  row.stats = stats;
+  row.ticks = 0;
+  if (stats->sampled != 0)
+    {
+      row.ticks = (double)stats->ticks * stats->events / stats->sampled;
+    }
+  rows.push_back (row);
+}
+
+void
+ProfilingSimulatorImpl::Print (std::ostream &os) const
+{
+  Rows sites;
+  for (std::map<std::string, Stats>::const_iterator i = m_sites.begin (); i != m_sites.end (); ++i)
+    {
+      AddRow (sites, i->first, &i->second);
+    }
+  Rows nodes;
+  for (uint32_t i = 0; i < m_nodes.size (); ++i)
+    {
+      if (m_nodes[i].events != 0)
+        {
+          std::ostringstream oss;
+          oss << "node " << i;
+          AddRow (nodes, oss.str (), &m_nodes[i]);
+        }
+    }
+  if (m_noContext.events != 0)
+    {
+      AddRow (nodes, "no node", &m_noContext);
+    }
+
+  uint64_t events = 0;
+  double ticks = 0;
+  for (Rows::const_iterator i = sites.begin (); i != sites.end (); ++i)
+    {
+      events += i->stats->events;
+      ticks += i->ticks;
+    }
+  std::ios::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+  os << "Profile of " << events << " events run in " << m_runMs << " ms";
+  if (m_runTicks != 0)
+    {
+      os << ", " << std::fixed << std::setprecision (1) << 100 * ticks / m_runTicks
+         << "% of the time in the events";
+    }
+  os << std::endl;
+  PrintRows (os, "site", sites);
+  PrintRows (os, "node", nodes);
+  os.flags (flags);
+  os.precision (precision);
+}
+
+void
+ProfilingSimulatorImpl::PrintRows (std::ostream &os, std::string title, Rows rows) const
+{
+  double ticks = 0;
+  uint64_t events = 0;
+  for (Rows::const_iterator i = rows.begin (); i != rows.end (); ++i)
+    {
+      ticks += i->ticks;
+      events += i->stats->events;
+    }
+  std::stable_sort (rows.begin (), rows.end ());
+  // ticks per ms, if the run lasted long enough to tell
+  double ticksPerMs = m_runMs > 0 ? (double)m_runTicks / m_runMs : 0;
+
+  os << std::right << std::fixed << std::setprecision (1) << std::endl
+     << std::setw (8) << "% time" << std::setw (12) << "ms"
+     << std::setw (14) << "events" << std::setw (10) << "% events"
+     << std::setw (12) << "ns/event" << "  " << title << std::endl;
+  for (uint32_t i = 0; i < rows.size (); ++i)
+    {
+      if (m_maxRows != 0 && i == m_maxRows)
+        {
+          os << std::setw (56) << "" << "  (" << rows.size () - i << " more)" << std::endl;
+          break;
+        }
+      const Row &row = rows[i];
+      os << std::setw (8) << (ticks > 0 ? 100 * row.ticks / ticks : 0.0);
+      if (ticksPerMs > 0)
+        {
+          os << std::setw (12) << row.ticks / ticksPerMs;
+        }
+      else
+        {
+          os << std::setw (12) << "-";
+        }
+      os << std::setw (14) << row.stats->events
+         << std::setw (10) << 100.0 * row.stats->events / events;
+      if (ticksPerMs > 0)
+        {
+          os << std::setw (12) << row.ticks / ticksPerMs * 1000000 / row.stats->events;
+        }
+      else
+        {
+          os << std::setw (12) << "-";
+        }
+      os << "  " << row.name << std::endl;
+    }
+}
+
+void
+ProfilingSimulatorImpl::Destroy ()
+{
+  m_simulator->Destroy ();
+}
+
+void
+ProfilingSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  m_simulator->SetScheduler (schedulerFactory);
+}
+
+uint32_t
+ProfilingSimulatorImpl::GetSystemId (void) const
+{
+  return m_simulator->GetSystemId ();
+}
+
+bool
+ProfilingSimulatorImpl::IsFinished (void) const
+{
+  return m_simulator->IsFinished ();
+}
+
+void
+ProfilingSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  SystemWallClockMs clock;
+  clock.Start ();
+  uint64_t start = GetTicks ();
+  m_simulator->Run ();
+  m_runTicks += GetTicks () - start;
+  m_runMs += clock.End ();
+
+  if (m_outputFile.empty ())
+    {
+      Print (std::cout);
+    }
+  else
+    {
+      std::ofstream os (m_outputFile.c_str ());
+      if (!os.is_open ())
+        {
+          NS_FATAL_ERROR ("Cannot open profile output file " << m_outputFile);
+        }
+      Print (os);
+    }
+}
+
+void
+ProfilingSimulatorImpl::Stop (void)
+{
+  m_simulator->Stop ();
+}
+
+void
+ProfilingSimulatorImpl::Stop (Time const &time)
+{
+  m_simulator->Stop (time);
+}
+
+EventId
+ProfilingSimulatorImpl::Schedule (Time const &time, EventImpl *event)
+{
+  return m_simulator->Schedule (time, Wrap (event));
+}
+
+void
+ProfilingSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event)
+{
+  m_simulator->ScheduleWithContext (context, time, Wrap (event));
+}
+
+EventId
+ProfilingSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return m_simulator->ScheduleNow (Wrap (event));
+}
+
+EventId
+ProfilingSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  // destroy events do not run during Simulator::Run
+  return m_simulator->ScheduleDestroy (event);
+}
+
+Time
+ProfilingSimulatorImpl::Now (void) const
+{
+  return m_simulator->Now ();
+}
+
+Time
+ProfilingSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  return m_simulator->GetDelayLeft (id);
+}
+
+void
+ProfilingSimulatorImpl::Remove (const EventId &id)
+{
+  m_simulator->Remove (id);
+}
+
+void
+ProfilingSimulatorImpl::Cancel (const EventId &id)
+{
+  m_simulator->Cancel (id);
+}
+
+bool
+ProfilingSimulatorImpl::IsExpired (const EventId &ev) const
+{
+  return m_simulator->IsExpired (ev);
+}
+
+Time
+ProfilingSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return m_simulator->GetMaximumSimulationTime ();
+}
+
+uint32_t
+ProfilingSimulatorImpl::GetContext (void) const
+{
+  return m_simulator->GetContext ();
+}
+
+} // namespace ns3
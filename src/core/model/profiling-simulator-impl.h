@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PROFILING_SIMULATOR_IMPL_H
+#define PROFILING_SIMULATOR_IMPL_H
+
+#include "simulator-impl.h"
+#include "event-impl.h"
+#include "object-factory.h"
+#include "ptr.h"
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief A simulator implementation which profiles the events run by
+ * another one
+ *
+ * To use this class, run any ns-3 simulation with the command-line
+ * argument --SimulatorImplementationType=ns3::ProfilingSimulatorImpl.
+ * The events are run by the simulator implementation created by the
+ * SimulatorImplFactory attribute (a DefaultSimulatorImpl by default),
+ * and each time Simulator::Run returns, two tables are printed:
+ *
+ *  - a flat profile, which gives the number of events and the time spent
+ *    in them for each event site, that is for each kind of event
+ *    created by MakeEvent: the type of the function, or of the member
+ *    function and of the object it is called on;
+ *  - a heat table, which gives the same numbers for each node (that is
+ *    for each event context).
+ *
+ * The time is measured with the time stamp counter of the processor
+ * when there is one, and converted to seconds with the wall-clock
+ * duration of the run. Only one event out of SamplingInterval, on
+ * average and at random, is timed, and the time of the other ones is
+ * extrapolated; all the events are counted. The time spent in the scheduler itself is the difference
+ * between the duration of the run and the time spent in the events.
+ *
+ * The events are profiled by the thread which calls Simulator::Run, so
+ * this class cannot wrap simulator implementations which run events in
+ * several threads.
+ */
+class ProfilingSimulatorImpl : public SimulatorImpl
+{
+public:
+  static TypeId GetTypeId (void);
+
+  ProfilingSimulatorImpl ();
+  ~ProfilingSimulatorImpl ();
+
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &time);
+  virtual EventId Schedule (Time const &time, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &ev);
+  virtual void Cancel (const EventId &ev);
+  virtual bool IsExpired (const EventId &ev) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * \param os the stream to print the profile to
+   *
+   * Print the profile of all the events run so far.
+   */
+  void Print (std::ostream &os) const;
+
+protected:
+  virtual void DoDispose (void);
+  virtual void NotifyConstructionCompleted (void);
+
+private:
+  class ProfiledEvent;
+
+  struct Stats
+  {
+    Stats ();
+    // number of events run
+    uint64_t events;
+    // number of events timed, and their total duration
+    uint64_t sampled;
+    uint64_t ticks;
+  };
+  struct Row
+  {
+    std::string name;
+    const Stats *stats;
+    // extrapolated duration of all the events
+    double ticks;
+    bool operator < (const Row &o) const;
+  };
+  typedef std::vector<Row> Rows;
+
+  EventImpl * Wrap (EventImpl *event);
+  void Invoke (EventImpl *event);
+  Stats * GetSite (EventImpl *event);
+  Stats * GetNode (uint32_t context);
+  void AddRow (Rows &rows, std::string name, const Stats *stats) const;
+  void PrintRows (std::ostream &os, std::string title, Rows rows) const;
+
+  Ptr<SimulatorImpl> m_simulator;
+  ObjectFactory m_simulatorImplFactory;
+  uint32_t m_samplingInterval;
+  uint32_t m_maxRows;
+  std::string m_outputFile;
+
+  // number of events before the next timed one
+  uint32_t m_countdown;
+  // linear congruential generator for the sampling intervals
+  uint32_t m_rng;
+  // sites by type name, and by address of the type name as a shortcut
+  std::map<std::string, Stats> m_sites;
+  std::map<const char *, Stats *> m_siteCache;
+  // site of the last event
+  const char *m_lastName;
+  Stats *m_lastSite;
+  // nodes by context, and events without a node context
+  std::vector<Stats> m_nodes;
+  Stats m_noContext;
+  // duration of the runs, in ticks and in ms
+  uint64_t m_runTicks;
+  int64_t m_runMs;
+};
+
+} // namespace ns3
+
+#endif /* PROFILING_SIMULATOR_IMPL_H */
@@ -28,6 +28,7 @@
 #include "boolean.h"
 #include "double.h"
 #include "integer.h"
+#include "uinteger.h"
 #include "string.h"
 #include "pointer.h"
 #include "log.h"
@@ -60,12 +61,20 @@ RandomVariableStream::GetTypeId (void)
 		  MakeBooleanAccessor(&RandomVariableStream::SetAntithetic,
 				      &RandomVariableStream::IsAntithetic),
 		  MakeBooleanChecker())
+    .AddAttribute("BufferSize", "The number of uniform random numbers drawn at a time from the RNG stream, "
+                  "ahead of their use: 0 to draw them one at a time. This does not change the values "
+                  "of the random variable.",
+                  UintegerValue (0),
+                  MakeUintegerAccessor (&RandomVariableStream::SetBufferSize,
+                                        &RandomVariableStream::GetBufferSize),
+                  MakeUintegerChecker<uint32_t> ())
     ;
   return tid;
 }
 
 RandomVariableStream::RandomVariableStream()
-  : m_rng (0)
+  : m_rng (0),
+    m_next (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -115,6 +124,8 @@ RandomVariableStream::SetStream (int64_t stream)
                              RngSeedManager::GetRun ());
     }
   m_stream = stream;
+  // the numbers drawn ahead came from the previous stream
+  m_next = m_buffer.size ();
 }
 int64_t
 RandomVariableStream::GetStream(void) const
@@ -130,6 +141,54 @@ RandomVariableStream::Peek(void) const
   return m_rng;
 }
 
+void
+RandomVariableStream::SetBufferSize (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  m_buffer.resize (size);
+  m_next = size;
+}
+uint32_t
+RandomVariableStream::GetBufferSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_buffer.size ();
+}
+
+void
+RandomVariableStream::GetValues (double *values, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      values[i] = GetValue ();
+    }
+}
+
+void
+RandomVariableStream::RandU01 (double *values, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  // first the numbers drawn ahead, then the next ones of the stream
+  uint32_t i = 0;
+  while (i < n && m_next < m_buffer.size ())
+    {
+      values[i++] = m_buffer[m_next++];
+    }
+  if (i < n)
+    {
+      m_rng->RandU01 (values + i, n - i);
+    }
+}
+
+double
+RandomVariableStream::RefillBuffer (void)
+{
+  m_rng->RandU01 (&m_buffer[0], m_buffer.size ());
+  m_next = 1;
+  return m_buffer[0];
+}
+
 NS_OBJECT_ENSURE_REGISTERED(UniformRandomVariable);
 
 TypeId 
@@ -172,7 +231,7 @@ double
 UniformRandomVariable::GetValue (double min, double max)
 {
   NS_LOG_FUNCTION (this << min << max);
-  double v = min + Peek ()->RandU01 () * (max - min);
+  double v = min + RandU01 () * (max - min);
   if (IsAntithetic ())
     {
       v = min + (max - v);
@@ -193,6 +252,24 @@ UniformRandomVariable::GetValue (void)
   NS_LOG_FUNCTION (this);
   return GetValue (m_min, m_max);
 }
+void
+UniformRandomVariable::GetValues (double *values, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  RandU01 (values, n);
+  bool antithetic = IsAntithetic ();
+  double min = m_min;
+  double max = m_max;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double v = min + values[i] * (max - min);
+      if (antithetic)
+        {
+          v = min + (max - v);
+        }
+      values[i] = v;
+    }
+}
 uint32_t 
 UniformRandomVariable::GetInteger (void)
 {
@@ -398,7 +475,7 @@ ExponentialRandomVariable::GetValue (double mean, double bound)
   while (1)
     {
       // Get a uniform random variable in [0,1].
-      double v = Peek ()->RandU01 ();
+      double v = RandU01 ();
       if (IsAntithetic ())
         {
           v = (1 - v);
@@ -427,6 +504,36 @@ ExponentialRandomVariable::GetValue (void)
   NS_LOG_FUNCTION (this);
   return GetValue (m_mean, m_bound);
 }
+void
+ExponentialRandomVariable::GetValues (double *values, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  bool antithetic = IsAntithetic ();
+  double mean = m_mean;
+  double bound = m_bound;
+  uint32_t filled = 0;
+  while (filled < n)
+    {
+      // Draw the uniform random variables of the missing values, and
+      // replace them in place by the acceptable exponential ones.
+      RandU01 (values + filled, n - filled);
+      uint32_t j = filled;
+      for (uint32_t i = filled; i < n; i++)
+        {
+          double v = values[i];
+          if (antithetic)
+            {
+              v = (1 - v);
+            }
+          double r = -mean*std::log (v);
+          if (bound == 0 || r <= bound)
+            {
+              values[j++] = r;
+            }
+        }
+      filled = j;
+    }
+}
 uint32_t 
 ExponentialRandomVariable::GetInteger (void)
 {
@@ -493,7 +600,7 @@ ParetoRandomVariable::GetValue (double mean, double shape, double bound)
   while (1)
     {
       // Get a uniform random variable in [0,1].
-      double v = Peek ()->RandU01 ();
+      double v = RandU01 ();
       if (IsAntithetic ())
         {
           v = (1 - v);
@@ -522,6 +629,37 @@ ParetoRandomVariable::GetValue (void)
   NS_LOG_FUNCTION (this);
   return GetValue (m_mean, m_shape, m_bound);
 }
+void
+ParetoRandomVariable::GetValues (double *values, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  bool antithetic = IsAntithetic ();
+  double shape = m_shape;
+  double bound = m_bound;
+  double scale = m_mean * (shape - 1.0) / shape;
+  uint32_t filled = 0;
+  while (filled < n)
+    {
+      // Draw the uniform random variables of the missing values, and
+      // replace them in place by the acceptable Pareto ones.
+      RandU01 (values + filled, n - filled);
+      uint32_t j = filled;
+      for (uint32_t i = filled; i < n; i++)
+        {
+          double v = values[i];
+          if (antithetic)
+            {
+              v = (1 - v);
+            }
+          double r = (scale * ( 1.0 / std::pow (v, 1.0 / shape)));
+          if (bound == 0 || r <= bound)
+            {
+              values[j++] = r;
+            }
+        }
+      filled = j;
+    }
+}
 uint32_t 
 ParetoRandomVariable::GetInteger (void)
 {
@@ -586,7 +724,7 @@ WeibullRandomVariable::GetValue (double scale, double shape, double bound)
   while (1)
     {
       // Get a uniform random variable in [0,1].
-      double v = Peek ()->RandU01 ();
+      double v = RandU01 ();
       if (IsAntithetic ())
         {
           v = (1 - v);
@@ -688,8 +826,8 @@ NormalRandomVariable::GetValue (double mean, double variance, double bound)
     { // See Simulation Modeling and Analysis p. 466 (Averill Law)
       // for algorithm; basically a Box-Muller transform:
       // http://en.wikipedia.org/wiki/Box-Muller_transform
-      double u1 = Peek ()->RandU01 ();
-      double u2 = Peek ()->RandU01 ();
+      double u1 = RandU01 ();
+      double u2 = RandU01 ();
       if (IsAntithetic ())
         {
           u1 = (1 - u1);
@@ -817,8 +955,8 @@ LogNormalRandomVariable::GetValue (double mu, double sigma)
     {
       /* choose x,y in uniform square (-1,-1) to (+1,+1) */
 
-      double u1 = Peek ()->RandU01 ();
-      double u2 = Peek ()->RandU01 ();
+      double u1 = RandU01 ();
+      double u2 = RandU01 ();
       if (IsAntithetic ())
         {
           u1 = (1 - u1);
@@ -923,7 +1061,7 @@ GammaRandomVariable::GetValue (double alpha, double beta)
   NS_LOG_FUNCTION (this << alpha << beta);
   if (alpha < 1)
     {
-      double u = Peek ()->RandU01 ();
+      double u = RandU01 ();
       if (IsAntithetic ())
         {
           u = (1 - u);
@@ -951,7 +1089,7 @@ GammaRandomVariable::GetValue (double alpha, double beta)
       while (v <= 0);
 
       v = v * v * v;
-      u = Peek ()->RandU01 ();
+      u = RandU01 ();
       if (IsAntithetic ())
         {
           u = (1 - u);
@@ -1002,8 +1140,8 @@ GammaRandomVariable::GetNormalValue (double mean, double variance, double bound)
     { // See Simulation Modeling and Analysis p. 466 (Averill Law)
       // for algorithm; basically a Box-Muller transform:
       // http://en.wikipedia.org/wiki/Box-Muller_transform
-      double u1 = Peek ()->RandU01 ();
-      double u2 = Peek ()->RandU01 ();
+      double u1 = RandU01 ();
+      double u2 = RandU01 ();
       if (IsAntithetic ())
         {
           u1 = (1 - u1);
@@ -1129,7 +1267,7 @@ ErlangRandomVariable::GetExponentialValue (double mean, double bound)
   while (1)
     {
       // Get a uniform random variable in [0,1].
-      double v = Peek ()->RandU01 ();
+      double v = RandU01 ();
       if (IsAntithetic ())
         {
           v = (1 - v);
@@ -1203,7 +1341,7 @@ TriangularRandomVariable::GetValue (double mean, double min, double max)
   double mode = 3.0 * mean - min - max;
 
   // Get a uniform random variable in [0,1].
-  double u = Peek ()->RandU01 ();
+  double u = RandU01 ();
   if (IsAntithetic ())
     {
       u = (1 - u);
@@ -1291,7 +1429,7 @@ ZipfRandomVariable::GetValue (uint32_t n, double alpha)
   m_c = 1.0 / m_c;
 
   // Get a uniform random variable in [0,1].
-  double u = Peek ()->RandU01 ();
+  double u = RandU01 ();
   if (IsAntithetic ())
     {
       u = (1 - u);
@@ -1371,14 +1509,14 @@ ZetaRandomVariable::GetValue (double alpha)
   do
     {
       // Get a uniform random variable in [0,1].
-      u = Peek ()->RandU01 ();
+      u = RandU01 ();
       if (IsAntithetic ())
         {
           u = (1 - u);
         }
 
       // Get a uniform random variable in [0,1].
-      v = Peek ()->RandU01 ();
+      v = RandU01 ();
       if (IsAntithetic ())
         {
           v = (1 - v);
@@ -1539,7 +1677,7 @@ EmpiricalRandomVariable::GetValue (void)
     }
 
   // Get a uniform random variable in [0,1].
-  double r = Peek ()->RandU01 ();
+  double r = RandU01 ();
   if (IsAntithetic ())
     {
       r = (1 - r);
@@ -29,7 +29,9 @@
 #include "type-id.h"
 #include "object.h"
 #include "attribute-helper.h"
+#include "rng-stream.h"
 #include <stdint.h>
+#include <vector>
 
 namespace ns3 {
 
@@ -64,7 +66,6 @@ namespace ns3 {
  */
   
 class RngStream;
-
 /**
  * \ingroup randomvariable
  * \brief The Random Number Generator (RNG) that allows stream numbers to be set deterministically.
@@ -129,12 +130,56 @@ public:
    */
   virtual uint32_t GetInteger (void) = 0;
 
+  /**
+   * \brief Fills an array with random doubles from the underlying distribution
+   * \param values The array to fill.
+   * \param n The number of values to put in the array.
+   *
+   * The values are the same as the values returned by n calls to
+   * GetValue (void), in the same order, but the distributions which
+   * are drawn the most often generate them faster.
+   */
+  virtual void GetValues (double *values, uint32_t n);
+
+  /**
+   * \brief Specifies the number of uniform random numbers drawn at a time.
+   * \param size The number of numbers drawn ahead of their use, 0 to draw
+   * them one at a time.
+   *
+   * Drawing the numbers of the RNG stream in blocks is faster, and
+   * does not change the values of the random variable. Changing the
+   * size discards the numbers drawn ahead.
+   */
+  void SetBufferSize (uint32_t size);
+
+  /**
+   * \brief Returns the number of uniform random numbers drawn at a time.
+   * \return The number of numbers drawn ahead of their use.
+   */
+  uint32_t GetBufferSize (void) const;
+
 protected:
   /**
    * \brief Returns a pointer to the underlying RNG stream.
+   *
+   * The subclasses should draw their numbers with RandU01 instead, which
+   * takes into account the numbers drawn ahead in the buffer.
    */
   RngStream *Peek(void) const;
 
+  /**
+   * \brief Returns the next uniform random number of the RNG stream.
+   * \return A random number in [0,1].
+   */
+  double RandU01 (void);
+
+  /**
+   * \brief Fills an array with the next uniform random numbers of the RNG stream.
+   * \param values The array to fill.
+   * \param n The number of values to put in the array.
+   */
+  void RandU01 (double *values, uint32_t n);
+
 private:
   // you can't copy these objects.
   // Theoretically, it is possible to give them good copy semantics
@@ -150,8 +195,34 @@ private:
 
   /// The stream number for this RNG stream.
   int64_t m_stream;
+
+  /**
+   * \brief Refills the buffer with the next numbers of the RNG stream.
+   * \return The first number of the buffer.
+   */
+  double RefillBuffer (void);
+
+  /// The uniform random numbers drawn ahead, when the buffer is used.
+  std::vector<double> m_buffer;
+
+  /// The index in m_buffer of the next number to use.
+  uint32_t m_next;
 };
 
+inline double
+RandomVariableStream::RandU01 (void)
+{
+  if (m_buffer.empty ())
+    {
+      return m_rng->RandU01 ();
+    }
+  if (m_next < m_buffer.size ())
+    {
+      return m_buffer[m_next++];
+    }
+  return RefillBuffer ();
+}
+
 /**
  * \ingroup randomvariable
  * \brief The uniform distribution Random Number Generator (RNG) that allows stream numbers to be set deterministically.
@@ -268,6 +339,16 @@ public:
    */
   virtual double GetValue (void);
 
+  /**
+   * \brief Fills an array with random doubles from a uniform distribution with the current lower and upper bounds.
+   * \param values The array to fill.
+   * \param n The number of values to put in the array.
+   *
+   * The values are the same as the values returned by n calls to
+   * GetValue (void), only generated faster.
+   */
+  virtual void GetValues (double *values, uint32_t n);
+
   /**
    * \brief Returns a random unsigned integer from a uniform distribution over the interval [min,max] including both ends, where min and max are the current lower and upper bounds.
    * \return A random unsigned integer value.
@@ -571,6 +652,16 @@ public:
    */
   virtual double GetValue (void);
 
+  /**
+   * \brief Fills an array with random doubles from an exponential distribution with the current mean and upper bound.
+   * \param values The array to fill.
+   * \param n The number of values to put in the array.
+   *
+   * The values are the same as the values returned by n calls to
+   * GetValue (void), only generated faster.
+   */
+  virtual void GetValues (double *values, uint32_t n);
+
   /**
    * \brief Returns a random unsigned integer from an exponential distribution with the current mean and upper bound.
    * \return A random unsigned integer value.
@@ -777,6 +868,16 @@ public:
    */
   virtual double GetValue (void);
 
+  /**
+   * \brief Fills an array with random doubles from a Pareto distribution with the current mean, shape, and upper bound.
+   * \param values The array to fill.
+   * \param n The number of values to put in the array.
+   *
+   * The values are the same as the values returned by n calls to
+   * GetValue (void), only generated faster.
+   */
+  virtual void GetValues (double *values, uint32_t n);
+
   /**
    * \brief Returns a random unsigned integer from a Pareto distribution with the current mean, shape, and upper bound.
    * \return A random unsigned integer value.
@@ -62,6 +62,11 @@ RealtimeSimulatorImpl::GetTypeId (void)
                    TimeValue (Seconds (0.1)),
                    MakeTimeAccessor (&RealtimeSimulatorImpl::m_hardLimit),
                    MakeTimeChecker ())
+    .AddAttribute ("SynchronizerType",
+                   "The type of the Synchronizer which keeps the simulation in sync with real time.",
+                   TypeIdValue (WallClockSynchronizer::GetTypeId ()),
+                   MakeTypeIdAccessor (&RealtimeSimulatorImpl::SetSynchronizerType),
+                   MakeTypeIdChecker ())
   ;
   return tid;
 }
@@ -86,9 +91,7 @@ RealtimeSimulatorImpl::RealtimeSimulatorImpl ()
 
   m_main = SystemThread::Self();
 
-  // Be very careful not to do anything that would cause a change or assignment
-  // of the underlying reference counts of m_synchronizer or you will be sorry.
-  m_synchronizer = CreateObject<WallClockSynchronizer> ();
+  // The synchronizer is created by the SynchronizerType attribute.
 }
 
 RealtimeSimulatorImpl::~RealtimeSimulatorImpl ()
@@ -135,6 +138,25 @@ RealtimeSimulatorImpl::Destroy ()
     }
 }
 
+void
+RealtimeSimulatorImpl::SetSynchronizerType (TypeId type)
+{
+  NS_LOG_FUNCTION (this << type);
+  NS_ASSERT_MSG (!m_running, "Cannot change the synchronizer of a running simulation");
+  ObjectFactory factory;
+  factory.SetTypeId (type);
+  // Be very careful not to do anything that would cause a change or assignment
+  // of the underlying reference counts of m_synchronizer or you will be sorry.
+  m_synchronizer = factory.Create<Synchronizer> ();
+}
+
+Ptr<Synchronizer>
+RealtimeSimulatorImpl::GetSynchronizer (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_synchronizer;
+}
+
 void
 RealtimeSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
 {
@@ -86,6 +86,16 @@ public:
   void SetHardLimit (Time limit);
   Time GetHardLimit (void) const;
 
+  /**
+   * Replace the synchronizer, before the simulation starts.
+   * \param type the TypeId of a Synchronizer.
+   */
+  void SetSynchronizerType (TypeId type);
+  /**
+   * \return the synchronizer, for instance to connect to its trace sources.
+   */
+  Ptr<Synchronizer> GetSynchronizer (void) const;
+
 private:
   bool Running (void) const;
   bool Realtime (void) const;
@@ -26,6 +26,10 @@
 #include "fatal-error.h"
 #include "log.h"
 
+#if defined (__clang__) || (defined (__GNUC__) && __GNUC__ >= 9)
+#define NS3_RNG_STREAM_SIMD 1
+#endif
+
 // Note:  Logging in this file is largely avoided due to the
 // number of calls that are made to these functions and the possibility
 // of causing recursions leading to stack overflow
@@ -39,6 +43,8 @@ typedef double Matrix[3][3];
 const double m1   =       4294967087.0;
 const double m2   =       4294944443.0;
 const double norm =       1.0 / (m1 + 1.0);
+const double m1inv =      1.0 / m1;
+const double m2inv =      1.0 / m2;
 const double a12  =       1403580.0;
 const double a13n =       810728.0;
 const double a21  =       527612.0;
@@ -239,6 +245,148 @@ void PowerOfTwoMatrix (int n, Matrix a1p, Matrix a2p)
     }
 }
 
+
+//-------------------------------------------------------------------------
+// Return p MOD m, in [0, m), for an integer p with |p| < 2^53: this is
+// the value the recurrences below compute with the quotient p / m.
+// The quotient is computed with a multiplication by minv = 1 / m
+// instead, which is faster but can be off by one: the corrections
+// absorb the error, so that the result is the same.
+//
+inline double ModM (double p, double m, double minv)
+{
+  int32_t k = static_cast<int32_t> (p * minv);
+  p -= k * m;
+  if (p < 0.0)
+    {
+      p += m;
+      if (p < 0.0)
+        {
+          p += m;
+        }
+    }
+  else if (p >= m)
+    {
+      p -= m;
+    }
+  return p;
+}
+
+//-------------------------------------------------------------------------
+// Advance the state s of a stream by one step and return the
+// uniform random number of this step.
+//
+inline double Next (double s[6])
+{
+  /* Component 1 */
+  double p1 = ModM (a12 * s[1] - a13n * s[0], m1, m1inv);
+  s[0] = s[1]; s[1] = s[2]; s[2] = p1;
+
+  /* Component 2 */
+  double p2 = ModM (a21 * s[5] - a23n * s[3], m2, m2inv);
+  s[3] = s[4]; s[4] = s[5]; s[5] = p2;
+
+  /* Combination */
+  return ((p1 > p2) ? (p1 - p2) * norm : (p1 - p2 + m1) * norm);
+}
+
+#ifdef NS3_RNG_STREAM_SIMD
+// The vector kernel advances LANES copies of the stream at once, with
+// the compiler's vector extensions: lane k starts k * length steps
+// after the state of the stream, and produces the numbers k * length
+// to (k + 1) * length - 1 of the block. The arithmetic is that of Next,
+// exact on integers, so the numbers are the same bit for bit. A vector
+// fills a register: four lanes with AVX, two with SSE2 and the like.
+#ifdef __AVX__
+const uint32_t LANES = 4;
+#else
+const uint32_t LANES = 2;
+#endif
+typedef double Vector __attribute__ ((vector_size (LANES * sizeof (double))));
+typedef int32_t VectorInt __attribute__ ((vector_size (LANES * sizeof (int32_t))));
+typedef int64_t VectorMask __attribute__ ((vector_size (LANES * sizeof (int64_t))));
+
+// Blocks of fewer than LANES << MIN_LOG2_LENGTH numbers do not pay
+// for the jumps ahead of the lanes.
+const uint32_t MIN_LOG2_LENGTH = 6;
+const uint32_t MAX_LOG2_LENGTH = 10;
+
+//-------------------------------------------------------------------------
+// Return 1.0 in the lanes where mask is true and 0.0 in the others.
+//
+inline Vector Select (VectorMask mask)
+{
+  return __builtin_convertvector (-mask, Vector);
+}
+
+//-------------------------------------------------------------------------
+// Return p MOD m in each lane, as ModM does.
+//
+inline Vector ModM (Vector p, double m, double minv)
+{
+  Vector k = __builtin_convertvector (__builtin_convertvector (p * minv, VectorInt), Vector);
+  p -= k * m;
+  p += m * Select (p < 0.0);
+  p += m * Select (p < 0.0);
+  p -= m * Select (p >= m);
+  return p;
+}
+
+//-------------------------------------------------------------------------
+// Fill values with the next LANES << log2Length numbers of the stream
+// with the state s, and advance s past them.
+//
+void NextBlock (double s[6], double *values, uint32_t log2Length)
+{
+  uint32_t length = 1U << log2Length;
+  double start[LANES][6];
+  Matrix a1p, a2p;
+
+  PowerOfTwoMatrix (log2Length, a1p, a2p);
+  for (int j = 0; j < 6; ++j)
+    {
+      start[0][j] = s[j];
+    }
+  for (uint32_t k = 1; k < LANES; ++k)
+    {
+      MatVecModM (a1p, start[k - 1], start[k], m1);
+      MatVecModM (a2p, &start[k - 1][3], &start[k][3], m2);
+    }
+
+  Vector v[6];
+  for (int j = 0; j < 6; ++j)
+    {
+      for (uint32_t k = 0; k < LANES; ++k)
+        {
+          v[j][k] = start[k][j];
+        }
+    }
+  for (uint32_t i = 0; i < length; ++i)
+    {
+      /* Component 1 */
+      Vector p1 = ModM (a12 * v[1] - a13n * v[0], m1, m1inv);
+      v[0] = v[1]; v[1] = v[2]; v[2] = p1;
+
+      /* Component 2 */
+      Vector p2 = ModM (a21 * v[5] - a23n * v[3], m2, m2inv);
+      v[3] = v[4]; v[4] = v[5]; v[5] = p2;
+
+      /* Combination */
+      Vector u = (p1 - p2 + m1 * Select (p1 <= p2)) * norm;
+      for (uint32_t k = 0; k < LANES; ++k)
+        {
+          values[(k << log2Length) + i] = u[k];
+        }
+    }
+
+  /* The last lane ends where the block does */
+  for (int j = 0; j < 6; ++j)
+    {
+      s[j] = v[j][LANES - 1];
+    }
+}
+#endif /* NS3_RNG_STREAM_SIMD */
+
 } // end of anonymous namespace
 
 
@@ -248,33 +396,42 @@ namespace ns3 {
 //
 double RngStream::RandU01 ()
 {
-  int32_t k;
-  double p1, p2, u;
+  return Next (m_currentState);
+}
 
-  /* Component 1 */
-  p1 = a12 * m_currentState[1] - a13n * m_currentState[0];
-  k = static_cast<int32_t> (p1 / m1);
-  p1 -= k * m1;
-  if (p1 < 0.0)
+void RngStream::RandU01 (double *values, uint32_t n)
+{
+  // Work on a copy of the state, which the compiler can keep in
+  // registers for the whole loop.
+  double state[6];
+  for (int i = 0; i < 6; ++i)
     {
-      p1 += m1;
+      state[i] = m_currentState[i];
     }
-  m_currentState[0] = m_currentState[1]; m_currentState[1] = m_currentState[2]; m_currentState[2] = p1;
-
-  /* Component 2 */
-  p2 = a21 * m_currentState[5] - a23n * m_currentState[3];
-  k = static_cast<int32_t> (p2 / m2);
-  p2 -= k * m2;
-  if (p2 < 0.0)
+#ifdef NS3_RNG_STREAM_SIMD
+  // Each step of MRG32k3a depends on the previous states of the
+  // stream, so the vector kernel runs the lanes on distant parts of
+  // the block instead, the largest it can, and the rest is scalar.
+  uint32_t log2Length = MAX_LOG2_LENGTH;
+  while (n >= (LANES << MIN_LOG2_LENGTH))
+    {
+      while ((LANES << log2Length) > n)
+        {
+          --log2Length;
+        }
+      NextBlock (state, values, log2Length);
+      values += LANES << log2Length;
+      n -= LANES << log2Length;
+    }
+#endif
+  for (uint32_t i = 0; i < n; ++i)
     {
-      p2 += m2;
+      values[i] = Next (state);
+    }
+  for (int i = 0; i < 6; ++i)
+    {
+      m_currentState[i] = state[i];
     }
-  m_currentState[3] = m_currentState[4]; m_currentState[4] = m_currentState[5]; m_currentState[5] = p2;
-
-  /* Combination */
-  u = ((p1 > p2) ? (p1 - p2) * norm : (p1 - p2 + m1) * norm);
-
-  return u;
 }
 
 RngStream::RngStream (uint32_t seedNumber, uint64_t stream, uint64_t substream)
@@ -45,6 +45,13 @@ public:
    * Uniformly distributed between 0 and 1.
    */
   double RandU01 (void);
+  /**
+   * Generate the next n random numbers for this stream, the same
+   * as n calls to RandU01 (void), only faster.
+   * \param values the array to fill with the numbers
+   * \param n the number of values to generate
+   */
+  void RandU01 (double *values, uint32_t n);
 
 private:
   void AdvanceNthBy (uint64_t nth, int by, double state[6]);
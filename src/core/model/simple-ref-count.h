@@ -24,6 +24,7 @@
 
 #include "empty.h"
 #include "default-deleter.h"
+#include "atomic-counter.h"
 #include "assert.h"
 #include <stdint.h>
 #include <limits>
@@ -92,7 +93,7 @@ public:
   inline void Ref (void) const
   {
     NS_ASSERT (m_count < std::numeric_limits<uint32_t>::max());
-    m_count++;
+    AtomicIncrement (m_count);
   }
   /**
    * Decrement the reference count. This method should not be called
@@ -102,8 +103,7 @@ public:
    */
   inline void Unref (void) const
   {
-    m_count--;
-    if (m_count == 0)
+    if (AtomicDecrement (m_count) == 0)
       {
         DELETER::Delete (static_cast<T*> (const_cast<SimpleRefCount *> (this)));
       }
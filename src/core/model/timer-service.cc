@@ -0,0 +1,265 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "timer-service.h"
+#include "simulator.h"
+#include "uinteger.h"
+#include "abort.h"
+#include "assert.h"
+#include "log.h"
+
+NS_LOG_COMPONENT_DEFINE ("TimerService");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (TimerService);
+
+TypeId
+TimerService::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TimerService")
+    .SetParent<Object> ()
+    .AddConstructor<TimerService> ()
+    .AddAttribute ("Granularity",
+                   "The duration of a slot of the wheel: the timers wake "
+                   "up the simulation at most once per slot.",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&TimerService::m_granularity),
+                   MakeTimeChecker ())
+    .AddAttribute ("Slots",
+                   "The number of slots of the wheel, a power of two. "
+                   "The timers more than Slots times Granularity away "
+                   "share the slots of the nearer ones.",
+                   UintegerValue (256),
+                   MakeUintegerAccessor (&TimerService::m_nSlots),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+TimerService::TimerService ()
+  : m_count (0),
+    m_nextTick (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TimerService::~TimerService ()
+{
+  NS_LOG_FUNCTION (this);
+  m_tickEvent.Cancel ();
+}
+
+void
+TimerService::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Entry *>::iterator i = m_slots.begin (); i != m_slots.end (); ++i)
+    {
+      for (Entry *entry = *i; entry != 0; entry = entry->m_next)
+        {
+          entry->m_linked = false;
+        }
+      *i = 0;
+    }
+  m_lasts.assign (m_lasts.size (), 0);
+  m_count = 0;
+  m_tickEvent.Cancel ();
+  Object::DoDispose ();
+}
+
+void
+TimerService::Link (Entry *entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+  if (m_slots.empty ())
+    {
+      NS_ABORT_MSG_UNLESS ((m_nSlots & (m_nSlots - 1)) == 0,
+                           "TimerService::Slots must be a power of two, not " << m_nSlots);
+      NS_ABORT_MSG_UNLESS (m_granularity.IsStrictlyPositive (),
+                           "TimerService::Granularity must be positive");
+      m_slots.resize (m_nSlots, 0);
+      m_lasts.resize (m_nSlots, 0);
+    }
+
+  Time now = Simulator::Now ();
+  entry->m_tick = entry->m_deadline.GetTimeStep () / m_granularity.GetTimeStep ();
+  Time tickTime = TimeStep (entry->m_tick * m_granularity.GetTimeStep ());
+  // A tick due now, but not run yet, still takes the timers of its
+  // slot, so that they expire after the timers armed before them.
+  bool tickPending = m_tickEvent.IsRunning () && m_nextTick == entry->m_tick;
+  if (tickTime < now || (tickTime == now && !tickPending))
+    {
+      // The tick of the slot is over: the deadline is less than a slot away.
+      entry->m_event = Simulator::Schedule (entry->m_deadline - now, &Entry::Expire, entry);
+      return;
+    }
+
+  // Append the timer, so that the timers of a slot stay in arming order.
+  uint32_t index = entry->m_tick & (m_nSlots - 1);
+  entry->m_prev = m_lasts[index];
+  entry->m_next = 0;
+  if (m_lasts[index] != 0)
+    {
+      m_lasts[index]->m_next = entry;
+    }
+  else
+    {
+      m_slots[index] = entry;
+    }
+  m_lasts[index] = entry;
+  entry->m_linked = true;
+  m_count++;
+
+  if (entry->m_tick < m_nextTick || !m_tickEvent.IsRunning ())
+    {
+      ScheduleTick (entry->m_tick);
+    }
+}
+
+void
+TimerService::Unlink (Entry *entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+  NS_ASSERT (entry->m_linked);
+  uint32_t index = entry->m_tick & (m_nSlots - 1);
+  if (entry->m_prev != 0)
+    {
+      entry->m_prev->m_next = entry->m_next;
+    }
+  else
+    {
+      m_slots[index] = entry->m_next;
+    }
+  if (entry->m_next != 0)
+    {
+      entry->m_next->m_prev = entry->m_prev;
+    }
+  else
+    {
+      m_lasts[index] = entry->m_prev;
+    }
+  entry->m_linked = false;
+  m_count--;
+}
+
+void
+TimerService::ScheduleTick (uint64_t tick)
+{
+  NS_LOG_FUNCTION (this << tick);
+  m_tickEvent.Cancel ();
+  m_nextTick = tick;
+  m_tickEvent = Simulator::Schedule (TimeStep (tick * m_granularity.GetTimeStep ()) - Simulator::Now (),
+                                     &TimerService::Tick, this);
+}
+
+void
+TimerService::Tick (void)
+{
+  NS_LOG_FUNCTION (this << m_nextTick);
+  uint64_t tick = m_nextTick;
+  Time now = Simulator::Now ();
+
+  Entry *entry = m_slots[tick & (m_nSlots - 1)];
+  while (entry != 0)
+    {
+      Entry *next = entry->m_next;
+      NS_ASSERT (entry->m_tick >= tick);
+      if (entry->m_tick == tick)
+        {
+          Unlink (entry);
+          entry->m_event = Simulator::Schedule (entry->m_deadline - now, &Entry::Expire, entry);
+        }
+      entry = next;
+    }
+
+  if (m_count == 0)
+    {
+      return;
+    }
+  // Some slot holds a timer, so the search ends at the latest when it
+  // gets back to this slot.
+  for (uint64_t next = tick + 1; next <= tick + m_nSlots; next++)
+    {
+      if (m_slots[next & (m_nSlots - 1)] != 0)
+        {
+          ScheduleTick (next);
+          return;
+        }
+    }
+  NS_ASSERT_MSG (false, "TimerService::Tick(): Internal error: timers not found");
+}
+
+TimerService::Entry::Entry (Ptr<TimerService> service, Callback<void> function)
+  : m_service (service),
+    m_function (function),
+    m_prev (0),
+    m_next (0),
+    m_linked (false),
+    m_tick (0)
+{
+  NS_LOG_FUNCTION (this << service);
+}
+
+TimerService::Entry::~Entry ()
+{
+  NS_LOG_FUNCTION (this);
+  Cancel ();
+}
+
+void
+TimerService::Entry::Schedule (const Time &delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+  Cancel ();
+  m_deadline = Simulator::Now () + delay;
+  m_service->Link (this);
+}
+
+void
+TimerService::Entry::Cancel (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_linked)
+    {
+      m_service->Unlink (this);
+    }
+  m_event.Cancel ();
+}
+
+bool
+TimerService::Entry::IsRunning (void) const
+{
+  return m_linked || m_event.IsRunning ();
+}
+
+Time
+TimerService::Entry::GetDelayLeft (void) const
+{
+  if (!IsRunning ())
+    {
+      return TimeStep (0);
+    }
+  return m_deadline - Simulator::Now ();
+}
+
+void
+TimerService::Entry::Expire (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_function ();
+}
+
+} // namespace ns3
@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef TIMER_SERVICE_H
+#define TIMER_SERVICE_H
+
+#include <vector>
+
+#include "object.h"
+#include "nstime.h"
+#include "event-id.h"
+#include "callback.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup core
+ * \brief a timer wheel shared by many timers
+ *
+ * Each Timer and Watchdog schedules a simulator event when it is armed,
+ * and cancels or removes it when it is re-armed.  The protocols which
+ * re-arm a timer for each packet, such as retransmission and keepalive
+ * timers, thus insert and remove an event in the scheduler per packet.
+ *
+ * The timers which use a TimerService instead are kept in the slots of
+ * a hashed timer wheel, indexed by their deadline divided by the
+ * Granularity of the wheel, so that arming, re-arming and cancelling a
+ * timer only moves it between two doubly-linked lists.  The only
+ * simulator events are the ticks of the wheel, scheduled at the first
+ * slot holding a timer, and the expiry events:  at the tick of its slot,
+ * a timer which is still armed schedules an event at its exact deadline.
+ * The slots keep the timers in the order they were armed, so the timers
+ * of a TimerService expire at the same time, and in the same order
+ * among themselves, as if they had scheduled their own event, and the
+ * timers re-armed before their last tick never reach the scheduler.
+ * Since the expiry events are scheduled at the tick, an event scheduled
+ * by other means, for the same time as the deadline of a timer, may run
+ * before the timer expires even if it was scheduled after the timer was
+ * armed.
+ *
+ * Timer and Watchdog use a TimerService after a call to their
+ * SetTimerService method.  A TimerService::Entry can also be used
+ * directly, to invoke a callback.
+ *
+ * The expiry events are scheduled from the ticks, which run in the
+ * context of the event which scheduled them:  use one TimerService per
+ * node, so that the timers expire in the context of their node.
+ */
+class TimerService : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  TimerService ();
+  virtual ~TimerService ();
+
+  /**
+   * \brief a timer of a TimerService
+   */
+  class Entry
+  {
+public:
+    /**
+     * \param service the wheel of this timer
+     * \param function the function invoked when this timer expires
+     */
+    Entry (Ptr<TimerService> service, Callback<void> function);
+    /**
+     * Cancel this timer, if it is armed.
+     */
+    ~Entry ();
+
+    /**
+     * \param delay the delay until the expiry of this timer
+     *
+     * Arm this timer, or re-arm it if it is already armed.
+     */
+    void Schedule (const Time &delay);
+    /**
+     * Disarm this timer, if it is armed.  Do nothing otherwise.
+     */
+    void Cancel (void);
+    /**
+     * \returns true if this timer is armed, false otherwise.
+     */
+    bool IsRunning (void) const;
+    /**
+     * \returns the amount of time left until this timer expires, or
+     *          zero if it is not armed.
+     */
+    Time GetDelayLeft (void) const;
+
+private:
+    friend class TimerService;
+    Entry (const Entry &o);
+    Entry &operator = (const Entry &o);
+    void Expire (void);
+
+    Ptr<TimerService> m_service;
+    Callback<void> m_function;
+    Entry *m_prev;         //!< The previous timer of the slot.
+    Entry *m_next;         //!< The next timer of the slot.
+    bool m_linked;         //!< Whether the timer is in a slot.
+    uint64_t m_tick;       //!< The tick of the slot of the timer.
+    Time m_deadline;       //!< The expiry time of the timer.
+    EventId m_event;       //!< The expiry event, after the tick.
+  };
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * Add an armed timer to its slot, or schedule its expiry event if
+   * the tick of its slot is already over.
+   */
+  void Link (Entry *entry);
+  /** Remove a timer from its slot. */
+  void Unlink (Entry *entry);
+  /** Schedule the expiry events of the timers of the current slot. */
+  void Tick (void);
+  /** Schedule the tick of the slot at the given tick. */
+  void ScheduleTick (uint64_t tick);
+
+  Time m_granularity;             //!< The duration of a slot.
+  uint32_t m_nSlots;              //!< The number of slots.
+  std::vector<Entry *> m_slots;   //!< The first timer of each slot.
+  std::vector<Entry *> m_lasts;   //!< The last timer of each slot.
+  uint32_t m_count;               //!< The number of timers in the slots.
+  uint64_t m_nextTick;            //!< The tick of the next tick event.
+  EventId m_tickEvent;            //!< The next tick event.
+};
+
+} // namespace ns3
+
+#endif /* TIMER_SERVICE_H */
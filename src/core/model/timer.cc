@@ -30,7 +30,8 @@ Timer::Timer ()
   : m_flags (CHECK_ON_DESTROY),
     m_delay (FemtoSeconds (0)),
     m_event (),
-    m_impl (0)
+    m_impl (0),
+    m_entry (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -39,7 +40,8 @@ Timer::Timer (enum DestroyPolicy destroyPolicy)
   : m_flags (destroyPolicy),
     m_delay (FemtoSeconds (0)),
     m_event (),
-    m_impl (0)
+    m_impl (0),
+    m_entry (0)
 {
   NS_LOG_FUNCTION (this << destroyPolicy);
 }
@@ -47,7 +49,15 @@ Timer::Timer (enum DestroyPolicy destroyPolicy)
 Timer::~Timer ()
 {
   NS_LOG_FUNCTION (this);
-  if (m_flags & CHECK_ON_DESTROY)
+  if (m_entry != 0)
+    {
+      if ((m_flags & CHECK_ON_DESTROY) && m_entry->IsRunning ())
+        {
+          NS_FATAL_ERROR ("Event is still running while destroying.");
+        }
+      delete m_entry;
+    }
+  else if (m_flags & CHECK_ON_DESTROY)
     {
       if (m_event.IsRunning ())
         {
@@ -84,6 +94,10 @@ Timer::GetDelayLeft (void) const
   switch (GetState ())
     {
     case Timer::RUNNING:
+      if (m_entry != 0)
+        {
+          return m_entry->GetDelayLeft ();
+        }
       return Simulator::GetDelayLeft (m_event);
       break;
     case Timer::EXPIRED:
@@ -103,24 +117,42 @@ void
 Timer::Cancel (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_entry != 0)
+    {
+      m_entry->Cancel ();
+      return;
+    }
   Simulator::Cancel (m_event);
 }
 void
 Timer::Remove (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_entry != 0)
+    {
+      m_entry->Cancel ();
+      return;
+    }
   Simulator::Remove (m_event);
 }
 bool
 Timer::IsExpired (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_entry != 0)
+    {
+      return !IsSuspended () && !m_entry->IsRunning ();
+    }
   return !IsSuspended () && m_event.IsExpired ();
 }
 bool
 Timer::IsRunning (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_entry != 0)
+    {
+      return !IsSuspended () && m_entry->IsRunning ();
+    }
   return !IsSuspended () && m_event.IsRunning ();
 }
 bool
@@ -160,6 +192,15 @@ Timer::Schedule (Time delay)
 {
   NS_LOG_FUNCTION (this << delay);
   NS_ASSERT (m_impl != 0);
+  if (m_entry != 0)
+    {
+      if (m_entry->IsRunning ())
+        {
+          NS_FATAL_ERROR ("Event is still running while re-scheduling.");
+        }
+      m_entry->Schedule (delay);
+      return;
+    }
   if (m_event.IsRunning ())
     {
       NS_FATAL_ERROR ("Event is still running while re-scheduling.");
@@ -172,8 +213,16 @@ Timer::Suspend (void)
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (IsRunning ());
-  m_delayLeft = Simulator::GetDelayLeft (m_event);
-  Simulator::Remove (m_event);
+  if (m_entry != 0)
+    {
+      m_delayLeft = m_entry->GetDelayLeft ();
+      m_entry->Cancel ();
+    }
+  else
+    {
+      m_delayLeft = Simulator::GetDelayLeft (m_event);
+      Simulator::Remove (m_event);
+    }
   m_flags |= TIMER_SUSPENDED;
 }
 
@@ -182,10 +231,33 @@ Timer::Resume (void)
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (m_flags & TIMER_SUSPENDED);
-  m_event = m_impl->Schedule (m_delayLeft);
+  if (m_entry != 0)
+    {
+      m_entry->Schedule (m_delayLeft);
+    }
+  else
+    {
+      m_event = m_impl->Schedule (m_delayLeft);
+    }
   m_flags &= ~TIMER_SUSPENDED;
 }
 
+void
+Timer::SetTimerService (Ptr<TimerService> service)
+{
+  NS_LOG_FUNCTION (this << service);
+  NS_ASSERT (!IsRunning () && !IsSuspended ());
+  delete m_entry;
+  m_entry = new TimerService::Entry (service, MakeCallback (&Timer::Expire, this));
+}
+
+void
+Timer::Expire (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_impl->Invoke ();
+}
+
 
 } // namespace ns3
 
@@ -24,6 +24,7 @@
 #include "nstime.h"
 #include "event-id.h"
 #include "int-to-type.h"
+#include "timer-service.h"
 
 namespace ns3 {
 
@@ -229,17 +230,31 @@ public:
    */
   void Resume (void);
 
+  /**
+   * \param service the timer wheel of this timer
+   *
+   * Keep this timer in the slots of the TimerService instead of
+   * scheduling a simulator event each time it is scheduled, which makes
+   * scheduling and cancelling it cheaper.  The timer expires at the same
+   * time.  Calling SetTimerService on a running or suspended timer is an
+   * error.
+   */
+  void SetTimerService (Ptr<TimerService> service);
+
 private:
   enum
   {
     TIMER_SUSPENDED = (1 << 7)
   };
 
+  void Expire (void);
+
   int m_flags;
   Time m_delay;
   EventId m_event;
   TimerImpl *m_impl;
   Time m_delayLeft;
+  TimerService::Entry *m_entry; //!< The timer in the TimerService, if any.
 };
 
 } // namespace ns3
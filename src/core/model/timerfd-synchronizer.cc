@@ -0,0 +1,404 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/prctl.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "log.h"
+#include "abort.h"
+#include "integer.h"
+#include "uinteger.h"
+#include "trace-source-accessor.h"
+
+#include "timerfd-synchronizer.h"
+
+NS_LOG_COMPONENT_DEFINE ("TimerfdSynchronizer");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (TimerfdSynchronizer);
+
+/// Conversion from ns to s.
+static const uint64_t NS_PER_SEC = 1000000000;
+
+TypeId
+TimerfdSynchronizer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TimerfdSynchronizer")
+    .SetParent<Synchronizer> ()
+    .AddConstructor<TimerfdSynchronizer> ()
+    .AddAttribute ("MinSpinTail",
+                   "The minimum time spent spinning at the end of a wait.",
+                   TimeValue (MicroSeconds (2)),
+                   MakeTimeAccessor (&TimerfdSynchronizer::m_minSpinTail),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxSpinTail",
+                   "The maximum time spent spinning at the end of a wait, "
+                   "and the spin tail before the calibration.",
+                   TimeValue (MicroSeconds (500)),
+                   MakeTimeAccessor (&TimerfdSynchronizer::m_maxSpinTail),
+                   MakeTimeChecker ())
+    .AddAttribute ("CpuAffinity",
+                   "The CPU to pin the simulation thread to, or -1 to leave it unpinned.",
+                   IntegerValue (-1),
+                   MakeIntegerAccessor (&TimerfdSynchronizer::m_cpuAffinity),
+                   MakeIntegerChecker<int32_t> (-1))
+    .AddAttribute ("TimerSlack",
+                   "The timer slack of the simulation thread: how late the "
+                   "kernel may end its sleeps to group the wakeups.",
+                   TimeValue (NanoSeconds (1)),
+                   MakeTimeAccessor (&TimerfdSynchronizer::m_timerSlack),
+                   MakeTimeChecker ())
+    .AddAttribute ("ReportInterval",
+                   "The number of waits between two LatenessPercentiles reports.",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor (&TimerfdSynchronizer::m_reportInterval),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddTraceSource ("Lateness",
+                     "How late each wait ended, after the time of its event.",
+                     MakeTraceSourceAccessor (&TimerfdSynchronizer::m_latenessTrace))
+    .AddTraceSource ("LatenessPercentiles",
+                     "The median, 90th percentile, 99th percentile and maximum "
+                     "of the lateness of the last ReportInterval waits.",
+                     MakeTraceSourceAccessor (&TimerfdSynchronizer::m_latenessPercentilesTrace))
+  ;
+  return tid;
+}
+
+TimerfdSynchronizer::TimerfdSynchronizer ()
+  : m_condition (false),
+    m_nsEventStart (0),
+    m_spinTail (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_timerFd = timerfd_create (CLOCK_MONOTONIC, TFD_CLOEXEC);
+  NS_ABORT_MSG_IF (m_timerFd == -1, "timerfd_create failed: " << std::strerror (errno));
+  m_eventFd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+  NS_ABORT_MSG_IF (m_eventFd == -1, "eventfd failed: " << std::strerror (errno));
+}
+
+TimerfdSynchronizer::~TimerfdSynchronizer ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TimerfdSynchronizer::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_timerFd != -1)
+    {
+      close (m_timerFd);
+      m_timerFd = -1;
+    }
+  if (m_eventFd != -1)
+    {
+      close (m_eventFd);
+      m_eventFd = -1;
+    }
+  Synchronizer::DoDispose ();
+}
+
+uint64_t
+TimerfdSynchronizer::GetSpinTail (void) const
+{
+  return m_spinTail;
+}
+
+bool
+TimerfdSynchronizer::DoRealtime (void)
+{
+  NS_LOG_FUNCTION (this);
+  return true;
+}
+
+uint64_t
+TimerfdSynchronizer::DoGetCurrentRealtime (void)
+{
+  NS_LOG_FUNCTION (this);
+  return GetNormalizedRealtime ();
+}
+
+void
+TimerfdSynchronizer::DoSetOrigin (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+  //
+  // The origin is set by the simulation thread when the simulation starts,
+  // which makes it the place to configure that thread.
+  //
+  SetupThread ();
+  m_spinTail = m_maxSpinTail.GetNanoSeconds ();
+  m_lateness.clear ();
+  m_lateness.reserve (m_reportInterval);
+  m_realtimeOriginNano = GetRealtime ();
+  NS_LOG_INFO ("origin = " << m_realtimeOriginNano);
+}
+
+int64_t
+TimerfdSynchronizer::DoGetDrift (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+  uint64_t nsNow = GetNormalizedRealtime ();
+  if (nsNow > ns)
+    {
+      return (int64_t)(nsNow - ns);
+    }
+  else
+    {
+      return -(int64_t)(ns - nsNow);
+    }
+}
+
+bool
+TimerfdSynchronizer::DoSynchronize (uint64_t nsCurrent, uint64_t nsDelay)
+{
+  NS_LOG_FUNCTION (this << nsCurrent << nsDelay);
+  //
+  // The wait ends at an absolute time, so that the time spent since
+  // nsCurrent was measured, and any earlier oversleeping, are taken
+  // into account.
+  //
+  uint64_t nsTarget = nsCurrent + nsDelay;
+  uint64_t nsNow = GetNormalizedRealtime ();
+  if (nsNow + m_spinTail < nsTarget)
+    {
+      uint64_t nsWake = nsTarget - m_spinTail;
+      NS_LOG_INFO ("SleepWait until " << nsWake << " ns");
+      if (SleepWait (nsWake) == false)
+        {
+          NS_LOG_INFO ("SleepWait interrupted");
+          return false;
+        }
+      Calibrate ((int64_t)(GetNormalizedRealtime () - nsWake));
+    }
+  NS_LOG_INFO ("SpinWait until " << nsTarget << " ns");
+  if (SpinWait (nsTarget) == false)
+    {
+      NS_LOG_INFO ("SpinWait interrupted");
+      return false;
+    }
+  RecordLateness (DoGetDrift (nsTarget));
+  return true;
+}
+
+void
+TimerfdSynchronizer::DoSignal (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_condition = true;
+  __sync_synchronize ();
+  uint64_t one = 1;
+  ssize_t written = write (m_eventFd, &one, sizeof (one));
+  NS_ASSERT (written == (ssize_t)sizeof (one) || errno == EAGAIN);
+  (void)written;
+}
+
+void
+TimerfdSynchronizer::DoSetCondition (bool cond)
+{
+  NS_LOG_FUNCTION (this << cond);
+  m_condition = cond;
+  __sync_synchronize ();
+  if (!cond)
+    {
+      // drain the Signals which have already been consumed
+      uint64_t count;
+      while (read (m_eventFd, &count, sizeof (count)) == (ssize_t)sizeof (count))
+        {
+        }
+    }
+}
+
+void
+TimerfdSynchronizer::DoEventStart (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nsEventStart = GetNormalizedRealtime ();
+}
+
+uint64_t
+TimerfdSynchronizer::DoEventEnd (void)
+{
+  NS_LOG_FUNCTION (this);
+  return GetNormalizedRealtime () - m_nsEventStart;
+}
+
+uint64_t
+TimerfdSynchronizer::GetRealtime (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+uint64_t
+TimerfdSynchronizer::GetNormalizedRealtime (void)
+{
+  return GetRealtime () - m_realtimeOriginNano;
+}
+
+void
+TimerfdSynchronizer::SetupThread (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_cpuAffinity >= 0)
+    {
+      cpu_set_t cpus;
+      CPU_ZERO (&cpus);
+      CPU_SET (m_cpuAffinity, &cpus);
+      int error = pthread_setaffinity_np (pthread_self (), sizeof (cpus), &cpus);
+      NS_ABORT_MSG_IF (error != 0, "Cannot pin the simulation thread to CPU "
+                       << m_cpuAffinity << ": " << std::strerror (error));
+      NS_LOG_INFO ("Pinned to CPU " << m_cpuAffinity);
+    }
+  //
+  // The kernel may delay the end of a sleep by the timer slack of the
+  // thread, 50 us by default, to group it with other wakeups.
+  //
+  unsigned long slack = std::max<int64_t> (m_timerSlack.GetNanoSeconds (), 1);
+  if (prctl (PR_SET_TIMERSLACK, slack, 0, 0, 0) != 0)
+    {
+      NS_LOG_WARN ("Cannot set the timer slack: " << std::strerror (errno));
+    }
+}
+
+bool
+TimerfdSynchronizer::SleepWait (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+  if (m_condition)
+    {
+      return false;
+    }
+  uint64_t deadline = m_realtimeOriginNano + ns;
+  struct itimerspec timer;
+  std::memset (&timer, 0, sizeof (timer));
+  timer.it_value.tv_sec = deadline / NS_PER_SEC;
+  timer.it_value.tv_nsec = deadline % NS_PER_SEC;
+  int status = timerfd_settime (m_timerFd, TFD_TIMER_ABSTIME, &timer, 0);
+  NS_ABORT_MSG_IF (status == -1, "timerfd_settime failed: " << std::strerror (errno));
+
+  struct pollfd fds[2];
+  fds[0].fd = m_timerFd;
+  fds[0].events = POLLIN;
+  fds[1].fd = m_eventFd;
+  fds[1].events = POLLIN;
+  for (;;)
+    {
+      fds[0].revents = 0;
+      fds[1].revents = 0;
+      status = poll (fds, 2, -1);
+      if (status == -1 && errno == EINTR)
+        {
+          continue;
+        }
+      NS_ABORT_MSG_IF (status == -1, "poll failed: " << std::strerror (errno));
+      if (fds[1].revents & POLLIN)
+        {
+          return false;
+        }
+      if (fds[0].revents & POLLIN)
+        {
+          uint64_t expirations;
+          ssize_t bytes = read (m_timerFd, &expirations, sizeof (expirations));
+          NS_ASSERT (bytes == (ssize_t)sizeof (expirations));
+          (void)bytes;
+          return true;
+        }
+    }
+}
+
+bool
+TimerfdSynchronizer::SpinWait (uint64_t ns)
+{
+  //
+  // No logging here: the spin must follow the clock as closely as possible.
+  //
+  for (;;)
+    {
+      if (GetNormalizedRealtime () >= ns)
+        {
+          return true;
+        }
+      if (m_condition)
+        {
+          return false;
+        }
+    }
+}
+
+void
+TimerfdSynchronizer::Calibrate (int64_t overshoot)
+{
+  NS_LOG_FUNCTION (this << overshoot);
+  //
+  // The spin tail covers twice the overshoot of the sleeps: it grows at
+  // once to cover a late wakeup, and shrinks by 1/16th of the excess at
+  // each accurate one, so that a single early wakeup does not expose the
+  // next waits to the usual overshoot.
+  //
+  uint64_t wanted = overshoot > 0 ? 2 * (uint64_t)overshoot : 0;
+  if (wanted > m_spinTail)
+    {
+      m_spinTail = wanted;
+    }
+  else
+    {
+      m_spinTail -= (m_spinTail - wanted) / 16;
+    }
+  uint64_t minSpinTail = m_minSpinTail.GetNanoSeconds ();
+  uint64_t maxSpinTail = m_maxSpinTail.GetNanoSeconds ();
+  m_spinTail = std::min (std::max (m_spinTail, minSpinTail), maxSpinTail);
+  NS_LOG_LOGIC ("spin tail " << m_spinTail << " ns");
+}
+
+void
+TimerfdSynchronizer::RecordLateness (int64_t lateness)
+{
+  m_latenessTrace (NanoSeconds (lateness));
+  if (m_latenessPercentilesTrace.IsEmpty ())
+    {
+      return;
+    }
+  m_lateness.push_back (lateness);
+  if (m_lateness.size () < m_reportInterval)
+    {
+      return;
+    }
+  std::vector<int64_t>::iterator begin = m_lateness.begin ();
+  std::vector<int64_t>::size_type n = m_lateness.size ();
+  std::nth_element (begin, begin + n / 2, m_lateness.end ());
+  Time median = NanoSeconds (*(begin + n / 2));
+  std::nth_element (begin + n / 2, begin + n * 9 / 10, m_lateness.end ());
+  Time p90 = NanoSeconds (*(begin + n * 9 / 10));
+  std::nth_element (begin + n * 9 / 10, begin + n * 99 / 100, m_lateness.end ());
+  Time p99 = NanoSeconds (*(begin + n * 99 / 100));
+  Time max = NanoSeconds (*std::max_element (begin + n * 99 / 100, m_lateness.end ()));
+  m_lateness.clear ();
+  m_latenessPercentilesTrace (median, p90, p99, max);
+}
+
+} // namespace ns3
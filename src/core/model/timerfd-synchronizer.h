@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TIMERFD_SYNCHRONIZER_H
+#define TIMERFD_SYNCHRONIZER_H
+
+#include <vector>
+
+#include "synchronizer.h"
+#include "nstime.h"
+#include "traced-callback.h"
+
+namespace ns3 {
+
+/**
+ * @brief Synchronizer with a low jitter, for the emulations which exchange
+ * real traffic with the simulation, built on the Linux timerfd.
+ *
+ * Enable this synchronizer using:
+ *
+ *   Config::SetDefault ("ns3::RealtimeSimulatorImpl::SynchronizerType",
+ *                       TypeIdValue (TimerfdSynchronizer::GetTypeId ()));
+ *
+ * before calling any simulator functions.
+ *
+ * The synchronizer sleeps until shortly before the next event, and spins
+ * for the rest of the wait.  The sleep is an absolute CLOCK_MONOTONIC
+ * timerfd deadline, with a minimal timer slack, so that the oversleeping
+ * does not accumulate: the WallClockSynchronizer, by contrast, sleeps in
+ * relative jiffies on a condition variable and spins the last three
+ * jiffies.  The spin tail is calibrated as the simulation runs: it grows
+ * as soon as a sleep overshoots its deadline and slowly shrinks back while
+ * the sleeps are accurate, between the MinSpinTail and MaxSpinTail
+ * attributes.  A Signal wakes up the sleep through an eventfd, and the
+ * spin through the condition flag.
+ *
+ * The simulation thread can be pinned to a CPU with the CpuAffinity
+ * attribute, to avoid migrations during the spins.  The lateness of the
+ * waits, that is the delay between the time of an event and the end of
+ * its wait, is reported by the Lateness trace source, and its percentiles
+ * by the LatenessPercentiles trace source, every ReportInterval waits.
+ */
+class TimerfdSynchronizer : public Synchronizer
+{
+public:
+  static TypeId GetTypeId (void);
+
+  TimerfdSynchronizer ();
+  virtual ~TimerfdSynchronizer ();
+
+  /** \return the current spin tail, in ns. */
+  uint64_t GetSpinTail (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+  virtual bool DoRealtime (void);
+  virtual uint64_t DoGetCurrentRealtime (void);
+  virtual void DoSetOrigin (uint64_t ns);
+  virtual int64_t DoGetDrift (uint64_t ns);
+  virtual bool DoSynchronize (uint64_t nsCurrent, uint64_t nsDelay);
+  virtual void DoSignal (void);
+  virtual void DoSetCondition (bool cond);
+  virtual void DoEventStart (void);
+  virtual uint64_t DoEventEnd (void);
+
+private:
+  /** \return the CLOCK_MONOTONIC time, in ns. */
+  static uint64_t GetRealtime (void);
+  /** \return the time since the origin, in ns. */
+  uint64_t GetNormalizedRealtime (void);
+  /** Configure the simulation thread: CPU affinity and timer slack. */
+  void SetupThread (void);
+  /**
+   * Sleep until a normalized time.
+   * \param ns the normalized time.
+   * \return false if the sleep was interrupted by a Signal.
+   */
+  bool SleepWait (uint64_t ns);
+  /**
+   * Spin until a normalized time.
+   * \param ns the normalized time.
+   * \return false if the spin was interrupted by a Signal.
+   */
+  bool SpinWait (uint64_t ns);
+  /**
+   * Adapt the spin tail to the overshoot of a sleep.
+   * \param overshoot how late the sleep ended, in ns.
+   */
+  void Calibrate (int64_t overshoot);
+  /**
+   * Record the lateness of a wait.
+   * \param lateness how late the wait ended, in ns.
+   */
+  void RecordLateness (int64_t lateness);
+
+  int m_timerFd;                        //!< The timerfd of the sleeps.
+  int m_eventFd;                        //!< The eventfd which interrupts the sleeps.
+  volatile bool m_condition;            //!< Set by Signal to interrupt the waits.
+  uint64_t m_nsEventStart;              //!< The start time of the current event.
+
+  Time m_minSpinTail;                   //!< The minimum spin tail.
+  Time m_maxSpinTail;                   //!< The maximum spin tail.
+  uint64_t m_spinTail;                  //!< The calibrated spin tail, in ns.
+  int32_t m_cpuAffinity;                //!< The CPU of the simulation thread, or -1.
+  Time m_timerSlack;                    //!< The timer slack of the simulation thread.
+
+  uint32_t m_reportInterval;            //!< The number of waits per percentiles report.
+  std::vector<int64_t> m_lateness;      //!< The lateness of the waits since the last report.
+  TracedCallback<Time> m_latenessTrace; //!< The lateness of each wait.
+  /** The lateness percentiles, every m_reportInterval waits. */
+  TracedCallback<Time, Time, Time, Time> m_latenessPercentilesTrace;
+};
+
+} // namespace ns3
+
+#endif /* TIMERFD_SYNCHRONIZER_H */
@@ -21,8 +21,13 @@
 #ifndef TRACED_CALLBACK_H
 #define TRACED_CALLBACK_H
 
-#include <list>
+#include <vector>
 #include "callback.h"
+#include "ptr.h"
+#include "simple-ref-count.h"
+#ifdef NS3_MULTITHREADED
+#include <sched.h>
+#endif
 
 namespace ns3 {
 
@@ -44,6 +49,19 @@ class TracedCallback
 {
 public:
   TracedCallback ();
+  /**
+   * \param o the TracedCallback to copy
+   *
+   * The copy is connected to the callbacks of \p o, but disconnecting
+   * them from one of the TracedCallbacks does not affect the other.
+   */
+  TracedCallback (const TracedCallback &o);
+  /**
+   * \param o the TracedCallback to copy
+   * \returns this TracedCallback
+   */
+  TracedCallback &operator = (const TracedCallback &o);
+  ~TracedCallback ();
   /**
    * \param callback callback to add to chain of callbacks
    *
@@ -78,6 +96,16 @@ public:
    * of the TracedCallback::Connect method.
    */
   void Disconnect (const CallbackBase & callback, std::string path);
+  /**
+   * \return true if no callback is connected.
+   *
+   * The hot trace points can check it, or use NS_TRACE, to avoid
+   * building the arguments of a trace which nobody listens to.
+   */
+  bool IsEmpty (void) const
+  {
+    return m_chain == 0;
+  }
   void operator() (void) const;
   void operator() (T1 a1) const;
   void operator() (T1 a1, T2 a2) const;
@@ -89,22 +117,162 @@ public:
   void operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const;
 
 private:
-  typedef std::list<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
-  CallbackList m_callbackList;
+  /**
+   * A connected callback, shared by the snapshots of the chain which
+   * contain it.
+   */
+  class Sink : public SimpleRefCount<Sink>
+  {
+  public:
+    /**
+     * \param callback the connected callback
+     */
+    Sink (const Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> &callback)
+      : m_callback (callback),
+        m_disconnected (false)
+    {
+    }
+    /**
+     * \returns false once the callback is disconnected
+     */
+    bool IsConnected (void) const
+    {
+      return !__atomic_load_n (&m_disconnected, __ATOMIC_RELAXED);
+    }
+    /**
+     * Stop the invocations in progress from calling the callback.
+     */
+    void SetDisconnected (void)
+    {
+      __atomic_store_n (&m_disconnected, true, __ATOMIC_RELAXED);
+    }
+
+    Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> m_callback; //!< the callback
+  private:
+    bool m_disconnected; //!< true once the callback is disconnected
+  };
+  typedef std::vector<Ptr<Sink> > SinkList;
+  /**
+   * A snapshot of the chain of callbacks: it is not modified once it
+   * is published in m_chain.
+   */
+  class Chain : public SimpleRefCount<Chain>
+  {
+  public:
+    SinkList m_sinks; //!< the connected callbacks, in order
+  };
+
+  /**
+   * \returns the current chain, or 0 if no callback is connected
+   */
+  Ptr<const Chain> GetChain (void) const;
+  /**
+   * Publish a new chain, which contains the \p sinks.
+   * \param sinks the sinks of the new chain
+   */
+  void SetChain (const SinkList &sinks);
+  /** Lock m_chain against concurrent modifications */
+  void Lock (void) const;
+  /** Unlock m_chain */
+  void Unlock (void) const;
+
+  /*
+   * The chain is copied on write: Connect and Disconnect publish a new
+   * chain, while the invocations in progress, in this thread or in the
+   * other threads of the multithreaded simulator, keep calling the
+   * chain they started with. They skip the callbacks disconnected
+   * meanwhile, and the callbacks connected are called from the next
+   * invocations.
+   */
+  Ptr<const Chain> m_chain;
+#ifdef NS3_MULTITHREADED
+  mutable uint32_t m_lock; //!< nonzero while m_chain is read or replaced
+#endif
 };
 
 } // namespace ns3
 
+/**
+ * \ingroup tracing
+ *
+ * Invoke a TracedCallback, evaluating its arguments only if a callback
+ * is connected to it.
+ *
+ * \param trace the TracedCallback
+ * \param args the parenthesized list of arguments
+ *
+ * Example:
+ * \code
+ *   NS_TRACE (m_macTxTrace, (packet->Copy (), GetAddress ()));
+ * \endcode
+ */
+#define NS_TRACE(trace, args)                                         \
+  do {                                                                \
+      if (!(trace).IsEmpty ())                                        \
+        {                                                             \
+          (trace) args;                                               \
+        }                                                             \
+    } while (false)
+
 // implementation below.
 
 namespace ns3 {
 
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback ()
-  : m_callbackList () 
+  : m_chain ()
+#ifdef NS3_MULTITHREADED
+    , m_lock (0)
+#endif
+{
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback (const TracedCallback &o)
+  : m_chain ()
+#ifdef NS3_MULTITHREADED
+    , m_lock (0)
+#endif
+{
+  *this = o;
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8> &
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator = (const TracedCallback &o)
+{
+  if (this != &o)
+    {
+      // the sinks are not shared with o: disconnecting a callback from
+      // o must not stop the invocations of this TracedCallback.
+      Ptr<const Chain> chain = o.GetChain ();
+      SinkList sinks;
+      if (chain != 0)
+        {
+          for (typename SinkList::const_iterator i = chain->m_sinks.begin ();
+               i != chain->m_sinks.end (); i++)
+            {
+              sinks.push_back (Create<Sink> ((*i)->m_callback));
+            }
+        }
+      Lock ();
+      SetChain (sinks);
+      Unlock ();
+    }
+  return *this;
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::~TracedCallback ()
 {
 }
 template<typename T1, typename T2,
@@ -112,11 +280,78 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Lock (void) const
+{
+#ifdef NS3_MULTITHREADED
+  while (!AtomicCompareAndSwap<uint32_t> (m_lock, 0, 1))
+    {
+      // the thread which holds the lock may have been preempted
+      sched_yield ();
+    }
+#endif
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Unlock (void) const
+{
+#ifdef NS3_MULTITHREADED
+  __sync_lock_release (&m_lock);
+#endif
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+Ptr<const typename TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Chain>
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::GetChain (void) const
+{
+  Lock ();
+  Ptr<const Chain> chain = m_chain;
+  Unlock ();
+  return chain;
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::SetChain (const SinkList &sinks)
+{
+  if (sinks.empty ())
+    {
+      m_chain = 0;
+      return;
+    }
+  Ptr<Chain> chain = Create<Chain> ();
+  chain->m_sinks = sinks;
+  m_chain = chain;
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::ConnectWithoutContext (const CallbackBase & callback)
 {
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> cb;
   cb.Assign (callback);
-  m_callbackList.push_back (cb);
+  Ptr<Sink> sink = Create<Sink> (cb);
+  // released after Unlock: the callbacks of a deleted chain may hold
+  // the last references to objects.
+  Ptr<const Chain> old;
+  Lock ();
+  old = m_chain;
+  SinkList sinks;
+  if (old != 0)
+    {
+      sinks = old->m_sinks;
+    }
+  sinks.push_back (sink);
+  SetChain (sinks);
+  Unlock ();
 }
 template<typename T1, typename T2,
          typename T3, typename T4,
@@ -128,33 +363,42 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Connect (const CallbackBase & callback,
   Callback<void,std::string,T1,T2,T3,T4,T5,T6,T7,T8> cb;
   cb.Assign (callback);
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
-  m_callbackList.push_back (realCb);
+  ConnectWithoutContext (realCb);
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::DisconnectWithoutContext (const CallbackBase & callback)
 {
-  for (typename CallbackList::iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); /* empty */)
+  Ptr<const Chain> old;
+  Lock ();
+  old = m_chain;
+  if (old != 0)
     {
-      if ((*i).IsEqual (callback))
-        {
-          i = m_callbackList.erase (i);
-        }
-      else
+      SinkList sinks;
+      for (typename SinkList::const_iterator i = old->m_sinks.begin ();
+           i != old->m_sinks.end (); i++)
         {
-          i++;
+          if ((*i)->m_callback.IsEqual (callback))
+            {
+              (*i)->SetDisconnected ();
+            }
+          else
+            {
+              sinks.push_back (*i);
+            }
         }
+      SetChain (sinks);
     }
+  Unlock ();
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Disconnect (const CallbackBase & callback, std::string path)
 {
   Callback<void,std::string,T1,T2,T3,T4,T5,T6,T7,T8> cb;
@@ -162,121 +406,193 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Disconnect (const CallbackBase & callba
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
   DisconnectWithoutContext (realCb);
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (void) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  Ptr<const Chain> chain = GetChain ();
+  if (chain == 0)
     {
-      (*i)();
+      return;
+    }
+  for (typename SinkList::const_iterator i = chain->m_sinks.begin ();
+       i != chain->m_sinks.end (); i++)
+    {
+      if ((*i)->IsConnected ())
+        {
+          (*i)->m_callback ();
+        }
     }
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  Ptr<const Chain> chain = GetChain ();
+  if (chain == 0)
     {
-      (*i)(a1);
+      return;
+    }
+  for (typename SinkList::const_iterator i = chain->m_sinks.begin ();
+       i != chain->m_sinks.end (); i++)
+    {
+      if ((*i)->IsConnected ())
+        {
+          (*i)->m_callback (a1);
+        }
     }
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  Ptr<const Chain> chain = GetChain ();
+  if (chain == 0)
+    {
+      return;
+    }
+  for (typename SinkList::const_iterator i = chain->m_sinks.begin ();
+       i != chain->m_sinks.end (); i++)
     {
-      (*i)(a1, a2);
+      if ((*i)->IsConnected ())
+        {
+          (*i)->m_callback (a1, a2);
+        }
     }
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  Ptr<const Chain> chain = GetChain ();
+  if (chain == 0)
+    {
+      return;
+    }
+  for (typename SinkList::const_iterator i = chain->m_sinks.begin ();
+       i != chain->m_sinks.end (); i++)
     {
-      (*i)(a1, a2, a3);
+      if ((*i)->IsConnected ())
+        {
+          (*i)->m_callback (a1, a2, a3);
+        }
     }
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  Ptr<const Chain> chain = GetChain ();
+  if (chain == 0)
     {
-      (*i)(a1, a2, a3, a4);
+      return;
+    }
+  for (typename SinkList::const_iterator i = chain->m_sinks.begin ();
+       i != chain->m_sinks.end (); i++)
+    {
+      if ((*i)->IsConnected ())
+        {
+          (*i)->m_callback (a1, a2, a3, a4);
+        }
     }
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  Ptr<const Chain> chain = GetChain ();
+  if (chain == 0)
     {
-      (*i)(a1, a2, a3, a4, a5);
+      return;
+    }
+  for (typename SinkList::const_iterator i = chain->m_sinks.begin ();
+       i != chain->m_sinks.end (); i++)
+    {
+      if ((*i)->IsConnected ())
+        {
+          (*i)->m_callback (a1, a2, a3, a4, a5);
+        }
     }
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  Ptr<const Chain> chain = GetChain ();
+  if (chain == 0)
     {
-      (*i)(a1, a2, a3, a4, a5, a6);
+      return;
+    }
+  for (typename SinkList::const_iterator i = chain->m_sinks.begin ();
+       i != chain->m_sinks.end (); i++)
+    {
+      if ((*i)->IsConnected ())
+        {
+          (*i)->m_callback (a1, a2, a3, a4, a5, a6);
+        }
     }
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  Ptr<const Chain> chain = GetChain ();
+  if (chain == 0)
+    {
+      return;
+    }
+  for (typename SinkList::const_iterator i = chain->m_sinks.begin ();
+       i != chain->m_sinks.end (); i++)
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7);
+      if ((*i)->IsConnected ())
+        {
+          (*i)->m_callback (a1, a2, a3, a4, a5, a6, a7);
+        }
     }
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  Ptr<const Chain> chain = GetChain ();
+  if (chain == 0)
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7, a8);
+      return;
+    }
+  for (typename SinkList::const_iterator i = chain->m_sinks.begin ();
+       i != chain->m_sinks.end (); i++)
+    {
+      if ((*i)->IsConnected ())
+        {
+          (*i)->m_callback (a1, a2, a3, a4, a5, a6, a7, a8);
+        }
     }
 }
 
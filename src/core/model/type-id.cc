@@ -23,6 +23,7 @@
 #include "singleton.h"
 #include "trace-source-accessor.h"
 
+#include <deque>
 #include <map>
 #include <vector>
 #include <sstream>
@@ -42,8 +43,12 @@ NS_LOG_COMPONENT_DEFINE ("TypeId");
 /**
  * \brief TypeId information manager
  *
- * Information records are stored in a vector.  Name and hash lookup
- * are performed by maps to the vector index.
+ * Information records are stored in a deque, which keeps them in
+ * place when more types are registered.  Name lookups hash the name
+ * and look the hash up in a map to the record index.  Each record
+ * also keeps the list of the attributes of the type and of all its
+ * parents, so that the attributes of an object can be found without
+ * walking its inheritance tree.
  *
  * \internal
  * <b>Hash Chaining</b>
@@ -76,7 +81,7 @@ public:
   void SetGroupName (uint16_t uid, std::string groupName);
   void AddConstructor (uint16_t uid, Callback<ObjectBase *> callback);
   void HideFromDocumentation (uint16_t uid);
-  uint16_t GetUid (std::string name) const;
+  uint16_t GetUid (const std::string &name) const;
   uint16_t GetUid (TypeId::hash_t hash) const;
   std::string GetName (uint16_t uid) const;
   TypeId::hash_t GetHash (uint16_t uid) const;
@@ -98,18 +103,23 @@ public:
                                 Ptr<const AttributeValue> initialValue);
   uint32_t GetAttributeN (uint16_t uid) const;
   struct TypeId::AttributeInformation GetAttribute(uint16_t uid, uint32_t i) const;
+  uint32_t GetAllAttributeN (uint16_t uid) const;
+  const struct TypeId::AttributeInformation & GetAllAttribute (uint16_t uid, uint32_t i, uint16_t *owner) const;
+  bool LookupAttribute (uint16_t uid, const std::string &name, struct TypeId::AttributeInformation *info) const;
   void AddTraceSource (uint16_t uid,
                        std::string name, 
                        std::string help,
                        Ptr<const TraceSourceAccessor> accessor);
   uint32_t GetTraceSourceN (uint16_t uid) const;
   struct TypeId::TraceSourceInformation GetTraceSource(uint16_t uid, uint32_t i) const;
+  Ptr<const TraceSourceAccessor> LookupTraceSource (uint16_t uid, const std::string &name) const;
   bool MustHideFromDocumentation (uint16_t uid) const;
 
 private:
   bool HasTraceSource (uint16_t uid, std::string name);
   bool HasAttribute (uint16_t uid, std::string name);
-  static TypeId::hash_t Hasher (const std::string name);
+  void UpdateAllAttributes (uint16_t uid);
+  static TypeId::hash_t Hasher (const std::string &name);
 
   struct IidInformation {
     std::string name;
@@ -121,15 +131,15 @@ private:
     bool mustHideFromDocumentation;
     std::vector<struct TypeId::AttributeInformation> attributes;
     std::vector<struct TypeId::TraceSourceInformation> traceSources;
+    // the uid and attribute index of the attributes of this type
+    // and of its parents, most derived first.
+    std::vector<std::pair<uint16_t, uint32_t> > allAttributes;
+    bool hasChildren;
   };
-  typedef std::vector<struct IidInformation>::const_iterator Iterator;
 
   struct IidManager::IidInformation *LookupInformation (uint16_t uid) const;
 
-  std::vector<struct IidInformation> m_information;
-
-  typedef std::map<std::string, uint16_t> namemap_t;
-  namemap_t m_namemap;
+  std::deque<struct IidInformation> m_information;
 
   typedef std::map<TypeId::hash_t, uint16_t> hashmap_t;
   hashmap_t m_hashmap;
@@ -147,10 +157,12 @@ IidManager::IidManager ()
 
   //static
 TypeId::hash_t
-IidManager::Hasher (const std::string name)
+IidManager::Hasher (const std::string &name)
 {
-  static ns3::Hasher hasher ( Create<Hash::Function::Murmur3> () );
-  return hasher.clear ().GetHash32 (name);
+  // a local hash function, rather than a shared Hasher,
+  // so that lookups from several threads do not race.
+  Hash::Function::Murmur3 murmur;
+  return murmur.GetHash32 (name.c_str (), name.size ());
 }
   
 uint16_t
@@ -158,7 +170,7 @@ IidManager::AllocateUid (std::string name)
 {
   NS_LOG_FUNCTION (this << name);
   // Type names are definitive: equal names are equal types
-  NS_ASSERT_MSG (m_namemap.count (name) == 0,
+  NS_ASSERT_MSG (GetUid (name) == 0,
                  "Trying to allocate twice the same uid: " << name);
   
   TypeId::hash_t hash = Hasher (name) & (~HashChainFlag);
@@ -213,12 +225,11 @@ IidManager::AllocateUid (std::string name)
   information.groupName = "";
   information.hasConstructor = false;
   information.mustHideFromDocumentation = false;
+  information.hasChildren = false;
   m_information.push_back (information);
   uint32_t uid = m_information.size ();
   NS_ASSERT (uid <= 0xffff);
 
-  // Add to both maps:
-  m_namemap.insert (std::make_pair (name, uid));
   m_hashmap.insert (std::make_pair (hash, uid));
   return uid;
 }
@@ -238,6 +249,11 @@ IidManager::SetParent (uint16_t uid, uint16_t parent)
   NS_ASSERT (parent <= m_information.size ());
   struct IidInformation *information = LookupInformation (uid);
   information->parent = parent;
+  if (parent != 0 && parent != uid)
+    {
+      LookupInformation (parent)->hasChildren = true;
+    }
+  UpdateAllAttributes (uid);
 }
 void 
 IidManager::SetGroupName (uint16_t uid, std::string groupName)
@@ -268,18 +284,22 @@ IidManager::AddConstructor (uint16_t uid, Callback<ObjectBase *> callback)
 }
 
 uint16_t 
-IidManager::GetUid (std::string name) const
+IidManager::GetUid (const std::string &name) const
 {
   NS_LOG_FUNCTION (this << name);
-  namemap_t::const_iterator it = m_namemap.find (name);
-  if (it != m_namemap.end ())
-    {
-      return it->second;
-    }
-  else
+  TypeId::hash_t hash = Hasher (name) & (~HashChainFlag);
+  // look for the type first with its own hash, then with the
+  // chained hash, in case of collision.
+  for (uint32_t chained = 0; chained < 2; chained++)
     {
-      return 0;
+      hashmap_t::const_iterator it = m_hashmap.find (hash);
+      if (it != m_hashmap.end () && LookupInformation (it->second)->name == name)
+        {
+          return it->second;
+        }
+      hash |= HashChainFlag;
     }
+  return 0;
 }
 uint16_t 
 IidManager::GetUid (TypeId::hash_t hash) const
@@ -361,27 +381,44 @@ IidManager::HasAttribute (uint16_t uid,
                           std::string name)
 {
   NS_LOG_FUNCTION (this << uid << name);
-  struct IidInformation *information  = LookupInformation (uid);
+  struct TypeId::AttributeInformation info;
+  return LookupAttribute (uid, name, &info);
+}
+
+void
+IidManager::UpdateAllAttributes (uint16_t uid)
+{
+  NS_LOG_FUNCTION (this << uid);
+  struct IidInformation *information = LookupInformation (uid);
+  information->allAttributes.clear ();
+  uint16_t current = uid;
   while (true)
     {
-      for (std::vector<struct TypeId::AttributeInformation>::const_iterator i = information->attributes.begin ();
-           i != information->attributes.end (); ++i)
+      struct IidInformation *tmp = LookupInformation (current);
+      for (uint32_t i = 0; i < tmp->attributes.size (); i++)
         {
-          if (i->name == name)
-            {
-              return true;
-            }
+          information->allAttributes.push_back (std::make_pair (current, i));
         }
-      struct IidInformation *parent = LookupInformation (information->parent);
-      if (parent == information)
+      if (tmp->parent == 0 || tmp->parent == current)
         {
           // top of inheritance tree
-          return false;
+          break;
+        }
+      current = tmp->parent;
+    }
+  if (!information->hasChildren)
+    {
+      return;
+    }
+  // attributes are rarely added to a type once other types derive
+  // from it, but the lists of these types must then be updated too.
+  for (uint32_t child = 1; child <= m_information.size (); child++)
+    {
+      if (child != uid && LookupInformation (child)->parent == uid)
+        {
+          UpdateAllAttributes (child);
         }
-      // check parent
-      information = parent;
     }
-  return false;
 }
 
 void 
@@ -409,6 +446,7 @@ IidManager::AddAttribute (uint16_t uid,
   info.accessor = accessor;
   info.checker = checker;
   information->attributes.push_back (info);
+  UpdateAllAttributes (uid);
 }
 void 
 IidManager::SetAttributeInitialValue(uint16_t uid,
@@ -438,6 +476,40 @@ IidManager::GetAttribute(uint16_t uid, uint32_t i) const
   NS_ASSERT (i < information->attributes.size ());
   return information->attributes[i];
 }
+uint32_t
+IidManager::GetAllAttributeN (uint16_t uid) const
+{
+  NS_LOG_FUNCTION (this << uid);
+  struct IidInformation *information = LookupInformation (uid);
+  return information->allAttributes.size ();
+}
+const struct TypeId::AttributeInformation &
+IidManager::GetAllAttribute (uint16_t uid, uint32_t i, uint16_t *owner) const
+{
+  NS_LOG_FUNCTION (this << uid << i << owner);
+  struct IidInformation *information = LookupInformation (uid);
+  NS_ASSERT (i < information->allAttributes.size ());
+  const std::pair<uint16_t, uint32_t> &attribute = information->allAttributes[i];
+  *owner = attribute.first;
+  return LookupInformation (attribute.first)->attributes[attribute.second];
+}
+bool
+IidManager::LookupAttribute (uint16_t uid, const std::string &name, struct TypeId::AttributeInformation *info) const
+{
+  NS_LOG_FUNCTION (this << uid << name << info);
+  struct IidInformation *information = LookupInformation (uid);
+  for (std::vector<std::pair<uint16_t, uint32_t> >::const_iterator i = information->allAttributes.begin ();
+       i != information->allAttributes.end (); ++i)
+    {
+      const struct TypeId::AttributeInformation &tmp = LookupInformation (i->first)->attributes[i->second];
+      if (tmp.name == name)
+        {
+          *info = tmp;
+          return true;
+        }
+    }
+  return false;
+}
 
 bool
 IidManager::HasTraceSource (uint16_t uid,
@@ -501,6 +573,36 @@ IidManager::GetTraceSource(uint16_t uid, uint32_t i) const
   NS_ASSERT (i < information->traceSources.size ());
   return information->traceSources[i];
 }
+Ptr<const TraceSourceAccessor>
+IidManager::LookupTraceSource (uint16_t uid, const std::string &name) const
+{
+  NS_LOG_FUNCTION (this << uid << name);
+  struct IidInformation *information = LookupInformation (uid);
+  while (true)
+    {
+      for (std::vector<struct TypeId::TraceSourceInformation>::const_iterator i = information->traceSources.begin ();
+           i != information->traceSources.end (); ++i)
+        {
+          if (i->name == name)
+            {
+              return i->accessor;
+            }
+        }
+      if (information->parent == 0)
+        {
+          return 0;
+        }
+      struct IidInformation *parent = LookupInformation (information->parent);
+      if (parent == information)
+        {
+          // top of inheritance tree
+          return 0;
+        }
+      // check parent
+      information = parent;
+    }
+  return 0;
+}
 bool 
 IidManager::MustHideFromDocumentation (uint16_t uid) const
 {
@@ -588,22 +690,7 @@ bool
 TypeId::LookupAttributeByName (std::string name, struct TypeId::AttributeInformation *info) const
 {
   NS_LOG_FUNCTION (this << name << info);
-  TypeId tid;
-  TypeId nextTid = *this;
-  do {
-      tid = nextTid;
-      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
-        {
-          struct TypeId::AttributeInformation tmp = tid.GetAttribute(i);
-          if (tmp.name == name)
-            {
-              *info = tmp;
-              return true;
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return false;
+  return Singleton<IidManager>::Get ()->LookupAttribute (m_tid, name, info);
 }
 
 TypeId 
@@ -754,6 +841,24 @@ TypeId::GetAttributeFullName (uint32_t i) const
   struct TypeId::AttributeInformation info = GetAttribute(i);
   return GetName () + "::" + info.name;
 }
+uint32_t
+TypeId::GetAllAttributeN (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return Singleton<IidManager>::Get ()->GetAllAttributeN (m_tid);
+}
+const struct TypeId::AttributeInformation &
+TypeId::GetAllAttribute (uint32_t i, TypeId *owner) const
+{
+  NS_LOG_FUNCTION (this << i << owner);
+  uint16_t uid;
+  const struct TypeId::AttributeInformation &info = Singleton<IidManager>::Get ()->GetAllAttribute (m_tid, i, &uid);
+  if (owner != 0)
+    {
+      *owner = TypeId (uid);
+    }
+  return info;
+}
 
 uint32_t 
 TypeId::GetTraceSourceN (void) const
@@ -791,21 +896,7 @@ Ptr<const TraceSourceAccessor>
 TypeId::LookupTraceSourceByName (std::string name) const
 {
   NS_LOG_FUNCTION (this << name);
-  TypeId tid;
-  TypeId nextTid = *this;
-  do {
-      tid = nextTid;
-      for (uint32_t i = 0; i < tid.GetTraceSourceN (); i++)
-        {
-          struct TypeId::TraceSourceInformation info = tid.GetTraceSource (i);
-          if (info.name == name)
-            {
-              return info.accessor;
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return 0;
+  return Singleton<IidManager>::Get ()->LookupTraceSource (m_tid, name);
 }
 
 uint16_t 
@@ -188,6 +188,25 @@ public:
    *          index is i.
    */
   std::string GetAttributeFullName (uint32_t i) const;
+  /**
+   * \returns the number of attributes associated to this TypeId
+   *          and to all its parents
+   */
+  uint32_t GetAllAttributeN (void) const;
+  /**
+   * \param i index into the attributes of this TypeId and of all its
+   *        parents: the attributes of this TypeId come first, then
+   *        those of its parent, and so on.
+   * \param owner if not zero, set to the TypeId which registered
+   *        the attribute.
+   * \returns the information associated to the attribute whose
+   *          index is i.
+   *
+   * Unlike GetAttribute, this method does not copy the information:
+   * the reference stays valid as long as no attribute is added to
+   * the owner TypeId.
+   */
+  const struct TypeId::AttributeInformation & GetAllAttribute (uint32_t i, TypeId *owner = 0) const;
 
   /**
    * \returns a callback which can be used to instanciate an object
@@ -28,6 +28,18 @@ NS_LOG_COMPONENT_DEFINE ("WallClockSynchronizer");
 
 namespace ns3 {
 
+NS_OBJECT_ENSURE_REGISTERED (WallClockSynchronizer);
+
+TypeId
+WallClockSynchronizer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::WallClockSynchronizer")
+    .SetParent<Synchronizer> ()
+    .AddConstructor<WallClockSynchronizer> ()
+  ;
+  return tid;
+}
+
 WallClockSynchronizer::WallClockSynchronizer ()
 {
   NS_LOG_FUNCTION (this);
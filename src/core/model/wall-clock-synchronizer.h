@@ -62,6 +62,8 @@ namespace ns3 {
 class WallClockSynchronizer : public Synchronizer
 {
 public:
+  static TypeId GetTypeId (void);
+
   WallClockSynchronizer ();
   virtual ~WallClockSynchronizer ();
 
@@ -27,7 +27,8 @@ namespace ns3 {
 Watchdog::Watchdog ()
   : m_impl (0),
     m_event (),
-    m_end (MicroSeconds (0))
+    m_end (MicroSeconds (0)),
+    m_entry (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -35,6 +36,7 @@ Watchdog::Watchdog ()
 Watchdog::~Watchdog ()
 {
   NS_LOG_FUNCTION (this);
+  delete m_entry;
   delete m_impl;
 }
 
@@ -43,6 +45,15 @@ Watchdog::Ping (Time delay)
 {
   NS_LOG_FUNCTION (this << delay);
   Time end = Simulator::Now () + delay;
+  if (m_entry != 0)
+    {
+      if (end > m_end || !m_entry->IsRunning ())
+        {
+          m_end = std::max (m_end, end);
+          m_entry->Schedule (m_end - Now ());
+        }
+      return;
+    }
   m_end = std::max (m_end, end);
   if (m_event.IsRunning ())
     {
@@ -59,11 +70,29 @@ Watchdog::Expire (void)
     {
       m_impl->Invoke ();
     }
+  else if (m_entry != 0)
+    {
+      m_entry->Schedule (m_end - Now ());
+    }
   else
     {
       m_event = Simulator::Schedule (m_end - Now (), &Watchdog::Expire, this);
     }
 }
 
+void
+Watchdog::SetTimerService (Ptr<TimerService> service)
+{
+  NS_LOG_FUNCTION (this << service);
+  bool running = m_event.IsRunning () || (m_entry != 0 && m_entry->IsRunning ());
+  m_event.Cancel ();
+  delete m_entry;
+  m_entry = new TimerService::Entry (service, MakeCallback (&Watchdog::Expire, this));
+  if (running)
+    {
+      m_entry->Schedule (m_end - Now ());
+    }
+}
+
 } // namespace ns3
 
@@ -22,6 +22,7 @@
 
 #include "nstime.h"
 #include "event-id.h"
+#include "timer-service.h"
 
 namespace ns3 {
 
@@ -49,6 +50,14 @@ public:
    */
   void Ping (Time delay);
 
+  /**
+   * \param service the timer wheel of this watchdog
+   *
+   * Keep this watchdog in the slots of the TimerService instead of
+   * scheduling a simulator event, which makes pinging it cheaper.
+   */
+  void SetTimerService (Ptr<TimerService> service);
+
   /**
    * \param fn the function
    *
@@ -130,6 +139,7 @@ private:
   TimerImpl *m_impl;
   EventId m_event;
   Time m_end;
+  TimerService::Entry *m_entry; //!< The watchdog in the TimerService, if any.
 };
 
 } // namespace ns3
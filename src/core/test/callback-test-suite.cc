@@ -19,6 +19,7 @@
 #include "ns3/test.h"
 #include "ns3/callback.h"
 #include <stdint.h>
+#include <cstring>
 
 using namespace ns3;
 
@@ -688,6 +689,118 @@ MakeCallbackTemplatesTestCase::DoRun (void)
   that.CheckParentalRights ();
 }
 
+// ===========================================================================
+// Test the storage of the Callback implementations
+// ===========================================================================
+class CallbackStorageTestObject : public SimpleRefCount<CallbackStorageTestObject>
+{
+public:
+  CallbackStorageTestObject () { ++m_live; }
+  ~CallbackStorageTestObject () { --m_live; }
+  int Add (int a) { return a + 1; }
+
+  static int m_live;
+};
+
+int CallbackStorageTestObject::m_live = 0;
+
+struct CallbackStorageTestLarge
+{
+  int m_values[32];
+};
+
+bool operator != (const CallbackStorageTestLarge &a, const CallbackStorageTestLarge &b)
+{
+  return std::memcmp (a.m_values, b.m_values, sizeof (a.m_values)) != 0;
+}
+
+int CallbackStorageTestTwo (Ptr<CallbackStorageTestObject> object, int b, int a) { return object->Add (a) + b; }
+int CallbackStorageTestLargeArg (CallbackStorageTestLarge large, int a) { return large.m_values[31] + a; }
+
+class CallbackStorageTestCase : public TestCase
+{
+public:
+  CallbackStorageTestCase ();
+  virtual ~CallbackStorageTestCase () {}
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param cb a Callback
+   * \return true if the implementation of cb is stored inline
+   */
+  static bool IsInline (const CallbackBase &cb);
+};
+
+CallbackStorageTestCase::CallbackStorageTestCase ()
+  : TestCase ("Check the inline and heap storage of the Callback implementations")
+{
+}
+
+bool
+CallbackStorageTestCase::IsInline (const CallbackBase &cb)
+{
+  const char *impl = reinterpret_cast<const char *> (cb.PeekImpl ());
+  const char *base = reinterpret_cast<const char *> (&cb);
+  return impl >= base && impl < base + sizeof (cb);
+}
+
+void
+CallbackStorageTestCase::DoRun (void)
+{
+  Ptr<CallbackStorageTestObject> object = Create<CallbackStorageTestObject> ();
+  Ptr<CallbackImplBase> impl;
+  {
+    Callback<int, int> a = MakeCallback (&CallbackStorageTestObject::Add, object);
+    NS_TEST_ASSERT_MSG_EQ (IsInline (a), true, "member Callback not stored inline");
+    NS_TEST_ASSERT_MSG_EQ (a (1), 2, "member Callback did not fire");
+
+    Callback<int, int> b = a;
+    NS_TEST_ASSERT_MSG_EQ (IsInline (b), true, "copied Callback not stored inline");
+    NS_TEST_ASSERT_MSG_NE (b.PeekImpl (), a.PeekImpl (), "inline Callback shared");
+    NS_TEST_ASSERT_MSG_EQ (b.IsEqual (a), true, "copied Callback not equal");
+    NS_TEST_ASSERT_MSG_EQ (b (2), 3, "copied Callback did not fire");
+
+    Callback<int, int> c = MakeBoundCallback (&CallbackStorageTestTwo, object, 10);
+    NS_TEST_ASSERT_MSG_EQ (IsInline (c), true, "two bound arguments not stored inline");
+    NS_TEST_ASSERT_MSG_EQ (c (1), 12, "bound Callback did not fire");
+    NS_TEST_ASSERT_MSG_EQ (c.IsEqual (a), false, "different Callbacks equal");
+    b = c;
+    NS_TEST_ASSERT_MSG_EQ (b.IsEqual (c), true, "assigned Callback not equal");
+    NS_TEST_ASSERT_MSG_EQ (b (1), 12, "assigned Callback did not fire");
+
+    CallbackBase base = a;
+    NS_TEST_ASSERT_MSG_EQ (c.CheckType (base), true, "Callback types not compatible");
+    c.Assign (base);
+    NS_TEST_ASSERT_MSG_EQ (c.IsEqual (a), true, "Callback not assigned");
+
+    // the impl of an inline Callback outlives it
+    impl = a.GetImpl ();
+    NS_TEST_ASSERT_MSG_EQ (impl->IsEqual (Ptr<const CallbackImplBase> (b.PeekImpl ())), false, "impl equal to another Callback");
+    NS_TEST_ASSERT_MSG_EQ (impl->IsEqual (Ptr<const CallbackImplBase> (a.PeekImpl ())), true, "impl not equal to its Callback");
+
+    b.Nullify ();
+    NS_TEST_ASSERT_MSG_EQ (b.IsNull (), true, "Nullified Callback reports not IsNull()");
+  }
+  object = 0;
+  NS_TEST_ASSERT_MSG_EQ (CallbackStorageTestObject::m_live, 1, "object released before the impl");
+  impl = 0;
+  NS_TEST_ASSERT_MSG_EQ (CallbackStorageTestObject::m_live, 0, "object not released by the Callbacks");
+
+  // large implementations are shared on the heap
+  CallbackStorageTestLarge large;
+  large.m_values[31] = 5;
+  Callback<int, int> d = MakeBoundCallback (&CallbackStorageTestLargeArg, large);
+  NS_TEST_ASSERT_MSG_EQ (IsInline (d), false, "large Callback stored inline");
+  Callback<int, int> e = d;
+  NS_TEST_ASSERT_MSG_EQ (e.PeekImpl (), d.PeekImpl (), "heap Callback not shared");
+  NS_TEST_ASSERT_MSG_EQ (e (1), 6, "heap Callback did not fire");
+  NS_TEST_ASSERT_MSG_EQ (e.GetImpl (), d.GetImpl (), "heap Callback impl copied");
+
+  Callback<int> f = e.Bind (2);
+  NS_TEST_ASSERT_MSG_EQ (f (), 7, "Bind Callback did not fire");
+}
+
 // ===========================================================================
 // The Test Suite that glues all of the Test Cases together.
 // ===========================================================================
@@ -705,6 +818,7 @@ CallbackTestSuite::CallbackTestSuite ()
   AddTestCase (new MakeBoundCallbackTestCase, TestCase::QUICK);
   AddTestCase (new NullifyCallbackTestCase, TestCase::QUICK);
   AddTestCase (new MakeCallbackTemplatesTestCase, TestCase::QUICK);
+  AddTestCase (new CallbackStorageTestCase, TestCase::QUICK);
 }
 
 static CallbackTestSuite CallbackTestSuite;
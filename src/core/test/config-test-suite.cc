@@ -27,6 +27,7 @@
 #include "ns3/singleton.h"
 #include "ns3/object.h"
 #include "ns3/object-vector.h"
+#include "ns3/object-map.h"
 #include "ns3/names.h"
 #include "ns3/pointer.h"
 #include "ns3/log.h"
@@ -46,6 +47,7 @@ public:
 
   void AddNodeA (Ptr<ConfigTestObject> a);
   void AddNodeB (Ptr<ConfigTestObject> b);
+  void AddNodeMap (uint32_t key, Ptr<ConfigTestObject> node);
 
   void SetNodeA (Ptr<ConfigTestObject> a);
   void SetNodeB (Ptr<ConfigTestObject> b);
@@ -56,6 +58,7 @@ public:
 private:
   std::vector<Ptr<ConfigTestObject> > m_nodesA;
   std::vector<Ptr<ConfigTestObject> > m_nodesB;
+  std::map<uint32_t, Ptr<ConfigTestObject> > m_nodesMap;
   Ptr<ConfigTestObject> m_nodeA;
   Ptr<ConfigTestObject> m_nodeB;
   int8_t m_a;
@@ -76,6 +79,10 @@ ConfigTestObject::GetTypeId (void)
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&ConfigTestObject::m_nodesB),
                    MakeObjectVectorChecker<ConfigTestObject> ())
+    .AddAttribute ("NodesMap", "",
+                   ObjectMapValue (),
+                   MakeObjectMapAccessor (&ConfigTestObject::m_nodesMap),
+                   MakeObjectMapChecker<ConfigTestObject> ())
     .AddAttribute ("NodeA", "",
                    PointerValue (),
                    MakePointerAccessor (&ConfigTestObject::m_nodeA),
@@ -126,6 +133,12 @@ ConfigTestObject::AddNodeB (Ptr<ConfigTestObject> b)
   m_nodesB.push_back (b);
 }
 
+void
+ConfigTestObject::AddNodeMap (uint32_t key, Ptr<ConfigTestObject> node)
+{
+  m_nodesMap[key] = node;
+}
+
 int8_t 
 ConfigTestObject::GetA (void) const
 {
@@ -521,6 +534,118 @@ ObjectVectorConfigTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (iv.Get (), -16, "Object Attribute \"A\" not set as expected");
 }
 
+// ===========================================================================
+// Test for the ability to configure maps of objects with sparse indexes,
+// and to find the objects added after a path was first resolved.
+// ===========================================================================
+class ObjectMapConfigTestCase : public TestCase
+{
+public:
+  ObjectMapConfigTestCase ();
+  virtual ~ObjectMapConfigTestCase () {}
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the value of the attribute "A" of the objects of the map.
+   *
+   * \param [in] expected the expected values, in the order of the keys.
+   */
+  void CheckA (const int8_t expected[]);
+
+  std::vector<Ptr<ConfigTestObject> > m_objects; //!< The objects of the map.
+};
+
+ObjectMapConfigTestCase::ObjectMapConfigTestCase ()
+  : TestCase ("Check ability to configure maps of Object with sparse indexes")
+{
+}
+
+void
+ObjectMapConfigTestCase::CheckA (const int8_t expected[])
+{
+  for (uint32_t i = 0; i < m_objects.size (); ++i)
+    {
+      IntegerValue iv;
+      m_objects[i]->GetAttribute ("A", iv);
+      NS_TEST_ASSERT_MSG_EQ ((int)iv.Get (), (int)expected[i], "Object Attribute \"A\" of object " << i << " not as expected");
+    }
+}
+
+void
+ObjectMapConfigTestCase::DoRun (void)
+{
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject> ();
+  root->SetNodeA (a);
+
+  //
+  // Add four objects with sparse keys to the ObjectMap Attribute.
+  //
+  uint32_t keys[] = { 2, 7, 40, 1000 };
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      m_objects.push_back (CreateObject<ConfigTestObject> ());
+      a->AddNodeMap (keys[i], m_objects[i]);
+    }
+
+  //
+  // The indexes are the keys of the map, not the positions in it.
+  //
+  Config::Set ("/NodeA/NodesMap/7/A", IntegerValue (-11));
+  int8_t expected1[] = { 10, -11, 10, 10 };
+  CheckA (expected1);
+
+  Config::Set ("/NodeA/NodesMap/0|1|2|3/A", IntegerValue (-12));
+  int8_t expected2[] = { -12, -11, 10, 10 };
+  CheckA (expected2);
+
+  //
+  // Small and large ranges, which are resolved differently.
+  //
+  Config::Set ("/NodeA/NodesMap/[5-50]/A", IntegerValue (-13));
+  int8_t expected3[] = { -12, -13, -13, 10 };
+  CheckA (expected3);
+
+  Config::Set ("/NodeA/NodesMap/[3-100000]/A", IntegerValue (-14));
+  int8_t expected4[] = { -12, -14, -14, -14 };
+  CheckA (expected4);
+
+  Config::Set ("/NodeA/NodesMap/[0-6]|1000/A", IntegerValue (-15));
+  int8_t expected5[] = { -15, -14, -14, -15 };
+  CheckA (expected5);
+
+  Config::MatchContainer matches = Config::LookupMatches ("/NodeA/NodesMap/*");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 4, "Wrong number of objects in the map");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (3), "/NodeA/NodesMap/1000/", "Wrong path of the last object of the map");
+
+  //
+  // The objects added after a path was resolved are found by the same path.
+  //
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/NodeA/NodesMap/[5-50]").GetN (), 2, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/NodeA/NodesMap/30").GetN (), 0, "Unexpected match");
+  m_objects.insert (m_objects.begin () + 2, CreateObject<ConfigTestObject> ());
+  a->AddNodeMap (30, m_objects[2]);
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/NodeA/NodesMap/[5-50]").GetN (), 3, "Added object not matched");
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/NodeA/NodesMap/30").GetN (), 1, "Added object not matched");
+  Config::Set ("/NodeA/NodesMap/[5-50]/A", IntegerValue (-16));
+  int8_t expected6[] = { -15, -16, -16, -16, -15 };
+  CheckA (expected6);
+
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/NodeA/NodesA/1").GetN (), 0, "Unexpected match");
+  Ptr<ConfigTestObject> obj0 = CreateObject<ConfigTestObject> ();
+  Ptr<ConfigTestObject> obj1 = CreateObject<ConfigTestObject> ();
+  a->AddNodeA (obj0);
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/NodeA/NodesA/1").GetN (), 0, "Unexpected match");
+  a->AddNodeA (obj1);
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/NodeA/NodesA/1").GetN (), 1, "Added object not matched");
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/NodeA/NodesA/1").Get (0), obj1, "Wrong object matched");
+
+  m_objects.clear ();
+  Config::UnregisterRootNamespaceObject (root);
+}
+
 // ===========================================================================
 // Test for the ability to trace configure with vectors of objects.
 // ===========================================================================
@@ -735,6 +860,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new RootNamespaceConfigTestCase, TestCase::QUICK);
   AddTestCase (new UnderRootNamespaceConfigTestCase, TestCase::QUICK);
   AddTestCase (new ObjectVectorConfigTestCase, TestCase::QUICK);
+  AddTestCase (new ObjectMapConfigTestCase, TestCase::QUICK);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase, TestCase::QUICK);
 }
 
@@ -209,6 +209,97 @@ Murmur3TestCase::DoRun (void)
 }
 
 
+//----------------------------
+//
+// Test xxHash on the reference test vectors
+
+class XxHashTestCase : public HashTestCase
+{
+public:
+  XxHashTestCase ();
+  virtual ~XxHashTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+XxHashTestCase::XxHashTestCase ()
+  : HashTestCase ("XxHash: ")
+{
+}
+
+XxHashTestCase::~XxHashTestCase ()
+{
+}
+
+void
+XxHashTestCase::DoRun (void)
+{
+  Hasher hasher = Hasher ( Create<Hash::Function::XxHash> () );
+
+  hash32Reference = 0x02cc5d05;  // XXH32("")
+  Check ( "xxhash", hasher.clear ().GetHash32 ("", 0));
+  hash64Reference = 0xef46db3751d8e999ULL;  // XXH64("")
+  Check ( "xxhash", hasher.clear ().GetHash64 ("", 0));
+
+  hash32Reference = 0x32d153ff;  // XXH32("abc")
+  Check ( "xxhash", hasher.clear ().GetHash32 ("abc"));
+  hash64Reference = 0x44bc2cf5ad770999ULL;  // XXH64("abc")
+  Check ( "xxhash", hasher.clear ().GetHash64 ("abc"));
+
+  // Long enough for the four lanes of both
+  std::string spam = "Nobody inspects the spammish repetition";
+  hash32Reference = 0xe2293b2f;  // XXH32(spam)
+  Check ( "xxhash", hasher.clear ().GetHash32 (spam));
+  hash64Reference = 0xfbcea83c8a378bf1ULL;  // XXH64(spam)
+  Check ( "xxhash", hasher.clear ().GetHash64 (spam));
+}
+
+
+//----------------------------
+//
+// Test CRC32C on the reference check value
+
+class Crc32cTestCase : public HashTestCase
+{
+public:
+  Crc32cTestCase ();
+  virtual ~Crc32cTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+Crc32cTestCase::Crc32cTestCase ()
+  : HashTestCase ("Crc32c: ")
+{
+}
+
+Crc32cTestCase::~Crc32cTestCase ()
+{
+}
+
+void
+Crc32cTestCase::DoRun (void)
+{
+  Hasher hasher = Hasher ( Create<Hash::Function::Crc32c> () );
+  std::cout << GetName () << "using the "
+            << (Hash::Function::Crc32c::IsAccelerated () ? "SSE4.2" : "software")
+            << " implementation" << std::endl;
+
+  hash32Reference = 0xe3069283;  // CRC32C("123456789")
+  Check ( "crc32c", hasher.clear ().GetHash32 ("123456789"));
+
+  // 32 bytes of zeros, from RFC 3720, B.4
+  std::string zeros (32, '\0');
+  hash32Reference = 0x8a9136aa;
+  Check ( "crc32c", hasher.clear ().GetHash32 (zeros));
+
+  // 32 bytes of 0xff, from RFC 3720, B.4
+  std::string ones (32, '\xff');
+  hash32Reference = 0x62a8ab43;
+  Check ( "crc32c", hasher.clear ().GetHash32 (ones));
+}
+
+
 //----------------------------
 //
 // Test Hash32Function_ptr/Hash64Function_ptr
@@ -361,6 +452,8 @@ IncrementalTestCase::DoRun (void)
   DoHash ( "default", Hasher ( ) );
   DoHash ( "murmur3", Hasher ( Create<Hash::Function::Murmur3> () ) );
   DoHash ( "FNV1a",   Hasher ( Create<Hash::Function::Fnv1a> () ) );
+  DoHash ( "xxhash",  Hasher ( Create<Hash::Function::XxHash> () ) );
+  DoHash ( "crc32c",  Hasher ( Create<Hash::Function::Crc32c> () ) );
 }
 
 
@@ -379,6 +472,8 @@ HashTestSuite::HashTestSuite ()
   AddTestCase (new DefaultHashTestCase, QUICK);
   AddTestCase (new Murmur3TestCase, QUICK);
   AddTestCase (new Fnv1aTestCase, QUICK);
+  AddTestCase (new XxHashTestCase, QUICK);
+  AddTestCase (new Crc32cTestCase, QUICK);
   AddTestCase (new IncrementalTestCase, QUICK);
   AddTestCase (new Hash32FunctionPtrTestCase, QUICK);
   AddTestCase (new Hash64FunctionPtrTestCase, QUICK);
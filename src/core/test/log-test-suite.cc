@@ -0,0 +1,358 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// a file-local context, as for the MAC models
+#define NS_LOG_APPEND_CONTEXT if (m_id != 0) { std::clog << "[id=" << m_id << "] "; }
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#include "ns3/core-config.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/log.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#ifdef HAVE_PTHREAD_H
+#include <unistd.h>
+#include <sys/wait.h>
+#include "ns3/system-thread.h"
+#endif
+
+NS_LOG_COMPONENT_DEFINE ("LogTestSuite");
+
+using namespace ns3;
+
+class LogBinaryTestCase : public TestCase
+{
+public:
+  LogBinaryTestCase ();
+  virtual ~LogBinaryTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /** Log some messages with all the macros. */
+  void LogMessages (void);
+  /**
+   * Log the messages to std::clog and to a binary log file, and check
+   * that the file is printed as std::clog.
+   *
+   * \param [in] bufferSize the size of the buffer of the binary log.
+   * \param [in] repeat the number of times LogMessages is called.
+   */
+  void Check (uint32_t bufferSize, uint32_t repeat);
+
+  uint32_t m_id;  //!< The file-local context.
+};
+
+LogBinaryTestCase::LogBinaryTestCase ()
+  : TestCase ("Check that the binary log files are printed as the text logs"),
+    m_id (0)
+{
+}
+
+LogBinaryTestCase::~LogBinaryTestCase ()
+{
+}
+
+void
+LogBinaryTestCase::LogMessages (void)
+{
+  NS_LOG_FUNCTION (this << 3 << -4 << "abc" << Seconds (1.5));
+  NS_LOG_FUNCTION_NOARGS ();
+  NS_LOG_INFO ("int " << -12345678 << " unsigned " << 42u << " size " << sizeof (m_id)
+               << " bool " << true << " double " << 0.1 << " float " << 2.5f);
+  NS_LOG_DEBUG ("char " << 'x' << " uint8_t " << static_cast<uint8_t> ('y')
+                << " string " << std::string ("def") << " time " << MilliSeconds (3));
+  char buffer[] = "buffer";
+  Ptr<Object> object;
+  NS_LOG_LOGIC ("char[] " << buffer << " pointer " << this << " null " << object
+                << " hex " << std::hex << 255 << " " << 1.25 << std::dec);
+  NS_LOG_WARN ("setw [" << std::setw (6) << 17 << "] " << std::setprecision (3) << 3.14159);
+  NS_LOG_ERROR ("");
+}
+
+void
+LogBinaryTestCase::Check (uint32_t bufferSize, uint32_t repeat)
+{
+  std::ostringstream text;
+  std::streambuf *clog = std::clog.rdbuf (text.rdbuf ());
+  for (uint32_t i = 0; i < repeat; ++i)
+    {
+      LogMessages ();
+    }
+  std::clog.rdbuf (clog);
+
+  std::string filename = CreateTempDirFilename ("log-binary");
+  LogSetBinaryFile (filename, bufferSize);
+  NS_TEST_ASSERT_MSG_EQ (LogIsBinary (), true, "binary log not opened");
+  for (uint32_t i = 0; i < repeat; ++i)
+    {
+      LogMessages ();
+    }
+  // as NS_FATAL_ERROR, before the file is closed
+  FatalImpl::FlushStreams ();
+  std::ifstream fatal (filename.c_str (), std::ios::binary);
+  std::ostringstream flushed;
+  NS_TEST_ASSERT_MSG_EQ (LogPrintBinary (fatal, flushed), true, "flushed binary log not read back");
+  NS_TEST_ASSERT_MSG_EQ (flushed.str (), text.str (), "binary log not flushed on fatal errors");
+  LogSetBinaryFile ("");
+  NS_TEST_ASSERT_MSG_EQ (LogIsBinary (), false, "binary log not closed");
+
+  std::ifstream is (filename.c_str (), std::ios::binary);
+  std::ostringstream binary;
+  NS_TEST_ASSERT_MSG_EQ (LogPrintBinary (is, binary), true, "binary log not read back");
+  NS_TEST_ASSERT_MSG_EQ (binary.str (), text.str (), "binary log printed differently");
+}
+
+void
+LogBinaryTestCase::DoRun (void)
+{
+  g_log.Enable (LOG_LEVEL_ALL);
+  Check (1 << 16, 1);
+  g_log.Enable (LOG_PREFIX_ALL);
+  Check (1 << 16, 1);
+
+  // with the simulation time and the context of an event
+  m_id = 7;
+  Simulator::ScheduleWithContext (3, Seconds (2.5), &LogBinaryTestCase::Check, this, 1 << 16, 1);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // messages larger than the buffer
+  Check (64, 100);
+  g_log.Disable (LOG_ALL);
+}
+
+#ifdef HAVE_PTHREAD_H
+class LogBinaryThreadsTestCase : public TestCase
+{
+public:
+  static const uint32_t N_THREADS = 4;
+  static const uint32_t N_MESSAGES = 2000;
+  static const uint32_t BUFFER_SIZE = 256;
+
+  LogBinaryThreadsTestCase ();
+  virtual ~LogBinaryThreadsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /** Log the messages of the next thread. */
+  void LogMessages (void);
+
+  uint32_t m_id;       //!< The file-local context.
+  uint32_t m_threads;  //!< The number of threads started so far.
+};
+
+LogBinaryThreadsTestCase::LogBinaryThreadsTestCase ()
+  : TestCase ("Check the binary log files written by several threads"),
+    m_id (0),
+    m_threads (0)
+{
+}
+
+LogBinaryThreadsTestCase::~LogBinaryThreadsTestCase ()
+{
+}
+
+void
+LogBinaryThreadsTestCase::LogMessages (void)
+{
+  uint32_t thread = __sync_fetch_and_add (&m_threads, 1);
+  // some messages are larger than the buffer
+  std::string large (BUFFER_SIZE + 44, 'a' + thread);
+  for (uint32_t i = 0; i < N_MESSAGES; ++i)
+    {
+      NS_LOG_INFO ("thread " << thread << " message " << i << " " << (i % 100 == 0 ? large : ""));
+    }
+}
+
+void
+LogBinaryThreadsTestCase::DoRun (void)
+{
+  g_log.Disable (LOG_ALL);
+  g_log.Disable (LOG_PREFIX_ALL);
+  g_log.Enable (LOG_LEVEL_INFO);
+  std::string filename = CreateTempDirFilename ("log-binary-threads");
+  LogSetBinaryFile (filename, BUFFER_SIZE);
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t t = 0; t < N_THREADS; ++t)
+    {
+      threads.push_back (Create<SystemThread> (MakeCallback (&LogBinaryThreadsTestCase::LogMessages, this)));
+      threads.back ()->Start ();
+    }
+  for (uint32_t t = 0; t < N_THREADS; ++t)
+    {
+      threads[t]->Join ();
+    }
+  LogSetBinaryFile ("");
+  g_log.Disable (LOG_ALL);
+
+  // each message is whole, and the messages of each thread are in order
+  std::ifstream is (filename.c_str (), std::ios::binary);
+  std::stringstream text;
+  NS_TEST_ASSERT_MSG_EQ (LogPrintBinary (is, text), true, "binary log not read back");
+  std::vector<uint32_t> next (N_THREADS, 0);
+  std::string word, rest;
+  uint32_t thread, message;
+  while (text >> word >> thread >> word >> message)
+    {
+      std::getline (text, rest);
+      NS_TEST_ASSERT_MSG_LT (thread, N_THREADS, "wrong thread");
+      NS_TEST_ASSERT_MSG_EQ (message, next[thread], "wrong message of thread " << thread);
+      std::string large = message % 100 == 0 ? std::string (BUFFER_SIZE + 44, 'a' + thread) : "";
+      NS_TEST_ASSERT_MSG_EQ (rest, " " + large, "wrong message " << message << " of thread " << thread);
+      next[thread]++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (text.eof (), true, "wrong line in the binary log");
+  for (uint32_t t = 0; t < N_THREADS; ++t)
+    {
+      NS_TEST_ASSERT_MSG_EQ (next[t], N_MESSAGES, "missing messages of thread " << t);
+    }
+}
+
+class LogBinaryForkTestCase : public TestCase
+{
+public:
+  LogBinaryForkTestCase ();
+  virtual ~LogBinaryForkTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param [in] filename the binary log file.
+   * \return the messages of the file.
+   */
+  std::string Print (std::string filename);
+
+  uint32_t m_id;  //!< The file-local context.
+};
+
+LogBinaryForkTestCase::LogBinaryForkTestCase ()
+  : TestCase ("Check that a child process writes its own binary log file"),
+    m_id (0)
+{
+}
+
+LogBinaryForkTestCase::~LogBinaryForkTestCase ()
+{
+}
+
+std::string
+LogBinaryForkTestCase::Print (std::string filename)
+{
+  std::ifstream is (filename.c_str (), std::ios::binary);
+  std::ostringstream text;
+  if (!LogPrintBinary (is, text))
+    {
+      return "not a binary log file";
+    }
+  return text.str ();
+}
+
+void
+LogBinaryForkTestCase::DoRun (void)
+{
+  g_log.Disable (LOG_ALL);
+  g_log.Disable (LOG_PREFIX_ALL);
+  g_log.Enable (LOG_LEVEL_INFO);
+  std::string filename = CreateTempDirFilename ("log-binary-fork");
+  LogSetBinaryFile (filename);
+  NS_LOG_INFO ("before the fork");
+  pid_t pid = fork ();
+  if (pid == 0)
+    {
+      NS_LOG_INFO ("in the child");
+      // as ParameterSweep::Report
+      LogSetBinaryFile ("");
+      _exit (0);
+    }
+  NS_TEST_ASSERT_MSG_GT (pid, 0, "fork failed");
+  int status;
+  waitpid (pid, &status, 0);
+  NS_LOG_INFO ("in the parent");
+  LogSetBinaryFile ("");
+  g_log.Disable (LOG_ALL);
+
+  std::ostringstream child;
+  child << filename << "." << pid;
+  NS_TEST_ASSERT_MSG_EQ (Print (filename), "before the fork\nin the parent\n", "wrong binary log of the parent");
+  NS_TEST_ASSERT_MSG_EQ (Print (child.str ()), "in the child\n", "wrong binary log of the child");
+}
+#endif /* HAVE_PTHREAD_H */
+
+class LogWhitelistTestCase : public TestCase
+{
+public:
+  LogWhitelistTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LogWhitelistTestCase::LogWhitelistTestCase ()
+  : TestCase ("Check the compile-time lookup of the log component whitelist")
+{
+}
+
+void
+LogWhitelistTestCase::DoRun (void)
+{
+  static constexpr const char *whitelist[] = { "Ipv4L3Protocol", "Consumer", "Producer" };
+  // evaluated by the compiler
+  static_assert (LogComponentIsListed ("Consumer", whitelist, 3),
+                 "A whitelisted component is not found");
+  static_assert (!LogComponentIsListed ("ConsumerCbr", whitelist, 3),
+                 "A component is found by a prefix of its name");
+
+  NS_TEST_EXPECT_MSG_EQ (LogComponentIsListed ("Ipv4L3Protocol", whitelist, 3), true,
+                         "The first component is not found");
+  NS_TEST_EXPECT_MSG_EQ (LogComponentIsListed ("Producer", whitelist, 3), true,
+                         "The last component is not found");
+  NS_TEST_EXPECT_MSG_EQ (LogComponentIsListed ("Ipv4", whitelist, 3), false,
+                         "A component is found by a prefix of a whitelisted name");
+  NS_TEST_EXPECT_MSG_EQ (LogComponentIsListed ("", whitelist, 3), false,
+                         "The empty name is found");
+  NS_TEST_EXPECT_MSG_EQ (LogComponentIsListed ("Producer", whitelist, 2), false,
+                         "A component beyond the size of the list is found");
+  NS_TEST_EXPECT_MSG_EQ (LogComponentIsListed ("Producer", whitelist, 0), false,
+                         "A component is found in an empty list");
+}
+
+class LogTestSuite : public TestSuite
+{
+public:
+  LogTestSuite ();
+};
+
+LogTestSuite::LogTestSuite ()
+  : TestSuite ("log", UNIT)
+{
+#ifdef NS3_LOG_ENABLE
+  AddTestCase (new LogBinaryTestCase, TestCase::QUICK);
+#ifdef HAVE_PTHREAD_H
+  AddTestCase (new LogBinaryThreadsTestCase, TestCase::QUICK);
+  AddTestCase (new LogBinaryForkTestCase, TestCase::QUICK);
+#endif
+#endif
+  AddTestCase (new LogWhitelistTestCase, TestCase::QUICK);
+}
+
+static LogTestSuite logTestSuite;
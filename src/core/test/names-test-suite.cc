@@ -919,6 +919,85 @@ AlternateFindTestCase::DoRun (void)
                          "Unexpectedly able to GetObject<TestObject> on an AlternateTestObject");
 }
 
+// ===========================================================================
+// Test case to make sure that the paths already found by Names::Find are
+// forgotten when a name in the path changes, or when the names are cleared.
+// ===========================================================================
+class CachedFindTestCase : public TestCase
+{
+public:
+  CachedFindTestCase ();
+  virtual ~CachedFindTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+CachedFindTestCase::CachedFindTestCase ()
+  : TestCase ("Check Names::Find of the same paths after Names::Rename and Names::Clear")
+{
+}
+
+CachedFindTestCase::~CachedFindTestCase ()
+{
+}
+
+void
+CachedFindTestCase::DoTeardown (void)
+{
+  Names::Clear ();
+}
+
+void
+CachedFindTestCase::DoRun (void)
+{
+  Ptr<TestObject> found;
+
+  Ptr<TestObject> client = CreateObject<TestObject> ();
+  Names::Add ("Client", client);
+
+  Ptr<TestObject> clientEth0 = CreateObject<TestObject> ();
+  Names::Add ("Client/eth0", clientEth0);
+
+  found = Names::Find<TestObject> ("/Names/Client/eth0");
+  NS_TEST_ASSERT_MSG_EQ (found, clientEth0, "Could not find a previously named Object via a fully qualified path");
+
+  found = Names::Find<TestObject> ("Client/eth0");
+  NS_TEST_ASSERT_MSG_EQ (found, clientEth0, "Could not find a previously named Object via a relative path");
+
+  found = Names::Find<TestObject> ("Client/eth1");
+  NS_TEST_ASSERT_MSG_EQ (found, 0, "Unexpectedly found a non-existent Object");
+
+  Ptr<TestObject> clientEth1 = CreateObject<TestObject> ();
+  Names::Add ("Client/eth1", clientEth1);
+
+  found = Names::Find<TestObject> ("Client/eth1");
+  NS_TEST_ASSERT_MSG_EQ (found, clientEth1, "Could not find an Object named after a failed search");
+
+  Names::Rename ("Client", "Server");
+
+  found = Names::Find<TestObject> ("/Names/Client/eth0");
+  NS_TEST_ASSERT_MSG_EQ (found, 0, "Unexpectedly found an Object under a renamed path");
+
+  found = Names::Find<TestObject> ("Server/eth0");
+  NS_TEST_ASSERT_MSG_EQ (found, clientEth0, "Could not find an Object under a renamed path");
+
+  Ptr<TestObject> newClient = CreateObject<TestObject> ();
+  Names::Add ("Client", newClient);
+
+  Ptr<TestObject> newClientEth0 = CreateObject<TestObject> ();
+  Names::Add ("Client/eth0", newClientEth0);
+
+  found = Names::Find<TestObject> ("Client/eth0");
+  NS_TEST_ASSERT_MSG_EQ (found, newClientEth0, "Found the Object previously named by the same path");
+
+  Names::Clear ();
+
+  found = Names::Find<TestObject> ("Server/eth0");
+  NS_TEST_ASSERT_MSG_EQ (found, 0, "Unexpectedly found an Object after Names::Clear");
+}
+
 class NamesTestSuite : public TestSuite
 {
 public:
@@ -942,6 +1021,7 @@ NamesTestSuite::NamesTestSuite ()
   AddTestCase (new FullyQualifiedFindTestCase, TestCase::QUICK);
   AddTestCase (new RelativeFindTestCase, TestCase::QUICK);
   AddTestCase (new AlternateFindTestCase, TestCase::QUICK);
+  AddTestCase (new CachedFindTestCase, TestCase::QUICK);
 }
 
 static NamesTestSuite namesTestSuite;
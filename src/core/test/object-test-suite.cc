@@ -18,10 +18,17 @@
  * Authors: Gustavo Carneiro <gjcarneiro@gmail.com>,
  *          Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
+#include "ns3/core-config.h"
 #include "ns3/test.h"
 #include "ns3/object.h"
 #include "ns3/object-factory.h"
+#include "ns3/random-variable-stream.h"
 #include "ns3/assert.h"
+#ifdef NS3_MULTITHREADED
+#include "ns3/system-thread.h"
+#endif
+
+#include <vector>
 
 namespace {
 
@@ -335,6 +342,176 @@ AggregateObjectTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_NE (baseA, 0, "Unable to GetObject on released object");
 }
 
+// ===========================================================================
+// Test case to make sure that the lookups of GetObject stay right once
+// their results are cached
+// ===========================================================================
+class GetObjectCacheTestCase : public TestCase
+{
+public:
+  GetObjectCacheTestCase ();
+  virtual ~GetObjectCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+GetObjectCacheTestCase::GetObjectCacheTestCase ()
+  : TestCase ("Check GetObject after the aggregates change")
+{
+}
+
+GetObjectCacheTestCase::~GetObjectCacheTestCase ()
+{
+}
+
+void
+GetObjectCacheTestCase::DoRun (void)
+{
+  //
+  // Aggregate many objects of different types, and look them up twice,
+  // the second time from the cache.
+  //
+  ObjectFactory factory;
+  std::vector<TypeId> tids;
+  std::vector<Ptr<Object> > objects;
+  for (uint32_t i = 0; i < TypeId::GetRegisteredN (); ++i)
+    {
+      TypeId tid = TypeId::GetRegistered (i);
+      if (tid.HasConstructor () && tid.IsChildOf (RandomVariableStream::GetTypeId ()))
+        {
+          factory.SetTypeId (tid);
+          Ptr<Object> object = factory.Create ();
+          tids.push_back (tid);
+          objects.push_back (object);
+          if (objects.size () > 1)
+            {
+              objects[0]->AggregateObject (object);
+            }
+        }
+    }
+  for (uint32_t k = 0; k < 2; ++k)
+    {
+      for (uint32_t i = 0; i < tids.size (); ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (objects[0]->GetObject<Object> (tids[i]), objects[i],
+                                 "Wrong aggregate for " << tids[i].GetName ());
+          NS_TEST_ASSERT_MSG_EQ (objects[i]->GetObject<Object> (tids[0]), objects[0],
+                                 "Wrong aggregate for " << tids[0].GetName ());
+        }
+    }
+
+  //
+  // A type which was not found must be found once it is aggregated.
+  //
+  Ptr<BaseA> baseA = CreateObject<BaseA> ();
+  Ptr<DerivedB> derivedB = CreateObject<DerivedB> ();
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), 0, "Unexpectedly found a BaseB through baseA");
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), 0, "Unexpectedly found a BaseB through baseA");
+  baseA->AggregateObject (derivedB);
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), derivedB, "Cannot GetObject (through baseA) for BaseB Object");
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<DerivedB> (), derivedB, "Cannot GetObject (through baseA) for DerivedB Object");
+  NS_TEST_ASSERT_MSG_EQ (derivedB->GetObject<BaseA> (), baseA, "Cannot GetObject (through derivedB) for BaseA Object");
+}
+
+#ifdef NS3_MULTITHREADED
+// ===========================================================================
+// Test case to make sure that the threads of the multithreaded simulator
+// can look up the same aggregates at the same time
+// ===========================================================================
+class GetObjectThreadsTestCase : public TestCase
+{
+public:
+  static const uint32_t N_THREADS = 4;
+  static const uint32_t N_AGGREGATES = 200;
+
+  GetObjectThreadsTestCase ();
+  virtual ~GetObjectThreadsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Look up every type in every aggregate, in an order which depends
+   * on the thread, and count the wrong results.
+   */
+  void LookUp (void);
+
+  std::vector<TypeId> m_tids;                       //!< The aggregated types.
+  std::vector<std::vector<Ptr<Object> > > m_objects; //!< The aggregates.
+  uint32_t m_errors[N_THREADS];                     //!< The wrong results of each thread.
+  uint32_t m_started;                               //!< The number of threads started.
+};
+
+GetObjectThreadsTestCase::GetObjectThreadsTestCase ()
+  : TestCase ("Check GetObject from several threads")
+{
+}
+
+GetObjectThreadsTestCase::~GetObjectThreadsTestCase ()
+{
+}
+
+void
+GetObjectThreadsTestCase::LookUp (void)
+{
+  uint32_t thread = __sync_fetch_and_add (&m_started, 1);
+  m_errors[thread] = 0;
+  for (uint32_t j = 0; j < N_AGGREGATES; ++j)
+    {
+      for (uint32_t k = 0; k < m_tids.size (); ++k)
+        {
+          uint32_t i = (k * (thread + 1)) % m_tids.size ();
+          if (m_objects[j][0]->GetObject<Object> (m_tids[i]) != m_objects[j][i])
+            {
+              m_errors[thread]++;
+            }
+        }
+    }
+}
+
+void
+GetObjectThreadsTestCase::DoRun (void)
+{
+  ObjectFactory factory;
+  for (uint32_t i = 0; i < TypeId::GetRegisteredN (); ++i)
+    {
+      TypeId tid = TypeId::GetRegistered (i);
+      if (tid.HasConstructor () && tid.IsChildOf (RandomVariableStream::GetTypeId ()))
+        {
+          m_tids.push_back (tid);
+        }
+    }
+  // fresh aggregates, so that the threads fill their caches together
+  m_objects.resize (N_AGGREGATES);
+  for (uint32_t j = 0; j < N_AGGREGATES; ++j)
+    {
+      for (uint32_t i = 0; i < m_tids.size (); ++i)
+        {
+          factory.SetTypeId (m_tids[i]);
+          m_objects[j].push_back (factory.Create ());
+          if (i > 0)
+            {
+              m_objects[j][0]->AggregateObject (m_objects[j][i]);
+            }
+        }
+    }
+
+  m_started = 0;
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t t = 0; t < N_THREADS; ++t)
+    {
+      threads.push_back (Create<SystemThread> (MakeCallback (&GetObjectThreadsTestCase::LookUp, this)));
+      threads.back ()->Start ();
+    }
+  for (uint32_t t = 0; t < N_THREADS; ++t)
+    {
+      threads[t]->Join ();
+      NS_TEST_EXPECT_MSG_EQ (m_errors[t], 0, "Wrong aggregates found by thread " << t);
+    }
+  m_objects.clear ();
+}
+#endif /* NS3_MULTITHREADED */
+
 // ===========================================================================
 // Test case to make sure that an Object factory can create Objects
 // ===========================================================================
@@ -421,6 +598,10 @@ ObjectTestSuite::ObjectTestSuite ()
 {
   AddTestCase (new CreateObjectTestCase, TestCase::QUICK);
   AddTestCase (new AggregateObjectTestCase, TestCase::QUICK);
+  AddTestCase (new GetObjectCacheTestCase, TestCase::QUICK);
+#ifdef NS3_MULTITHREADED
+  AddTestCase (new GetObjectThreadsTestCase, TestCase::QUICK);
+#endif
   AddTestCase (new ObjectFactoryTestCase, TestCase::QUICK);
 }
 
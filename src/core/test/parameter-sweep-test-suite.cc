@@ -0,0 +1,128 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/parameter-sweep.h"
+#include "ns3/simulator.h"
+#include "ns3/object.h"
+#include "ns3/uinteger.h"
+#include "ns3/names.h"
+#include "ns3/test.h"
+
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * Adds its Increment attribute to its total every second.
+ */
+class SweepAccumulator : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+  SweepAccumulator ();
+  void Tick (void);
+  uint32_t m_increment;
+  uint32_t m_total;
+};
+
+TypeId
+SweepAccumulator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SweepAccumulator")
+    .SetParent<Object> ()
+    .AddConstructor<SweepAccumulator> ()
+    .AddAttribute ("Increment", "Added to the total every second",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&SweepAccumulator::m_increment),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+SweepAccumulator::SweepAccumulator ()
+  : m_total (0)
+{
+}
+
+void
+SweepAccumulator::Tick (void)
+{
+  m_total += m_increment;
+  Simulator::Schedule (Seconds (1), &SweepAccumulator::Tick, this);
+}
+
+class ParameterSweepTestCase : public TestCase
+{
+public:
+  ParameterSweepTestCase (uint32_t maxProcesses);
+  virtual void DoRun (void);
+  uint32_t m_maxProcesses;
+};
+
+ParameterSweepTestCase::ParameterSweepTestCase (uint32_t maxProcesses)
+  : TestCase ("Check that the variants continue from the state at the fork"),
+    m_maxProcesses (maxProcesses)
+{
+}
+void
+ParameterSweepTestCase::DoRun (void)
+{
+  Ptr<SweepAccumulator> accumulator = CreateObject<SweepAccumulator> ();
+  Names::Add ("sweep-accumulator", accumulator);
+
+  ParameterSweep sweep;
+  sweep.SetMaxProcesses (m_maxProcesses);
+  for (uint32_t increment = 2; increment <= 4; ++increment)
+    {
+      std::ostringstream oss;
+      oss << increment;
+      uint32_t variant = sweep.AddVariant ();
+      sweep.Set (variant, "/Names/sweep-accumulator/Increment", oss.str ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (sweep.GetNVariants (), 3, "Wrong number of variants");
+
+  // ticks at 1, 2, ... 10 s, fork after the tick at 5 s
+  Simulator::Schedule (Seconds (1), &SweepAccumulator::Tick, accumulator);
+  sweep.ForkAt (Seconds (5.5));
+  Simulator::Stop (Seconds (10.5));
+  Simulator::Run ();
+  if (sweep.IsChild ())
+    {
+      std::ostringstream oss;
+      oss << sweep.GetVariant () << " " << accumulator->m_total;
+      sweep.Report (oss.str ());
+    }
+  Simulator::Destroy ();
+  Names::Clear ();
+
+  NS_TEST_EXPECT_MSG_EQ (accumulator->m_total, 5, "The parent did not stop at the fork");
+  NS_TEST_EXPECT_MSG_EQ (sweep.IsSuccess (0), true, "The first variant failed");
+  NS_TEST_EXPECT_MSG_EQ (sweep.GetResult (0), "0 15", "Wrong result for the first variant");
+  NS_TEST_EXPECT_MSG_EQ (sweep.IsSuccess (1), true, "The second variant failed");
+  NS_TEST_EXPECT_MSG_EQ (sweep.GetResult (1), "1 20", "Wrong result for the second variant");
+  NS_TEST_EXPECT_MSG_EQ (sweep.IsSuccess (2), true, "The third variant failed");
+  NS_TEST_EXPECT_MSG_EQ (sweep.GetResult (2), "2 25", "Wrong result for the third variant");
+}
+
+static class ParameterSweepTestSuite : public TestSuite
+{
+public:
+  ParameterSweepTestSuite ()
+    : TestSuite ("parameter-sweep", UNIT)
+  {
+    AddTestCase (new ParameterSweepTestCase (0), TestCase::QUICK);
+    AddTestCase (new ParameterSweepTestCase (1), TestCase::QUICK);
+  }
+} g_parameterSweepTestSuite;
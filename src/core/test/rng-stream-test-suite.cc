@@ -0,0 +1,238 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/object-factory.h"
+#include "ns3/test.h"
+#include "ns3/rng-stream.h"
+#include "ns3/random-variable-stream.h"
+
+using namespace ns3;
+
+// ===========================================================================
+// Test case for the values of the RngStream sequences
+// ===========================================================================
+class RngStreamKnownValuesTestCase : public TestCase
+{
+public:
+  static const uint32_t N_VALUES = 1000000;
+
+  RngStreamKnownValuesTestCase ();
+  virtual ~RngStreamKnownValuesTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RngStreamKnownValuesTestCase::RngStreamKnownValuesTestCase ()
+  : TestCase ("Check the RngStream sequences against known values")
+{
+}
+
+RngStreamKnownValuesTestCase::~RngStreamKnownValuesTestCase ()
+{
+}
+
+void
+RngStreamKnownValuesTestCase::DoRun (void)
+{
+  // The values 0 to 3 and N_VALUES - 1 of some streams, as computed
+  // with the modular reduction by division of the original MRG32k3a
+  // code: the reduction by multiplication must not change them.
+  struct
+  {
+    uint32_t seed;
+    uint64_t stream;
+    uint64_t substream;
+    double values[5];
+  } known[] = {
+    { 1, 0, 0,
+      { 0.0003395772237870988, 0.55588071598279964, 0.014204660652803588,
+        0.088122671313936751, 0.05900169589378703 } },
+    { 1, 1, 0,
+      { 0.16644822611036503, 0.82381720290379101, 0.7544544718522882,
+        0.53854099335533723, 0.48423247987412754 } },
+    { 3, 7, 2,
+      { 0.46173141478563995, 0.76829344844562875, 0.62359426699290232,
+        0.68289157027412362, 0.28740265122143355 } },
+    { 12345, (1ULL << 40) + 3, 5,
+      { 0.11144995647053955, 0.85228740616603305, 0.84709562621915024,
+        0.9909852391865408, 0.12053592737565584 } },
+  };
+
+  for (uint32_t i = 0; i < sizeof (known) / sizeof (known[0]); ++i)
+    {
+      RngStream single (known[i].seed, known[i].stream, known[i].substream);
+      RngStream block (single);
+      std::vector<double> values (N_VALUES);
+      block.RandU01 (&values[0], N_VALUES);
+      for (uint32_t j = 0; j < N_VALUES; ++j)
+        {
+          double value = single.RandU01 ();
+          NS_TEST_ASSERT_MSG_EQ (values[j], value, "stream " << i << ": block value " << j << " differs.");
+          if (j < 4)
+            {
+              NS_TEST_ASSERT_MSG_EQ (value, known[i].values[j], "stream " << i << ": wrong value " << j << ".");
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (values[N_VALUES - 1], known[i].values[4],
+                             "stream " << i << ": wrong value " << N_VALUES - 1 << ".");
+    }
+}
+
+// ===========================================================================
+// Test case for the block generation of RngStream
+// ===========================================================================
+class RngStreamBlockTestCase : public TestCase
+{
+public:
+  RngStreamBlockTestCase ();
+  virtual ~RngStreamBlockTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RngStreamBlockTestCase::RngStreamBlockTestCase ()
+  : TestCase ("Check that the blocks of RngStream are the scalar sequence bit for bit")
+{
+}
+
+RngStreamBlockTestCase::~RngStreamBlockTestCase ()
+{
+}
+
+void
+RngStreamBlockTestCase::DoRun (void)
+{
+  // sizes on both sides of the vector kernel thresholds, and sizes
+  // split between several vector blocks and a scalar tail
+  const uint32_t sizes[] = { 1, 3, 255, 256, 257, 1000, 1024, 4095, 4096, 4097, 8191, 12345, 65537 };
+
+  RngStream single (5, 3, 1);
+  RngStream block (single);
+  for (uint32_t i = 0; i < sizeof (sizes) / sizeof (sizes[0]); ++i)
+    {
+      uint32_t n = sizes[i];
+      std::vector<double> values (n);
+      block.RandU01 (&values[0], n);
+      for (uint32_t j = 0; j < n; ++j)
+        {
+          double value = single.RandU01 ();
+          NS_TEST_ASSERT_MSG_EQ (std::memcmp (&values[j], &value, sizeof (value)), 0,
+                                 "block of " << n << ": value " << j << " differs.");
+        }
+      // the block leaves the stream where the scalar sequence is
+      NS_TEST_ASSERT_MSG_EQ (block.RandU01 (), single.RandU01 (),
+                             "block of " << n << ": wrong state after the block.");
+    }
+}
+
+// ===========================================================================
+// Test case for the block generation of random variable streams
+// ===========================================================================
+class RandomVariableStreamBlockTestCase : public TestCase
+{
+public:
+  static const uint32_t N_MEASUREMENTS = 10000;
+
+  RandomVariableStreamBlockTestCase ();
+  virtual ~RandomVariableStreamBlockTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check that the values of a stream of the \p type are the same when
+   * drawn one at a time, with GetValues and through a buffer.
+   */
+  void Check (std::string type, bool antithetic);
+};
+
+RandomVariableStreamBlockTestCase::RandomVariableStreamBlockTestCase ()
+  : TestCase ("Block generation of Random Variable Streams")
+{
+}
+
+RandomVariableStreamBlockTestCase::~RandomVariableStreamBlockTestCase ()
+{
+}
+
+void
+RandomVariableStreamBlockTestCase::Check (std::string type, bool antithetic)
+{
+  ObjectFactory factory ("ns3::" + type + "RandomVariable");
+  factory.Set ("Antithetic", BooleanValue (antithetic));
+  Ptr<RandomVariableStream> x = factory.Create<RandomVariableStream> ();
+  factory.Set ("BufferSize", UintegerValue (64));
+  Ptr<RandomVariableStream> buffered = factory.Create<RandomVariableStream> ();
+  factory.Set ("BufferSize", UintegerValue (0));
+  Ptr<RandomVariableStream> block = factory.Create<RandomVariableStream> ();
+  x->SetStream (7);
+  buffered->SetStream (7);
+  block->SetStream (7);
+
+  std::vector<double> values (N_MEASUREMENTS);
+  // draw blocks of increasing sizes, to cross the buffer boundaries
+  for (uint32_t i = 0, n = 1; i < N_MEASUREMENTS; i += n, n++)
+    {
+      block->GetValues (&values[i], std::min (n, N_MEASUREMENTS - i));
+    }
+  for (uint32_t i = 0; i < N_MEASUREMENTS; ++i)
+    {
+      double value = x->GetValue ();
+      NS_TEST_ASSERT_MSG_EQ (buffered->GetValue (), value, type << ": buffered value " << i << " differs.");
+      NS_TEST_ASSERT_MSG_EQ (values[i], value, type << ": block value " << i << " differs.");
+    }
+
+  // changing the stream discards the buffered numbers
+  x->SetStream (8);
+  buffered->SetStream (8);
+  NS_TEST_ASSERT_MSG_EQ (buffered->GetValue (), x->GetValue (), type << ": buffer not reset by SetStream.");
+}
+
+void
+RandomVariableStreamBlockTestCase::DoRun (void)
+{
+  Check ("Uniform", false);
+  Check ("Uniform", true);
+  Check ("Exponential", false);
+  Check ("Exponential", true);
+  Check ("Pareto", false);
+  Check ("Pareto", true);
+  Check ("Normal", false);
+  Check ("Weibull", false);
+}
+
+class RngStreamTestSuite : public TestSuite
+{
+public:
+  RngStreamTestSuite ();
+};
+
+RngStreamTestSuite::RngStreamTestSuite ()
+  : TestSuite ("rng-stream", UNIT)
+{
+  AddTestCase (new RngStreamKnownValuesTestCase, TestCase::QUICK);
+  AddTestCase (new RngStreamBlockTestCase, TestCase::QUICK);
+  AddTestCase (new RandomVariableStreamBlockTestCase, TestCase::QUICK);
+}
+
+static RngStreamTestSuite rngStreamTestSuite;
@@ -23,6 +23,18 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/dary-heap-scheduler.h"
+#include "ns3/make-event.h"
+#include "ns3/event-impl.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/uinteger.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <set>
 
 using namespace ns3;
 
@@ -168,6 +180,108 @@ SimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_destroy, true, "Event should have run");
 }
 
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  uint32_t Random (void);
+  static void Nothing (void);
+  uint32_t m_random;
+  ObjectFactory m_schedulerFactory;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that many events are dequeued in (ts, uid) order with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_random (1),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+uint32_t
+SchedulerOrderTestCase::Random (void)
+{
+  // deterministic LCG, so that every scheduler sees the same workload
+  m_random = m_random * 1103515245 + 12345;
+  return m_random >> 8;
+}
+void
+SchedulerOrderTestCase::Nothing (void)
+{
+}
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  std::set<std::pair<uint64_t, uint32_t> > expected;
+  std::vector<Scheduler::Event> live;
+  uint64_t now = 0;
+  uint32_t uid = 0;
+
+  for (uint32_t i = 0; i < 20000; i++)
+    {
+      // hold model with a mix of far, near and simultaneous events
+      uint32_t nInsert = (i < 2000) ? 2 : 1 + Random () % 2;
+      for (uint32_t j = 0; j < nInsert; j++)
+        {
+          Scheduler::Event ev;
+          ev.impl = MakeEvent (&SchedulerOrderTestCase::Nothing);
+          switch (Random () % 4)
+            {
+            case 0:
+              ev.key.m_ts = now;
+              break;
+            case 1:
+              ev.key.m_ts = now + Random () % 16;
+              break;
+            case 2:
+              ev.key.m_ts = now + Random () % 100000;
+              break;
+            default:
+              ev.key.m_ts = now + Random () % 100000000;
+              break;
+            }
+          ev.key.m_uid = uid++;
+          ev.key.m_context = 0;
+          scheduler->Insert (ev);
+          expected.insert (std::make_pair (ev.key.m_ts, ev.key.m_uid));
+          live.push_back (ev);
+        }
+      if (Random () % 8 == 0)
+        {
+          // remove an arbitrary pending event
+          uint32_t k = Random () % live.size ();
+          while (expected.find (std::make_pair (live[k].key.m_ts, live[k].key.m_uid)) == expected.end ())
+            {
+              live[k] = live.back ();
+              live.pop_back ();
+              k = Random () % live.size ();
+            }
+          scheduler->Remove (live[k]);
+          live[k].impl->Unref ();
+          expected.erase (std::make_pair (live[k].key.m_ts, live[k].key.m_uid));
+          live[k] = live.back ();
+          live.pop_back ();
+        }
+      Scheduler::Event next = scheduler->PeekNext ();
+      Scheduler::Event ev = scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (next.key.m_uid, ev.key.m_uid, "PeekNext and RemoveNext disagree");
+      NS_TEST_ASSERT_MSG_EQ (ev.key.m_ts, expected.begin ()->first, "Wrong timestamp dequeued");
+      NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, expected.begin ()->second, "Wrong uid dequeued");
+      expected.erase (expected.begin ());
+      ev.impl->Unref ();
+      now = ev.key.m_ts;
+    }
+  while (!scheduler->IsEmpty ())
+    {
+      Scheduler::Event ev = scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, expected.begin ()->second, "Wrong uid dequeued");
+      expected.erase (expected.begin ());
+      ev.impl->Unref ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (expected.empty (), true, "Events were lost");
+}
+
 class SimulatorTemplateTestCase : public TestCase
 {
 public:
@@ -459,6 +573,202 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class EventImplPoolTestCase : public TestCase
+{
+public:
+  EventImplPoolTestCase ();
+  virtual void DoRun (void);
+  struct Big
+  {
+    uint8_t data[200];
+  };
+  void Add (uint32_t value);
+  void CheckBig (Big big);
+  uint32_t m_sum;
+};
+
+EventImplPoolTestCase::EventImplPoolTestCase ()
+  : TestCase ("Check that event objects are recycled")
+{
+}
+void
+EventImplPoolTestCase::Add (uint32_t value)
+{
+  m_sum += value;
+}
+void
+EventImplPoolTestCase::CheckBig (Big big)
+{
+  for (uint32_t i = 0; i < sizeof (big.data); i++)
+    {
+      m_sum += big.data[i] == (i & 0xff);
+    }
+}
+void
+EventImplPoolTestCase::DoRun (void)
+{
+  m_sum = 0;
+  EventImpl *a = MakeEvent (&EventImplPoolTestCase::Add, this, 1);
+  void *block = a;
+  a->Unref ();
+  EventImpl *b = MakeEvent (&EventImplPoolTestCase::Add, this, 2);
+  NS_TEST_EXPECT_MSG_EQ ((void *)b, block, "A freed event object was not reused");
+  b->Invoke ();
+  b->Unref ();
+  NS_TEST_EXPECT_MSG_EQ (m_sum, 2, "The recycled event was not invoked correctly");
+
+  // events too large for the free lists
+  m_sum = 0;
+  Big big;
+  for (uint32_t i = 0; i < sizeof (big.data); i++)
+    {
+      big.data[i] = i;
+    }
+  EventImpl *c = MakeEvent (&EventImplPoolTestCase::CheckBig, this, big);
+  c->Invoke ();
+  c->Unref ();
+  NS_TEST_EXPECT_MSG_EQ (m_sum, sizeof (big.data), "The large event was not invoked correctly");
+
+  // many events alive at the same time
+  m_sum = 0;
+  std::vector<EventImpl *> events;
+  for (uint32_t i = 0; i < 10000; i++)
+    {
+      events.push_back (MakeEvent (&EventImplPoolTestCase::Add, this, 1));
+    }
+  for (uint32_t i = 0; i < events.size (); i++)
+    {
+      events[i]->Invoke ();
+      events[i]->Unref ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_sum, 10000, "Events were not invoked correctly");
+}
+
+class ProfilingSimulatorTestCase : public TestCase
+{
+public:
+  ProfilingSimulatorTestCase ();
+  virtual void DoRun (void);
+  void Count (void);
+  uint32_t m_count;
+};
+
+ProfilingSimulatorTestCase::ProfilingSimulatorTestCase ()
+  : TestCase ("Check that the profiling simulator runs and profiles the events")
+{
+}
+void
+ProfilingSimulatorTestCase::Count (void)
+{
+  m_count++;
+}
+void
+ProfilingSimulatorTestCase::DoRun (void)
+{
+  std::string output = CreateTempDirFilename ("profile.txt");
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::ProfilingSimulatorImpl"));
+  Config::SetDefault ("ns3::ProfilingSimulatorImpl::OutputFile", StringValue (output));
+  m_count = 0;
+
+  Simulator::ScheduleWithContext (1, MicroSeconds (10), &ProfilingSimulatorTestCase::Count, this);
+  Simulator::ScheduleWithContext (2, MicroSeconds (11), &ProfilingSimulatorTestCase::Count, this);
+  Simulator::ScheduleWithContext (2, MicroSeconds (12), &ProfilingSimulatorTestCase::Count, this);
+  EventId cancelled = Simulator::Schedule (MicroSeconds (13), &ProfilingSimulatorTestCase::Count, this);
+  Simulator::Cancel (cancelled);
+  NS_TEST_EXPECT_MSG_EQ (cancelled.IsExpired (), true, "The event was cancelled: it should have expired");
+  Simulator::Run ();
+  Simulator::Destroy ();
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::SetDefault ("ns3::ProfilingSimulatorImpl::OutputFile", StringValue (""));
+
+  NS_TEST_EXPECT_MSG_EQ (m_count, 3, "The events did not run");
+  std::ifstream is (output.c_str ());
+  std::ostringstream profile;
+  profile << is.rdbuf ();
+  NS_TEST_EXPECT_MSG_NE (profile.str ().find ("Profile of 3 events"), std::string::npos,
+                         "Wrong number of events in the profile");
+  NS_TEST_EXPECT_MSG_NE (profile.str ().find ("ProfilingSimulatorTestCase::*"), std::string::npos,
+                         "Event site not found in the profile");
+  NS_TEST_EXPECT_MSG_NE (profile.str ().find ("node 2"), std::string::npos,
+                         "Node not found in the profile");
+}
+
+class SimulatorStatisticsTestCase : public TestCase
+{
+public:
+  SimulatorStatisticsTestCase ();
+  virtual void DoRun (void);
+  void Count (void);
+  void Notify (const DefaultSimulatorImpl::Statistics &statistics);
+  uint32_t m_count;
+  std::vector<uint64_t> m_notified;
+};
+
+SimulatorStatisticsTestCase::SimulatorStatisticsTestCase ()
+  : TestCase ("Check the statistics of the events of the default simulator")
+{
+}
+void
+SimulatorStatisticsTestCase::Count (void)
+{
+  m_count++;
+}
+void
+SimulatorStatisticsTestCase::Notify (const DefaultSimulatorImpl::Statistics &statistics)
+{
+  m_notified.push_back (statistics.executed);
+}
+void
+SimulatorStatisticsTestCase::DoRun (void)
+{
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::StatisticsInterval", UintegerValue (2));
+  m_count = 0;
+  m_notified.clear ();
+
+  Ptr<DefaultSimulatorImpl> impl = DynamicCast<DefaultSimulatorImpl> (Simulator::GetImplementation ());
+  NS_TEST_ASSERT_MSG_NE (impl, 0, "The simulator implementation is not the default one");
+  impl->TraceConnectWithoutContext ("Statistics", MakeCallback (&SimulatorStatisticsTestCase::Notify, this));
+
+  std::vector<EventId> events;
+  for (uint32_t i = 1; i <= 10; i++)
+    {
+      events.push_back (Simulator::Schedule (MicroSeconds (i), &SimulatorStatisticsTestCase::Count, this));
+    }
+  Simulator::Cancel (events[1]);
+  Simulator::Cancel (events[3]);
+  Simulator::Cancel (events[5]);
+  Simulator::Cancel (events[5]);
+  Simulator::Remove (events[7]);
+  Simulator::Remove (events[8]);
+  // a cancelled event leaves the event list when removed
+  Simulator::Cancel (events[9]);
+  Simulator::Remove (events[9]);
+  Simulator::Remove (events[9]);
+
+  DefaultSimulatorImpl::Statistics statistics = impl->GetStatistics ();
+  NS_TEST_EXPECT_MSG_EQ (statistics.inserted, 10, "Wrong number of inserted events");
+  NS_TEST_EXPECT_MSG_EQ (statistics.cancelled, 4, "Wrong number of cancelled events");
+  NS_TEST_EXPECT_MSG_EQ (statistics.cancelledPending, 3, "Wrong number of cancelled events in the event list");
+  NS_TEST_EXPECT_MSG_EQ (statistics.removed, 3, "Wrong number of removed events");
+  NS_TEST_EXPECT_MSG_EQ (statistics.queueSize, 7, "Wrong size of the event list");
+
+  Simulator::Run ();
+  statistics = impl->GetStatistics ();
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::StatisticsInterval", UintegerValue (1000000));
+
+  NS_TEST_EXPECT_MSG_EQ (m_count, 4, "The events did not run");
+  NS_TEST_EXPECT_MSG_EQ (statistics.executed, 4, "Wrong number of events run");
+  NS_TEST_EXPECT_MSG_EQ (statistics.cancelledPending, 0, "Wrong number of cancelled events in the event list");
+  NS_TEST_EXPECT_MSG_EQ (statistics.queueSize, 0, "Wrong size of the event list");
+  NS_TEST_EXPECT_MSG_EQ (statistics.maxQueueSize, 10, "Wrong largest size of the event list");
+  // every 2 events, and at the end of the run
+  NS_TEST_ASSERT_MSG_EQ (m_notified.size (), 3, "Wrong number of notifications");
+  NS_TEST_EXPECT_MSG_EQ (m_notified[0], 2, "Wrong first notification");
+  NS_TEST_EXPECT_MSG_EQ (m_notified[1], 4, "Wrong second notification");
+  NS_TEST_EXPECT_MSG_EQ (m_notified[2], 4, "Wrong last notification");
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -475,5 +785,26 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (DaryHeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (DaryHeapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (DaryHeapScheduler::GetTypeId ());
+    factory.Set ("Arity", UintegerValue (8));
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    AddTestCase (new EventImplPoolTestCase (), TestCase::QUICK);
+    AddTestCase (new ProfilingSimulatorTestCase (), TestCase::QUICK);
+    AddTestCase (new SimulatorStatisticsTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
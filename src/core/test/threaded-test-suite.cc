@@ -225,6 +225,64 @@ ThreadedSimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_a, m_d, "Bad scheduling");
 }
 
+class ThreadedSimulatorOrderTestCase : public TestCase
+{
+public:
+  ThreadedSimulatorOrderTestCase (const std::string &simulatorType);
+private:
+  virtual void DoRun (void);
+  void SchedulingThread (void);
+  void Event (uint32_t i);
+
+  std::string m_simulatorType;
+  uint32_t m_next;
+  bool m_inOrder;
+};
+
+static const uint32_t ORDER_EVENTS = 10000;
+
+ThreadedSimulatorOrderTestCase::ThreadedSimulatorOrderTestCase (const std::string &simulatorType)
+  : TestCase ("Events scheduled by another thread keep their order, with " + simulatorType),
+    m_simulatorType (simulatorType)
+{
+}
+void
+ThreadedSimulatorOrderTestCase::SchedulingThread (void)
+{
+  for (uint32_t i = 0; i < ORDER_EVENTS; ++i)
+    {
+      Simulator::ScheduleWithContext (i, Seconds (0), &ThreadedSimulatorOrderTestCase::Event, this, i);
+    }
+}
+void
+ThreadedSimulatorOrderTestCase::Event (uint32_t i)
+{
+  m_inOrder = m_inOrder && i == m_next && Simulator::GetContext () == i;
+  m_next++;
+}
+void
+ThreadedSimulatorOrderTestCase::DoRun (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue (m_simulatorType));
+  m_next = 0;
+  m_inOrder = true;
+  // create the simulator in this thread, so that it is the main one
+  Simulator::Now ();
+
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&ThreadedSimulatorOrderTestCase::SchedulingThread, this));
+  thread->Start ();
+  thread->Join ();
+
+  // the realtime simulator does not stop by itself when it runs out of events
+  Simulator::Stop (MilliSeconds (1));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+
+  NS_TEST_EXPECT_MSG_EQ (m_next, ORDER_EVENTS, "Lost events");
+  NS_TEST_EXPECT_MSG_EQ (m_inOrder, true, "Events not run in the order in which they were scheduled");
+}
+
 class ThreadedSimulatorTestSuite : public TestSuite
 {
 public:
@@ -241,7 +299,9 @@ public:
       "ns3::ListScheduler",
       "ns3::HeapScheduler",
       "ns3::MapScheduler",
-      "ns3::CalendarScheduler"
+      "ns3::CalendarScheduler",
+      "ns3::LadderScheduler",
+      "ns3::DaryHeapScheduler"
     };
     unsigned int threadcounts[] = {
       0,
@@ -261,6 +321,7 @@ public:
                 AddTestCase (new ThreadedSimulatorEventsTestCase (factory, simulatorTypes[i], threadcounts[j]), TestCase::QUICK);
               }
           }
+        AddTestCase (new ThreadedSimulatorOrderTestCase (simulatorTypes[i]), TestCase::QUICK);
       }
   }
 } g_threadedSimulatorTestSuite;
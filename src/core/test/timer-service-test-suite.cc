@@ -0,0 +1,325 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <vector>
+
+#include "ns3/timer-service.h"
+#include "ns3/timer.h"
+#include "ns3/watchdog.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+namespace {
+
+Ptr<TimerService>
+MakeService (Time granularity, uint32_t slots)
+{
+  Ptr<TimerService> service = CreateObject<TimerService> ();
+  service->SetAttribute ("Granularity", TimeValue (granularity));
+  service->SetAttribute ("Slots", UintegerValue (slots));
+  return service;
+}
+
+std::vector<Time> g_expired;
+std::vector<uint32_t> g_order;
+
+void
+RecordExpiry (uint32_t i)
+{
+  g_expired[i] = Simulator::Now ();
+  g_order.push_back (i);
+}
+
+} // anonymous namespace
+
+class TimerServiceExpiryTestCase : public TestCase
+{
+public:
+  TimerServiceExpiryTestCase ();
+  virtual void DoRun (void);
+};
+
+TimerServiceExpiryTestCase::TimerServiceExpiryTestCase ()
+  : TestCase ("Check that the timers expire at their exact deadline, in order")
+{
+}
+
+void
+TimerServiceExpiryTestCase::DoRun (void)
+{
+  // 8 slots of 10us: the deadlines go around the wheel many times, and
+  // several timers share a slot in different rounds.
+  Ptr<TimerService> service = MakeService (MicroSeconds (10), 8);
+  const uint32_t n = 100;
+  std::vector<TimerService::Entry *> entries;
+  std::vector<Time> deadlines;
+  g_expired.assign (n, Seconds (-1));
+  g_order.clear ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      entries.push_back (new TimerService::Entry (service, MakeBoundCallback (&RecordExpiry, i)));
+      // Distinct deadlines, from 3us to about 1ms, not in order.
+      Time delay = NanoSeconds (3000 + (i * 7919) % 997000);
+      deadlines.push_back (delay);
+      entries[i]->Schedule (delay);
+    }
+  NS_TEST_ASSERT_MSG_EQ (entries[0]->IsRunning (), true, "The timer is not running");
+  NS_TEST_ASSERT_MSG_EQ (entries[1]->GetDelayLeft (), deadlines[1], "Wrong delay left");
+  Simulator::Run ();
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (g_expired[i], deadlines[i], "Timer " << i << " did not expire at its deadline");
+      NS_TEST_ASSERT_MSG_EQ (entries[i]->IsRunning (), false, "Timer " << i << " is still running");
+    }
+  NS_TEST_ASSERT_MSG_EQ (g_order.size (), n, "Some timers expired more than once");
+  for (uint32_t i = 1; i < g_order.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_LT (deadlines[g_order[i - 1]], deadlines[g_order[i]], "The timers expired out of order");
+    }
+  for (uint32_t i = 0; i < n; i++)
+    {
+      delete entries[i];
+    }
+  Simulator::Destroy ();
+}
+
+class TimerServiceOrderTestCase : public TestCase
+{
+public:
+  TimerServiceOrderTestCase ();
+  virtual void DoRun (void);
+  /**
+   * Arm or re-arm the timer i, in m_entries, or as a plain simulator
+   * event if m_entries is empty.
+   */
+  void Arm (uint32_t i, Time deadline);
+  /** \returns the order in which the timers expired */
+  std::vector<uint32_t> Run (bool useService);
+
+  std::vector<TimerService::Entry *> m_entries;
+  std::vector<EventId> m_events;
+};
+
+TimerServiceOrderTestCase::TimerServiceOrderTestCase ()
+  : TestCase ("Check that the timers with equal deadlines expire in the order of plain events")
+{
+}
+
+void
+TimerServiceOrderTestCase::Arm (uint32_t i, Time deadline)
+{
+  if (m_entries.empty ())
+    {
+      m_events[i].Cancel ();
+      m_events[i] = Simulator::Schedule (deadline - Simulator::Now (), &RecordExpiry, i);
+    }
+  else
+    {
+      m_entries[i]->Schedule (deadline - Simulator::Now ());
+    }
+}
+
+std::vector<uint32_t>
+TimerServiceOrderTestCase::Run (bool useService)
+{
+  // Slots of 1ms: the timers armed at 3ms, due at 3.5ms, are armed just
+  // before the tick of their slot.
+  Ptr<TimerService> service = MakeService (MilliSeconds (1), 4);
+  const uint32_t n = 21;
+  g_expired.assign (n, Seconds (-1));
+  g_order.clear ();
+  m_events.assign (n, EventId ());
+  for (uint32_t i = 0; i < n; i++)
+    {
+      if (useService)
+        {
+          m_entries.push_back (new TimerService::Entry (service, MakeBoundCallback (&RecordExpiry, i)));
+        }
+      // Three deadlines shared by 7 timers each, armed in another order.
+      Time deadline = MicroSeconds (i % 3 == 0 ? 3500 : i % 3 == 1 ? 7500 : 4000);
+      Simulator::Schedule (MicroSeconds (500 * ((i * 5) % 7)),
+                           &TimerServiceOrderTestCase::Arm, this, i, deadline);
+    }
+  // Re-armed for the same deadline, after the others.
+  Simulator::Schedule (MicroSeconds (3200), &TimerServiceOrderTestCase::Arm, this, 0,
+                       MicroSeconds (3500));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  for (uint32_t i = 0; i < m_entries.size (); i++)
+    {
+      delete m_entries[i];
+    }
+  m_entries.clear ();
+  return g_order;
+}
+
+void
+TimerServiceOrderTestCase::DoRun (void)
+{
+  std::vector<uint32_t> expected = Run (false);
+  std::vector<uint32_t> order = Run (true);
+  NS_TEST_ASSERT_MSG_EQ (order.size (), expected.size (), "Wrong number of expiries");
+  for (uint32_t i = 0; i < order.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (order[i], expected[i], "Expiry " << i << " out of order");
+    }
+}
+
+class TimerServiceRearmTestCase : public TestCase
+{
+public:
+  TimerServiceRearmTestCase ();
+  virtual void DoRun (void);
+  void Expire (void);
+  void Rearm (TimerService::Entry *entry);
+  uint32_t m_count;
+  Time m_expired;
+};
+
+TimerServiceRearmTestCase::TimerServiceRearmTestCase ()
+  : TestCase ("Check that re-armed and cancelled timers expire only once, or never")
+{
+}
+
+void
+TimerServiceRearmTestCase::Expire (void)
+{
+  m_count++;
+  m_expired = Simulator::Now ();
+}
+
+void
+TimerServiceRearmTestCase::Rearm (TimerService::Entry *entry)
+{
+  entry->Schedule (MilliSeconds (50));
+}
+
+void
+TimerServiceRearmTestCase::DoRun (void)
+{
+  m_count = 0;
+  Ptr<TimerService> service = MakeService (MilliSeconds (1), 16);
+  TimerService::Entry entry (service, MakeCallback (&TimerServiceRearmTestCase::Expire, this));
+  TimerService::Entry cancelled (service, MakeCallback (&TimerServiceRearmTestCase::Expire, this));
+
+  // Re-armed every 100us for 100ms, then left to expire 50ms later.
+  for (uint32_t i = 0; i <= 1000; i++)
+    {
+      Simulator::Schedule (MicroSeconds (100 * i), &TimerServiceRearmTestCase::Rearm, this, &entry);
+    }
+  cancelled.Schedule (MilliSeconds (30));
+  Simulator::Schedule (MilliSeconds (10), &TimerService::Entry::Cancel, &cancelled);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_count, 1, "Wrong number of expiries");
+  NS_TEST_ASSERT_MSG_EQ (m_expired, MilliSeconds (150), "The timer did not expire at its last deadline");
+  NS_TEST_ASSERT_MSG_EQ (cancelled.IsRunning (), false, "The cancelled timer is running");
+  NS_TEST_ASSERT_MSG_EQ (cancelled.GetDelayLeft (), Seconds (0), "The cancelled timer has a delay left");
+}
+
+class TimerServiceTimerTestCase : public TestCase
+{
+public:
+  TimerServiceTimerTestCase ();
+  virtual void DoRun (void);
+  void Expire (int i);
+  void Suspend (Timer *timer);
+  uint32_t m_count;
+  Time m_expired;
+  int m_argument;
+};
+
+TimerServiceTimerTestCase::TimerServiceTimerTestCase ()
+  : TestCase ("Check Timer and Watchdog with a TimerService")
+{
+}
+
+void
+TimerServiceTimerTestCase::Expire (int i)
+{
+  m_count++;
+  m_expired = Simulator::Now ();
+  m_argument = i;
+}
+
+void
+TimerServiceTimerTestCase::Suspend (Timer *timer)
+{
+  timer->Suspend ();
+}
+
+void
+TimerServiceTimerTestCase::DoRun (void)
+{
+  Ptr<TimerService> service = MakeService (MicroSeconds (4), 4);
+
+  Timer timer (Timer::CANCEL_ON_DESTROY);
+  timer.SetTimerService (service);
+  timer.SetFunction (&TimerServiceTimerTestCase::Expire, this);
+  timer.SetArguments (7);
+  timer.SetDelay (MicroSeconds (30));
+  NS_TEST_ASSERT_MSG_EQ (timer.GetState (), Timer::EXPIRED, "");
+  timer.Schedule ();
+  NS_TEST_ASSERT_MSG_EQ (timer.GetState (), Timer::RUNNING, "");
+  NS_TEST_ASSERT_MSG_EQ (timer.GetDelayLeft (), MicroSeconds (30), "");
+  timer.Cancel ();
+  NS_TEST_ASSERT_MSG_EQ (timer.GetState (), Timer::EXPIRED, "");
+  timer.Schedule ();
+
+  // Suspended for 100us after 10us: expires at 130us.
+  m_count = 0;
+  Simulator::Schedule (MicroSeconds (10), &TimerServiceTimerTestCase::Suspend, this, &timer);
+  Simulator::Schedule (MicroSeconds (110), &Timer::Resume, &timer);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_count, 1, "Wrong number of expiries");
+  NS_TEST_ASSERT_MSG_EQ (m_expired, MicroSeconds (130), "The timer did not expire at the expected time");
+  NS_TEST_ASSERT_MSG_EQ (m_argument, 7, "We did not get the right argument");
+  NS_TEST_ASSERT_MSG_EQ (timer.GetState (), Timer::EXPIRED, "");
+
+  // The pings of the watchdog test suite, with a TimerService.
+  m_count = 0;
+  Time start = Simulator::Now ();
+  Watchdog watchdog;
+  watchdog.SetTimerService (service);
+  watchdog.SetFunction (&TimerServiceTimerTestCase::Expire, this);
+  watchdog.SetArguments (40);
+  watchdog.Ping (MicroSeconds (10));
+  Simulator::Schedule (MicroSeconds (5), &Watchdog::Ping, &watchdog, MicroSeconds (20));
+  Simulator::Schedule (MicroSeconds (20), &Watchdog::Ping, &watchdog, MicroSeconds (2));
+  Simulator::Schedule (MicroSeconds (23), &Watchdog::Ping, &watchdog, MicroSeconds (17));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_count, 1, "Wrong number of expiries");
+  NS_TEST_ASSERT_MSG_EQ (m_expired - start, MicroSeconds (40), "The watchdog did not expire at the expected time");
+  NS_TEST_ASSERT_MSG_EQ (m_argument, 40, "We did not get the right argument");
+}
+
+static class TimerServiceTestSuite : public TestSuite
+{
+public:
+  TimerServiceTestSuite ()
+    : TestSuite ("timer-service", UNIT)
+  {
+    AddTestCase (new TimerServiceExpiryTestCase (), TestCase::QUICK);
+    AddTestCase (new TimerServiceOrderTestCase (), TestCase::QUICK);
+    AddTestCase (new TimerServiceRearmTestCase (), TestCase::QUICK);
+    AddTestCase (new TimerServiceTimerTestCase (), TestCase::QUICK);
+  }
+} g_timerServiceTestSuite;
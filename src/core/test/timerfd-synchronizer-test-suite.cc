@@ -0,0 +1,164 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <unistd.h>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/realtime-simulator-impl.h"
+#include "ns3/timerfd-synchronizer.h"
+#include "ns3/system-thread.h"
+#include "ns3/config.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include "ns3/type-id.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+
+using namespace ns3;
+
+class TimerfdSynchronizerTestCase : public TestCase
+{
+public:
+  TimerfdSynchronizerTestCase ();
+  virtual ~TimerfdSynchronizerTestCase () {}
+
+private:
+  virtual void DoRun (void);
+  /** Check that an event runs after its time, in real time. */
+  void Event (void);
+  /** Schedule a realtime event from another thread. */
+  void SchedulingThread (void);
+  /** The event scheduled from another thread. */
+  void RealtimeEvent (void);
+  void Lateness (Time lateness);
+  void LatenessPercentiles (Time median, Time p90, Time p99, Time max);
+
+  Ptr<RealtimeSimulatorImpl> m_impl;
+  uint32_t m_events;
+  uint32_t m_early;
+  uint32_t m_waits;
+  uint32_t m_negative;
+  uint32_t m_reports;
+  bool m_ordered;
+  Time m_realtimeEvent;
+};
+
+TimerfdSynchronizerTestCase::TimerfdSynchronizerTestCase ()
+  : TestCase ("Check the waits and the lateness traces of the TimerfdSynchronizer")
+{
+}
+
+void
+TimerfdSynchronizerTestCase::Event (void)
+{
+  m_events++;
+  if (m_impl->RealtimeNow () < Simulator::Now ())
+    {
+      m_early++;
+    }
+}
+
+void
+TimerfdSynchronizerTestCase::SchedulingThread (void)
+{
+  usleep (20000);
+  m_impl->ScheduleRealtimeNow (MakeEvent (&TimerfdSynchronizerTestCase::RealtimeEvent, this));
+}
+
+void
+TimerfdSynchronizerTestCase::RealtimeEvent (void)
+{
+  m_realtimeEvent = m_impl->RealtimeNow ();
+}
+
+void
+TimerfdSynchronizerTestCase::Lateness (Time lateness)
+{
+  m_waits++;
+  if (lateness.IsStrictlyNegative ())
+    {
+      m_negative++;
+    }
+}
+
+void
+TimerfdSynchronizerTestCase::LatenessPercentiles (Time median, Time p90, Time p99, Time max)
+{
+  m_reports++;
+  m_ordered = m_ordered && median <= p90 && p90 <= p99 && p99 <= max;
+}
+
+void
+TimerfdSynchronizerTestCase::DoRun (void)
+{
+  m_events = 0;
+  m_early = 0;
+  m_waits = 0;
+  m_negative = 0;
+  m_reports = 0;
+  m_ordered = true;
+  m_realtimeEvent = Seconds (0);
+
+  Config::SetDefault ("ns3::RealtimeSimulatorImpl::SynchronizerType",
+                      TypeIdValue (TimerfdSynchronizer::GetTypeId ()));
+  Config::SetDefault ("ns3::TimerfdSynchronizer::ReportInterval", UintegerValue (10));
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::RealtimeSimulatorImpl"));
+  m_impl = DynamicCast<RealtimeSimulatorImpl> (Simulator::GetImplementation ());
+  NS_TEST_ASSERT_MSG_NE (m_impl, 0, "Realtime simulator not created");
+  Ptr<Synchronizer> synchronizer = m_impl->GetSynchronizer ();
+  NS_TEST_ASSERT_MSG_NE (DynamicCast<TimerfdSynchronizer> (synchronizer), 0, "Synchronizer not created");
+  synchronizer->TraceConnectWithoutContext ("Lateness", MakeCallback (&TimerfdSynchronizerTestCase::Lateness, this));
+  synchronizer->TraceConnectWithoutContext ("LatenessPercentiles", MakeCallback (&TimerfdSynchronizerTestCase::LatenessPercentiles, this));
+
+  for (uint32_t i = 1; i <= 40; i++)
+    {
+      Simulator::Schedule (MicroSeconds (500 * i), &TimerfdSynchronizerTestCase::Event, this);
+    }
+  // a Signal from another thread interrupts the wait for this event
+  Simulator::Schedule (Seconds (5), &TimerfdSynchronizerTestCase::Event, this);
+  Simulator::Stop (MilliSeconds (100));
+
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&TimerfdSynchronizerTestCase::SchedulingThread, this));
+  thread->Start ();
+  Simulator::Run ();
+  thread->Join ();
+  m_impl = 0;
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::Reset ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_events, 40, "Events not run");
+  NS_TEST_EXPECT_MSG_EQ (m_early, 0, "Events run before their time");
+  NS_TEST_EXPECT_MSG_GT (m_waits, 40, "Waits not traced");
+  NS_TEST_EXPECT_MSG_EQ (m_negative, 0, "Waits ended early");
+  NS_TEST_EXPECT_MSG_GT (m_reports, 3, "Percentiles not traced");
+  NS_TEST_EXPECT_MSG_EQ (m_ordered, true, "Percentiles not ordered");
+  NS_TEST_EXPECT_MSG_GT (m_realtimeEvent, MilliSeconds (19), "Realtime event not run");
+  NS_TEST_EXPECT_MSG_LT (m_realtimeEvent, MilliSeconds (100), "Realtime event not run in time");
+}
+
+class TimerfdSynchronizerTestSuite : public TestSuite
+{
+public:
+  TimerfdSynchronizerTestSuite ()
+    : TestSuite ("timerfd-synchronizer", UNIT)
+  {
+    AddTestCase (new TimerfdSynchronizerTestCase, TestCase::QUICK);
+  }
+};
+
+static TimerfdSynchronizerTestSuite timerfdSynchronizerTestSuite;
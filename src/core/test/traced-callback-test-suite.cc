@@ -16,8 +16,14 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include "ns3/core-config.h"
 #include "ns3/test.h"
 #include "ns3/traced-callback.h"
+#ifdef NS3_MULTITHREADED
+#include "ns3/system-thread.h"
+#endif
+
+#include <vector>
 
 using namespace ns3;
 
@@ -108,6 +114,226 @@ BasicTracedCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_two, true, "Callback CbTwo not called");
 }
 
+class EmptyTracedCallbackTestCase : public TestCase
+{
+public:
+  EmptyTracedCallbackTestCase ();
+  virtual ~EmptyTracedCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  int Argument (void);
+  void Cb (int a);
+  void CbConnect (int a);
+  void CbDisconnect (int a);
+
+  TracedCallback<int> m_trace;
+  int m_arguments;
+  int m_calls;
+};
+
+EmptyTracedCallbackTestCase::EmptyTracedCallbackTestCase ()
+  : TestCase ("Check IsEmpty, NS_TRACE and connections and disconnections from a callback")
+{
+}
+
+int
+EmptyTracedCallbackTestCase::Argument (void)
+{
+  m_arguments++;
+  return 5;
+}
+
+void
+EmptyTracedCallbackTestCase::Cb (int a)
+{
+  m_calls++;
+}
+
+void
+EmptyTracedCallbackTestCase::CbConnect (int a)
+{
+  m_calls++;
+  for (int i = 0; i < 10; i++)
+    {
+      m_trace.ConnectWithoutContext (MakeCallback (&EmptyTracedCallbackTestCase::Cb, this));
+    }
+}
+
+void
+EmptyTracedCallbackTestCase::CbDisconnect (int a)
+{
+  m_calls++;
+  m_trace.DisconnectWithoutContext (MakeCallback (&EmptyTracedCallbackTestCase::CbDisconnect, this));
+  m_trace.DisconnectWithoutContext (MakeCallback (&EmptyTracedCallbackTestCase::Cb, this));
+}
+
+void
+EmptyTracedCallbackTestCase::DoRun (void)
+{
+  m_arguments = 0;
+  m_calls = 0;
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "New TracedCallback not empty");
+
+  //
+  // The arguments of an unconnected trace are not evaluated.
+  //
+  NS_TRACE (m_trace, (Argument ()));
+  NS_TEST_ASSERT_MSG_EQ (m_arguments, 0, "Arguments of an empty trace evaluated");
+
+  m_trace.ConnectWithoutContext (MakeCallback (&EmptyTracedCallbackTestCase::CbConnect, this));
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), false, "Connected TracedCallback empty");
+  NS_TRACE (m_trace, (Argument ()));
+  NS_TEST_ASSERT_MSG_EQ (m_arguments, 1, "Arguments of a connected trace not evaluated");
+
+  //
+  // The callbacks connected while the trace is invoked are called from
+  // the next invocation.
+  //
+  NS_TEST_ASSERT_MSG_EQ (m_calls, 1, "Callbacks connected by a callback called too early");
+  m_trace.DisconnectWithoutContext (MakeCallback (&EmptyTracedCallbackTestCase::CbConnect, this));
+  m_trace (0);
+  NS_TEST_ASSERT_MSG_EQ (m_calls, 11, "Callbacks connected by a callback not called");
+
+  m_trace.DisconnectWithoutContext (MakeCallback (&EmptyTracedCallbackTestCase::Cb, this));
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "Disconnected TracedCallback not empty");
+
+  //
+  // The callbacks disconnected while the trace is invoked, including
+  // the running one, are not called any more.
+  //
+  m_calls = 0;
+  m_trace.ConnectWithoutContext (MakeCallback (&EmptyTracedCallbackTestCase::CbDisconnect, this));
+  for (int i = 0; i < 10; i++)
+    {
+      m_trace.ConnectWithoutContext (MakeCallback (&EmptyTracedCallbackTestCase::Cb, this));
+    }
+  m_trace (0);
+  NS_TEST_ASSERT_MSG_EQ (m_calls, 1, "Callbacks disconnected by a callback called");
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "Disconnected TracedCallback not empty");
+  m_trace (0);
+  NS_TEST_ASSERT_MSG_EQ (m_calls, 1, "Disconnected callbacks called");
+
+  //
+  // A copy has the callbacks of the original, but they are
+  // disconnected separately.
+  //
+  m_trace.ConnectWithoutContext (MakeCallback (&EmptyTracedCallbackTestCase::Cb, this));
+  TracedCallback<int> copy = m_trace;
+  copy.DisconnectWithoutContext (MakeCallback (&EmptyTracedCallbackTestCase::Cb, this));
+  NS_TEST_ASSERT_MSG_EQ (copy.IsEmpty (), true, "Disconnected copy not empty");
+  m_trace (0);
+  NS_TEST_ASSERT_MSG_EQ (m_calls, 2, "Callback disconnected from the copy of a trace");
+  m_trace.DisconnectWithoutContext (MakeCallback (&EmptyTracedCallbackTestCase::Cb, this));
+}
+
+#ifdef NS3_MULTITHREADED
+// ===========================================================================
+// Test case to make sure that the threads of the multithreaded simulator
+// can invoke the same trace at the same time
+// ===========================================================================
+class ThreadsTracedCallbackTestCase : public TestCase
+{
+public:
+  static const uint32_t N_THREADS = 4;
+  static const uint32_t N_CALLS = 1000000;
+
+  ThreadsTracedCallbackTestCase ();
+  virtual ~ThreadsTracedCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  /** Invoke the trace N_CALLS times. */
+  void Invoke (void);
+  /** Connect and disconnect a callback while the trace is invoked. */
+  void Toggle (void);
+  void Cb (uint32_t thread);
+  void CbToggled (uint32_t thread);
+
+  TracedCallback<uint32_t> m_trace;
+  uint32_t m_calls[N_THREADS];   //!< The calls of Cb, by thread.
+  uint32_t m_toggledCalls;       //!< The calls of CbToggled.
+  uint32_t m_started;            //!< The number of invoking threads started.
+  uint32_t m_running;            //!< The number of invoking threads running.
+};
+
+ThreadsTracedCallbackTestCase::ThreadsTracedCallbackTestCase ()
+  : TestCase ("Check the invocation of a TracedCallback from several threads")
+{
+}
+
+void
+ThreadsTracedCallbackTestCase::Cb (uint32_t thread)
+{
+  m_calls[thread]++;
+}
+
+void
+ThreadsTracedCallbackTestCase::CbToggled (uint32_t thread)
+{
+  __sync_fetch_and_add (&m_toggledCalls, 1);
+}
+
+void
+ThreadsTracedCallbackTestCase::Invoke (void)
+{
+  uint32_t thread = __sync_fetch_and_add (&m_started, 1);
+  for (uint32_t i = 0; i < N_CALLS; i++)
+    {
+      m_trace (thread);
+    }
+  __sync_fetch_and_sub (&m_running, 1);
+}
+
+void
+ThreadsTracedCallbackTestCase::Toggle (void)
+{
+  while (__sync_fetch_and_add (&m_running, 0) > 0)
+    {
+      m_trace.ConnectWithoutContext (MakeCallback (&ThreadsTracedCallbackTestCase::CbToggled, this));
+      m_trace.DisconnectWithoutContext (MakeCallback (&ThreadsTracedCallbackTestCase::CbToggled, this));
+    }
+}
+
+void
+ThreadsTracedCallbackTestCase::DoRun (void)
+{
+  for (uint32_t t = 0; t < N_THREADS; t++)
+    {
+      m_calls[t] = 0;
+    }
+  m_toggledCalls = 0;
+  m_started = 0;
+  m_running = N_THREADS;
+  m_trace.ConnectWithoutContext (MakeCallback (&ThreadsTracedCallbackTestCase::Cb, this));
+
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t t = 0; t < N_THREADS; t++)
+    {
+      threads.push_back (Create<SystemThread> (MakeCallback (&ThreadsTracedCallbackTestCase::Invoke, this)));
+      threads.back ()->Start ();
+    }
+  Toggle ();
+  for (uint32_t t = 0; t < N_THREADS; t++)
+    {
+      threads[t]->Join ();
+      NS_TEST_EXPECT_MSG_EQ (m_calls[t], N_CALLS, "Wrong number of calls from thread " << t);
+    }
+
+  //
+  // The connections made afterwards take effect at once.
+  //
+  m_trace.DisconnectWithoutContext (MakeCallback (&ThreadsTracedCallbackTestCase::Cb, this));
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "Disconnected TracedCallback not empty");
+  m_trace.ConnectWithoutContext (MakeCallback (&ThreadsTracedCallbackTestCase::CbToggled, this));
+  m_toggledCalls = 0;
+  m_trace (0);
+  NS_TEST_ASSERT_MSG_EQ (m_toggledCalls, 1, "Connected callback not called");
+}
+#endif /* NS3_MULTITHREADED */
+
 class TracedCallbackTestSuite : public TestSuite
 {
 public:
@@ -118,6 +344,10 @@ TracedCallbackTestSuite::TracedCallbackTestSuite ()
   : TestSuite ("traced-callback", UNIT)
 {
   AddTestCase (new BasicTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new EmptyTracedCallbackTestCase, TestCase::QUICK);
+#ifdef NS3_MULTITHREADED
+  AddTestCase (new ThreadsTracedCallbackTestCase, TestCase::QUICK);
+#endif
 }
 
 static TracedCallbackTestSuite tracedCallbackTestSuite;
@@ -180,6 +180,17 @@ CollisionTestCase::DoRun (void)
                           "Second and lesser TypeId has HashChainFlag set");
   cout << suite << "collision: second,lesser not chained: OK" << endl;
 
+  // Name lookups must still find the types, chained or not
+  NS_TEST_ASSERT_MSG_EQ (TypeId::LookupByName (t1Name).GetUid (), t1.GetUid (),
+                         "LookupByName did not find the first, lesser TypeId");
+  NS_TEST_ASSERT_MSG_EQ (TypeId::LookupByName (t2Name).GetUid (), t2.GetUid (),
+                         "LookupByName did not find the second, greater TypeId");
+  NS_TEST_ASSERT_MSG_EQ (TypeId::LookupByName (t3Name).GetUid (), t3.GetUid (),
+                         "LookupByName did not find the first, greater TypeId");
+  NS_TEST_ASSERT_MSG_EQ (TypeId::LookupByName (t4Name).GetUid (), t4.GetUid (),
+                         "LookupByName did not find the second, lesser TypeId");
+  cout << suite << "collision: lookup by name: OK" << endl;
+
   /** TODO Extra credit:  register three types whose hashes collide
    *
    *  None found in /usr/share/dict/web2
@@ -188,6 +199,68 @@ CollisionTestCase::DoRun (void)
 }
   
   
+//----------------------------
+//
+// Attributes of the parents
+
+class AllAttributesTestCase : public TestCase
+{
+public:
+  AllAttributesTestCase ();
+  virtual ~AllAttributesTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+AllAttributesTestCase::AllAttributesTestCase ()
+  : TestCase ("Check the attributes of the TypeIds and of their parents")
+{
+}
+
+AllAttributesTestCase::~AllAttributesTestCase ()
+{
+}
+
+void
+AllAttributesTestCase::DoRun (void)
+{
+  uint32_t nids = TypeId::GetRegisteredN ();
+  for (uint32_t i = 0; i < nids; ++i)
+    {
+      const TypeId tid = TypeId::GetRegistered (i);
+      // walk the inheritance tree as GetAllAttribute does
+      uint32_t k = 0;
+      TypeId tmp = tid;
+      while (true)
+        {
+          for (uint32_t j = 0; j < tmp.GetAttributeN (); ++j, ++k)
+            {
+              NS_TEST_ASSERT_MSG_LT (k, tid.GetAllAttributeN (),
+                                     "Missing attributes for " << tid.GetName ());
+              TypeId owner;
+              const struct TypeId::AttributeInformation &info = tid.GetAllAttribute (k, &owner);
+              NS_TEST_ASSERT_MSG_EQ (owner, tmp, "Wrong owner for " << tid.GetName ());
+              NS_TEST_ASSERT_MSG_EQ (info.name, tmp.GetAttribute (j).name,
+                                     "Wrong attribute for " << tid.GetName ());
+
+              struct TypeId::AttributeInformation found;
+              NS_TEST_ASSERT_MSG_EQ (tid.LookupAttributeByName (info.name, &found), true,
+                                     "LookupAttributeByName failed for " << tid.GetName ());
+              NS_TEST_ASSERT_MSG_EQ (found.accessor, info.accessor,
+                                     "LookupAttributeByName found another attribute for " << tid.GetName ());
+            }
+          // the types of the collision test have no parent at all
+          if (tmp.GetParent () == tmp || tmp.GetParent ().GetUid () == 0)
+            {
+              break;
+            }
+          tmp = tmp.GetParent ();
+        }
+      NS_TEST_ASSERT_MSG_EQ (k, tid.GetAllAttributeN (), "Extra attributes for " << tid.GetName ());
+    }
+}
+
+
 //----------------------------
 //
 // Performance test
@@ -298,6 +371,7 @@ TypeIdTestSuite::TypeIdTestSuite ()
   // as chained.
   AddTestCase (new UniqueTypeIdTestCase, QUICK);
   AddTestCase (new CollisionTestCase, QUICK);
+  AddTestCase (new AllAttributesTestCase, QUICK);
 }
 
 static TypeIdTestSuite g_TypeIdTestSuite;  
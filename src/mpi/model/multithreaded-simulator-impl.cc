@@ -0,0 +1,656 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/core-config.h"
+#include "ns3/simulator.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/make-event.h"
+#include "ns3/channel.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/nstime.h"
+#include "ns3/callback.h"
+#include "ns3/ptr.h"
+#include "ns3/assert.h"
+#include "ns3/fatal-error.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+__thread MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::m_current = 0;
+
+bool
+MultithreadedSimulatorImpl::Message::operator < (const Message &o) const
+{
+  if (target != o.target)
+    {
+      return target < o.target;
+    }
+  return ev.key.m_ts < o.ev.key.m_ts;
+}
+
+MultithreadedSimulatorImpl::Partition::Partition (MultithreadedSimulatorImpl *impl,
+                                                  uint32_t id, Ptr<Scheduler> events)
+  : m_impl (impl),
+    m_id (id),
+    m_events (events),
+    // uids are allocated from 4.
+    // uid 0 is "invalid" events
+    // uid 1 is "now" events
+    // uid 2 is "destroy" events
+    m_uid (4),
+    // before ::Run is entered, the m_currentUid will be zero
+    m_currentUid (0),
+    m_currentTs (0),
+    m_currentContext (0xffffffff),
+    m_unscheduledEvents (0),
+    m_stop (false)
+{
+}
+
+void
+MultithreadedSimulatorImpl::Partition::Run (void)
+{
+  m_impl->RunPartition (this);
+}
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("MaximumLookAhead",
+                   "An upper bound of the lookahead, used when no point-to-point "
+                   "channel connects different partitions.",
+                   TimeValue (Seconds (-1)),
+                   MakeTimeAccessor (&MultithreadedSimulatorImpl::m_maxLookAhead),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_running (false),
+    m_stopTs (0x7fffffffffffffffLL),
+    m_lookAhead (0),
+    m_windowEnd (0),
+    m_finished (false),
+    m_windows (0),
+    m_waiting (0),
+    m_generation (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_schedulerFactory.SetTypeId ("ns3::MapScheduler");
+#ifndef NS3_MULTITHREADED
+  NS_FATAL_ERROR ("Can't use the multithreaded simulator without --enable-multithreading");
+#endif
+  pthread_mutex_init (&m_barrierMutex, 0);
+  pthread_cond_init (&m_barrierCond, 0);
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  pthread_cond_destroy (&m_barrierCond);
+  pthread_mutex_destroy (&m_barrierMutex);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Partition *partition = *i;
+      while (!partition->m_events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->m_events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      delete partition;
+    }
+  m_partitions.clear ();
+  m_nodePartitions.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  NS_ASSERT (!m_running);
+  m_schedulerFactory = schedulerFactory;
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      while (!(*i)->m_events->IsEmpty ())
+        {
+          scheduler->Insert ((*i)->m_events->RemoveNext ());
+        }
+      (*i)->m_events = scheduler;
+    }
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetCurrent (void) const
+{
+  if (m_current != 0)
+    {
+      return m_current;
+    }
+  // the main thread, outside of Run
+  return const_cast<MultithreadedSimulatorImpl *> (this)->GetPartition (0);
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetPartition (uint32_t systemId)
+{
+  while (m_partitions.size () <= systemId)
+    {
+      NS_ASSERT (!m_running);
+      Partition *partition = new Partition (this, m_partitions.size (),
+                                            m_schedulerFactory.Create<Scheduler> ());
+      m_partitions.push_back (partition);
+    }
+  return m_partitions[systemId];
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetPartitionOf (uint32_t context) const
+{
+  if (m_running)
+    {
+      if (context < m_nodePartitions.size ())
+        {
+          return m_nodePartitions[context];
+        }
+      return GetCurrent ();
+    }
+  if (context < NodeList::GetNNodes ())
+    {
+      uint32_t systemId = NodeList::GetNode (context)->GetSystemId ();
+      return const_cast<MultithreadedSimulatorImpl *> (this)->GetPartition (systemId);
+    }
+  return GetCurrent ();
+}
+
+void
+MultithreadedSimulatorImpl::Insert (Partition *partition, Scheduler::Event &ev)
+{
+  ev.key.m_uid = partition->m_uid;
+  partition->m_uid++;
+  // the context of the event does not always tell its partition,
+  // e.g. 0xffffffff, so remember it for Remove and IsExpired.
+  ev.impl->SetSimulatorSlot (partition->m_id);
+  partition->m_unscheduledEvents++;
+  partition->m_events->Insert (ev);
+}
+
+void
+MultithreadedSimulatorImpl::CalculateLookAhead (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time lookAhead = m_maxLookAhead.IsStrictlyPositive () ? m_maxLookAhead : GetMaximumSimulationTime ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          Ptr<NetDevice> device = node->GetDevice (j);
+          Ptr<Channel> channel = device->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          for (uint32_t k = 0; k < channel->GetNDevices (); ++k)
+            {
+              Ptr<Node> remote = channel->GetDevice (k)->GetNode ();
+              if (remote->GetSystemId () == node->GetSystemId ())
+                {
+                  continue;
+                }
+              if (!device->IsPointToPoint ())
+                {
+                  NS_FATAL_ERROR ("Node " << node->GetId () << " and node " << remote->GetId () <<
+                                  " belong to different partitions but are not connected by a "
+                                  "point-to-point channel");
+                }
+              TimeValue delay;
+              channel->GetAttribute ("Delay", delay);
+              lookAhead = std::min (lookAhead, delay.Get ());
+            }
+        }
+    }
+  if (!lookAhead.IsStrictlyPositive ())
+    {
+      NS_FATAL_ERROR ("Partitions must be connected by channels with a positive delay");
+    }
+  m_lookAhead = lookAhead.GetTimeStep ();
+  NS_LOG_INFO ("lookahead is " << lookAhead);
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition *partition)
+{
+  Scheduler::Event next = partition->m_events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= partition->m_currentTs);
+  partition->m_unscheduledEvents--;
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts << " in partition " << partition->m_id);
+  partition->m_currentTs = next.key.m_ts;
+  partition->m_currentContext = next.key.m_context;
+  partition->m_currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      if ((*i)->m_stop)
+        {
+          return true;
+        }
+    }
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      if (!(*i)->m_events->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::NextWindow (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Deliver the events exchanged during the window. The outboxes are
+  // gathered in partition order and the sort is stable, so events with
+  // equal timestamps are ordered by sender, then by scheduling order,
+  // whatever the interleaving of the threads was.
+  std::vector<Message> messages;
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      messages.insert (messages.end (), (*i)->m_outbox.begin (), (*i)->m_outbox.end ());
+      (*i)->m_outbox.clear ();
+    }
+  std::stable_sort (messages.begin (), messages.end ());
+  for (std::vector<Message>::iterator i = messages.begin (); i != messages.end (); ++i)
+    {
+      Insert (m_partitions[i->target], i->ev);
+    }
+
+  uint64_t next = GetMaximumSimulationTime ().GetTimeStep ();
+  bool stop = false;
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      stop |= (*i)->m_stop;
+      if (!(*i)->m_events->IsEmpty ())
+        {
+          next = std::min (next, (*i)->m_events->PeekNext ().key.m_ts);
+        }
+    }
+  uint64_t max = GetMaximumSimulationTime ().GetTimeStep ();
+  m_finished = stop || next == max;
+  m_windowEnd = next > max - m_lookAhead ? max : next + m_lookAhead;
+  m_windows++;
+  NS_LOG_LOGIC ("window " << m_windows << " ends at " << m_windowEnd);
+}
+
+void
+MultithreadedSimulatorImpl::Barrier (void)
+{
+  pthread_mutex_lock (&m_barrierMutex);
+  uint32_t generation = m_generation;
+  m_waiting++;
+  if (m_waiting == m_partitions.size ())
+    {
+      // the last thread to reach the barrier prepares the next window
+      // while all the others are waiting.
+      m_waiting = 0;
+      NextWindow ();
+      m_generation++;
+      pthread_cond_broadcast (&m_barrierCond);
+    }
+  else
+    {
+      while (generation == m_generation)
+        {
+          pthread_cond_wait (&m_barrierCond, &m_barrierMutex);
+        }
+    }
+  pthread_mutex_unlock (&m_barrierMutex);
+}
+
+void
+MultithreadedSimulatorImpl::RunPartition (Partition *partition)
+{
+  NS_LOG_FUNCTION (this << partition->m_id);
+  m_current = partition;
+  while (!m_finished)
+    {
+      while (!partition->m_stop && !partition->m_events->IsEmpty ()
+             && partition->m_events->PeekNext ().key.m_ts < m_windowEnd)
+        {
+          ProcessOneEvent (partition);
+        }
+      Barrier ();
+    }
+  m_current = 0;
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  // create the partitions of all nodes, even those without events
+  m_nodePartitions.clear ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+    {
+      m_nodePartitions.push_back (GetPartition ((*i)->GetSystemId ()));
+    }
+  GetPartition (0);
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Partition *partition = *i;
+      partition->m_stop = false;
+      if (m_stopTs != static_cast<uint64_t> (GetMaximumSimulationTime ().GetTimeStep ()))
+        {
+          Scheduler::Event ev;
+          ev.impl = MakeEvent (&Simulator::Stop);
+          ev.key.m_ts = m_stopTs;
+          ev.key.m_context = 0xffffffff;
+          Insert (partition, ev);
+        }
+    }
+  m_stopTs = GetMaximumSimulationTime ().GetTimeStep ();
+  CalculateLookAhead ();
+  NS_LOG_INFO ("running " << m_partitions.size () << " partitions");
+
+  m_running = true;
+  m_windows = 0;
+  NextWindow ();
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < m_partitions.size (); ++i)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&Partition::Run, m_partitions[i]));
+      thread->Start ();
+      threads.push_back (thread);
+    }
+  RunPartition (m_partitions[0]);
+  for (std::vector<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+  m_running = false;
+  NS_LOG_INFO ("ran " << m_windows << " windows");
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      NS_ASSERT (!(*i)->m_events->IsEmpty () || (*i)->m_unscheduledEvents == 0);
+    }
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return GetCurrent ()->m_id;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  // the other partitions stop at the end of the current window
+  GetCurrent ()->m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &time)
+{
+  NS_LOG_FUNCTION (this << time.GetTimeStep ());
+  if (!m_running)
+    {
+      // all the partitions will stop at this time
+      uint64_t ts = GetCurrent ()->m_currentTs + time.GetTimeStep ();
+      m_stopTs = std::min (m_stopTs, ts);
+      return;
+    }
+  // the other partitions stop at the end of the window
+  Simulator::Schedule (time, &Simulator::Stop);
+}
+
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &time, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << time.GetTimeStep () << event);
+  Partition *partition = GetCurrent ();
+
+  Time tAbsolute = time + TimeStep (partition->m_currentTs);
+
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (partition->m_currentTs));
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = static_cast<uint64_t> (tAbsolute.GetTimeStep ());
+  ev.key.m_context = partition->m_currentContext;
+  Insert (partition, ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << time.GetTimeStep () << event);
+  Partition *partition = GetCurrent ();
+  Partition *target = GetPartitionOf (context);
+
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = partition->m_currentTs + time.GetTimeStep ();
+  ev.key.m_context = context;
+  if (!m_running || target == partition)
+    {
+      Insert (target, ev);
+      return;
+    }
+  if (ev.key.m_ts < m_windowEnd)
+    {
+      NS_FATAL_ERROR ("Event scheduled for node " << context << " in partition " << target->m_id <<
+                      " with a delay of " << time << " is earlier than the lookahead allows");
+    }
+  // handed over to the target at the end of the window
+  Message message;
+  message.ev = ev;
+  message.target = target->m_id;
+  partition->m_outbox.push_back (message);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+  Partition *partition = GetCurrent ();
+
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = partition->m_currentTs;
+  ev.key.m_context = partition->m_currentContext;
+  Insert (partition, ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+  CriticalSection cs (m_destroyMutex);
+  EventId id (Ptr<EventImpl> (event, false), GetCurrent ()->m_currentTs, 0xffffffff, 2);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  return TimeStep (GetCurrent ()->m_currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      Partition *partition = m_partitions[id.PeekEventImpl ()->GetSimulatorSlot ()];
+      return TimeStep (id.GetTs () - partition->m_currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *partition = m_partitions[id.PeekEventImpl ()->GetSimulatorSlot ()];
+  NS_ASSERT_MSG (!m_running || partition == GetCurrent (),
+                 "Events can only be removed by the partition which runs them");
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  partition->m_events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  partition->m_unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &ev) const
+{
+  if (ev.GetUid () == 2)
+    {
+      if (ev.PeekEventImpl () == 0
+          || ev.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (m_destroyMutex);
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == ev)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  if (ev.PeekEventImpl () == 0)
+    {
+      return true;
+    }
+  Partition *partition = m_partitions[ev.PeekEventImpl ()->GetSimulatorSlot ()];
+  if (ev.GetTs () < partition->m_currentTs
+      || (ev.GetTs () == partition->m_currentTs
+          && ev.GetUid () <= partition->m_currentUid)
+      || ev.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return GetCurrent ()->m_currentContext;
+}
+
+} // namespace ns3
@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/ptr.h"
+
+#include <pthread.h>
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \ingroup mpi
+ *
+ * \brief Shared-memory parallel simulator implementation
+ *
+ * The nodes are partitioned by system id, just like for the
+ * DistributedSimulatorImpl, but all the partitions run in a single
+ * process, each in its own thread, and each with its own event list.
+ * Partition 0 runs in the thread which calls Simulator::Run.
+ *
+ * The synchronization is conservative and uses granted time windows: the
+ * lookahead is the smallest delay of the point-to-point channels which
+ * connect nodes of different partitions. Each window ends at the time of
+ * the earliest pending event plus the lookahead, so that no event
+ * scheduled by another partition during the window can fall inside it.
+ * At the end of each window, all the threads meet at a barrier where the
+ * events scheduled for another partition are delivered, in a
+ * deterministic order. These events, and the packets they hold, are
+ * handed over as-is: nothing is serialized.
+ *
+ * Objects are shared between threads, so ns-3 must be configured with
+ * --enable-multithreading, which makes reference counts atomic. Events
+ * must be scheduled with the id of the node they act on as context
+ * (which is what the channels, the applications and Node do); events
+ * without a node context run in partition 0. Channels other than
+ * point-to-point ones cannot connect nodes of different partitions.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  static TypeId GetTypeId (void);
+
+  MultithreadedSimulatorImpl ();
+  ~MultithreadedSimulatorImpl ();
+
+  // virtual from SimulatorImpl
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &time);
+  virtual EventId Schedule (Time const &time, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &ev);
+  virtual void Cancel (const EventId &ev);
+  virtual bool IsExpired (const EventId &ev) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+private:
+  /**
+   * An event scheduled by a partition for another one.
+   */
+  struct Message
+  {
+    // order of delivery to the partitions
+    bool operator < (const Message &o) const;
+
+    Scheduler::Event ev;
+    uint32_t target;
+  };
+
+  /**
+   * The state of a partition, which is only used by its own thread
+   * while a window is processed.
+   */
+  class Partition
+  {
+  public:
+    Partition (MultithreadedSimulatorImpl *impl, uint32_t id, Ptr<Scheduler> events);
+    // thread body
+    void Run (void);
+
+    MultithreadedSimulatorImpl *m_impl;
+    uint32_t m_id;
+    Ptr<Scheduler> m_events;
+    uint32_t m_uid;
+    uint32_t m_currentUid;
+    uint64_t m_currentTs;
+    uint32_t m_currentContext;
+    // number of events that have been inserted but not yet scheduled
+    int m_unscheduledEvents;
+    bool m_stop;
+    // events scheduled for other partitions during the current window
+    std::vector<Message> m_outbox;
+  };
+
+  virtual void DoDispose (void);
+
+  Partition *GetCurrent (void) const;
+  Partition *GetPartition (uint32_t systemId);
+  Partition *GetPartitionOf (uint32_t context) const;
+  void Insert (Partition *partition, Scheduler::Event &ev);
+  void CalculateLookAhead (void);
+  void ProcessOneEvent (Partition *partition);
+  void RunPartition (Partition *partition);
+  void Barrier (void);
+  void NextWindow (void);
+
+  typedef std::list<EventId> DestroyEvents;
+
+  DestroyEvents m_destroyEvents;
+  mutable SystemMutex m_destroyMutex;
+  ObjectFactory m_schedulerFactory;
+  std::vector<Partition *> m_partitions;
+  // partition of each node, valid during Run
+  std::vector<Partition *> m_nodePartitions;
+  bool m_running;
+  // time of the Stop requested before Run
+  uint64_t m_stopTs;
+
+  Time m_maxLookAhead;
+  uint64_t m_lookAhead;
+  // events of the current window are strictly earlier than m_windowEnd
+  uint64_t m_windowEnd;
+  bool m_finished;
+  uint64_t m_windows;
+
+  pthread_mutex_t m_barrierMutex;
+  pthread_cond_t m_barrierCond;
+  uint32_t m_waiting;
+  uint32_t m_generation;
+
+  // partition run by the calling thread, if any
+  static __thread Partition *m_current;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
@@ -21,10 +21,13 @@
 #include "ns3/log.h"
 #include "ns3/assert.h"
 #include "ns3/packet.h"
+#include "ns3/system-mutex.h"
 
 #include "model/ndn-l3-protocol.hpp"
 #include "model/ndn-app-face.hpp"
 
+#include <map>
+
 NS_LOG_COMPONENT_DEFINE("ndn.App");
 
 namespace ns3 {
@@ -88,14 +91,28 @@ void
 App::OnInterest(shared_ptr<const Interest> interest)
 {
   NS_LOG_FUNCTION(this << interest);
-  m_receivedInterests(interest, this, m_face);
+  NS_TRACE(m_receivedInterests, (interest, this, m_face));
 }
 
 void
 App::OnData(shared_ptr<const Data> data)
 {
   NS_LOG_FUNCTION(this << data);
-  m_receivedDatas(data, this, m_face);
+  NS_TRACE(m_receivedDatas, (data, this, m_face));
+}
+
+shared_ptr<const ::ndn::Buffer>
+App::GetVirtualPayload(size_t size)
+{
+  static std::map<size_t, shared_ptr<const ::ndn::Buffer>> payloads;
+  // the applications of the multithreaded simulator run in several threads
+  static SystemMutex mutex;
+  CriticalSection cs(mutex);
+
+  shared_ptr<const ::ndn::Buffer>& payload = payloads[size];
+  if (payload == nullptr)
+    payload = make_shared< ::ndn::Buffer>(size);
+  return payload;
 }
 
 // Application Methods
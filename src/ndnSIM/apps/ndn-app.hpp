@@ -80,6 +80,18 @@ public:
   virtual void
   OnData(shared_ptr<const Data> data);
 
+  /**
+   * @brief Get the content of the Data with a virtual payload of the given size
+   *
+   * The virtual payloads are only zeros: one buffer is shared by all the Data of
+   * the same payload size, instead of allocating and zeroing a new buffer for each
+   * Data.  The Content block of the Data references this buffer without copying it.
+   *
+   * @param size payload size, in bytes
+   */
+  static shared_ptr<const ::ndn::Buffer>
+  GetVirtualPayload(size_t size);
+
 protected:
   /**
    * @brief Do cleanup when application is destroyed
@@ -175,7 +175,7 @@ CDN::OnPushInterest(const Name &interestName)
   // to create real wire encoding
   data->wireEncode();
 
-  m_transmittedDatas(data, this, m_face);
+  NS_TRACE(m_transmittedDatas, (data, this, m_face));
   m_face->onReceiveData(*data);
 }
 
@@ -279,7 +279,7 @@ CDNConsumer::SendPacket()
 
   WillSendOutInterest(seq);
 
-  m_transmittedInterests(interest, m_app, m_face);
+  NS_TRACE(m_transmittedInterests, (interest, m_app, m_face));
   m_face->onReceiveInterest(*interest);
 
   ScheduleNextPacket();
@@ -106,7 +106,7 @@ CDNProducer::OnInterest(shared_ptr<const Interest> interest, CDNStore& m_CDNStor
   data->setName(dataName);
   data->setFreshnessPeriod(::ndn::time::milliseconds(m_freshness.GetMilliSeconds()));
 
-  data->setContent(make_shared< ::ndn::Buffer>(m_virtualPayloadSize));
+  data->setContent(App::GetVirtualPayload(m_virtualPayloadSize));
 
   Signature signature;
   SignatureInfo signatureInfo(static_cast< ::ndn::tlv::SignatureTypeValue>(255));
@@ -125,7 +125,7 @@ CDNProducer::OnInterest(shared_ptr<const Interest> interest, CDNStore& m_CDNStor
   // to create real wire encoding
   data->wireEncode();
 
-  m_transmittedDatas(data, m_app, m_face);
+  NS_TRACE(m_transmittedDatas, (data, m_app, m_face));
   m_face->onReceiveData(*data);
 }
 
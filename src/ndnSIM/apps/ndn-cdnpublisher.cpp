@@ -123,7 +123,7 @@ CDNPublisher::OnInterest(shared_ptr<const Interest> interest)
   data->setName(dataName);
   data->setFreshnessPeriod(::ndn::time::milliseconds(m_freshness.GetMilliSeconds()));
 
-  data->setContent(make_shared< ::ndn::Buffer>(m_virtualPayloadSize));
+  data->setContent(App::GetVirtualPayload(m_virtualPayloadSize));
   data->setFinalBlockId(::ndn::name::Component::fromNumber(m_MaxSize));//wait to check
 
   Signature signature;
@@ -143,7 +143,7 @@ CDNPublisher::OnInterest(shared_ptr<const Interest> interest)
   // to create real wire encoding
   data->wireEncode();
 
-  m_transmittedDatas(data, this, m_face);
+  NS_TRACE(m_transmittedDatas, (data, this, m_face));
   m_face->onReceiveData(*data);
 }
 
@@ -171,7 +171,7 @@ CDNPublisher::SendPacket(uint32_t cdn_id, uint32_t interaction_type)
   // NS_LOG_INFO ("Requesting Interest: \n" << *interest);
   NS_LOG_INFO("send interaction interest to publish a file"<< cdn_id << interaction_type );
 
-  m_transmittedInterests(interest, this, m_face);
+  NS_TRACE(m_transmittedInterests, (interest, this, m_face));
   m_face->onReceiveInterest(*interest);
 }
 
@@ -0,0 +1,448 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "ndn-consumer-abr.hpp"
+#include "ns3/ptr.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/callback.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+
+#include <algorithm>
+#include <sstream>
+#include <cmath>
+#include <limits>
+
+NS_LOG_COMPONENT_DEFINE("ndn.ConsumerAbr");
+
+namespace ns3 {
+namespace ndn {
+
+NS_OBJECT_ENSURE_REGISTERED(ConsumerAbr);
+
+TypeId
+ConsumerAbr::GetTypeId(void)
+{
+  static TypeId tid =
+    TypeId("ns3::ndn::ConsumerAbr")
+      .SetGroupName("Ndn")
+      .SetParent<Consumer>()
+      .AddConstructor<ConsumerAbr>()
+
+      .AddAttribute("Bitrates", "Comma-separated list of variant bitrates in kbps",
+                    StringValue("250,500,1000,2000,4000"),
+                    MakeStringAccessor(&ConsumerAbr::SetBitrates, &ConsumerAbr::GetBitrates),
+                    MakeStringChecker())
+
+      .AddAttribute("SegmentDuration", "Media duration of one segment", StringValue("2s"),
+                    MakeTimeAccessor(&ConsumerAbr::m_segmentDuration), MakeTimeChecker())
+
+      .AddAttribute("NumSegments", "Number of segments in the content", UintegerValue(150),
+                    MakeUintegerAccessor(&ConsumerAbr::m_numSegments),
+                    MakeUintegerChecker<uint32_t>())
+
+      .AddAttribute("PayloadSize",
+                    "Expected payload size of one Data chunk (to calculate chunks per segment)",
+                    UintegerValue(1024), MakeUintegerAccessor(&ConsumerAbr::m_payloadSize),
+                    MakeUintegerChecker<uint32_t>(1))
+
+      .AddAttribute("Window", "Maximum number of outstanding chunk Interests", UintegerValue(16),
+                    MakeUintegerAccessor(&ConsumerAbr::m_window),
+                    MakeUintegerChecker<uint32_t>(1))
+
+      .AddAttribute("StartupBuffer", "Buffered media required to start or resume playout",
+                    StringValue("4s"), MakeTimeAccessor(&ConsumerAbr::m_startupBuffer),
+                    MakeTimeChecker())
+
+      .AddAttribute("MaxBuffer", "Buffered media above which segment downloads are paused",
+                    StringValue("30s"), MakeTimeAccessor(&ConsumerAbr::m_maxBuffer),
+                    MakeTimeChecker())
+
+      .AddAttribute("SafetyFactor", "Fraction of the estimated throughput a variant may use",
+                    DoubleValue(0.9), MakeDoubleAccessor(&ConsumerAbr::m_safetyFactor),
+                    MakeDoubleChecker<double>(0.0))
+
+      .AddAttribute("ThroughputAlpha",
+                    "Weight of the newest sample in the smoothed throughput estimate",
+                    DoubleValue(0.3), MakeDoubleAccessor(&ConsumerAbr::m_alpha),
+                    MakeDoubleChecker<double>(0.0, 1.0))
+
+      .AddTraceSource("StartupDelay", "Delay between application start and start of playout",
+                      MakeTraceSourceAccessor(&ConsumerAbr::m_startupDelay))
+
+      .AddTraceSource("Rebuffer", "Playout stall that has just ended, with its duration",
+                      MakeTraceSourceAccessor(&ConsumerAbr::m_rebuffer))
+
+      .AddTraceSource("SegmentFetched",
+                      "Segment downloaded, with its bitrate, download time and new buffer level",
+                      MakeTraceSourceAccessor(&ConsumerAbr::m_segmentFetched));
+
+  return tid;
+}
+
+ConsumerAbr::ConsumerAbr()
+  : m_numSegments(150)
+  , m_payloadSize(1024)
+  , m_window(16)
+  , m_safetyFactor(0.9)
+  , m_alpha(0.3)
+  , m_segment(0)
+  , m_variant(0)
+  , m_segmentSeq(0)
+  , m_chunksLeft(0)
+  , m_segmentBytes(0)
+  , m_throughput(0.0)
+  , m_downloading(false)
+  , m_playing(false)
+  , m_started(false)
+{
+  NS_LOG_FUNCTION_NOARGS();
+}
+
+void
+ConsumerAbr::SetBitrates(const std::string& bitrates)
+{
+  std::vector<uint32_t> parsed;
+  std::istringstream is(bitrates);
+  std::string item;
+  while (std::getline(is, item, ',')) {
+    std::istringstream value(item);
+    uint32_t bitrate = 0;
+    if (!(value >> bitrate) || bitrate == 0) {
+      NS_FATAL_ERROR("Invalid bitrate \"" << item << "\" in \"" << bitrates << "\"");
+    }
+    parsed.push_back(bitrate);
+  }
+  NS_ABORT_MSG_IF(parsed.empty(), "At least one bitrate variant is required");
+
+  std::sort(parsed.begin(), parsed.end());
+  m_bitrates.swap(parsed);
+}
+
+std::string
+ConsumerAbr::GetBitrates() const
+{
+  std::ostringstream os;
+  for (std::vector<uint32_t>::const_iterator i = m_bitrates.begin(); i != m_bitrates.end(); ++i) {
+    if (i != m_bitrates.begin())
+      os << ",";
+    os << *i;
+  }
+  return os.str();
+}
+
+uint32_t
+ConsumerAbr::GetChunksPerSegment(uint32_t variant) const
+{
+  double bytes = m_bitrates[variant] * 1000.0 / 8.0 * m_segmentDuration.ToDouble(Time::S);
+  return std::max<uint32_t>(1, static_cast<uint32_t>(std::ceil(bytes / m_payloadSize)));
+}
+
+// Application Methods
+void
+ConsumerAbr::StartApplication()
+{
+  NS_LOG_FUNCTION_NOARGS();
+
+  m_contentPrefix = m_interestName;
+  m_segment = 0;
+  m_variant = 0;
+  m_inFlight.clear();
+  m_throughput = 0.0;
+  m_downloading = false;
+  m_buffer = Seconds(0);
+  m_bufferUpdated = Simulator::Now();
+  m_playing = false;
+  m_started = false;
+  m_startTime = Simulator::Now();
+
+  Consumer::StartApplication();
+
+  if (m_numSegments > 0)
+    RequestSegment();
+}
+
+void
+ConsumerAbr::StopApplication()
+{
+  NS_LOG_FUNCTION_NOARGS();
+
+  Simulator::Cancel(m_requestEvent);
+  Simulator::Cancel(m_emptyEvent);
+  m_downloading = false;
+  m_playing = false;
+
+  // restore the content prefix, so the application can be restarted
+  m_interestName = m_contentPrefix;
+
+  Consumer::StopApplication();
+}
+
+void
+ConsumerAbr::RequestSegment()
+{
+  m_interestName = m_contentPrefix;
+  m_interestName.appendNumber(m_variant).appendNumber(m_segment);
+
+  // m_seq is not reset: the sequence numbers of this segment follow those of the previous one,
+  // while the chunk numbers in the names start again from 0
+  m_segmentSeq = m_seq;
+  m_seqMax = m_seq + GetChunksPerSegment(m_variant);
+  m_chunksLeft = m_seqMax - m_seq;
+  m_inFlight.clear();
+  m_segmentBytes = 0;
+  m_segmentStart = Simulator::Now();
+  m_downloading = true;
+
+  NS_LOG_INFO("> Segment " << m_segment << " at " << m_bitrates[m_variant] << " kbps ("
+                           << m_chunksLeft << " chunks)");
+
+  ScheduleNextPacket();
+}
+
+void
+ConsumerAbr::ScheduleNextPacket()
+{
+  if (!m_downloading || m_inFlight.size() >= m_window)
+    return;
+
+  if (m_retxSeqs.empty() && m_seq >= m_seqMax)
+    return; // everything for this segment has been requested
+
+  if (!m_sendEvent.IsRunning())
+    m_sendEvent = Simulator::ScheduleNow(&ConsumerAbr::SendPacket, this);
+}
+
+void
+ConsumerAbr::SendPacket()
+{
+  if (!m_active)
+    return;
+
+  NS_LOG_FUNCTION_NOARGS();
+
+  uint32_t seq = std::numeric_limits<uint32_t>::max(); // invalid
+
+  if (!m_retxSeqs.empty()) {
+    seq = *m_retxSeqs.begin();
+    m_retxSeqs.erase(m_retxSeqs.begin());
+  }
+  else {
+    if (m_seq >= m_seqMax)
+      return; // everything for this segment has been requested
+
+    seq = m_seq++;
+  }
+
+  shared_ptr<Name> nameWithSequence = make_shared<Name>(m_interestName);
+  nameWithSequence->appendSequenceNumber(seq - m_segmentSeq);
+
+  shared_ptr<Interest> interest = make_shared<Interest>();
+  interest->setNonce(m_rand.GetValue());
+  interest->setName(*nameWithSequence);
+  time::milliseconds interestLifeTime(m_interestLifeTime.GetMilliSeconds());
+  interest->setInterestLifetime(interestLifeTime);
+
+  NS_LOG_INFO("> Interest for chunk " << seq - m_segmentSeq << " (" << seq << ")");
+
+  WillSendOutInterest(seq);
+
+  NS_TRACE(m_transmittedInterests, (interest, this, m_face));
+  m_face->onReceiveInterest(*interest);
+
+  ScheduleNextPacket();
+}
+
+///////////////////////////////////////////////////
+//          Process incoming packets             //
+///////////////////////////////////////////////////
+
+void
+ConsumerAbr::OnData(shared_ptr<const Data> data)
+{
+  if (!m_active)
+    return;
+
+  if (!m_downloading || data->getName().getPrefix(-1) != m_interestName) {
+    NS_LOG_DEBUG("Ignoring late Data " << data->getName());
+    return;
+  }
+
+  uint32_t chunk = data->getName().at(-1).toSequenceNumber();
+  if (chunk >= m_seqMax - m_segmentSeq) {
+    NS_LOG_DEBUG("Ignoring Data beyond the segment " << data->getName());
+    return;
+  }
+
+  uint32_t seq = m_segmentSeq + chunk;
+  bool isOutstanding = m_seqFullDelay.find(seq) != m_seqFullDelay.end();
+
+  Consumer::OnSequenceData(data, seq);
+
+  // a late Data for a timed out Interest does not free a second slot of the window
+  m_inFlight.erase(seq);
+
+  if (!isOutstanding)
+    return; // duplicate
+
+  m_segmentBytes += data->getContent().value_size();
+  if (--m_chunksLeft == 0) {
+    OnSegmentFetched();
+    return;
+  }
+
+  ScheduleNextPacket();
+}
+
+void
+ConsumerAbr::OnTimeout(uint32_t sequenceNumber)
+{
+  m_inFlight.erase(sequenceNumber);
+
+  Consumer::OnTimeout(sequenceNumber);
+}
+
+void
+ConsumerAbr::WillSendOutInterest(uint32_t sequenceNumber)
+{
+  m_inFlight.insert(sequenceNumber);
+  Consumer::WillSendOutInterest(sequenceNumber);
+}
+
+///////////////////////////////////////////////////
+//          Rate adaptation and playout          //
+///////////////////////////////////////////////////
+
+void
+ConsumerAbr::OnSegmentFetched()
+{
+  m_downloading = false;
+
+  Time downloadTime = Simulator::Now() - m_segmentStart;
+  if (downloadTime.IsStrictlyPositive()) {
+    double sample = 8.0 * m_segmentBytes / downloadTime.ToDouble(Time::S);
+    m_throughput = (m_throughput == 0.0) ? sample : m_alpha * sample + (1 - m_alpha) * m_throughput;
+  }
+
+  UpdateBuffer();
+  m_buffer += m_segmentDuration;
+
+  NS_LOG_INFO("< Segment " << m_segment << " in " << downloadTime.ToDouble(Time::S)
+                           << "s, throughput " << m_throughput << " bps, buffer "
+                           << m_buffer.ToDouble(Time::S) << "s");
+  m_segmentFetched(this, m_segment, m_bitrates[m_variant], downloadTime, m_buffer);
+
+  m_segment++;
+  bool isLast = m_segment >= m_numSegments;
+
+  if (!m_playing) {
+    if (m_buffer >= m_startupBuffer || isLast)
+      StartPlayout();
+  }
+  else {
+    if (m_emptyEvent.IsRunning())
+      Simulator::Remove(m_emptyEvent);
+    m_emptyEvent = Simulator::Schedule(m_buffer, &ConsumerAbr::OnBufferEmpty, this);
+  }
+
+  if (isLast)
+    return;
+
+  m_variant = SelectVariant();
+
+  Time excess = m_buffer + m_segmentDuration - m_maxBuffer;
+  if (m_playing && excess.IsStrictlyPositive()) {
+    // wait until there is room for one more segment
+    m_requestEvent = Simulator::Schedule(excess, &ConsumerAbr::RequestSegment, this);
+  }
+  else
+    RequestSegment();
+}
+
+uint32_t
+ConsumerAbr::SelectVariant() const
+{
+  if (m_throughput == 0.0)
+    return 0;
+
+  // panic: less than one segment left to play
+  if (m_started && m_buffer < m_segmentDuration)
+    return 0;
+
+  uint32_t variant = 0;
+  for (uint32_t i = 1; i < m_bitrates.size(); i++) {
+    if (m_bitrates[i] * 1000.0 <= m_safetyFactor * m_throughput)
+      variant = i;
+  }
+  return variant;
+}
+
+void
+ConsumerAbr::UpdateBuffer()
+{
+  Time now = Simulator::Now();
+  if (m_playing) {
+    Time played = now - m_bufferUpdated;
+    m_buffer = (m_buffer > played) ? m_buffer - played : Seconds(0);
+  }
+  m_bufferUpdated = now;
+}
+
+void
+ConsumerAbr::StartPlayout()
+{
+  UpdateBuffer();
+  m_playing = true;
+
+  if (!m_started) {
+    m_started = true;
+    NS_LOG_INFO("Playout started after " << (Simulator::Now() - m_startTime).ToDouble(Time::S)
+                                         << "s");
+    m_startupDelay(this, Simulator::Now() - m_startTime);
+  }
+  else {
+    NS_LOG_INFO("Playout resumed after " << (Simulator::Now() - m_stallStart).ToDouble(Time::S)
+                                         << "s stall");
+    m_rebuffer(this, Simulator::Now() - m_stallStart);
+  }
+
+  m_emptyEvent = Simulator::Schedule(m_buffer, &ConsumerAbr::OnBufferEmpty, this);
+}
+
+void
+ConsumerAbr::OnBufferEmpty()
+{
+  UpdateBuffer();
+  m_playing = false;
+
+  if (m_segment >= m_numSegments) {
+    NS_LOG_INFO("Playout finished");
+    return;
+  }
+
+  NS_LOG_INFO("Buffer underrun while fetching segment " << m_segment);
+  m_stallStart = Simulator::Now();
+}
+
+} // namespace ndn
+} // namespace ns3
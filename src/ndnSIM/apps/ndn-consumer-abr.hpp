@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_CONSUMER_ABR_H
+#define NDN_CONSUMER_ABR_H
+
+#include "ns3/ndnSIM/model/ndn-common.hpp"
+
+#include "ndn-consumer.hpp"
+
+#include <set>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @ingroup ndn-apps
+ * \brief NDN application emulating an adaptive-bitrate (DASH-like) video client
+ *
+ * The content is a sequence of segments, each available in several bitrate variants.  Segment
+ * \p s of variant \p v is fetched as a CDNFile-like object named
+ * <tt>Prefix/v/s/[chunk seq]</tt>, where the chunks are numbered from 0 and their number is
+ * derived from the variant bitrate, SegmentDuration and PayloadSize.  Segments are downloaded
+ * one at a time, with up to Window chunk Interests in flight, using the Interest/retransmission
+ * machinery of Consumer.  This machinery tracks each chunk under a sequence number which runs on
+ * from one segment to the next, so that the RTT samples and the retransmission state of
+ * different segments never share a sequence number: the chunk number in the name is the
+ * sequence number less the one of the first chunk of the segment.
+ *
+ * After each segment the next variant is chosen as the highest bitrate not exceeding
+ * SafetyFactor times the smoothed download throughput (the lowest variant is used while the
+ * playout buffer holds less than one segment).  Playout starts once StartupBuffer seconds of
+ * media are buffered; a buffer underrun stalls playout until StartupBuffer is reached again.
+ *
+ * Playout is modelled lazily (the buffer level is only updated on segment arrival), so apart
+ * from the base Consumer the client only keeps a handful of scalars and at most two pending
+ * events, which keeps thousands of concurrent clients cheap.
+ */
+class ConsumerAbr : public Consumer {
+public:
+  static TypeId
+  GetTypeId();
+
+  /**
+   * \brief Default constructor
+   */
+  ConsumerAbr();
+
+  // From App
+  virtual void
+  OnData(shared_ptr<const Data> contentObject);
+
+  virtual void
+  OnTimeout(uint32_t sequenceNumber);
+
+  virtual void
+  WillSendOutInterest(uint32_t sequenceNumber);
+
+  /**
+   * \brief Sends the Interest of the next chunk, or of a chunk to retransmit, named with its
+   * chunk number in the current segment
+   */
+  void
+  SendPacket();
+
+protected:
+  // from App
+  virtual void
+  StartApplication();
+
+  virtual void
+  StopApplication();
+
+  /**
+   * \brief Keeps up to Window chunk Interests of the current segment in flight
+   */
+  virtual void
+  ScheduleNextPacket();
+
+private:
+  void
+  SetBitrates(const std::string& bitrates);
+
+  std::string
+  GetBitrates() const;
+
+  /**
+   * \brief Starts fetching segment m_segment using variant m_variant
+   */
+  void
+  RequestSegment();
+
+  /**
+   * \brief Called when all chunks of the current segment have been received
+   */
+  void
+  OnSegmentFetched();
+
+  /**
+   * \brief Chooses the variant for the next segment based on throughput and buffer level
+   */
+  uint32_t
+  SelectVariant() const;
+
+  /**
+   * \brief Number of Data chunks in one segment of the given variant
+   */
+  uint32_t
+  GetChunksPerSegment(uint32_t variant) const;
+
+  /**
+   * \brief Drains the playout buffer up to the current simulation time
+   */
+  void
+  UpdateBuffer();
+
+  void
+  StartPlayout();
+
+  /**
+   * \brief Fired when the playout buffer runs dry
+   */
+  void
+  OnBufferEmpty();
+
+private:
+  std::vector<uint32_t> m_bitrates; ///< @brief available variant bitrates (kbps), ascending
+  Time m_segmentDuration;           ///< @brief media duration of one segment
+  uint32_t m_numSegments;           ///< @brief number of segments in the content
+  uint32_t m_payloadSize;           ///< @brief expected payload size of one Data chunk
+  uint32_t m_window;                ///< @brief maximum chunk Interests in flight
+  Time m_startupBuffer;             ///< @brief buffered media needed to (re)start playout
+  Time m_maxBuffer;                 ///< @brief buffered media above which downloading pauses
+  double m_safetyFactor;            ///< @brief fraction of estimated throughput that may be used
+  double m_alpha;                   ///< @brief EWMA weight of the newest throughput sample
+
+  Name m_contentPrefix; ///< @brief base prefix of the content (value of Prefix attribute)
+
+  uint32_t m_segment;       ///< @brief segment currently being fetched
+  uint32_t m_variant;       ///< @brief variant of the segment currently being fetched
+  uint32_t m_segmentSeq;    ///< @brief sequence number of chunk 0 of the current segment
+  std::set<uint32_t> m_inFlight; ///< @brief chunks whose Interest is neither answered nor timed out
+  uint32_t m_chunksLeft;    ///< @brief chunks of the current segment not yet received
+  uint64_t m_segmentBytes;  ///< @brief payload bytes received for the current segment
+  Time m_segmentStart;      ///< @brief time when the current segment was requested
+  double m_throughput;      ///< @brief smoothed throughput estimate (bits/s), 0 if unknown
+  bool m_downloading;       ///< @brief true while a segment is being fetched
+
+  Time m_buffer;        ///< @brief buffered media as of m_bufferUpdated
+  Time m_bufferUpdated; ///< @brief last time m_buffer was brought up to date
+  bool m_playing;       ///< @brief true while playout is running
+  bool m_started;       ///< @brief true once playout has started for the first time
+  Time m_startTime;     ///< @brief application start time (for startup delay)
+  Time m_stallStart;    ///< @brief time when the current stall began
+
+  EventId m_requestEvent; ///< @brief deferred request of the next segment (buffer full)
+  EventId m_emptyEvent;   ///< @brief expected buffer underrun
+
+  TracedCallback<Ptr<App> /* app */, Time /* startup delay */> m_startupDelay;
+  TracedCallback<Ptr<App> /* app */, Time /* stall duration */> m_rebuffer;
+  TracedCallback<Ptr<App> /* app */, uint32_t /* segment */, uint32_t /* bitrate, kbps */,
+                 Time /* download time */, Time /* buffer level */> m_segmentFetched;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif
@@ -192,7 +192,7 @@ ConsumerZipfMandelbrot::SendPacket()
 
   m_rtt->SentSeq(SequenceNumber32(seq), 1);
 
-  m_transmittedInterests(interest, this, m_face);
+  NS_TRACE(m_transmittedInterests, (interest, this, m_face));
   m_face->onReceiveInterest(*interest);
 
   ConsumerZipfMandelbrot::ScheduleNextPacket();
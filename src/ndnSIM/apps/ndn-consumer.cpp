@@ -195,7 +195,7 @@ Consumer::SendPacket()
 
   WillSendOutInterest(seq);
 
-  m_transmittedInterests(interest, this, m_face);
+  NS_TRACE(m_transmittedInterests, (interest, this, m_face));
   m_face->onReceiveInterest(*interest);
 
   ScheduleNextPacket();
@@ -211,14 +211,19 @@ Consumer::OnData(shared_ptr<const Data> data)
   if (!m_active)
     return;
 
+  // This could be a problem......
+  OnSequenceData(data, data->getName().at(-1).toSequenceNumber());
+}
+
+void
+Consumer::OnSequenceData(shared_ptr<const Data> data, uint32_t seq)
+{
   App::OnData(data); // tracing inside
 
-  NS_LOG_FUNCTION(this << data);
+  NS_LOG_FUNCTION(this << data << seq);
 
   // NS_LOG_INFO ("Received content object: " << boost::cref(*data));
 
-  // This could be a problem......
-  uint32_t seq = data->getName().at(-1).toSequenceNumber();
   NS_LOG_INFO("< DATA for " << seq);
 
   int hopCount = -1;
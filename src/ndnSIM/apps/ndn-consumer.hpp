@@ -104,6 +104,15 @@ protected:
   virtual void
   ScheduleNextPacket() = 0;
 
+  /**
+   * \brief Processes the Data answering the Interest sent with the sequence number @p seq
+   *
+   * OnData takes the sequence number from the end of the Data name.  The subclasses which do not
+   * name their Interests with the sequence number call this method directly.
+   */
+  void
+  OnSequenceData(shared_ptr<const Data> data, uint32_t seq);
+
   /**
    * \brief Checks if the packet need to be retransmitted becuase of retransmission timer expiration
    */
@@ -110,7 +110,7 @@ Producer::OnInterest(shared_ptr<const Interest> interest)
   data->setName(dataName);
   data->setFreshnessPeriod(::ndn::time::milliseconds(m_freshness.GetMilliSeconds()));
 
-  data->setContent(make_shared< ::ndn::Buffer>(m_virtualPayloadSize));
+  data->setContent(App::GetVirtualPayload(m_virtualPayloadSize));
 
   Signature signature;
   SignatureInfo signatureInfo(static_cast< ::ndn::tlv::SignatureTypeValue>(255));
@@ -129,7 +129,7 @@ Producer::OnInterest(shared_ptr<const Interest> interest)
   // to create real wire encoding
   data->wireEncode();
 
-  m_transmittedDatas(data, this, m_face);
+  NS_TRACE(m_transmittedDatas, (data, this, m_face));
   m_face->onReceiveData(*data);
 }
 
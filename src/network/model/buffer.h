@@ -24,8 +24,7 @@
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
-
-#define BUFFER_FREE_LIST 1
+#include "ns3/atomic-counter.h"
 
 namespace ns3 {
 
@@ -671,6 +670,9 @@ private:
    * New user data can be safely written only outside of the "dirty
    * area" if the reference count is higher than 1 (that is, if
    * more than one Buffer instance references the same BufferData).
+   * The instances, which may belong to different simulation threads,
+   * extend the dirty area with AtomicCompareAndSwap: the one which
+   * does not manage to do so copies the data instead.
    */
   struct Data
   {
@@ -769,12 +771,6 @@ private:
    * m_zeroAreaStart.
    */
   uint32_t m_maxZeroAreaStart;
-  /**
-   * location in a newly-allocated buffer where you should start
-   * writing data. i.e., m_start should be initialized to this 
-   * value.
-   */
-  static uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -796,19 +792,6 @@ private:
    * instance from the start of m_data->m_data
    */
   uint32_t m_end;
-
-#ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
-  /// Local static destructor structure
-  struct LocalStaticDestructor 
-  {
-    ~LocalStaticDestructor ();
-  };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
-#endif
 };
 
 } // namespace ns3
@@ -1062,7 +1045,7 @@ Buffer::Buffer (Buffer const&o)
     m_start (o.m_start),
     m_end (o.m_end)
 {
-  m_data->m_count++;
+  AtomicIncrement (m_data->m_count);
   NS_ASSERT (CheckInternalState ());
 }
 
@@ -0,0 +1,306 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <new>
+#include <cstring>
+#include <algorithm>
+
+#include "packet-data-pool.h"
+#include "ns3/assert.h"
+#include "ns3/core-config.h"
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+namespace {
+
+/**
+ * The size classes hold the blocks of 2^(MIN_SHIFT + i) bytes, headers
+ * included, for i from 0 to N_CLASSES - 1.
+ */
+const uint32_t MIN_SHIFT = 5;
+const uint32_t N_CLASSES = 12;
+/** The size class of the blocks larger than the largest class. */
+const uint32_t LARGE = N_CLASSES;
+/** The maximum number of blocks of a free list. */
+const uint32_t MAX_FREE_BLOCKS = 1024;
+/** The maximum number of bytes of a free list. */
+const uint32_t MAX_FREE_BYTES = 4 << 20;
+
+struct Pool;
+
+/**
+ * The header of the blocks, padded to 16 bytes on every platform so
+ * that the data stays aligned like the blocks of the global allocator.
+ */
+struct alignas (16) Block
+{
+  union
+  {
+    Pool *owner;  //!< The pool of the thread which allocated the block.
+    Block *next;  //!< The next block of a free list or return stack.
+  };
+  uint32_t sizeClass;
+};
+static_assert (sizeof (Block) == 16, "the header of the blocks must be 16 bytes");
+
+/** The free lists of a thread. */
+struct Pool
+{
+  Block *free[N_CLASSES];
+  uint32_t count[N_CLASSES];
+  /** The blocks freed by the other threads. */
+  Block * volatile returned;
+  /** The next pool of g_pools. */
+  Pool *nextPool;
+  /** Set while no thread owns the pool, after its thread exited. */
+  uint32_t volatile orphaned;
+};
+
+__thread Pool *g_pool = 0;
+#ifdef HAVE_PTHREAD_H
+/** Orphans the pool of a thread when it exits. */
+pthread_key_t g_poolKey;
+pthread_once_t g_poolKeyOnce = PTHREAD_ONCE_INIT;
+#endif
+/** All the pools, so that they can be released at the end of the program. */
+Pool * volatile g_pools = 0;
+/**
+ * Set once the pools are released: the blocks freed after that are
+ * given back to the global allocator.
+ */
+bool g_destroyed = false;
+
+uint32_t
+MaxFreeBlocks (uint32_t sizeClass)
+{
+  uint32_t blocks = MAX_FREE_BYTES >> (MIN_SHIFT + sizeClass);
+  return blocks < MAX_FREE_BLOCKS ? blocks : MAX_FREE_BLOCKS;
+}
+
+void Drain (Pool *pool);
+
+#ifdef HAVE_PTHREAD_H
+/**
+ * The destructor of g_poolKey: the pool of the exiting thread, and
+ * the blocks it allocated which are still in use, are adopted by the
+ * next thread which needs a pool.
+ */
+void
+OrphanPool (void *p)
+{
+  Pool *pool = static_cast<Pool *> (p);
+  if (!g_destroyed)
+    {
+      Drain (pool);
+    }
+  g_pool = 0;
+  __sync_synchronize ();
+  pool->orphaned = 1;
+}
+
+void
+CreatePoolKey (void)
+{
+  pthread_key_create (&g_poolKey, &OrphanPool);
+}
+#endif /* HAVE_PTHREAD_H */
+
+Pool *
+CreatePool (void)
+{
+  Pool *pool;
+  for (pool = g_pools; pool != 0; pool = pool->nextPool)
+    {
+      if (pool->orphaned && __sync_bool_compare_and_swap (&pool->orphaned, 1, 0))
+        {
+          break;
+        }
+    }
+  if (pool == 0)
+    {
+      pool = new Pool;
+      std::memset (pool, 0, sizeof (Pool));
+      Pool *head;
+      do
+        {
+          head = g_pools;
+          pool->nextPool = head;
+        }
+      while (!__sync_bool_compare_and_swap (&g_pools, head, pool));
+    }
+#ifdef HAVE_PTHREAD_H
+  pthread_once (&g_poolKeyOnce, &CreatePoolKey);
+  pthread_setspecific (g_poolKey, pool);
+#endif
+  g_pool = pool;
+  return pool;
+}
+
+/**
+ * \param total the size of a block, header included, at most the size
+ *        of the largest class
+ * \returns the smallest size class which holds blocks of that size
+ */
+uint32_t
+GetSizeClass (uint32_t total)
+{
+  // The smallest power of two not less than total, which is more than 16.
+  uint32_t shift = 32 - __builtin_clz (total - 1);
+  if (shift < MIN_SHIFT)
+    {
+      shift = MIN_SHIFT;
+    }
+  return shift - MIN_SHIFT;
+}
+
+/** Free a block to the pool of the current thread. */
+void
+Recycle (Pool *pool, Block *block)
+{
+  uint32_t sizeClass = block->sizeClass;
+  if (pool->count[sizeClass] >= MaxFreeBlocks (sizeClass))
+    {
+      ::operator delete (block);
+      return;
+    }
+  block->next = pool->free[sizeClass];
+  pool->free[sizeClass] = block;
+  pool->count[sizeClass]++;
+}
+
+/** Move the blocks returned by the other threads to the free lists. */
+void
+Drain (Pool *pool)
+{
+  Block *block = __sync_lock_test_and_set (&pool->returned, (Block *)0);
+  while (block != 0)
+    {
+      Block *next = block->next;
+      Recycle (pool, block);
+      block = next;
+    }
+}
+
+/** Release the free lists at the end of the program. */
+static struct PoolDestructor
+{
+  ~PoolDestructor ()
+  {
+    g_destroyed = true;
+    for (Pool *pool = g_pools; pool != 0; pool = pool->nextPool)
+      {
+        Drain (pool);
+        for (uint32_t i = 0; i < N_CLASSES; i++)
+          {
+            while (pool->free[i] != 0)
+              {
+                Block *block = pool->free[i];
+                pool->free[i] = block->next;
+                ::operator delete (block);
+              }
+            pool->count[i] = 0;
+          }
+      }
+  }
+} g_poolDestructor;
+
+} // anonymous namespace
+
+namespace ns3 {
+
+void *
+PacketDataPool::Allocate (uint32_t size, uint32_t &capacity, uint32_t reuse)
+{
+  uint32_t total = size + sizeof (Block);
+  if (total > (1U << (MIN_SHIFT + N_CLASSES - 1)))
+    {
+      Block *block = static_cast<Block *> (::operator new (total));
+      block->owner = 0;
+      block->sizeClass = LARGE;
+      capacity = size;
+      return block + 1;
+    }
+  uint32_t sizeClass = GetSizeClass (total);
+
+  Pool *pool = g_pool;
+  if (pool == 0)
+    {
+      pool = CreatePool ();
+    }
+  Block *block = pool->free[sizeClass];
+  if (block == 0 && pool->returned != 0)
+    {
+      Drain (pool);
+      block = pool->free[sizeClass];
+    }
+  if (block == 0 && reuse > size)
+    {
+      // a free block of a larger class, up to the class of reuse,
+      // rather than a new block.
+      uint32_t reuseTotal = std::min<uint32_t> (reuse + sizeof (Block),
+                                                1U << (MIN_SHIFT + N_CLASSES - 1));
+      uint32_t reuseClass = GetSizeClass (reuseTotal);
+      for (uint32_t i = sizeClass + 1; block == 0 && i <= reuseClass; i++)
+        {
+          if (pool->free[i] != 0)
+            {
+              sizeClass = i;
+              block = pool->free[i];
+            }
+        }
+    }
+  if (block != 0)
+    {
+      pool->free[sizeClass] = block->next;
+      pool->count[sizeClass]--;
+    }
+  else
+    {
+      block = static_cast<Block *> (::operator new (1U << (MIN_SHIFT + sizeClass)));
+    }
+  block->owner = pool;
+  block->sizeClass = sizeClass;
+  capacity = (1U << (MIN_SHIFT + sizeClass)) - sizeof (Block);
+  return block + 1;
+}
+
+void
+PacketDataPool::Deallocate (void *p)
+{
+  Block *block = static_cast<Block *> (p) - 1;
+  Pool *owner = block->owner;
+  if (owner == 0 || g_destroyed)
+    {
+      ::operator delete (block);
+      return;
+    }
+  NS_ASSERT (block->sizeClass < N_CLASSES);
+  if (owner == g_pool)
+    {
+      Recycle (owner, block);
+      return;
+    }
+  Block *head;
+  do
+    {
+      head = owner->returned;
+      block->next = head;
+    }
+  while (!__sync_bool_compare_and_swap (&owner->returned, head, block));
+}
+
+} // namespace ns3
@@ -0,0 +1,66 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef PACKET_DATA_POOL_H
+#define PACKET_DATA_POOL_H
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ * \brief the allocator of the storage of Buffer, ByteTagList and
+ *        PacketMetadata
+ *
+ * The blocks are grouped in power-of-two size classes, from 32 bytes
+ * to 64 KiB, and each thread keeps a free list of the blocks it
+ * allocated, per size class.  A block freed by the thread which
+ * allocated it goes back to the free list of that thread, without any
+ * locking.  A block freed by another thread, for example a packet
+ * created by an emulation reader thread and destroyed by the
+ * simulation, is pushed on a lock-free return stack of the thread which
+ * allocated it, which moves the returned blocks to its free lists the
+ * next time one of them is empty.
+ *
+ * Each free list holds at most 1024 blocks, and at most 4 MiB: the
+ * extra blocks, and the blocks larger than 64 KiB, are given back to
+ * the global allocator.  The free lists of a thread which exits, and
+ * the blocks it allocated which are still in use, are adopted by the
+ * next thread which allocates a block; the free lists are released at
+ * the end of the program.
+ */
+class PacketDataPool
+{
+public:
+  /**
+   * \param size the number of bytes needed
+   * \param capacity the number of bytes usable in the block returned,
+   *        at least \p size
+   * \param reuse if no free block of the size class of \p size is
+   *        available, a free block of a larger class, large enough for
+   *        \p reuse bytes at most, is returned rather than a new block
+   * \returns the start of a block of \p capacity bytes
+   */
+  static void *Allocate (uint32_t size, uint32_t &capacity, uint32_t reuse = 0);
+  /**
+   * \param p a block returned by Allocate, from any thread
+   */
+  static void Deallocate (void *p);
+};
+
+} // namespace ns3
+
+#endif /* PACKET_DATA_POOL_H */
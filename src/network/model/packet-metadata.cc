@@ -17,12 +17,14 @@
  *
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
+#include <algorithm>
 #include <utility>
 #include <list>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 #include "packet-metadata.h"
+#include "packet-data-pool.h"
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
@@ -34,19 +36,14 @@ namespace ns3 {
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
+uint32_t PacketMetadata::m_sampling = 1;
 uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
 
-PacketMetadata::DataFreeList::~DataFreeList ()
-{
-  NS_LOG_FUNCTION (this);
-  for (iterator i = begin (); i != end (); i++)
-    {
-      PacketMetadata::Deallocate (*i);
-    }
-  PacketMetadata::m_enable = false;
-}
+/**
+ * The size of the largest metadata created by the thread: the new
+ * metadata are at least that large.
+ */
+static __thread uint32_t g_maxSize = 0;
 
 void 
 PacketMetadata::Enable (void)
@@ -70,6 +67,30 @@ PacketMetadata::EnableChecking (void)
   m_enableChecking = true;
 }
 
+void
+PacketMetadata::EnableSampling (uint32_t n)
+{
+  NS_LOG_FUNCTION (n);
+  NS_ASSERT_MSG (n > 0, "PacketMetadata::EnableSampling(): invalid sampling rate " << n);
+  Enable ();
+  m_sampling = n;
+}
+
+bool
+PacketMetadata::IsSkipped (void) const
+{
+  if (m_sampled == UNDECIDED)
+    {
+      if (!m_enable)
+        {
+          m_metadataSkipped = true;
+          return true;
+        }
+      m_sampled = IsSampled (m_packetUid) ? SAMPLED : SKIPPED;
+    }
+  return m_sampled == SKIPPED;
+}
+
 void
 PacketMetadata::ReserveCopy (uint32_t size)
 {
@@ -77,8 +98,7 @@ PacketMetadata::ReserveCopy (uint32_t size)
   struct PacketMetadata::Data *newData = PacketMetadata::Create (m_used + size);
   memcpy (newData->m_data, m_data->m_data, m_used);
   newData->m_dirtyEnd = m_used;
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (AtomicDecrement (m_data->m_count) == 0)
     {
       PacketMetadata::Recycle (m_data);
     }
@@ -101,11 +121,13 @@ PacketMetadata::Reserve (uint32_t size)
   NS_LOG_FUNCTION (this << size);
   NS_ASSERT (m_data != 0);
   if (m_data->m_size >= m_used + size &&
-      (m_head == 0xffff ||
-       m_data->m_count == 1 ||
-       m_data->m_dirtyEnd == m_used))
+      (m_data->m_count == 1 ||
+       AtomicCompareAndSwap<uint16_t> (m_data->m_dirtyEnd, m_used, m_used + size)))
     {
-      /* enough room, not dirty. */
+      /* enough room, not dirty: the data is not shared, or we have
+       * just claimed the bytes after m_used for ourselves, before the
+       * other instances which reference it, possibly from other
+       * simulation threads. */
     }
   else 
     {
@@ -318,6 +340,51 @@ PacketMetadata::AppendValue (uint32_t value, uint8_t *buffer)
   AppendValueExtra (value, buffer);
 }
 
+uint32_t
+PacketMetadata::GetUleb128Size64 (uint64_t value) const
+{
+  NS_LOG_FUNCTION (this << value);
+  uint32_t n = 1;
+  while (value >= 0x80)
+    {
+      value >>= 7;
+      n++;
+    }
+  return n;
+}
+uint64_t
+PacketMetadata::ReadUleb128U64 (const uint8_t **pBuffer) const
+{
+  NS_LOG_FUNCTION (this << &pBuffer);
+  const uint8_t *buffer = *pBuffer;
+  uint64_t result = 0;
+  uint32_t shift = 0;
+  uint8_t byte;
+  do
+    {
+      /* a valid 64 bit number is coded in at most 10 bytes. */
+      NS_ASSERT (shift < 70);
+      byte = *buffer++;
+      result |= static_cast<uint64_t> (byte & (~0x80)) << shift;
+      shift += 7;
+    }
+  while (byte & 0x80);
+  *pBuffer = buffer;
+  return result;
+}
+void
+PacketMetadata::AppendValue64 (uint64_t value, uint8_t *buffer)
+{
+  NS_LOG_FUNCTION (this << value << &buffer);
+  while (value >= 0x80)
+    {
+      *buffer = 0x80 | (value & 0x7f);
+      buffer++;
+      value >>= 7;
+    }
+  *buffer = value;
+}
+
 void
 PacketMetadata::UpdateTail (uint16_t written)
 {
@@ -341,7 +408,11 @@ PacketMetadata::UpdateTail (uint16_t written)
   NS_ASSERT (m_head != 0xffff);
   NS_ASSERT (written >= 8);
   m_used += written;
-  m_data->m_dirtyEnd = m_used;
+  if (m_data->m_count == 1)
+    {
+      // a shared dirty area was already extended by Reserve.
+      m_data->m_dirtyEnd = m_used;
+    }
 }
 
 
@@ -368,7 +439,11 @@ PacketMetadata::UpdateHead (uint16_t written)
   NS_ASSERT (m_head != 0xffff);
   NS_ASSERT (written >= 8);
   m_used += written;
-  m_data->m_dirtyEnd = m_used;
+  if (m_data->m_count == 1)
+    {
+      // a shared dirty area was already extended by Reserve.
+      m_data->m_dirtyEnd = m_used;
+    }
 }
 
 uint16_t
@@ -380,13 +455,7 @@ PacketMetadata::AddSmall (const struct PacketMetadata::SmallItem *item)
   uint32_t typeUidSize = GetUleb128Size (item->typeUid);
   uint32_t sizeSize = GetUleb128Size (item->size);
   uint32_t n =  2 + 2 + typeUidSize + sizeSize + 2;
-  if (m_used + n > m_data->m_size ||
-      (m_head != 0xffff &&
-       m_data->m_count != 1 &&
-       m_used != m_data->m_dirtyEnd))
-    {
-      ReserveCopy (n);
-    }
+  Reserve (n);
   uint8_t *buffer = &m_data->m_data[m_used];
   Append16 (item->next, buffer);
   buffer += 2;
@@ -414,17 +483,13 @@ PacketMetadata::AddBig (uint32_t next, uint32_t prev,
 
   uint32_t typeUidSize = GetUleb128Size (typeUid);
   uint32_t sizeSize = GetUleb128Size (item->size);
+  NS_ASSERT (extraItem->fragmentEnd <= item->size);
   uint32_t fragStartSize = GetUleb128Size (extraItem->fragmentStart);
-  uint32_t fragEndSize = GetUleb128Size (extraItem->fragmentEnd);
-  uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
+  uint32_t fragEndSize = GetUleb128Size (item->size - extraItem->fragmentEnd);
+  uint32_t uidSize = GetUleb128Size64 (extraItem->packetUid ^ m_packetUid);
+  uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + uidSize;
 
-  if (m_used + n > m_data->m_size ||
-      (m_head != 0xffff &&
-       m_data->m_count != 1 &&
-       m_used != m_data->m_dirtyEnd))
-    {
-      ReserveCopy (n);
-    }
+  Reserve (n);
 
   uint8_t *buffer = &m_data->m_data[m_used];
 
@@ -440,9 +505,9 @@ PacketMetadata::AddBig (uint32_t next, uint32_t prev,
   buffer += 2;
   AppendValue (extraItem->fragmentStart, buffer);
   buffer += fragStartSize;
-  AppendValue (extraItem->fragmentEnd, buffer);
+  AppendValue (item->size - extraItem->fragmentEnd, buffer);
   buffer += fragEndSize;
-  Append32 (extraItem->packetUid, buffer);
+  AppendValue64 (extraItem->packetUid ^ m_packetUid, buffer);
 
   return n;
 }
@@ -472,9 +537,11 @@ PacketMetadata::ReplaceTail (PacketMetadata::SmallItem *item,
   uint32_t typeUid = ((item->typeUid & 0x1) == 0x1) ? item->typeUid : item->typeUid+1;
   uint32_t typeUidSize = GetUleb128Size (typeUid);
   uint32_t sizeSize = GetUleb128Size (item->size);
+  NS_ASSERT (extraItem->fragmentEnd <= item->size);
   uint32_t fragStartSize = GetUleb128Size (extraItem->fragmentStart);
-  uint32_t fragEndSize = GetUleb128Size (extraItem->fragmentEnd);
-  uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
+  uint32_t fragEndSize = GetUleb128Size (item->size - extraItem->fragmentEnd);
+  uint32_t uidSize = GetUleb128Size64 (extraItem->packetUid ^ m_packetUid);
+  uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + uidSize;
 
   if (available >= n &&
       m_data->m_count == 1)
@@ -492,9 +559,10 @@ PacketMetadata::ReplaceTail (PacketMetadata::SmallItem *item,
       buffer += 2;
       AppendValue (extraItem->fragmentStart, buffer);
       buffer += fragStartSize;
-      AppendValue (extraItem->fragmentEnd, buffer);
+      AppendValue (item->size - extraItem->fragmentEnd, buffer);
       buffer += fragEndSize;
-      Append32 (extraItem->packetUid, buffer);
+      AppendValue64 (extraItem->packetUid ^ m_packetUid, buffer);
+      buffer += uidSize;
       m_used = std::max (m_used, (uint16_t)(buffer - &m_data->m_data[0]));
       m_data->m_dirtyEnd = m_used;
       return;
@@ -550,12 +618,8 @@ PacketMetadata::ReadItems (uint16_t current,
   if (isExtra)
     {
       extraItem->fragmentStart = ReadUleb128 (&buffer);
-      extraItem->fragmentEnd = ReadUleb128 (&buffer);
-      extraItem->packetUid = buffer[0];
-      extraItem->packetUid |= buffer[1] << 8;
-      extraItem->packetUid |= buffer[2] << 16;
-      extraItem->packetUid |= buffer[3] << 24;
-      buffer += 4;
+      extraItem->fragmentEnd = item->size - ReadUleb128 (&buffer);
+      extraItem->packetUid = ReadUleb128U64 (&buffer) ^ m_packetUid;
     }
   else
     {
@@ -571,48 +635,20 @@ struct PacketMetadata::Data *
 PacketMetadata::Create (uint32_t size)
 {
   NS_LOG_FUNCTION (size);
-  NS_LOG_LOGIC ("create size="<<size<<", max="<<m_maxSize);
-  if (size > m_maxSize)
+  NS_LOG_LOGIC ("create size="<<size<<", max="<<g_maxSize);
+  if (size > g_maxSize)
     {
-      m_maxSize = size;
+      g_maxSize = size;
     }
-  while (!m_freeList.empty ()) 
-    {
-      struct PacketMetadata::Data *data = m_freeList.back ();
-      m_freeList.pop_back ();
-      if (data->m_size >= size) 
-        {
-          NS_LOG_LOGIC ("create found size="<<data->m_size);
-          data->m_count = 1;
-          return data;
-        }
-      PacketMetadata::Deallocate (data);
-      NS_LOG_LOGIC ("create dealloc size="<<data->m_size);
-    }
-  NS_LOG_LOGIC ("create alloc size="<<m_maxSize);
-  return PacketMetadata::Allocate (m_maxSize);
+  return PacketMetadata::Allocate (g_maxSize);
 }
 
 void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
-    {
-      PacketMetadata::Deallocate (data);
-      return;
-    } 
-  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList.size ());
   NS_ASSERT (data->m_count == 0);
-  if (m_freeList.size () > 1000 ||
-      data->m_size < m_maxSize) 
-    {
-      PacketMetadata::Deallocate (data);
-    } 
-  else 
-    {
-      m_freeList.push_back (data);
-    }
+  PacketMetadata::Deallocate (data);
 }
 
 struct PacketMetadata::Data *
@@ -625,9 +661,11 @@ PacketMetadata::Allocate (uint32_t n)
       n = PACKET_METADATA_DATA_M_DATA_SIZE;
     }
   size += n - PACKET_METADATA_DATA_M_DATA_SIZE;
-  uint8_t *buf = new uint8_t [size];
-  struct PacketMetadata::Data *data = (struct PacketMetadata::Data *)buf;
-  data->m_size = n;
+  uint32_t capacity;
+  void *buf = PacketDataPool::Allocate (size, capacity);
+  struct PacketMetadata::Data *data = static_cast<struct PacketMetadata::Data *> (buf);
+  // The offsets of the items are 16 bit integers.
+  data->m_size = std::min<uint32_t> (n + capacity - size, 0xffff);
   data->m_count = 1;
   data->m_dirtyEnd = 0;
   return data;
@@ -636,8 +674,7 @@ void
 PacketMetadata::Deallocate (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  uint8_t *buf = (uint8_t *)data;
-  delete [] buf;
+  PacketDataPool::Deallocate (data);
 }
 
 
@@ -664,9 +701,8 @@ void
 PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
 {
   NS_LOG_FUNCTION (this << uid << size);
-  if (!m_enable)
+  if (IsSkipped ())
     {
-      m_metadataSkipped = true;
       return;
     }
 
@@ -686,9 +722,8 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
   uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &header << size);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (IsSkipped ())
     {
-      m_metadataSkipped = true;
       return;
     }
   struct PacketMetadata::SmallItem item;
@@ -734,9 +769,8 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
   uint32_t uid = trailer.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &trailer << size);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable)
+  if (IsSkipped ())
     {
-      m_metadataSkipped = true;
       return;
     }
   struct PacketMetadata::SmallItem item;
@@ -756,9 +790,8 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
   uint32_t uid = trailer.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &trailer << size);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (IsSkipped ())
     {
-      m_metadataSkipped = true;
       return;
     }
   struct PacketMetadata::SmallItem item;
@@ -803,9 +836,17 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
 {
   NS_LOG_FUNCTION (this << &o);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (IsSkipped ())
     {
-      m_metadataSkipped = true;
+      return;
+    }
+  if (o.IsSkipped ())
+    {
+      // The items of o were not recorded: the items of this packet
+      // would not describe all its bytes anymore.
+      m_head = 0xffff;
+      m_tail = 0xffff;
+      m_sampled = SKIPPED;
       return;
     }
   if (m_tail == 0xffff)
@@ -880,9 +921,8 @@ void
 PacketMetadata::AddPaddingAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
-  if (!m_enable)
+  if (IsSkipped ())
     {
-      m_metadataSkipped = true;
       return;
     }
 }
@@ -891,9 +931,8 @@ PacketMetadata::RemoveAtStart (uint32_t start)
 {
   NS_LOG_FUNCTION (this << start);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (IsSkipped ())
     {
-      m_metadataSkipped = true;
       return;
     }
   NS_ASSERT (m_data != 0);
@@ -954,9 +993,8 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (IsSkipped ())
     {
-      m_metadataSkipped = true;
       return;
     }
   NS_ASSERT (m_data != 0);
@@ -1289,6 +1327,8 @@ PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
 
   buffer = ReadFromRawU64 (m_packetUid, start, buffer, size);
   desSize -= 8;
+  // the items received are kept even if this packet is not sampled here.
+  m_sampled = desSize > 0 ? SAMPLED : UNDECIDED;
 
   struct PacketMetadata::SmallItem item = {0};
   struct PacketMetadata::ExtraItem extraItem = {0};
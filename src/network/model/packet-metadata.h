@@ -26,6 +26,7 @@
 #include "ns3/callback.h"
 #include "ns3/assert.h"
 #include "ns3/type-id.h"
+#include "ns3/atomic-counter.h"
 #include "buffer.h"
 
 namespace ns3 {
@@ -71,10 +72,13 @@ class Trailer;
  *
  * Each item of the linked list is a variable-sized byte buffer
  * made of a number of fields. Some of these fields are stored
- * as fixed-size 32 bit integers, others as fixed-size 16 bit 
- * integers, and some others as variable-size 32-bit integers.
- * The variable-size 32 bit integers are stored using the uleb128
- * encoding.
+ * as fixed-size 16 bit integers, and the others as variable-size
+ * integers, using the uleb128 encoding.  The header and trailer
+ * types are stored as their TypeId uid, and the fields of the
+ * fragments as deltas which are small in the common case.
+ *
+ * The metadata can also be recorded for a sample of the packets
+ * only: see EnableSampling.
  */
 class PacketMetadata 
 {
@@ -160,6 +164,20 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable the packet metadata of one packet in \p n
+   *
+   * The metadata are recorded only for the packets whose uid is a
+   * multiple of \p n, chosen at the first operation on the metadata of
+   * the packet once they are enabled: the fragments and copies of a
+   * packet share its uid, so they are recorded too.
+   * The other packets behave as if the metadata were disabled, and
+   * a packet which aggregates an unsampled packet stops recording
+   * its metadata.
+   *
+   * \param n the sampling period, 1 to record all the packets
+   */
+  static void EnableSampling (uint32_t n);
 
   /**
    * \brief Constructor
@@ -481,27 +499,21 @@ private:
     uint32_t fragmentStart;
     /** offset (in bytes) from start of original header to
        the end of the fragment still present.
-       stored as a variable-size 32 bit integer.
+       stored as a variable-size 32 bit integer, as the number
+       of bytes from the end of the fragment to the end of the
+       original header, which is zero most of the time.
      */
     uint32_t fragmentEnd;
     /** the packetUid of the packet in which this header or trailer
        was first added. It could be different from the m_packetUid
        field if the user has aggregated multiple packets into one.
-       stored as a fixed-size 64 bit integer.
+       stored as a variable-size 64 bit integer, xored with
+       m_packetUid so that it takes one byte unless the packets
+       were aggregated.
      */
     uint64_t packetUid;
   };
 
-  /**
-   * \brief Class to hold all the metadata
-   */
-  class DataFreeList : public std::vector<struct Data *>
-  {
-public:
-    ~DataFreeList ();
-  };
-
-  friend DataFreeList::~DataFreeList ();
   friend class ItemIterator;
 
   PacketMetadata ();
@@ -556,6 +568,18 @@ public:
    * \returns the value
    */
   uint32_t ReadUleb128 (const uint8_t **pBuffer) const;
+  /**
+   * \brief Get the ULEB128 size of a 64-bit value
+   * \param value the value
+   * \returns the value's ULEB128 size
+   */
+  uint32_t GetUleb128Size64 (uint64_t value) const;
+  /**
+   * \brief Read a ULEB128 coded 64-bit number
+   * \param pBuffer the buffer to read from
+   * \returns the value
+   */
+  uint64_t ReadUleb128U64 (const uint8_t **pBuffer) const;
   /**
    * \brief Append a 16-bit value to the buffer
    * \param value the value to add
@@ -583,6 +607,12 @@ public:
    * \param buffer the buffer to write to
    */
   void AppendValueExtra (uint32_t value, uint8_t *buffer);
+  /**
+   * \brief Append a 64-bit value to the buffer, ULEB128 coded
+   * \param value the value to add
+   * \param buffer the buffer to write to
+   */
+  void AppendValue64 (uint64_t value, uint8_t *buffer);
 
   /**
    * \brief Reserve space
@@ -621,6 +651,21 @@ public:
    * \returns true if the internal state is ok
    */
   bool IsStateOk (void) const;
+  /**
+   * \brief Check if the operations on this packet are not recorded
+   *
+   * Sets m_metadataSkipped if the metadata are disabled, and
+   * decides whether this packet is sampled otherwise.
+   *
+   * \returns true if the metadata are disabled or if this packet
+   *          is not sampled
+   */
+  bool IsSkipped (void) const;
+  /**
+   * \param uid a packet uid
+   * \returns true if the metadata of the packet \p uid are recorded
+   */
+  static inline bool IsSampled (uint64_t uid);
   /**
    * \brief Check if the position is valid
    * \param pointer the position to check
@@ -657,7 +702,6 @@ public:
    */
   static void Deallocate (struct PacketMetadata::Data *data);
 
-  static DataFreeList m_freeList; //!< the metadata data storage
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
 
@@ -667,8 +711,8 @@ public:
    * middle of a simulation, which isn't allowed.
    */
   static bool m_metadataSkipped;
+  static uint32_t m_sampling; //!< Record the metadata of one packet in m_sampling
 
-  static uint32_t m_maxSize; //!< maximum metadata size
   static uint16_t m_chunkUid; //!< Chunk Uid
 
   struct Data *m_data; //!< Metadata storage
@@ -680,6 +724,14 @@ public:
   uint16_t m_head; //!< list head
   uint16_t m_tail; //!< list tail
   uint16_t m_used; //!< used portion
+  /// Whether the metadata of this packet are recorded
+  enum Sampling
+  {
+    UNDECIDED, //!< not decided until the metadata are enabled
+    SAMPLED,   //!< the metadata are recorded
+    SKIPPED    //!< the metadata are not recorded
+  };
+  mutable uint8_t m_sampled; //!< a Sampling value
   uint64_t m_packetUid; //!< packet Uid
 };
 
@@ -692,6 +744,7 @@ PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
+    m_sampled (UNDECIDED),
     m_packetUid (uid)
 {
   memset (m_data->m_data, 0xff, 4);
@@ -705,11 +758,12 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_head (o.m_head),
     m_tail (o.m_tail),
     m_used (o.m_used),
+    m_sampled (o.m_sampled),
     m_packetUid (o.m_packetUid)
 {
   NS_ASSERT (m_data != 0);
   NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
-  m_data->m_count++;
+  AtomicIncrement (m_data->m_count);
 }
 PacketMetadata &
 PacketMetadata::operator = (PacketMetadata const& o)
@@ -718,26 +772,30 @@ PacketMetadata::operator = (PacketMetadata const& o)
     {
       // not self assignment
       NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (AtomicDecrement (m_data->m_count) == 0)
         {
           PacketMetadata::Recycle (m_data);
         }
       m_data = o.m_data;
       NS_ASSERT (m_data != 0);
-      m_data->m_count++;
+      AtomicIncrement (m_data->m_count);
     }
   m_head = o.m_head;
   m_tail = o.m_tail;
   m_used = o.m_used;
+  m_sampled = o.m_sampled;
   m_packetUid = o.m_packetUid;
   return *this;
 }
+bool
+PacketMetadata::IsSampled (uint64_t uid)
+{
+  return m_enable && (m_sampling == 1 || static_cast<uint32_t> (uid) % m_sampling == 0);
+}
 PacketMetadata::~PacketMetadata ()
 {
   NS_ASSERT (m_data != 0);
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (AtomicDecrement (m_data->m_count) == 0)
     {
       PacketMetadata::Recycle (m_data);
     }
@@ -132,13 +132,13 @@ PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
     {
       NS_ASSERT (cur != 0);
       NS_ASSERT (cur->count > 1);
-      cur->count--;                       // unmerge cur
+      AtomicDecrement (cur->count);       // unmerge cur
       struct TagData * copy = new struct TagData ();
       copy->tid = cur->tid;
       copy->count = 1;
       memcpy (copy->data, cur->data, TagData::MAX_SIZE);
       copy->next = cur->next;             // merge into tail
-      copy->next->count++;                // mark new merge
+      AtomicIncrement (copy->next->count); // mark new merge
       *prevNext = copy;                   // point prior list at copy
       prevNext = &copy->next;             // advance
       cur      =  copy->next;
@@ -157,6 +157,21 @@ PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 bool
 PacketTagList::Remove (Tag & tag)
 {
+  uint32_t i = FindInline (tag.GetInstanceTypeId ());
+  if (i < m_nInline)
+    {
+      NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
+      tag.Deserialize (TagBuffer (m_inline[i].data,
+                                  m_inline[i].data + TagData::MAX_SIZE));
+      // keep the other slots in the order they were added
+      m_nInline--;
+      for (; i < m_nInline; i++)
+        {
+          m_inline[i].tid = m_inline[i + 1].tid;
+          memcpy (m_inline[i].data, m_inline[i + 1].data, TagData::MAX_SIZE);
+        }
+      return true;
+    }
   return COWTraverse (tag, &PacketTagList::RemoveWriter);
 }
 
@@ -183,11 +198,11 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
     {
       // cur is always a merge at this point
       // unmerge cur, since we linked around it already
-      cur->count--;
+      AtomicDecrement (cur->count);
       if (cur->next != 0)
         {
           // there's a next, so make it a merge
-          cur->next->count++;
+          AtomicIncrement (cur->next->count);
         }
     }
   return found;
@@ -196,6 +211,14 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
 bool
 PacketTagList::Replace (Tag & tag)
 {
+  uint32_t i = FindInline (tag.GetInstanceTypeId ());
+  if (i < m_nInline)
+    {
+      NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
+      tag.Serialize (TagBuffer (m_inline[i].data,
+                                m_inline[i].data + tag.GetSerializedSize ()));
+      return true;
+    }
   bool found = COWTraverse (tag, &PacketTagList::ReplaceWriter);
   if (!found)
     {
@@ -224,7 +247,7 @@ PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
     {
       // cur is always a merge at this point
       // need to copy, replace, and link past cur
-      cur->count--;                     // unmerge cur
+      AtomicDecrement (cur->count);     // unmerge cur
       struct TagData * copy = new struct TagData ();
       copy->tid = tag.GetInstanceTypeId ();
       copy->count = 1;
@@ -233,7 +256,7 @@ PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
       copy->next = cur->next;           // merge into tail
       if (copy->next != 0)
         {
-          copy->next->count++;          // mark new merge
+          AtomicIncrement (copy->next->count); // mark new merge
         }
       *prevNext = copy;                 // point prior list at copy
     }
@@ -245,16 +268,28 @@ PacketTagList::Add (const Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   // ensure this id was not yet added
+  NS_ASSERT (FindInline (tag.GetInstanceTypeId ()) == m_nInline);
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
     {
       NS_ASSERT (cur->tid != tag.GetInstanceTypeId ());
     }
+  NS_ASSERT (tag.GetSerializedSize () <= TagData::MAX_SIZE);
+  // the slots hold the oldest tags, so that the tags are iterated
+  // from the newest, through the tree and then the slots
+  if (m_nInline < INLINE_SLOTS && m_next == 0)
+    {
+      PacketTagList *self = const_cast<PacketTagList *> (this);
+      struct TagData *slot = &self->m_inline[m_nInline];
+      slot->tid = tag.GetInstanceTypeId ();
+      tag.Serialize (TagBuffer (slot->data, slot->data + tag.GetSerializedSize ()));
+      self->m_nInline++;
+      return;
+    }
   struct TagData * head = new struct TagData ();
   head->count = 1;
   head->next = 0;
   head->tid = tag.GetInstanceTypeId ();
   head->next = m_next;
-  NS_ASSERT (tag.GetSerializedSize () <= TagData::MAX_SIZE);
   tag.Serialize (TagBuffer (head->data, head->data + tag.GetSerializedSize ()));
 
   const_cast<PacketTagList *> (this)->m_next = head;
@@ -265,6 +300,13 @@ PacketTagList::Peek (Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   TypeId tid = tag.GetInstanceTypeId ();
+  uint32_t i = FindInline (tid);
+  if (i < m_nInline)
+    {
+      uint8_t *data = const_cast<uint8_t *> (m_inline[i].data);
+      tag.Deserialize (TagBuffer (data, data + TagData::MAX_SIZE));
+      return true;
+    }
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
     {
       if (cur->tid == tid) 
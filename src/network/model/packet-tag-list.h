@@ -26,8 +26,10 @@
 */
 
 #include <stdint.h>
+#include <cstring>
 #include <ostream>
 #include "ns3/type-id.h"
+#include "ns3/atomic-counter.h"
 
 namespace ns3 {
 
@@ -120,6 +122,20 @@ class Tag;
  *       shared. This portion is copied before the #Remove or #Replace is
  *       performed.
  *
+ * \par <b> Inline slots </b>
+ *
+ *   - The first #INLINE_SLOTS tags added are not put in the tree, but
+ *     in TagData slots inside the PacketTagList itself, so that the few
+ *     tags a packet usually carries, such as hop counts and flow ids,
+ *     are added, replaced and removed without any allocation.  The
+ *     slots are copied, rather than shared, with the PacketTagList.
+ *
+ *   - The tags added when the slots are full, or when the tree is not
+ *     empty, go to the tree: the slots always hold the oldest tags.
+ *     #Peek, #Remove and #Replace look into the slots before the tree.
+ *     The tags are iterated from the newest, through #Head and then
+ *     #InlineSlots in reverse.
+ *
  * \par <b> Memory Management: </b>
  * \n
  * Packet tags must serialize to a finite maximum size, see TagData
@@ -167,6 +183,14 @@ public:
     uint32_t count;           /**< Number of incoming links */
   };  /* struct TagData */
 
+  /**
+   * The number of tags stored inline, before the tree is used.
+   */
+  enum
+  {
+    INLINE_SLOTS = 2
+  };
+
   /**
    * Create a new PacketTagList.
    */
@@ -234,9 +258,15 @@ public:
    */
   inline void RemoveAll (void);
   /**
-   * \returns pointer to head of tag list
+   * \returns pointer to head of the tree of tags, the newest ones
    */
   const struct PacketTagList::TagData *Head (void) const;
+  /**
+   * \param [out] n The number of inline slots in use.
+   * \returns pointer to the inline slots, which hold the oldest tags,
+   *          oldest first
+   */
+  inline const struct PacketTagList::TagData *InlineSlots (uint32_t *n) const;
 
 private:
   /**
@@ -286,11 +316,31 @@ private:
    * \returns True, since tag value will definitely be replaced.
    */
   bool ReplaceWriter (Tag & tag, bool preMerge, struct TagData * cur, struct TagData ** prevNext);
+  /**
+   * \param [in] tid The tag type to look for.
+   * \returns The index of the inline slot holding \pname{tid},
+   *          or the number of slots in use if there is none.
+   */
+  inline uint32_t FindInline (TypeId tid) const;
+  /**
+   * Copy the inline slots of another list.
+   *
+   * \param [in] o The PacketTagList to copy.
+   */
+  inline void CopyInline (PacketTagList const &o);
 
   /**
    * Pointer to first \ref TagData on the list
    */
   struct TagData *m_next;
+  /**
+   * The inline slots: only tid and data are used.
+   */
+  struct TagData m_inline[INLINE_SLOTS];
+  /**
+   * The number of inline slots in use, the first ones.
+   */
+  uint32_t m_nInline;
 };
 
 } // namespace ns3
@@ -302,7 +352,8 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_next (),
+    m_nInline (0)
 {
 }
 
@@ -311,27 +362,61 @@ PacketTagList::PacketTagList (PacketTagList const &o)
 {
   if (m_next != 0)
     {
-      m_next->count++;
+      AtomicIncrement (m_next->count);
     }
+  CopyInline (o);
 }
 
 PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
   // self assignment
-  if (m_next == o.m_next) 
+  if (this == &o) 
     {
       return *this;
     }
-  RemoveAll ();
-  m_next = o.m_next;
-  if (m_next != 0) 
+  if (m_next != o.m_next)
     {
-      m_next->count++;
+      RemoveAll ();
+      m_next = o.m_next;
+      if (m_next != 0) 
+        {
+          AtomicIncrement (m_next->count);
+        }
     }
+  CopyInline (o);
   return *this;
 }
 
+const struct PacketTagList::TagData *
+PacketTagList::InlineSlots (uint32_t *n) const
+{
+  *n = m_nInline;
+  return m_inline;
+}
+
+uint32_t
+PacketTagList::FindInline (TypeId tid) const
+{
+  uint32_t i = 0;
+  while (i < m_nInline && m_inline[i].tid != tid)
+    {
+      i++;
+    }
+  return i;
+}
+
+void
+PacketTagList::CopyInline (PacketTagList const &o)
+{
+  m_nInline = o.m_nInline;
+  for (uint32_t i = 0; i < m_nInline; i++)
+    {
+      m_inline[i].tid = o.m_inline[i].tid;
+      std::memcpy (m_inline[i].data, o.m_inline[i].data, TagData::MAX_SIZE);
+    }
+}
+
 PacketTagList::~PacketTagList ()
 {
   RemoveAll ();
@@ -340,11 +425,11 @@ PacketTagList::~PacketTagList ()
 void
 PacketTagList::RemoveAll (void)
 {
+  m_nInline = 0;
   struct TagData *prev = 0;
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
     {
-      cur->count--;
-      if (cur->count > 0) 
+      if (AtomicDecrement (cur->count) > 0)
         {
           break;
         }
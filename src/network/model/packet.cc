@@ -21,6 +21,9 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#include "ns3/system-mutex.h"
+#include "ns3/core-config.h"
+#include <map>
 #include <string>
 #include <cstdarg>
 
@@ -28,7 +31,31 @@ NS_LOG_COMPONENT_DEFINE ("Packet");
 
 namespace ns3 {
 
-uint32_t Packet::m_globalUid = 0;
+uint64_t
+Packet::AllocateUid (void)
+{
+  uint32_t systemId = Simulator::GetSystemId ();
+#ifdef NS3_MULTITHREADED
+  /* Each thread caches the counter of the partition it runs; the map
+   * which holds the counters is only walked when a thread meets a new
+   * system id.
+   */
+  static __thread uint32_t *counter = 0;
+  static __thread uint32_t counterSystemId = 0;
+  if (counter == 0 || counterSystemId != systemId)
+    {
+      static SystemMutex mutex;
+      static std::map<uint32_t, uint32_t> counters;
+      CriticalSection cs (mutex);
+      counter = &counters[systemId];
+      counterSystemId = systemId;
+    }
+  return static_cast<uint64_t> (systemId) << 32 | (*counter)++;
+#else
+  static uint32_t counter = 0;
+  return static_cast<uint64_t> (systemId) << 32 | counter++;
+#endif
+}
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -81,19 +108,28 @@ ByteTagIterator::ByteTagIterator (ByteTagList::Iterator i)
 }
 
 
-PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head)
-  : m_current (head)
+PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head,
+                                      const struct PacketTagList::TagData *slots, uint32_t nSlots)
+  : m_current (head),
+    m_slots (slots),
+    m_nSlots (nSlots)
 {
 }
 bool
 PacketTagIterator::HasNext (void) const
 {
-  return m_current != 0;
+  return m_current != 0 || m_nSlots != 0;
 }
 PacketTagIterator::Item
 PacketTagIterator::Next (void)
 {
   NS_ASSERT (HasNext ());
+  if (m_current == 0)
+    {
+      // the slots, from the newest
+      m_nSlots--;
+      return PacketTagIterator::Item (&m_slots[m_nSlots]);
+    }
   const struct PacketTagList::TagData *prev = m_current;
   m_current = m_current->next;
   return PacketTagIterator::Item (prev);
@@ -131,16 +167,9 @@ Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
     m_packetTagList (),
-    /* The upper 32 bits of the packet id in 
-     * metadata is for the system id. For non-
-     * distributed simulations, this is simply 
-     * zero.  The lower 32 bits are for the 
-     * global UID
-     */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
+    m_metadata (AllocateUid (), 0),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
@@ -173,16 +202,9 @@ Packet::Packet (uint32_t size)
   : m_buffer (size),
     m_byteTagList (),
     m_packetTagList (),
-    /* The upper 32 bits of the packet id in 
-     * metadata is for the system id. For non-
-     * distributed simulations, this is simply 
-     * zero.  The lower 32 bits are for the 
-     * global UID
-     */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
@@ -199,16 +221,9 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
   : m_buffer (),
     m_byteTagList (),
     m_packetTagList (),
-    /* The upper 32 bits of the packet id in 
-     * metadata is for the system id. For non-
-     * distributed simulations, this is simply 
-     * zero.  The lower 32 bits are for the 
-     * global UID
-     */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
@@ -218,17 +233,10 @@ Packet::Packet (const std::string &buffer)
   : m_buffer (),
     m_byteTagList (),
     m_packetTagList (),
-    /* The upper 32 bits of the packet id in 
-     * metadata is for the system id. For non-
-     * distributed simulations, this is simply 
-     * zero.  The lower 32 bits are for the 
-     * global UID
-     */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, buffer.size ()),
+    m_metadata (AllocateUid (), buffer.size ()),
     m_nixVector (0)
 {
   NS_LOG_FUNCTION (this << &buffer);
-  m_globalUid++;
   m_buffer.AddAtStart (buffer.size ());
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (reinterpret_cast<const uint8_t*> (&buffer[0]), buffer.size ());
@@ -575,6 +583,13 @@ Packet::EnablePrinting (void)
   PacketMetadata::Enable ();
 }
 
+void
+Packet::EnableSampledPrinting (uint32_t n)
+{
+  NS_LOG_FUNCTION (n);
+  PacketMetadata::EnableSampling (n);
+}
+
 void
 Packet::EnableChecking (void)
 {
@@ -918,7 +933,9 @@ Packet::PrintPacketTags (std::ostream &os) const
 PacketTagIterator 
 Packet::GetPacketTagIterator (void) const
 {
-  return PacketTagIterator (m_packetTagList.Head ());
+  uint32_t nSlots;
+  const struct PacketTagList::TagData *slots = m_packetTagList.InlineSlots (&nSlots);
+  return PacketTagIterator (m_packetTagList.Head (), slots, nSlots);
 }
 
 std::ostream& operator<< (std::ostream& os, const Packet &packet)
@@ -165,10 +165,15 @@ private:
   friend class Packet;
   /**
    * Constructor
-   * \param head head of the items
+   * \param head head of the items in the tree, the newest ones
+   * \param slots the items in the inline slots, oldest first
+   * \param nSlots the number of items in the inline slots
    */
-  PacketTagIterator (const struct PacketTagList::TagData *head);
+  PacketTagIterator (const struct PacketTagList::TagData *head,
+                     const struct PacketTagList::TagData *slots, uint32_t nSlots);
   const struct PacketTagList::TagData *m_current;  //!< actual position over the set of tags in a packet
+  const struct PacketTagList::TagData *m_slots;    //!< the inline slots, iterated after the tree
+  uint32_t m_nSlots;                               //!< the number of inline slots still to iterate
 };
 
 /**
@@ -191,7 +196,9 @@ private:
  * output from Packet::Print. If you wish to only enable
  * checking of metadata, and do not need any printing capability, you can
  * call Packet::EnableChecking: its runtime cost is lower than
- * Packet::EnablePrinting.
+ * Packet::EnablePrinting. In large simulations,
+ * Packet::EnableSampledPrinting keeps the metadata of a fraction
+ * of the packets only.
  *
  * - The set of tags contain simulation-specific information which cannot
  * be stored in the packet byte buffer because the protocol headers or trailers
@@ -505,6 +512,17 @@ public:
    * simulation setup and before any packet is created.
    */
   static void EnablePrinting (void);
+  /**
+   * \brief Enable printing the metadata of one packet in \p n.
+   *
+   * Like EnablePrinting, but the metadata are kept only for the
+   * packets whose uid is a multiple of \p n, and for their
+   * fragments and copies: Print prints nothing for the other
+   * packets, whose cost is that of the packets without metadata.
+   *
+   * \param n the sampling period, 1 to print all the packets
+   */
+  static void EnableSampledPrinting (uint32_t n);
   /**
    * \brief Enable packets metadata checking.
    *
@@ -684,6 +702,19 @@ private:
 
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
 
+  /**
+   * \brief Allocate the uid of a new packet.
+   *
+   * The upper 32 bits of the uid are the system id of the simulator
+   * partition which creates the packet, and the lower 32 bits count
+   * the packets created by this partition, so that the uids do not
+   * depend on how the partitions of the multithreaded simulator
+   * interleave.
+   *
+   * \returns the new uid
+   */
+  static uint64_t AllocateUid (void);
+
   Buffer m_buffer;                //!< the packet buffer (it's actual contents)
   ByteTagList m_byteTagList;      //!< the ByteTag list
   PacketTagList m_packetTagList;  //!< the packet's Tag list
@@ -691,8 +722,6 @@ private:
 
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
-
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
 };
 
 /**
@@ -20,6 +20,7 @@
 #include <cstdarg>
 #include <iostream>
 #include <sstream>
+#include <vector>
 #include "ns3/test.h"
 #include "ns3/header.h"
 #include "ns3/trailer.h"
@@ -256,6 +257,8 @@ public:
   virtual ~PacketMetadataTest ();
   void CheckHistory (Ptr<Packet> p, const char *file, int line, uint32_t n, ...);
   virtual void DoRun (void);
+protected:
+  PacketMetadataTest (std::string name);
 private:
   Ptr<Packet> DoAddHeader (Ptr<Packet> p);
 };
@@ -265,6 +268,11 @@ PacketMetadataTest::PacketMetadataTest ()
 {
 }
 
+PacketMetadataTest::PacketMetadataTest (std::string name)
+  : TestCase (name)
+{
+}
+
 PacketMetadataTest::~PacketMetadataTest ()
 {
 }
@@ -823,6 +831,140 @@ PacketMetadataTest::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (msg, std::string ("hello world"), "Could not find original data in received packet");
 }
 //-----------------------------------------------------------------------------
+class PacketMetadataSamplingTest : public PacketMetadataTest
+{
+public:
+  PacketMetadataSamplingTest ();
+  virtual void DoRun (void);
+private:
+  uint32_t CountItems (Ptr<Packet> p);
+};
+
+PacketMetadataSamplingTest::PacketMetadataSamplingTest ()
+  : PacketMetadataTest ("Packet metadata of one packet in n")
+{
+}
+
+uint32_t
+PacketMetadataSamplingTest::CountItems (Ptr<Packet> p)
+{
+  uint32_t n = 0;
+  PacketMetadata::ItemIterator k = p->BeginItem ();
+  while (k.HasNext ())
+    {
+      k.Next ();
+      n++;
+    }
+  return n;
+}
+
+void
+PacketMetadataSamplingTest::DoRun (void)
+{
+  Packet::EnableSampledPrinting (4);
+
+  std::vector<Ptr<Packet> > sampled;
+  std::vector<Ptr<Packet> > skipped;
+  for (uint32_t i = 0; i < 16; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (100);
+      ADD_HEADER (p, 10);
+      if (p->GetUid () % 4 == 0)
+        {
+          CHECK_HISTORY (p, 2, 10, 100);
+          sampled.push_back (p);
+        }
+      else
+        {
+          NS_TEST_EXPECT_MSG_EQ (CountItems (p), 0, "Packet " << p->GetUid () << " is not sampled");
+          skipped.push_back (p);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (sampled.size (), 4, "Wrong number of sampled packets");
+
+  // The fragments of a sampled packet are sampled.
+  Ptr<Packet> p = sampled[0];
+  Ptr<Packet> p1 = p->CreateFragment (0, 4);
+  Ptr<Packet> p2 = p->CreateFragment (4, 106);
+  CHECK_HISTORY (p1, 1, 4);
+  CHECK_HISTORY (p2, 2, 6, 100);
+  p1->AddAtEnd (p2);
+  CHECK_HISTORY (p1, 2, 10, 100);
+  REM_HEADER (p1, 10);
+  CHECK_HISTORY (p1, 1, 100);
+
+  // The packets of two sampled packets are kept, as fragments.
+  p1 = sampled[1]->Copy ();
+  p1->AddAtEnd (sampled[2]);
+  CHECK_HISTORY (p1, 4, 10, 100, 10, 100);
+  p1->RemoveAtStart (5);
+  p1->RemoveAtEnd (110);
+  CHECK_HISTORY (p1, 2, 5, 100);
+
+  // A sampled packet which aggregates an unsampled one is not sampled
+  // anymore, but its operations still work.
+  p1 = sampled[3]->Copy ();
+  p1->AddAtEnd (skipped[0]);
+  NS_TEST_EXPECT_MSG_EQ (CountItems (p1), 0, "The aggregate is still sampled");
+  p1->RemoveAtStart (20);
+  p1->RemoveAtEnd (20);
+  ADD_TRAILER (p1, 4);
+  NS_TEST_EXPECT_MSG_EQ (p1->GetSize (), 184, "Wrong size of the aggregate");
+  NS_TEST_EXPECT_MSG_EQ (CountItems (p1), 0, "The aggregate is still sampled");
+  p2 = skipped[1]->Copy ();
+  p2->AddAtEnd (sampled[3]);
+  REM_HEADER (p2, 10);
+  NS_TEST_EXPECT_MSG_EQ (CountItems (p2), 0, "An unsampled packet is sampled");
+
+  Packet::EnableSampledPrinting (1);
+}
+//-----------------------------------------------------------------------------
+class PacketMetadataLateEnableTest : public PacketMetadataTest
+{
+public:
+  PacketMetadataLateEnableTest ();
+  virtual void DoRun (void);
+};
+
+PacketMetadataLateEnableTest::PacketMetadataLateEnableTest ()
+  : PacketMetadataTest ("Packet metadata of the packets created before it is enabled")
+{
+}
+
+void
+PacketMetadataLateEnableTest::DoRun (void)
+{
+  // The packets created before the metadata, or their sampling, are
+  // enabled are sampled at their first operation on the metadata.
+  std::vector<Ptr<Packet> > packets;
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      packets.push_back (Create<Packet> ());
+    }
+  Packet::EnableSampledPrinting (2);
+
+  uint32_t sampled = 0;
+  for (uint32_t i = 0; i < packets.size (); i++)
+    {
+      Ptr<Packet> p = packets[i];
+      ADD_HEADER (p, 10);
+      ADD_TRAILER (p, 4);
+      if (p->GetUid () % 2 == 0)
+        {
+          CHECK_HISTORY (p, 2, 10, 4);
+          sampled++;
+        }
+      else
+        {
+          PacketMetadata::ItemIterator k = p->BeginItem ();
+          NS_TEST_EXPECT_MSG_EQ (k.HasNext (), false, "Packet " << p->GetUid () << " is not sampled");
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (sampled, 4, "Wrong number of sampled packets");
+
+  Packet::EnableSampledPrinting (1);
+}
+//-----------------------------------------------------------------------------
 class PacketMetadataTestSuite : public TestSuite
 {
 public:
@@ -833,6 +975,8 @@ PacketMetadataTestSuite::PacketMetadataTestSuite ()
   : TestSuite ("packet-metadata", UNIT)
 {
   AddTestCase (new PacketMetadataTest, TestCase::QUICK);
+  AddTestCase (new PacketMetadataSamplingTest, TestCase::QUICK);
+  AddTestCase (new PacketMetadataLateEnableTest, TestCase::QUICK);
 }
 
 PacketMetadataTestSuite g_packetMetadataTest;
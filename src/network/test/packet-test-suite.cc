@@ -17,10 +17,14 @@
  *
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
+#include "ns3/core-config.h"
 #include "ns3/packet.h"
 #include "ns3/packet-tag-list.h"
 #include "ns3/test.h"
 #include "ns3/unused.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
 #include <limits>     // std:numeric_limits
 #include <string>
 #include <cstdarg>
@@ -467,6 +471,9 @@ private:
   void CheckRefList (const PacketTagList & ref,
                      const char * msg,
                      int miss = 0);
+  void CheckOrder (Ptr<const Packet> p,
+                   const std::vector<TypeId> & expected,
+                   const char * msg);
   int RemoveTime (const PacketTagList & ref,
                   ATestTagBase & t,
                   const char * msg = 0);
@@ -528,6 +535,21 @@ PacketTagListTest::CheckRefList (const PacketTagList & ptl,
   CheckRef (ptl, t6, msg, miss == 6);
   CheckRef (ptl, t7, msg, miss == 7);
 }
+
+void
+PacketTagListTest::CheckOrder (Ptr<const Packet> p,
+                               const std::vector<TypeId> & expected,
+                               const char * msg)
+{
+  PacketTagIterator i = p->GetPacketTagIterator ();
+  for (uint32_t k = 0; k < expected.size (); ++k)
+    {
+      NS_TEST_ASSERT_MSG_EQ (i.HasNext (), true, msg << ": missing tag " << k);
+      NS_TEST_EXPECT_MSG_EQ (i.Next ().GetTypeId (), expected[k],
+                             msg << ": wrong tag " << k);
+    }
+  NS_TEST_EXPECT_MSG_EQ (i.HasNext (), false, msg << ": extra tags");
+}
   
 int
 PacketTagListTest::RemoveTime (const PacketTagList & ref,
@@ -675,6 +697,54 @@ PacketTagListTest::DoRun (void)
     ReplaceCheck (7);
   }
   
+  { // Inline slots
+    std::cout << GetName () << "check inline slots and iteration" << std::endl;
+    Ptr<Packet> p = Create<Packet> (10);
+    p->AddPacketTag (ATestTag<1> (1));  // inline
+    p->AddPacketTag (ATestTag<2> (2));  // inline
+    p->AddPacketTag (ATestTag<3> (3));  // tree
+    Ptr<Packet> c = p->Copy ();
+    ATestTag<1> s1 (11);
+    c->ReplacePacketTag (s1);
+    ATestTag<2> r2;
+    c->RemovePacketTag (r2);
+    NS_TEST_EXPECT_MSG_EQ (r2.GetData (), 2, "removed inline tag value");
+    c->AddPacketTag (ATestTag<4> (4));  // tree, newer than the inline tags
+
+    ATestTag<1> g1;
+    ATestTag<2> g2;
+    p->PeekPacketTag (g1);
+    p->PeekPacketTag (g2);
+    NS_TEST_EXPECT_MSG_EQ (g1.GetData (), 1, "original inline tag after copy replaced it");
+    NS_TEST_EXPECT_MSG_EQ (g2.GetData (), 2, "original inline tag after copy removed it");
+    c->PeekPacketTag (g1);
+    NS_TEST_EXPECT_MSG_EQ (g1.GetData (), 11, "replaced inline tag");
+    NS_TEST_EXPECT_MSG_EQ (c->PeekPacketTag (g2), false, "removed inline tag");
+
+    // the tags are iterated from the newest, as without inline slots
+    std::vector<TypeId> expected;
+    expected.push_back (ATestTag<4>::GetTypeId ());
+    expected.push_back (ATestTag<3>::GetTypeId ());
+    expected.push_back (ATestTag<1>::GetTypeId ());
+    CheckOrder (c, expected, "tree and inline slots");
+    c->PeekPacketTag (g1);
+    NS_TEST_EXPECT_MSG_EQ (g1.GetData (), 11, "replaced inline tag after iteration");
+
+    expected[0] = ATestTag<3>::GetTypeId ();
+    expected[1] = ATestTag<2>::GetTypeId ();
+    CheckOrder (p, expected, "original packet");
+
+    Ptr<Packet> q = Create<Packet> (10);
+    q->AddPacketTag (ATestTag<1> (1));
+    q->AddPacketTag (ATestTag<2> (2));
+    q->RemovePacketTag (g1);
+    q->AddPacketTag (ATestTag<5> (5));  // inline, the tree is empty
+    expected.resize (2);
+    expected[0] = ATestTag<5>::GetTypeId ();
+    expected[1] = ATestTag<2>::GetTypeId ();
+    CheckOrder (q, expected, "inline slots only");
+  }
+
   { // Timing
     std::cout << GetName () << "add+remove timing" << std::endl;
     int flm = std::numeric_limits<int>::max ();
@@ -716,6 +786,98 @@ PacketTagListTest::DoRun (void)
     
 }
 
+#ifdef HAVE_PTHREAD_H
+//-----------------------------------------------------------------------------
+class PacketThreadTest : public TestCase
+{
+public:
+  PacketThreadTest ();
+  virtual void DoRun (void);
+private:
+  /** Fill m_packets with packets of various sizes. */
+  void Create (void);
+  /** Check the content of m_packets, and destroy them. */
+  void CheckAndDestroy (void);
+
+  std::vector<Ptr<Packet> > m_packets;
+  bool m_ok;
+};
+
+PacketThreadTest::PacketThreadTest ()
+  : TestCase ("Check the packets created and destroyed by different threads")
+{
+}
+
+void
+PacketThreadTest::Create (void)
+{
+  uint8_t data[3000];
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      uint32_t size = 1 + (i * 37) % 3000;
+      for (uint32_t j = 0; j < size; j++)
+        {
+          data[j] = i + j;
+        }
+      Ptr<Packet> p = ns3::Create<Packet> (data, size);
+      p->AddByteTag (ATestTag<3> (i));
+      m_packets.push_back (p);
+    }
+}
+
+void
+PacketThreadTest::CheckAndDestroy (void)
+{
+  uint8_t data[3000];
+  for (uint32_t i = 0; i < m_packets.size (); i++)
+    {
+      uint32_t size = 1 + (i * 37) % 3000;
+      if (m_packets[i]->CopyData (data, sizeof (data)) != size)
+        {
+          m_ok = false;
+        }
+      for (uint32_t j = 0; j < size; j++)
+        {
+          if (data[j] != (uint8_t)(i + j))
+            {
+              m_ok = false;
+            }
+        }
+      ATestTag<3> tag;
+      if (!m_packets[i]->FindFirstMatchingByteTag (tag) || tag.GetData () != (uint8_t)i)
+        {
+          m_ok = false;
+        }
+    }
+  m_packets.clear ();
+}
+
+void
+PacketThreadTest::DoRun (void)
+{
+  m_ok = true;
+  for (uint32_t round = 0; round < 3; round++)
+    {
+      // The packets of this thread are destroyed by another one, and
+      // their memory is reused by this thread in the next round.
+      Create ();
+      SystemThread consumer (MakeCallback (&PacketThreadTest::CheckAndDestroy, this));
+      consumer.Start ();
+      consumer.Join ();
+      NS_TEST_ASSERT_MSG_EQ (m_packets.size (), 0, "The packets were not destroyed");
+
+      // The packets of another thread are destroyed by this one; the
+      // pool of the thread, which exited, is adopted by the next one.
+      SystemThread producer (MakeCallback (&PacketThreadTest::Create, this));
+      producer.Start ();
+      producer.Join ();
+      NS_TEST_ASSERT_MSG_EQ (m_packets.size (), 500, "The packets were not created");
+      CheckAndDestroy ();
+      NS_TEST_ASSERT_MSG_EQ (m_ok, true, "Corrupted packet in round " << round);
+    }
+}
+#endif /* HAVE_PTHREAD_H */
+
 //-----------------------------------------------------------------------------
 class PacketTestSuite : public TestSuite
 {
@@ -728,6 +890,9 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+#ifdef HAVE_PTHREAD_H
+  AddTestCase (new PacketThreadTest, TestCase::QUICK);
+#endif
 }
 
 static PacketTestSuite g_packetTestSuite;
@@ -70,7 +70,7 @@ Queue::Enqueue (Ptr<Packet> p)
   if (retval)
     {
       NS_LOG_LOGIC ("m_traceEnqueue (p)");
-      m_traceEnqueue (p);
+      NS_TRACE (m_traceEnqueue, (p));
 
       uint32_t size = p->GetSize ();
       m_nBytes += size;
@@ -98,7 +98,7 @@ Queue::Dequeue (void)
       m_nPackets--;
 
       NS_LOG_LOGIC ("m_traceDequeue (packet)");
-      m_traceDequeue (packet);
+      NS_TRACE (m_traceDequeue, (packet));
     }
   return packet;
 }
@@ -196,7 +196,7 @@ Queue::Drop (Ptr<Packet> p)
   m_nTotalDroppedBytes += p->GetSize ();
 
   NS_LOG_LOGIC ("m_traceDrop (p)");
-  m_traceDrop (p);
+  NS_TRACE (m_traceDrop, (p));
 }
 
 } // namespace ns3
@@ -22,6 +22,7 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/core-config.h"
 
 NS_LOG_COMPONENT_DEFINE ("PointToPointChannel");
 
@@ -93,9 +94,18 @@ PointToPointChannel::TransmitStart (
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
+  Ptr<Packet> rx = p;
+#ifdef NS3_MULTITHREADED
+  if (src->GetNode ()->GetSystemId () != m_link[wire].m_dst->GetNode ()->GetSystemId ())
+    {
+      // the receiver runs in another thread of the MultithreadedSimulatorImpl
+      // while the sender still holds p: hand over a packet of its own.
+      rx = p->Copy ();
+    }
+#endif
   Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
                                   txTime + m_delay, &PointToPointNetDevice::Receive,
-                                  m_link[wire].m_dst, p);
+                                  m_link[wire].m_dst, rx);
 
   // Call the tx anim callback on the net device
   m_txrxPointToPoint (GetId (), p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
@@ -216,7 +216,7 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
   m_txMachineState = BUSY;
   m_currentPkt = p;
-  m_phyTxBeginTrace (m_currentPkt);
+  NS_TRACE (m_phyTxBeginTrace, (m_currentPkt));
 
   Time txTime = Seconds (m_bps.CalculateTxTime (p->GetSize ()));
   Time txCompleteTime = txTime + m_tInterframeGap;
@@ -227,7 +227,7 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   bool result = m_channel->TransmitStart (p, this, txTime);
   if (result == false)
     {
-      m_phyTxDropTrace (p);
+      NS_TRACE (m_phyTxDropTrace, (p));
     }
   return result;
 }
@@ -248,7 +248,7 @@ PointToPointNetDevice::TransmitComplete (void)
 
   NS_ASSERT_MSG (m_currentPkt != 0, "PointToPointNetDevice::TransmitComplete(): m_currentPkt zero");
 
-  m_phyTxEndTrace (m_currentPkt);
+  NS_TRACE (m_phyTxEndTrace, (m_currentPkt));
   m_currentPkt = 0;
 
   Ptr<Packet> p = m_queue->Dequeue ();
@@ -263,8 +263,8 @@ PointToPointNetDevice::TransmitComplete (void)
   //
   // Got another packet off of the queue, so start the transmit process agin.
   //
-  m_snifferTrace (p);
-  m_promiscSnifferTrace (p);
+  NS_TRACE (m_snifferTrace, (p));
+  NS_TRACE (m_promiscSnifferTrace, (p));
   TransmitStart (p);
 }
 
@@ -312,7 +312,7 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
       // If we have an error model and it indicates that it is time to lose a
       // corrupted packet, don't forward this packet up, let it go.
       //
-      m_phyRxDropTrace (packet);
+      NS_TRACE (m_phyRxDropTrace, (packet));
     }
   else 
     {
@@ -321,9 +321,9 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
       // device because it is so simple, but this is not usually the case in
       // more complicated devices.
       //
-      m_snifferTrace (packet);
-      m_promiscSnifferTrace (packet);
-      m_phyRxEndTrace (packet);
+      NS_TRACE (m_snifferTrace, (packet));
+      NS_TRACE (m_promiscSnifferTrace, (packet));
+      NS_TRACE (m_phyRxEndTrace, (packet));
 
       //
       // Trace sinks will expect complete packets, not packets without some of the
@@ -341,11 +341,11 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
 
       if (!m_promiscCallback.IsNull ())
         {
-          m_macPromiscRxTrace (originalPacket);
+          NS_TRACE (m_macPromiscRxTrace, (originalPacket));
           m_promiscCallback (this, packet, protocol, GetRemote (), GetAddress (), NetDevice::PACKET_HOST);
         }
 
-      m_macRxTrace (originalPacket);
+      NS_TRACE (m_macRxTrace, (originalPacket));
       m_rxCallback (this, packet, protocol, GetRemote ());
     }
 }
@@ -491,7 +491,7 @@ PointToPointNetDevice::Send (
   //
   if (IsLinkUp () == false)
     {
-      m_macTxDropTrace (packet);
+      NS_TRACE (m_macTxDropTrace, (packet));
       return false;
     }
 
@@ -501,7 +501,7 @@ PointToPointNetDevice::Send (
   //
   AddHeader (packet, protocolNumber);
 
-  m_macTxTrace (packet);
+  NS_TRACE (m_macTxTrace, (packet));
 
   //
   // We should enqueue and dequeue the packet to hit the tracing hooks.
@@ -514,15 +514,15 @@ PointToPointNetDevice::Send (
       if (m_txMachineState == READY)
         {
           packet = m_queue->Dequeue ();
-          m_snifferTrace (packet);
-          m_promiscSnifferTrace (packet);
+          NS_TRACE (m_snifferTrace, (packet));
+          NS_TRACE (m_promiscSnifferTrace, (packet));
           return TransmitStart (packet);
         }
       return true;
     }
 
   // Enqueue may fail (overflow)
-  m_macTxDropTrace (packet);
+  NS_TRACE (m_macTxDropTrace, (packet));
   return false;
 }
 
@@ -3,6 +3,16 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/core-config.h"
+#ifdef NS3_MULTITHREADED
+#include "ns3/point-to-point-helper.h"
+#include "ns3/llc-snap-header.h"
+#include "ns3/node-container.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include <map>
+#include <vector>
+#endif
 
 using namespace ns3;
 
@@ -55,6 +65,216 @@ PointToPointTest::DoRun (void)
 
   Simulator::Destroy ();
 }
+#ifdef NS3_MULTITHREADED
+//-----------------------------------------------------------------------------
+/**
+ * Sends packets around a ring of point-to-point links split across the
+ * partitions of the MultithreadedSimulatorImpl. The receiver of a packet
+ * sent to another partition gets a copy which shares its buffer with the
+ * sender's packet, and both add headers to it at the same time: the
+ * payload and the headers must survive, and the packet uids must be
+ * unique and the same from one run to the next.
+ */
+class PointToPointPartitionsTest : public TestCase
+{
+public:
+  PointToPointPartitionsTest ();
+
+  virtual void DoRun (void);
+
+private:
+  class Forwarder : public SimpleRefCount<Forwarder>
+  {
+  public:
+    Forwarder (uint16_t id, uint32_t systemId, Ptr<NetDevice> next);
+    void Start (uint32_t burst);
+    void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                  const Address &from, const Address &to, NetDevice::PacketType type);
+    void Send (Ptr<Packet> packet);
+    void Touch (Ptr<Packet> packet);
+
+    uint16_t m_id;
+    uint32_t m_systemId;
+    Ptr<NetDevice> m_next;
+    std::vector<uint64_t> m_created;
+    std::vector<uint64_t> m_received;
+    uint32_t m_errors;
+  };
+
+  std::vector<Ptr<Forwarder> > RunRing (void);
+  std::map<uint64_t, uint32_t> GetCreationOrder (const std::vector<Ptr<Forwarder> > &forwarders);
+
+  static const uint32_t PAYLOAD = 64;
+};
+
+PointToPointPartitionsTest::Forwarder::Forwarder (uint16_t id, uint32_t systemId,
+                                                  Ptr<NetDevice> next)
+  : m_id (id),
+    m_systemId (systemId),
+    m_next (next),
+    m_errors (0)
+{
+}
+
+void
+PointToPointPartitionsTest::Forwarder::Start (uint32_t burst)
+{
+  for (uint32_t i = 0; i < burst; ++i)
+    {
+      uint8_t payload[PAYLOAD];
+      for (uint32_t j = 0; j < PAYLOAD; ++j)
+        {
+          payload[j] = j;
+        }
+      Ptr<Packet> packet = Create<Packet> (payload, PAYLOAD);
+      m_created.push_back (packet->GetUid ());
+      Send (packet);
+    }
+}
+
+void
+PointToPointPartitionsTest::Forwarder::Send (Ptr<Packet> packet)
+{
+  LlcSnapHeader llc;
+  llc.SetType (m_id);
+  packet->AddHeader (llc);
+  m_next->Send (packet, m_next->GetBroadcast (), 0x0800);
+  // keep writing in front of the packet which was sent, while the
+  // receiver writes in front of its copy.
+  Simulator::ScheduleNow (&Forwarder::Touch, this, packet);
+}
+
+void
+PointToPointPartitionsTest::Forwarder::Touch (Ptr<Packet> packet)
+{
+  LlcSnapHeader llc;
+  llc.SetType (0xffff);
+  packet->AddHeader (llc);
+  packet->RemoveHeader (llc);
+}
+
+void
+PointToPointPartitionsTest::Forwarder::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                                uint16_t protocol, const Address &from,
+                                                const Address &to, NetDevice::PacketType type)
+{
+  if (device == m_next)
+    {
+      return;
+    }
+  m_received.push_back (packet->GetUid ());
+  Ptr<Packet> copy = packet->Copy ();
+  LlcSnapHeader llc;
+  copy->RemoveHeader (llc);
+  uint8_t payload[PAYLOAD];
+  if (copy->CopyData (payload, PAYLOAD) != PAYLOAD || copy->GetSize () != PAYLOAD)
+    {
+      m_errors++;
+      return;
+    }
+  for (uint32_t j = 0; j < PAYLOAD; ++j)
+    {
+      if (payload[j] != j)
+        {
+          m_errors++;
+          return;
+        }
+    }
+  Send (copy);
+}
+
+PointToPointPartitionsTest::PointToPointPartitionsTest ()
+  : TestCase ("PointToPoint links between the partitions of the multithreaded simulator")
+{
+}
+
+std::vector<Ptr<PointToPointPartitionsTest::Forwarder> >
+PointToPointPartitionsTest::RunRing (void)
+{
+  const uint32_t partitions = 4;
+  const uint32_t nodes = 2;
+  const uint32_t total = partitions * nodes;
+
+  NodeContainer ring;
+  for (uint32_t i = 0; i < total; ++i)
+    {
+      ring.Add (CreateObject<Node> (i / nodes));
+    }
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  std::vector<Ptr<Forwarder> > forwarders;
+  for (uint32_t i = 0; i < total; ++i)
+    {
+      NetDeviceContainer link = p2p.Install (ring.Get (i), ring.Get ((i + 1) % total));
+      forwarders.push_back (Create<Forwarder> (i, i / nodes, link.Get (0)));
+    }
+  for (uint32_t i = 0; i < total; ++i)
+    {
+      ring.Get (i)->RegisterProtocolHandler (MakeCallback (&Forwarder::Receive, forwarders[i]),
+                                             0x0800, 0);
+      Simulator::ScheduleWithContext (i, Seconds (0), &Forwarder::Start, forwarders[i], 20);
+    }
+  Simulator::Stop (Seconds (0.1));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return forwarders;
+}
+
+void
+PointToPointPartitionsTest::DoRun (void)
+{
+  StringValue impl;
+  GlobalValue::GetValueByName ("SimulatorImplementationType", impl);
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SimulatorImplementationType",
+                     StringValue ("ns3::MultithreadedSimulatorImpl"));
+
+  std::vector<Ptr<Forwarder> > first = RunRing ();
+  std::vector<Ptr<Forwarder> > second = RunRing ();
+
+  GlobalValue::Bind ("SimulatorImplementationType", impl);
+
+  // the uid counters go on from one run to the next, so the packets
+  // are compared by creator and creation order.
+  std::map<uint64_t, uint32_t> firstUids = GetCreationOrder (first);
+  std::map<uint64_t, uint32_t> secondUids = GetCreationOrder (second);
+  for (uint32_t i = 0; i < first.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (first[i]->m_errors + second[i]->m_errors, 0,
+                             "node " << i << " received a corrupted packet");
+      NS_TEST_EXPECT_MSG_GT (first[i]->m_received.size (), 20u,
+                             "node " << i << " received too few packets");
+      NS_TEST_ASSERT_MSG_EQ (first[i]->m_received.size (), second[i]->m_received.size (),
+                             "node " << i << " received another number of packets in the second run");
+      for (uint32_t j = 0; j < first[i]->m_received.size (); ++j)
+        {
+          NS_TEST_EXPECT_MSG_EQ (firstUids[first[i]->m_received[j]], secondUids[second[i]->m_received[j]],
+                                 "node " << i << " received another packet in the second run");
+        }
+    }
+}
+
+std::map<uint64_t, uint32_t>
+PointToPointPartitionsTest::GetCreationOrder (const std::vector<Ptr<Forwarder> > &forwarders)
+{
+  std::map<uint64_t, uint32_t> order;
+  uint32_t created = 0;
+  for (uint32_t i = 0; i < forwarders.size (); ++i)
+    {
+      for (uint32_t j = 0; j < forwarders[i]->m_created.size (); ++j)
+        {
+          uint64_t uid = forwarders[i]->m_created[j];
+          NS_TEST_EXPECT_MSG_EQ ((uid >> 32), forwarders[i]->m_systemId,
+                                 "the uid of a packet does not tell its partition");
+          order[uid] = created++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (order.size (), created, "packet uids are not unique");
+  return order;
+}
+#endif /* NS3_MULTITHREADED */
+
 //-----------------------------------------------------------------------------
 class PointToPointTestSuite : public TestSuite
 {
@@ -66,6 +286,9 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+#ifdef NS3_MULTITHREADED
+  AddTestCase (new PointToPointPartitionsTest, TestCase::QUICK);
+#endif
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite;
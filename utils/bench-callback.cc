@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+std::string g_me;
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+// Output field width
+int g_fwidth = 12;
+
+// Sum of all the results, so that the compiler cannot skip the calls
+int64_t g_sum = 0;
+
+class Target : public SimpleRefCount<Target>
+{
+public:
+  int Add (int a) { return a + 1; }
+};
+
+/** A bound argument too large to be stored inline. */
+struct Large
+{
+  int m_values[32];
+};
+
+bool operator != (const Large &a, const Large &b)
+{
+  return std::memcmp (a.m_values, b.m_values, sizeof (a.m_values)) != 0;
+}
+
+int Function (int a) { return a + 2; }
+int BoundOne (Ptr<Target> target, int a) { return target->Add (a); }
+int BoundTwo (Ptr<Target> target, int b, int a) { return target->Add (a) + b; }
+int BoundLarge (Large large, int a) { return large.m_values[0] + a; }
+
+Target g_target;
+Ptr<Target> g_ptr = Create<Target> ();
+Large g_large;
+
+// The callbacks benchmarked
+Callback<int, int> MakeFunction (void) { return MakeCallback (&Function); }
+Callback<int, int> MakeMember (void) { return MakeCallback (&Target::Add, &g_target); }
+Callback<int, int> MakePtrMember (void) { return MakeCallback (&Target::Add, g_ptr); }
+Callback<int, int> MakeBoundOne (void) { return MakeBoundCallback (&BoundOne, g_ptr); }
+Callback<int, int> MakeBoundTwo (void) { return MakeBoundCallback (&BoundTwo, g_ptr, 3); }
+Callback<int, int> MakeBoundLarge (void) { return MakeBoundCallback (&BoundLarge, g_large); }
+
+/**
+ * Benchmark \p n creations, copies and invocations of the callbacks
+ * made by \p make, and print the mean duration of each, in ns.
+ */
+static void
+Run (std::string name, Callback<int, int> (*make)(void), uint32_t n)
+{
+  std::cout << std::left << std::setw (g_fwidth) << name
+            << std::right << std::fixed << std::setprecision (1) << std::flush;
+
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Callback<int, int> cb = make ();
+      g_sum += cb.IsNull ();
+    }
+  std::cout << std::setw (g_fwidth) << time.End () * 1000000.0 / n << std::flush;
+
+  Callback<int, int> cb = make ();
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Callback<int, int> copy = cb;
+      g_sum += copy.IsNull ();
+    }
+  std::cout << std::setw (g_fwidth) << time.End () * 1000000.0 / n << std::flush;
+
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_sum += cb (i);
+    }
+  std::cout << std::setw (g_fwidth) << time.End () * 1000000.0 / n << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 10000000;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the Callbacks.\n"
+             "\n"
+             "For the common shapes of Callbacks, --n Callbacks are created\n"
+             "and destroyed, copied and destroyed, and invoked. The time per\n"
+             "operation is printed.");
+  cmd.AddValue ("n", "number of operations (default 1E7)", n);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+  std::memset (&g_large, 0, sizeof (g_large));
+
+  LOGME ("operations: " << n);
+
+  LOG ("");
+  LOG ("ns per operation:");
+  std::cout << std::left << std::setw (g_fwidth) << ""
+            << std::right << std::setw (g_fwidth) << "create"
+            << std::right << std::setw (g_fwidth) << "copy"
+            << std::right << std::setw (g_fwidth) << "invoke"
+            << std::endl;
+  Run ("function", &MakeFunction, n);
+  Run ("member", &MakeMember, n);
+  Run ("Ptr member", &MakePtrMember, n);
+  Run ("bound 1", &MakeBoundOne, n);
+  Run ("bound 2", &MakeBoundTwo, n);
+  Run ("bound large", &MakeBoundLarge, n);
+  LOG ("");
+  NS_ASSERT (g_sum != 0);
+  return 0;
+}
@@ -0,0 +1,128 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+std::string g_me;
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+// Output field width
+int g_fwidth = 10;
+
+// Sum of all the hashes, so that the compiler cannot skip the calls
+uint64_t g_sum = 0;
+
+// The key sizes benchmarked
+const uint32_t g_sizes[] = { 4, 8, 16, 32, 64, 128, 256, 1024, 4096, 65536 };
+const uint32_t g_nSizes = sizeof (g_sizes) / sizeof (g_sizes[0]);
+
+/**
+ * Benchmark one hash function over all the key sizes.
+ *
+ * For each key size, hash keys of that size, taken at successive offsets
+ * in \p data, until \p bytes have been hashed, and print the throughput
+ * in MB/s.
+ */
+static void
+Run (std::string name, Hasher hasher, int bits,
+     const std::vector<char> &data, uint64_t bytes)
+{
+  std::cout << std::left << std::setw (16) << name
+            << std::right << std::fixed << std::setprecision (0) << std::flush;
+
+  for (uint32_t s = 0; s < g_nSizes; s++)
+    {
+      uint32_t size = g_sizes[s];
+      uint64_t n = bytes / size;
+      uint32_t offsets = data.size () - size;
+      uint32_t offset = 0;
+      SystemWallClockMs time;
+      time.Start ();
+      for (uint64_t i = 0; i < n; i++)
+        {
+          const char *key = &data[offset];
+          offset += 64;
+          if (offset >= offsets)
+            {
+              offset -= offsets;
+            }
+          if (bits == 32)
+            {
+              g_sum += hasher.clear ().GetHash32 (key, size);
+            }
+          else
+            {
+              g_sum += hasher.clear ().GetHash64 (key, size);
+            }
+        }
+      int64_t ms = time.End ();
+      std::cout << std::setw (g_fwidth)
+                << (ms > 0 ? (double)n * size / ms / 1000.0 : 0.0) << std::flush;
+    }
+  std::cout << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint64_t bytes = 500000000;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the hash functions.\n"
+             "\n"
+             "Each hash function hashes --bytes of keys of each size, and\n"
+             "its throughput is printed, in MB/s.");
+  cmd.AddValue ("bytes", "number of bytes hashed per key size (default 5E8)", bytes);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  std::vector<char> data (2 * g_sizes[g_nSizes - 1]);
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  for (uint32_t i = 0; i < data.size (); i++)
+    {
+      data[i] = rng->GetInteger (0, 255);
+    }
+
+  LOGME ("bytes per key size: " << bytes);
+  LOGME ("CRC32C: "
+         << (Hash::Function::Crc32c::IsAccelerated () ? "SSE4.2" : "software"));
+
+  LOG ("");
+  LOG ("MB/s, by key size in bytes:");
+  std::cout << std::left << std::setw (16) << "";
+  for (uint32_t s = 0; s < g_nSizes; s++)
+    {
+      std::cout << std::right << std::setw (g_fwidth) << g_sizes[s];
+    }
+  std::cout << std::endl;
+
+  Run ("FNV1a 32",   Hasher (Create<Hash::Function::Fnv1a> ()),   32, data, bytes);
+  Run ("FNV1a 64",   Hasher (Create<Hash::Function::Fnv1a> ()),   64, data, bytes);
+  Run ("Murmur3 32", Hasher (Create<Hash::Function::Murmur3> ()), 32, data, bytes);
+  Run ("Murmur3 64", Hasher (Create<Hash::Function::Murmur3> ()), 64, data, bytes);
+  Run ("xxHash 32",  Hasher (Create<Hash::Function::XxHash> ()),  32, data, bytes);
+  Run ("xxHash 64",  Hasher (Create<Hash::Function::XxHash> ()),  64, data, bytes);
+  Run ("CRC32C",     Hasher (Create<Hash::Function::Crc32c> ()),  32, data, bytes);
+  LOG ("");
+  NS_ASSERT (g_sum != 0);
+  return 0;
+}
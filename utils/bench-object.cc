@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+std::string g_me;
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+/**
+ * Print the mean duration of one of the \p n operations timed by \p time.
+ */
+static void
+Report (std::string what, SystemWallClockMs &time, uint32_t n)
+{
+  double elapsed = time.End ();
+  std::cout << std::left << std::setw (36) << what
+            << std::right << std::setw (10) << std::fixed << std::setprecision (1)
+            << elapsed * 1000000 / n << " ns" << std::endl;
+}
+
+/**
+ * Aggregate \p count objects of different types, as done for the
+ * protocols and models of a Node, and time GetObject on them.
+ */
+static void
+BenchGetObject (uint32_t n, uint32_t count)
+{
+  // pick the random variables, which all have a constructor
+  std::vector<TypeId> tids;
+  for (uint32_t i = 0; i < TypeId::GetRegisteredN () && tids.size () < count; ++i)
+    {
+      TypeId tid = TypeId::GetRegistered (i);
+      if (tid.IsChildOf (RandomVariableStream::GetTypeId ()) && tid.HasConstructor ())
+        {
+          tids.push_back (tid);
+        }
+    }
+  if (tids.empty ())
+    {
+      return;
+    }
+  ObjectFactory factory;
+  factory.SetTypeId (tids[0]);
+  Ptr<Object> node = factory.Create ();
+  for (uint32_t i = 1; i < tids.size (); ++i)
+    {
+      factory.SetTypeId (tids[i]);
+      node->AggregateObject (factory.Create ());
+    }
+
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      node->GetObject<Object> (tids[i % tids.size ()]);
+    }
+  std::ostringstream oss;
+  oss << "Object::GetObject, " << tids.size () << " aggregates";
+  Report (oss.str (), time, n);
+
+  time.Start ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      node->GetObject<RandomVariableStream> ();
+    }
+  Report ("Object::GetObject, parent type", time, n);
+
+  time.Start ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      node->GetObject<Scheduler> ();
+    }
+  Report ("Object::GetObject, missing type", time, n);
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 1000000;
+  uint32_t aggregates = 12;
+  std::string type = "ns3::NormalRandomVariable";
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the creation of objects and the access to their\n"
+             "attributes by name.\n"
+             "\n"
+             "Each line gives the mean duration of one of --n operations on\n"
+             "objects of the --type, which needs a constructor, or on\n"
+             "--aggregates objects aggregated together.");
+  cmd.AddValue ("n",    "number of operations (default 1E6)", n);
+  cmd.AddValue ("type", "TypeId of the objects",              type);
+  cmd.AddValue ("aggregates", "number of objects aggregated for GetObject (default 12)", aggregates);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  TypeId tid = TypeId::LookupByName (type);
+  // the attribute set through the factory and on the objects
+  struct TypeId::AttributeInformation info;
+  bool hasAttribute = false;
+  for (TypeId t = tid; !hasAttribute; t = t.GetParent ())
+    {
+      for (uint32_t i = 0; i < t.GetAttributeN () && !hasAttribute; ++i)
+        {
+          info = t.GetAttribute (i);
+          hasAttribute = (info.flags & TypeId::ATTR_SGC) == TypeId::ATTR_SGC;
+        }
+      if (t == t.GetParent ())
+        {
+          break;
+        }
+    }
+
+  LOGME ("type: " << type);
+  LOGME ("operations: " << n);
+  if (hasAttribute)
+    {
+      LOGME ("attribute: " << info.name);
+    }
+  LOG ("");
+
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      TypeId::LookupByName (type);
+    }
+  Report ("TypeId::LookupByName", time, n);
+
+  ObjectFactory factory;
+  factory.SetTypeId (tid);
+  time.Start ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      factory.Create ();
+    }
+  Report ("ObjectFactory::Create", time, n);
+
+  BenchGetObject (n, aggregates);
+
+  if (!hasAttribute)
+    {
+      return 0;
+    }
+
+  Ptr<Object> object = factory.Create ();
+  Ptr<AttributeValue> value = info.checker->Create ();
+  object->GetAttribute (info.name, *value);
+
+  factory.Set (info.name, *value);
+  time.Start ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      factory.Create ();
+    }
+  Report ("ObjectFactory::Create, 1 attribute", time, n);
+
+  time.Start ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      tid.LookupAttributeByName (info.name, &info);
+    }
+  Report ("TypeId::LookupAttributeByName", time, n);
+
+  time.Start ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      object->SetAttribute (info.name, *value);
+    }
+  Report ("ObjectBase::SetAttribute", time, n);
+
+  time.Start ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      object->GetAttribute (info.name, *value);
+    }
+  Report ("ObjectBase::GetAttribute", time, n);
+
+  LOG ("");
+  return 0;
+}
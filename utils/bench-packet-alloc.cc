@@ -0,0 +1,348 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/packet.h"
+#include "ns3/header.h"
+#include "ns3/tag.h"
+
+using namespace ns3;
+
+std::string g_me;
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+// Output field width
+int g_fwidth = 12;
+
+// The payload sizes benchmarked
+const uint32_t g_sizes[] = { 64, 512, 1500, 9000 };
+const uint32_t g_nSizes = sizeof (g_sizes) / sizeof (g_sizes[0]);
+
+/** A header of N bytes. */
+template <int N>
+class BenchHeader : public Header
+{
+public:
+  static std::string GetName (void)
+  {
+    std::ostringstream oss;
+    oss << "ns3::BenchAllocHeader<" << N << ">";
+    return oss.str ();
+  }
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId (GetName ().c_str ())
+      .SetParent<Header> ()
+      .HideFromDocumentation ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const
+  {
+    return GetTypeId ();
+  }
+  virtual void Print (std::ostream &os) const
+  {
+  }
+  virtual uint32_t GetSerializedSize (void) const
+  {
+    return N;
+  }
+  virtual void Serialize (Buffer::Iterator start) const
+  {
+    start.WriteU8 (N, N);
+  }
+  virtual uint32_t Deserialize (Buffer::Iterator start)
+  {
+    start.Next (N);
+    return N;
+  }
+};
+
+/** A byte tag, so that the tag lists are allocated too. */
+class BenchTag : public Tag
+{
+public:
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::BenchAllocTag")
+      .SetParent<Tag> ()
+      .AddConstructor<BenchTag> ()
+      .HideFromDocumentation ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const
+  {
+    return GetTypeId ();
+  }
+  virtual uint32_t GetSerializedSize (void) const
+  {
+    return 4;
+  }
+  virtual void Serialize (TagBuffer buf) const
+  {
+    buf.WriteU32 (0);
+  }
+  virtual void Deserialize (TagBuffer buf)
+  {
+    buf.ReadU32 ();
+  }
+  virtual void Print (std::ostream &os) const
+  {
+  }
+};
+
+/**
+ * One cycle: create a packet, add its headers and a byte tag, copy
+ * it, cut the copy in two fragments, reassemble them and destroy all
+ * the packets.
+ */
+static uint32_t
+Cycle (uint32_t size)
+{
+  BenchHeader<8> udp;
+  BenchHeader<20> ip;
+  BenchTag tag;
+
+  Ptr<Packet> p = Create<Packet> (size);
+  p->AddHeader (udp);
+  p->AddByteTag (tag);
+  p->AddHeader (ip);
+  Ptr<Packet> copy = p->Copy ();
+  uint32_t half = copy->GetSize () / 2;
+  Ptr<Packet> first = copy->CreateFragment (0, half);
+  Ptr<Packet> second = copy->CreateFragment (half, copy->GetSize () - half);
+  first->AddAtEnd (second);
+  first->RemoveHeader (ip);
+  return first->GetSize ();
+}
+
+/** The arguments and the result of a thread running Cycle. */
+struct Worker
+{
+  uint32_t size;
+  uint64_t n;
+  uint64_t sum;
+
+  void Run (void)
+  {
+    for (uint64_t i = 0; i < n; i++)
+      {
+        sum += Cycle (size);
+      }
+  }
+};
+
+/**
+ * Run \p n cycles in each of \p nThreads threads, and print the total
+ * number of cycles per second, for each payload size.
+ */
+static void
+RunCycles (uint32_t nThreads, uint64_t n)
+{
+  std::cout << std::left << std::setw (24) << "create/copy/fragment"
+            << std::right << std::fixed << std::setprecision (0) << std::flush;
+  for (uint32_t s = 0; s < g_nSizes; s++)
+    {
+      std::vector<Worker> workers (nThreads);
+      std::vector<Ptr<SystemThread> > threads;
+      SystemWallClockMs time;
+      time.Start ();
+      for (uint32_t t = 0; t < nThreads; t++)
+        {
+          workers[t].size = g_sizes[s];
+          workers[t].n = n;
+          workers[t].sum = 0;
+          if (t > 0)
+            {
+              threads.push_back (Create<SystemThread> (MakeCallback (&Worker::Run, &workers[t])));
+              threads.back ()->Start ();
+            }
+        }
+      workers[0].Run ();
+      for (uint32_t t = 0; t < threads.size (); t++)
+        {
+          threads[t]->Join ();
+        }
+      int64_t ms = time.End ();
+      for (uint32_t t = 0; t < nThreads; t++)
+        {
+          NS_ASSERT (workers[t].sum == n * (g_sizes[s] + 8));
+        }
+      std::cout << std::setw (g_fwidth)
+                << (ms > 0 ? (double)n * nThreads / ms * 1000.0 : 0.0) << std::flush;
+    }
+  std::cout << std::endl;
+}
+
+/**
+ * Packets created by a thread and destroyed by another, as with the
+ * reader thread of an emulated device.
+ */
+class Handoff
+{
+public:
+  Handoff (uint32_t size, uint64_t n)
+    : m_size (size),
+      m_n (n),
+      m_done (false)
+  {
+  }
+
+  /** Create the packets, and hand them over in batches of 64. */
+  void Produce (void)
+  {
+    BenchHeader<20> ip;
+    std::vector<Ptr<Packet> > batch;
+    for (uint64_t i = 0; i < m_n; i++)
+      {
+        Ptr<Packet> p = Create<Packet> (m_size);
+        p->AddHeader (ip);
+        batch.push_back (p);
+        if (batch.size () == 64 || i + 1 == m_n)
+          {
+            m_mutex.Lock ();
+            m_batches.push_back (std::vector<Ptr<Packet> > ());
+            m_batches.back ().swap (batch);
+            m_mutex.Unlock ();
+            m_ready.SetCondition (true);
+            m_ready.Signal ();
+          }
+      }
+    m_mutex.Lock ();
+    m_done = true;
+    m_mutex.Unlock ();
+  }
+
+  /** Destroy the packets, and return their number. */
+  uint64_t Consume (void)
+  {
+    uint64_t n = 0;
+    while (true)
+      {
+        std::vector<Ptr<Packet> > batch;
+        m_mutex.Lock ();
+        bool done = m_done && m_batches.empty ();
+        if (!m_batches.empty ())
+          {
+            batch.swap (m_batches.front ());
+            m_batches.pop_front ();
+          }
+        m_mutex.Unlock ();
+        if (done)
+          {
+            return n;
+          }
+        if (batch.empty ())
+          {
+            // A signal can be missed: wake up anyway.
+            m_ready.TimedWait (100000);
+          }
+        n += batch.size ();
+      }
+  }
+
+private:
+  uint32_t m_size;
+  uint64_t m_n;
+  bool m_done;
+  SystemMutex m_mutex;
+  SystemCondition m_ready;
+  std::deque<std::vector<Ptr<Packet> > > m_batches;
+};
+
+static void
+RunHandoff (uint64_t n)
+{
+  std::cout << std::left << std::setw (24) << "cross-thread free"
+            << std::right << std::fixed << std::setprecision (0) << std::flush;
+  for (uint32_t s = 0; s < g_nSizes; s++)
+    {
+      Handoff handoff (g_sizes[s], n);
+      SystemWallClockMs time;
+      time.Start ();
+      SystemThread producer (MakeCallback (&Handoff::Produce, &handoff));
+      producer.Start ();
+      uint64_t consumed = handoff.Consume ();
+      producer.Join ();
+      int64_t ms = time.End ();
+      NS_ASSERT (consumed == n);
+      std::cout << std::setw (g_fwidth)
+                << (ms > 0 ? (double)consumed / ms * 1000.0 : 0.0) << std::flush;
+    }
+  std::cout << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint64_t n = 1000000;
+  uint32_t threads = 1;
+  bool printing = false;
+  uint32_t sampling = 1;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the allocation of the packets.\n"
+             "\n"
+             "Each thread runs --n cycles which create a packet, add headers\n"
+             "and a byte tag, copy it, fragment the copy, reassemble the\n"
+             "fragments and destroy all the packets.  Then a thread creates\n"
+             "--n packets which the main thread destroys.  The number of\n"
+             "packets per second is printed for each payload size.");
+  cmd.AddValue ("n", "number of cycles per thread and payload size", n);
+  cmd.AddValue ("threads", "number of threads running the cycles", threads);
+  cmd.AddValue ("printing", "enable the packet metadata", printing);
+  cmd.AddValue ("sampling", "with --printing, keep the metadata of one packet in this many", sampling);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  if (printing)
+    {
+      Packet::EnableSampledPrinting (sampling);
+    }
+  // Create the simulator and register the types before starting the
+  // threads.
+  Cycle (g_sizes[0]);
+
+  LOGME ("cycles per thread and payload size: " << n);
+  LOGME ("threads: " << threads);
+  LOGME ("metadata: " << (printing ? "enabled" : "disabled"));
+  if (printing && sampling > 1)
+    {
+      LOGME ("metadata of one packet in: " << sampling);
+    }
+
+  LOG ("");
+  LOG ("packets/s, by payload size in bytes:");
+  std::cout << std::left << std::setw (24) << "";
+  for (uint32_t s = 0; s < g_nSizes; s++)
+    {
+      std::cout << std::right << std::setw (g_fwidth) << g_sizes[s];
+    }
+  std::cout << std::endl;
+
+  RunCycles (threads, n);
+  RunHandoff (n);
+  LOG ("");
+  return 0;
+}
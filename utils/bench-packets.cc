@@ -242,6 +242,30 @@ benchC (uint32_t n)
 }
 
 
+static void
+benchE (uint32_t n)
+{
+  BenchTag<2> hopCount;
+  BenchTag<4> flowId;
+  BenchTag<19> packetInfo;
+
+  for (uint32_t i = 0; i < n; i++) {
+    Ptr<Packet> p = Create<Packet> (2000);
+    p->AddPacketTag (flowId);
+    p->AddPacketTag (hopCount);
+    for (uint32_t hop = 0; hop < 10; hop++) {
+      // each hop forwards a copy, updates the hop count, and
+      // tags the packet with its reception info while it handles it
+      p = p->Copy ();
+      p->PeekPacketTag (hopCount);
+      p->ReplacePacketTag (hopCount);
+      p->AddPacketTag (packetInfo);
+      p->PeekPacketTag (flowId);
+      p->RemovePacketTag (packetInfo);
+    }
+  }
+}
+
 static void
 runBench (void (*bench) (uint32_t), uint32_t n, char const *name)
 {
@@ -289,6 +313,7 @@ int main (int argc, char *argv[])
   runBench (&benchB, n, "Just add headers");
   runBench (&benchC, n, "Remove by func call");
   runBench (&benchD, n, "Intermixed add/remove headers and tags");
+  runBench (&benchE, n, "Packet tags along a 10-hop path");
 
   return 0;
 }
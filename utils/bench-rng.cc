@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+std::string g_me;
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+// Output field width
+int g_fwidth = 12;
+
+// Sum of all the values drawn, so that the compiler cannot skip them
+double g_sum = 0;
+
+/**
+ * Split a comma separated list.
+ */
+static std::vector<std::string>
+Split (std::string list)
+{
+  std::vector<std::string> items;
+  std::istringstream iss (list);
+  std::string item;
+  while (std::getline (iss, item, ','))
+    {
+      if (!item.empty ())
+        {
+          items.push_back (item);
+        }
+    }
+  return items;
+}
+
+/**
+ * Draw \p n values from a new random variable of type \p type, with
+ * GetValue when \p block is 0, or else with GetValues, \p block values
+ * at a time.
+ *
+ * \return the mean duration of a value, in ns.
+ */
+static double
+Run (std::string type, uint32_t n, uint32_t block, uint32_t buffer)
+{
+  ObjectFactory factory ("ns3::" + type + "RandomVariable");
+  factory.Set ("BufferSize", UintegerValue (buffer));
+  Ptr<RandomVariableStream> rv = factory.Create<RandomVariableStream> ();
+  std::vector<double> values (block);
+
+  SystemWallClockMs time;
+  time.Start ();
+  if (block == 0)
+    {
+      for (uint32_t i = 0; i < n; i++)
+        {
+          g_sum += rv->GetValue ();
+        }
+    }
+  else
+    {
+      for (uint32_t i = 0; i < n; i += block)
+        {
+          rv->GetValues (&values[0], block);
+          g_sum += values[0];
+        }
+    }
+  double elapsed = time.End ();
+  return elapsed * 1000000 / n;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 10000000;
+  uint32_t block = 256;
+  uint32_t buffer = 256;
+  std::string types = "Uniform,Exponential,Pareto,Normal";
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the generation of random variables.\n"
+             "\n"
+             "For each of the --types of random variables, --n values are\n"
+             "drawn one at a time with GetValue, then with GetValue again from\n"
+             "a stream with a --buffer of uniform random numbers, then --block\n"
+             "values at a time with GetValues. The time per value is printed.");
+  cmd.AddValue ("n",      "number of values (default 1E7)",               n);
+  cmd.AddValue ("block",  "number of values per GetValues (default 256)", block);
+  cmd.AddValue ("buffer", "BufferSize of the buffered streams (default 256)", buffer);
+  cmd.AddValue ("types",  "comma separated list of random variables",     types);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  LOGME ("values: " << n);
+  LOGME ("block: " << block);
+  LOGME ("buffer: " << buffer);
+
+  LOG ("");
+  LOG ("ns per value:");
+  std::cout << std::left << std::setw (g_fwidth) << ""
+            << std::right << std::setw (g_fwidth) << "GetValue"
+            << std::right << std::setw (g_fwidth) << "buffered"
+            << std::right << std::setw (g_fwidth) << "GetValues"
+            << std::endl;
+  std::vector<std::string> typeList = Split (types);
+  for (std::vector<std::string>::const_iterator t = typeList.begin (); t != typeList.end (); ++t)
+    {
+      std::cout << std::left << std::setw (g_fwidth) << *t << std::flush;
+      std::cout << std::right << std::setw (g_fwidth) << std::fixed << std::setprecision (1)
+                << Run (*t, n, 0, 0) << std::flush;
+      std::cout << std::right << std::setw (g_fwidth) << Run (*t, n, 0, buffer) << std::flush;
+      std::cout << std::right << std::setw (g_fwidth) << Run (*t, n, block, 0) << std::endl;
+    }
+  LOG ("");
+  NS_ASSERT (g_sum != 0);
+  return 0;
+}
@@ -0,0 +1,273 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+std::string g_me;
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+// Output field width
+int g_fwidth = 12;
+
+// Number of pre-computed inter-event times, cycled through by the hold loop
+static const uint32_t NSAMPLES = 1 << 16;
+
+static void
+Nothing (void)
+{
+}
+
+/**
+ * Split a comma separated list.
+ */
+static std::vector<std::string>
+Split (std::string list)
+{
+  std::vector<std::string> items;
+  std::istringstream iss (list);
+  std::string item;
+  while (std::getline (iss, item, ','))
+    {
+      if (!item.empty ())
+        {
+          items.push_back (item);
+        }
+    }
+  return items;
+}
+
+/**
+ * Draw NSAMPLES inter-event times, in scheduler time units, with a mean
+ * close to \p mean.
+ */
+static std::vector<uint64_t>
+GetSamples (std::string dist, double mean)
+{
+  std::vector<uint64_t> samples (NSAMPLES);
+  if (dist == "exp")
+    {
+      Ptr<ExponentialRandomVariable> rv = CreateObject<ExponentialRandomVariable> ();
+      rv->SetAttribute ("Mean", DoubleValue (mean));
+      for (uint32_t i = 0; i < NSAMPLES; i++)
+        {
+          samples[i] = rv->GetValue ();
+        }
+    }
+  else if (dist == "uniform")
+    {
+      Ptr<UniformRandomVariable> rv = CreateObject<UniformRandomVariable> ();
+      for (uint32_t i = 0; i < NSAMPLES; i++)
+        {
+          samples[i] = rv->GetValue (0, 2 * mean);
+        }
+    }
+  else if (dist == "bimodal")
+    {
+      // 90% of short delays, 10% of delays 10 times as long as the mean
+      Ptr<UniformRandomVariable> rv = CreateObject<UniformRandomVariable> ();
+      for (uint32_t i = 0; i < NSAMPLES; i++)
+        {
+          if (rv->GetValue () < 0.9)
+            {
+              samples[i] = rv->GetValue (0, 0.2 * mean);
+            }
+          else
+            {
+              samples[i] = rv->GetValue (9 * mean, 11 * mean);
+            }
+        }
+    }
+  else if (dist == "pareto")
+    {
+      Ptr<ParetoRandomVariable> rv = CreateObject<ParetoRandomVariable> ();
+      rv->SetAttribute ("Mean", DoubleValue (mean));
+      rv->SetAttribute ("Shape", DoubleValue (1.5));
+      for (uint32_t i = 0; i < NSAMPLES; i++)
+        {
+          samples[i] = rv->GetValue ();
+        }
+    }
+  else if (dist == "constant")
+    {
+      for (uint32_t i = 0; i < NSAMPLES; i++)
+        {
+          samples[i] = mean;
+        }
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Unknown distribution " << dist);
+    }
+  return samples;
+}
+
+/**
+ * Run the classic hold model: fill the scheduler with \p pop events, then
+ * repeat \p ops times: remove the earliest event and insert it back later
+ * by an inter-event time taken from \p samples. When \p cancel is not
+ * zero, that fraction of the hold operations also cancels a random pending
+ * event and schedules it again, as done by timers which are restarted.
+ *
+ * \return the mean duration of a hold operation, in ns.
+ */
+static double
+RunHold (ObjectFactory factory, const std::vector<uint64_t> &samples,
+         uint32_t pop, uint32_t ops, double cancel)
+{
+  Ptr<Scheduler> scheduler = factory.Create<Scheduler> ();
+  // pending event of each of the pop slots, and slot of each uid
+  std::vector<Scheduler::Event> pending (pop);
+  std::vector<uint32_t> slots (pop);
+  uint32_t cancelThreshold = cancel * 1000;
+  uint32_t uid = 0;
+  uint32_t next = 0;
+  for (uint32_t i = 0; i < pop; i++)
+    {
+      Scheduler::Event ev;
+      ev.impl = MakeEvent (&Nothing);
+      ev.key.m_ts = samples[next++ % NSAMPLES];
+      ev.key.m_uid = uid++;
+      scheduler->Insert (ev);
+      pending[i] = ev;
+      slots[i] = i;
+    }
+  if (cancelThreshold > 0)
+    {
+      slots.resize (pop + 2 * ops);
+    }
+  // cheap linear congruential generator for the cancellations
+  uint32_t rng = 1;
+
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < ops; i++)
+    {
+      Scheduler::Event ev = scheduler->RemoveNext ();
+      uint32_t slot = cancelThreshold > 0 ? slots[ev.key.m_uid] : 0;
+      ev.key.m_ts += samples[next++ % NSAMPLES];
+      ev.key.m_uid = uid++;
+      scheduler->Insert (ev);
+      if (cancelThreshold > 0)
+        {
+          slots[ev.key.m_uid] = slot;
+          pending[slot] = ev;
+          rng = rng * 1664525 + 1013904223;
+          if ((rng >> 8) % 1000 < cancelThreshold)
+            {
+              rng = rng * 1664525 + 1013904223;
+              slot = (rng >> 8) % pop;
+              ev = pending[slot];
+              scheduler->Remove (ev);
+              ev.key.m_ts += samples[next++ % NSAMPLES];
+              ev.key.m_uid = uid++;
+              scheduler->Insert (ev);
+              slots[ev.key.m_uid] = slot;
+              pending[slot] = ev;
+            }
+        }
+    }
+  double elapsed = time.End ();
+
+  while (!scheduler->IsEmpty ())
+    {
+      scheduler->RemoveNext ();
+    }
+  for (std::vector<Scheduler::Event>::const_iterator i = pending.begin (); i != pending.end (); ++i)
+    {
+      i->impl->Unref ();
+    }
+  return elapsed * 1000000 / ops;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t pop = 100000;
+  uint32_t ops = 1000000;
+  double mean = 1000;
+  std::string schedulers = "Map,Heap,DaryHeap,Calendar,Ladder";
+  std::string dists = "exp,uniform,bimodal,pareto,constant";
+  uint32_t arity = 4;
+  double cancel = 0;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the event schedulers with the hold model.\n"
+             "\n"
+             "The scheduler is first filled with --pop events, then each of\n"
+             "the --ops hold operations removes the earliest event and inserts\n"
+             "it back after an inter-event time drawn from each of the\n"
+             "distributions (exp, uniform, bimodal, pareto, constant), all with\n"
+             "the same --mean. The time per hold operation is printed for each\n"
+             "scheduler of --sched (by default Map, Heap, DaryHeap, Calendar\n"
+             "and Ladder; List is also available).\n"
+             "With --cancel, that fraction of the hold operations also cancels\n"
+             "a random pending event and schedules it again.");
+  cmd.AddValue ("pop",    "event population size (default 1E5)",          pop);
+  cmd.AddValue ("ops",    "number of hold operations (default 1E6)",       ops);
+  cmd.AddValue ("mean",   "mean inter-event time (default 1000)",          mean);
+  cmd.AddValue ("sched",  "comma separated list of schedulers",            schedulers);
+  cmd.AddValue ("dist",   "comma separated list of distributions",         dists);
+  cmd.AddValue ("arity",  "arity of the DaryHeapScheduler (default 4)",    arity);
+  cmd.AddValue ("cancel", "fraction of hold operations which also cancel an event (default 0)", cancel);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  std::vector<std::string> schedList = Split (schedulers);
+  std::vector<std::string> distList = Split (dists);
+
+  LOGME ("population: " << pop);
+  LOGME ("hold operations: " << ops);
+  LOGME ("mean inter-event time: " << mean);
+  LOGME ("cancelled fraction: " << cancel);
+
+  // table header
+  LOG ("");
+  LOG ("ns per hold operation:");
+  std::cout << std::left << std::setw (g_fwidth) << "";
+  for (std::vector<std::string>::const_iterator s = schedList.begin (); s != schedList.end (); ++s)
+    {
+      std::cout << std::right << std::setw (g_fwidth) << *s;
+    }
+  std::cout << std::endl;
+
+  for (std::vector<std::string>::const_iterator d = distList.begin (); d != distList.end (); ++d)
+    {
+      std::vector<uint64_t> samples = GetSamples (*d, mean);
+      std::cout << std::left << std::setw (g_fwidth) << *d << std::flush;
+      for (std::vector<std::string>::const_iterator s = schedList.begin (); s != schedList.end (); ++s)
+        {
+          ObjectFactory factory ("ns3::" + *s + "Scheduler");
+          if (*s == "DaryHeap")
+            {
+              factory.Set ("Arity", UintegerValue (arity));
+            }
+          double ns = RunHold (factory, samples, pop, ops, cancel);
+          std::cout << std::right << std::setw (g_fwidth) << std::fixed
+                    << std::setprecision (1) << ns << std::flush;
+        }
+      std::cout << std::endl;
+    }
+
+  LOG ("");
+  return 0;
+}
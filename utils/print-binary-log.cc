@@ -0,0 +1,47 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <iostream>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  std::string file;
+
+  CommandLine cmd;
+  cmd.Usage ("Print a binary log file, written with the NS_LOG_BINARY_FILE\n"
+             "environment variable or with ns3::LogSetBinaryFile, as the\n"
+             "log messages would have been printed to std::clog.");
+  cmd.AddValue ("file", "the binary log file", file);
+  cmd.Parse (argc, argv);
+
+  std::ifstream is (file.c_str (), std::ios::binary);
+  if (!is)
+    {
+      std::cerr << cmd.GetName () << ": could not open \"" << file << "\"" << std::endl;
+      return 1;
+    }
+  if (!LogPrintBinary (is, std::cout))
+    {
+      std::cerr << cmd.GetName () << ": \"" << file << "\" is not a complete binary log file" << std::endl;
+      return 1;
+    }
+  return 0;
+}